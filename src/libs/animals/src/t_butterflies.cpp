@@ -97,7 +97,7 @@ void TButterflies::Execute(uint32_t _dTime)
     butterflies[0].SetCenter(pos);
     int i;
 
-    const auto its = core.GetEntityIds(SHADOW);
+    const auto its = core.GetLayerSnapshot(SHADOW);
 
     // redefine minY
     yDefineTime += _dTime;
@@ -111,7 +111,7 @@ void TButterflies::Execute(uint32_t _dTime)
             topVector.y = ALL_Y;
             bottomVector.y = -ALL_Y;
 
-            const auto ray = collide->Trace(its, topVector, bottomVector, nullptr, 0);
+            const auto ray = collide->Trace(its.ids(), topVector, bottomVector, nullptr, 0);
             if (ray <= 1.0f)
                 butterflies[i].SetMinY(-ALL_Y + (1.f - ray) * 2.f * ALL_Y);
             else
@@ -124,7 +124,7 @@ void TButterflies::Execute(uint32_t _dTime)
 
     for (i = 0; i < butterfliesCount; i++)
     {
-        butterflies[i].Calculate(_dTime, collide, its);
+        butterflies[i].Calculate(_dTime, collide, its.ids());
         butterflies[i].Draw(ivManager);
         // butterflies[i].Draw(renderService);
     }
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "c_vector.h"
+
+#include <cstdint>
+#include <deque>
+
+constexpr int SPLASH_FADE_IN_TIME = 700;
+constexpr int SPLASH_FADE_TIME = 4700;
+constexpr float SPLASH_MOVE_Y = -0.05f;
+
+constexpr int GRID_STEPS = 8;
+constexpr float GRID_LENGTH = 4.1f;
+constexpr int TRIANGLES_COUNT = ((GRID_STEPS - 1) * (GRID_STEPS - 1) * 2);
+
+constexpr int SPLASH_FRAME_DELAY = 65;
+constexpr int SPLASH_FRAMES_COUNT = 64;
+
+struct GRID_VERTEX
+{
+    CVECTOR pos;
+    uint32_t color;
+    float tu, tv;
+};
+
+namespace storm
+{
+
+/**
+ * \brief Water grid of a cannonball splash at one age
+ *
+ * Heights, colour and texture coordinates depend only on the age of a splash. So splashes of one age share a profile,
+ * and each of them only moves and scales it.
+ */
+class SplashProfile final
+{
+  public:
+    static constexpr int kVertices = GRID_STEPS * GRID_STEPS;
+
+    void build(uint32_t time, uint32_t ambient);
+
+    // writes the grid of one splash: x and z scaled by growK around the centre, y lifted by midY
+    void expand(const CVECTOR &center, float growK, float midY, GRID_VERTEX *out) const;
+
+    [[nodiscard]] uint32_t time() const
+    {
+        return time_;
+    }
+
+    [[nodiscard]] uint32_t ambient() const
+    {
+        return ambient_;
+    }
+
+    // height of the water over the middle of the splash at the distance r from it
+    static float height(uint32_t time, float r);
+    // alpha in the top byte and the ambient colour below it
+    static uint32_t color(uint32_t time, uint32_t ambient);
+
+  private:
+    GRID_VERTEX grid_[kVertices];
+    uint32_t time_ = 0;
+    uint32_t ambient_ = 0;
+};
+
+// The profiles of the ages met in one frame
+class SplashProfiles final
+{
+  public:
+    const SplashProfile &get(uint32_t time, uint32_t ambient);
+    // keeps the memory for the next frame
+    void clear();
+
+    [[nodiscard]] size_t size() const
+    {
+        return used_;
+    }
+
+  private:
+    std::deque<SplashProfile> profiles_;
+    size_t used_ = 0;
+};
+
+} // namespace storm
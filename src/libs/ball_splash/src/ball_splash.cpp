@@ -86,29 +86,43 @@ void BALLSPLASH::Realize(uint32_t _dTime)
     TSplash::realizeTicks = 0;
     TSplash::processCount = 0;
 
-    // draw bottom part
-    TSplash::startRender = true;
-    TSplash::topIndex = 0;
-    auto lastProcessed = -1;
+    // draw bottom part, the splashes of one age share their grid profile
+    profiles.clear();
+    GRID_VERTEX *grids = nullptr;
+    uint32_t count = 0;
     for (auto i = 0; i < MAX_SPLASHES; ++i)
-        if (splashes[i].Process(_dTime))
-            lastProcessed = i;
-    if (lastProcessed != -1)
-        splashes[lastProcessed].PostProcess();
-    splashes[lastProcessed].Realize(_dTime);
+    {
+        if (!splashes[i].Enabled())
+            continue;
+        if (!grids)
+            grids = TSplash::LockGrids();
+        if (splashes[i].Process(_dTime, profiles, grids + count * GRID_STEPS * GRID_STEPS))
+            ++count;
+    }
+    if (grids)
+    {
+        TSplash::UnlockGrids();
+        TSplash::RealizeGrids(count);
+    }
 
     // draw top part
     const auto techniqueStarted = renderer->TechniqueExecuteStart("splash2");
-    TSplash::startRender = true;
-    TSplash::topIndex = 0;
-    lastProcessed = -1;
+    GRID_VERTEX2 *planes = nullptr;
+    count = 0;
     for (auto i = 0; i < MAX_SPLASHES; ++i)
     {
-        if (splashes[i].Process2(_dTime))
-            lastProcessed = i;
+        if (!splashes[i].Enabled())
+            continue;
+        if (!planes)
+            planes = TSplash::LockPlanes();
+        if (splashes[i].Process2(_dTime, planes + count * VPLANES_COUNT * 4))
+            ++count;
+    }
+    if (planes)
+    {
+        TSplash::UnlockPlanes();
+        TSplash::RealizePlanes(count);
     }
-    splashes[lastProcessed].PostProcess2();
-    splashes[lastProcessed].Realize2(_dTime);
     if (techniqueStarted)
         while (renderer->TechniqueExecuteNext())
             ;
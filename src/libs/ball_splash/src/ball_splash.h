@@ -44,6 +44,7 @@ class BALLSPLASH : public Entity
     TSplash *TryToAddSplash(const CVECTOR &_pos, const CVECTOR &_dir);
 
     TSplash splashes[MAX_SPLASHES];
+    storm::SplashProfiles profiles;
     VDX9RENDER *renderer;
     SEA_BASE *sea;
 };
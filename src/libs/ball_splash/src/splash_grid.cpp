@@ -0,0 +1,100 @@
+#include "splash_grid.h"
+
+#include <cmath>
+#include <emmintrin.h>
+
+namespace storm
+{
+
+static_assert(sizeof(GRID_VERTEX) == 6 * sizeof(float));
+static_assert(SplashProfile::kVertices % 2 == 0);
+
+float SplashProfile::height(uint32_t time, float r)
+{
+    const auto rK = (GRID_LENGTH - r) / GRID_LENGTH;
+    auto k = static_cast<float>(time) / SPLASH_FADE_TIME;
+    if (k > 1.0f)
+        k = 1.0f;
+    k = 1.f - k;
+    return (.55f + k * fabsf(cosf(rK * 10.f + time / 7e2f))) * rK * rK;
+}
+
+uint32_t SplashProfile::color(uint32_t time, uint32_t ambient)
+{
+    const int dt = time - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2;
+    uint32_t alpha;
+    if (time < SPLASH_FADE_IN_TIME)
+        alpha = static_cast<uint32_t>(255.f * time / SPLASH_FADE_IN_TIME);
+    else if (dt < 0)
+        alpha = 0xFF;
+    else
+        alpha = static_cast<uint32_t>(255.f -
+                                      dt * 255.f / (SPLASH_FADE_TIME - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2));
+    return (alpha << 24) | (0x00FFFFFF & ambient);
+}
+
+void SplashProfile::build(uint32_t time, uint32_t ambient)
+{
+    time_ = time;
+    ambient_ = ambient;
+
+    const auto stepSize = static_cast<float>(GRID_LENGTH) / static_cast<float>(GRID_STEPS);
+    const auto halfSize = GRID_LENGTH / 2.0f;
+    const auto color = SplashProfile::color(time, ambient);
+    auto *vertex = grid_;
+    for (int z = 0; z < GRID_STEPS; ++z)
+        for (int x = 0; x < GRID_STEPS; ++x, ++vertex)
+        {
+            vertex->pos.x = stepSize * x - halfSize;
+            vertex->pos.z = stepSize * z - halfSize;
+            // the border stays under the water
+            if ((x > 0) && (z > 0) && (x < GRID_STEPS - 1) && (z < GRID_STEPS - 1))
+                vertex->pos.y = height(time, sqrtf(vertex->pos.x * vertex->pos.x + vertex->pos.z * vertex->pos.z));
+            else
+                vertex->pos.y = 2 * SPLASH_MOVE_Y;
+            vertex->color = color;
+            vertex->tu = static_cast<float>(x) / (GRID_STEPS - 1);
+            vertex->tv = static_cast<float>(z) / (GRID_STEPS - 1);
+        }
+}
+
+void SplashProfile::expand(const CVECTOR &center, float growK, float midY, GRID_VERTEX *out) const
+{
+    // two vertices are three registers: [x y z c] [u v x y] [z c u v], the colour is copied as it is
+    const __m128 mul[3] = {_mm_setr_ps(growK, 1.0f, growK, 1.0f), _mm_setr_ps(1.0f, 1.0f, growK, 1.0f),
+                           _mm_setr_ps(growK, 1.0f, 1.0f, 1.0f)};
+    const __m128 add[3] = {_mm_setr_ps(center.x, midY, center.z, 0.0f), _mm_setr_ps(0.0f, 0.0f, center.x, midY),
+                           _mm_setr_ps(center.z, 0.0f, 0.0f, 0.0f)};
+    const __m128 keep[3] = {_mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1)), _mm_setzero_ps(),
+                            _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, 0))};
+
+    const auto *src = reinterpret_cast<const float *>(grid_);
+    auto *dst = reinterpret_cast<float *>(out);
+    for (int n = 0; n < kVertices / 2; n++, src += 12, dst += 12)
+        for (int r = 0; r < 3; r++)
+        {
+            const auto v = _mm_loadu_ps(src + r * 4);
+            const auto moved = _mm_add_ps(_mm_mul_ps(v, mul[r]), add[r]);
+            _mm_storeu_ps(dst + r * 4, _mm_or_ps(_mm_and_ps(keep[r], v), _mm_andnot_ps(keep[r], moved)));
+        }
+}
+
+const SplashProfile &SplashProfiles::get(uint32_t time, uint32_t ambient)
+{
+    for (size_t i = 0; i < used_; i++)
+        if (profiles_[i].time() == time && profiles_[i].ambient() == ambient)
+            return profiles_[i];
+
+    if (used_ == profiles_.size())
+        profiles_.emplace_back();
+    auto &profile = profiles_[used_++];
+    profile.build(time, ambient);
+    return profile;
+}
+
+void SplashProfiles::clear()
+{
+    used_ = 0;
+}
+
+} // namespace storm
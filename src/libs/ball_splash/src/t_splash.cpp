@@ -4,7 +4,6 @@
 #include "math_inlines.h"
 
 VDX9RENDER *TSplash::renderer = nullptr;
-bool TSplash::startRender = true;
 float dU = 1.f / SPLASH_FRAMES_COUNT;
 
 int TSplash::buffersUsage = 0;
@@ -27,10 +26,10 @@ uint64_t TSplash::fillTicks = 0;
 uint64_t TSplash::unlockTicks = 0;
 uint64_t TSplash::realizeTicks = 0;
 uint32_t TSplash::processCount = 0;
-uint32_t TSplash::topIndex = 0;
-uint32_t TSplash::topIndex2 = 0;
 
 uint32_t ambientColor = 0;
+// directions of the vertical planes, the same for every splash
+static float planeCos[VPLANES_COUNT], planeSin[VPLANES_COUNT];
 //--------------------------------------------------------------------
 uint32_t Desaturate(uint32_t _color, float _k)
 {
@@ -95,10 +94,10 @@ void TSplash::Initialize(INIFILE *_ini, IDirect3DDevice9 *_device, SEA_BASE *_se
         iBuffer =
             renderer->CreateIndexBuffer(MAX_SPLASHES * TRIANGLES_COUNT * 3 * sizeof(uint16_t), D3DUSAGE_WRITEONLY);
         vBuffer = renderer->CreateVertexBuffer(GRID_FVF, MAX_SPLASHES * GRID_STEPS * GRID_STEPS * sizeof(GRID_VERTEX),
-                                               D3DUSAGE_WRITEONLY);
+                                               D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC);
         iBuffer2 = renderer->CreateIndexBuffer(MAX_SPLASHES * VPLANES_COUNT * 6 * sizeof(uint16_t), D3DUSAGE_WRITEONLY);
         vBuffer2 = renderer->CreateVertexBuffer(GRID_FVF2, MAX_SPLASHES * VPLANES_COUNT * 4 * sizeof(GRID_VERTEX2),
-                                                D3DUSAGE_WRITEONLY);
+                                                D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC);
 
         texture = renderer->TextureCreate("explos.tga");
         texture2 = renderer->TextureCreate("splash.tga");
@@ -136,6 +135,13 @@ void TSplash::Initialize(INIFILE *_ini, IDirect3DDevice9 *_device, SEA_BASE *_se
                 *(indexes++) = startIndex + j * 4 + 3;
             }
         renderer->UnLockIndexBuffer(iBuffer2);
+
+        auto a = 0.f;
+        for (auto i = 0; i < VPLANES_COUNT; i++, a += PI / VPLANES_COUNT)
+        {
+            planeCos[i] = cosf(a);
+            planeSin[i] = sinf(a);
+        }
     }
 }
 
@@ -169,19 +175,7 @@ void TSplash::Start(const CVECTOR &_pos, const CVECTOR &_dir)
 }
 
 //--------------------------------------------------------------------
-float TSplash::HeightF(uint32_t _time, float _r, float _k)
-{
-    auto tPhase = static_cast<float>(_time) * (2.f * PId2 / (SPLASH_FRAME_DELAY * SPLASH_FRAMES_COUNT));
-    const auto rK = (GRID_LENGTH - _r) / GRID_LENGTH;
-    auto k = static_cast<float>(_time) / SPLASH_FADE_TIME;
-    if (k > 1.0f)
-        k = 1.0f;
-    k = 1.f - k;
-    return (.55f + k * fabsf(cosf(rK * 10.f + _time / 7e2f))) * rK * rK;
-}
-
-//--------------------------------------------------------------------
-bool TSplash::Process(uint32_t _dTime)
+bool TSplash::Process(uint32_t _dTime, storm::SplashProfiles &profiles, GRID_VERTEX *vertices)
 {
     if (!enabled)
         return false;
@@ -195,89 +189,18 @@ bool TSplash::Process(uint32_t _dTime)
         return false;
     }
 
-    auto rho = rand(MAX_RHO);
-    auto r = SPLASH_RADIUS;
-    int x, z;
-
-    static GRID_VERTEX *startVertices;
     midY = sea->WaveXZ(center.x, center.z) + SPLASH_MOVE_Y;
 
-    uint64_t ticksLock;
-    RDTSC_B(ticksLock);
-    if (startRender)
-    {
-        startVertices = static_cast<GRID_VERTEX *>(renderer->LockVertexBuffer(vBuffer));
-        startRender = false;
-    }
-    RDTSC_E(ticksLock);
-    lockTicks += ticksLock;
     uint64_t ticksFill;
     RDTSC_B(ticksFill);
-
-    auto *vertices = startVertices + topIndex * GRID_STEPS * GRID_STEPS;
-    const auto stepSize = static_cast<float>(GRID_LENGTH) / static_cast<float>(GRID_STEPS);
-    const auto halfSize = GRID_LENGTH / 2.0f;
-    CVECTOR curPos;
-    float localHeight;
-
-    // calculate alpha
-    const int dt = time - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2;
-    uint32_t alpha;
-    if (time < SPLASH_FADE_IN_TIME)
-        alpha = static_cast<uint32_t>(255.f * time / SPLASH_FADE_IN_TIME);
-    else if (dt < 0)
-        alpha = 0xFF;
-    else
-        alpha = static_cast<uint32_t>(255.f -
-                                      dt * 255.f / (SPLASH_FADE_TIME - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2));
-    alpha = (alpha << 24) | (0x00FFFFFF & ambientColor);
-
-    // fill vertices
-    for (z = 0; z < GRID_STEPS; ++z)
-        for (x = 0; x < GRID_STEPS; ++x)
-        {
-            vertices->pos.x = center.x + growK * (stepSize * x - halfSize);
-            vertices->pos.z = center.z + growK * (stepSize * z - halfSize);
-
-            if ((x > 0) && (z > 0) && (x < GRID_STEPS - 1) && (z < GRID_STEPS - 1))
-            {
-                curPos.x = (center.x + stepSize * x) - halfSize;
-                curPos.z = (center.z + stepSize * z) - halfSize;
-                rho = sqrtf((curPos.x - center.x) * (curPos.x - center.x) +
-                            (curPos.z - center.z) * (curPos.z - center.z));
-                localHeight = HeightF(time, rho, (GRID_LENGTH - rho) / GRID_LENGTH);
-
-                vertices->pos.y = midY + localHeight;
-            }
-            else
-                vertices->pos.y = midY + 2 * SPLASH_MOVE_Y;
-
-            vertices->color = alpha;
-            vertices->tu = static_cast<float>(x) / (GRID_STEPS - 1);
-            vertices->tv = static_cast<float>(z) / (GRID_STEPS - 1);
-            ++vertices;
-        }
-
+    profiles.get(time, ambientColor).expand(center, growK, midY, vertices);
     RDTSC_E(ticksFill);
     fillTicks += ticksFill;
-    ++topIndex;
     return true;
 }
 
 //--------------------------------------------------------------------
-void TSplash::PostProcess()
-{
-    if (startRender)
-        return;
-    uint64_t ticksUnlock;
-    RDTSC_B(ticksUnlock);
-    renderer->UnLockVertexBuffer(vBuffer);
-    RDTSC_E(ticksUnlock);
-    unlockTicks += ticksUnlock;
-}
-
-//--------------------------------------------------------------------
-bool TSplash::Process2(uint32_t _dTime)
+bool TSplash::Process2(uint32_t _dTime, GRID_VERTEX2 *vertices)
 {
     if (!enabled)
         return false;
@@ -285,21 +208,9 @@ bool TSplash::Process2(uint32_t _dTime)
     if (time > (SPLASH_FRAMES_COUNT - 1) * SPLASH_FRAME_DELAY)
         return false;
 
-    // VERTICES 2
-    static GRID_VERTEX2 *startVertices2;
-    uint64_t ticksLock;
-    RDTSC_B(ticksLock);
-    if (startRender)
-    {
-        startVertices2 = static_cast<GRID_VERTEX2 *>(renderer->LockVertexBuffer(vBuffer2));
-        startRender = false;
-    }
-    RDTSC_E(ticksLock);
-    lockTicks += ticksLock;
     uint64_t ticksFill;
     RDTSC_B(ticksFill);
 
-    auto *vertices = startVertices2 + topIndex * 4 * VPLANES_COUNT;
     auto u = dU * static_cast<int>(time / SPLASH_FRAME_DELAY);
     if (u > (1.f - dU))
         u = 1.f - dU;
@@ -307,13 +218,13 @@ bool TSplash::Process2(uint32_t _dTime)
     auto alpha = static_cast<uint32_t>((static_cast<float>(time % SPLASH_FRAME_DELAY) / SPLASH_FRAME_DELAY) * 0xFF);
     alpha = (alpha << 24) | (0x00FFFFFF & ambientColor);
 
-    auto a = 0.f;
-    auto dx = VPLANES_WIDTH / 2.f;
-    auto dy = 0.f;
-    for (auto i = 0; i < VPLANES_COUNT; i++, a += PI / VPLANES_COUNT)
+    for (auto i = 0; i < VPLANES_COUNT; i++)
     {
-        vertices->pos.x = center.x - width2 * cosf(a);
-        vertices->pos.z = center.z - width2 * sinf(a);
+        const auto dx = width2 * planeCos[i];
+        const auto dz = width2 * planeSin[i];
+
+        vertices->pos.x = center.x - dx;
+        vertices->pos.z = center.z - dz;
         vertices->pos.y = midY + height + SPLASH_MOVE_Y2;
         vertices->tu = u;
         vertices->tu2 = vertices->tu + dU;
@@ -322,8 +233,8 @@ bool TSplash::Process2(uint32_t _dTime)
         vertices->color = alpha;
         ++vertices;
 
-        vertices->pos.x = center.x - width2 * cosf(a);
-        vertices->pos.z = center.z - width2 * sinf(a);
+        vertices->pos.x = center.x - dx;
+        vertices->pos.z = center.z - dz;
         vertices->pos.y = midY + SPLASH_MOVE_Y2;
         vertices->tu = u;
         vertices->tu2 = vertices->tu + dU;
@@ -332,8 +243,8 @@ bool TSplash::Process2(uint32_t _dTime)
         vertices->color = alpha;
         ++vertices;
 
-        vertices->pos.x = center.x + width2 * cosf(a);
-        vertices->pos.z = center.z + width2 * sinf(a);
+        vertices->pos.x = center.x + dx;
+        vertices->pos.z = center.z + dz;
         vertices->pos.y = midY + SPLASH_MOVE_Y2;
         vertices->tu = u + dU;
         vertices->tu2 = vertices->tu + dU;
@@ -342,8 +253,8 @@ bool TSplash::Process2(uint32_t _dTime)
         vertices->color = alpha;
         ++vertices;
 
-        vertices->pos.x = center.x + width2 * cosf(a);
-        vertices->pos.z = center.z + width2 * sinf(a);
+        vertices->pos.x = center.x + dx;
+        vertices->pos.z = center.z + dz;
         vertices->pos.y = midY + height + SPLASH_MOVE_Y2;
         vertices->tu = u + dU;
         vertices->tu2 = vertices->tu + dU;
@@ -355,60 +266,87 @@ bool TSplash::Process2(uint32_t _dTime)
 
     RDTSC_E(ticksFill);
     fillTicks += ticksFill;
-    ++topIndex;
     return true;
 }
 
 //--------------------------------------------------------------------
-void TSplash::PostProcess2()
+GRID_VERTEX *TSplash::LockGrids()
+{
+    uint64_t ticksLock;
+    RDTSC_B(ticksLock);
+    auto *vertices = static_cast<GRID_VERTEX *>(renderer->LockVertexBuffer(vBuffer, D3DLOCK_DISCARD));
+    RDTSC_E(ticksLock);
+    lockTicks += ticksLock;
+    return vertices;
+}
+
+//--------------------------------------------------------------------
+void TSplash::UnlockGrids()
 {
-    if (startRender)
-        return;
     uint64_t ticksUnlock;
     RDTSC_B(ticksUnlock);
-    renderer->UnLockVertexBuffer(vBuffer2);
+    renderer->UnLockVertexBuffer(vBuffer);
     RDTSC_E(ticksUnlock);
     unlockTicks += ticksUnlock;
 }
 
 //--------------------------------------------------------------------
-void TSplash::Realize(uint32_t _dTime)
+void TSplash::RealizeGrids(uint32_t count)
 {
-    if (startRender)
+    if (!count)
         return;
 
     uint64_t ticksRealize;
     RDTSC_B(ticksRealize);
 
-    static uint32_t ambient, tfactor, oldAmbient, alpha;
     const CMatrix m;
     renderer->SetTransform(D3DTS_WORLD, static_cast<D3DMATRIX *>(m));
     renderer->TextureSet(0, texture);
 
-    renderer->DrawBuffer(vBuffer, sizeof(GRID_VERTEX), iBuffer, 0, GRID_STEPS * GRID_STEPS * topIndex, 0,
-                         TRIANGLES_COUNT * topIndex, "splash");
+    renderer->DrawBuffer(vBuffer, sizeof(GRID_VERTEX), iBuffer, 0, GRID_STEPS * GRID_STEPS * count, 0,
+                         TRIANGLES_COUNT * count, "splash");
 
     RDTSC_E(ticksRealize);
     realizeTicks += ticksRealize;
 }
 
 //--------------------------------------------------------------------
-void TSplash::Realize2(uint32_t _dTime)
+GRID_VERTEX2 *TSplash::LockPlanes()
+{
+    uint64_t ticksLock;
+    RDTSC_B(ticksLock);
+    auto *vertices = static_cast<GRID_VERTEX2 *>(renderer->LockVertexBuffer(vBuffer2, D3DLOCK_DISCARD));
+    RDTSC_E(ticksLock);
+    lockTicks += ticksLock;
+    return vertices;
+}
+
+//--------------------------------------------------------------------
+void TSplash::UnlockPlanes()
+{
+    uint64_t ticksUnlock;
+    RDTSC_B(ticksUnlock);
+    renderer->UnLockVertexBuffer(vBuffer2);
+    RDTSC_E(ticksUnlock);
+    unlockTicks += ticksUnlock;
+}
+
+//--------------------------------------------------------------------
+void TSplash::RealizePlanes(uint32_t count)
 {
-    if (!topIndex)
+    if (!count)
         return;
 
     uint64_t ticksRealize;
     RDTSC_B(ticksRealize);
 
-    static uint32_t ambient, fogColor, oldAmbient;
     const CMatrix m;
     renderer->SetTransform(D3DTS_WORLD, static_cast<D3DMATRIX *>(m));
     renderer->TextureSet(0, texture2);
     renderer->TextureSet(1, texture2);
 
-    renderer->DrawBuffer(vBuffer2, sizeof(GRID_VERTEX2), iBuffer2, 0, VPLANES_COUNT * 4 * topIndex, 0,
-                         VPLANES_COUNT * 2 * topIndex, nullptr);
+    renderer->DrawBuffer(vBuffer2, sizeof(GRID_VERTEX2), iBuffer2, 0, VPLANES_COUNT * 4 * count, 0,
+                         VPLANES_COUNT * 2 * count, nullptr);
 
     RDTSC_E(ticksRealize);
     realizeTicks += ticksRealize;
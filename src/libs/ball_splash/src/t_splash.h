@@ -3,6 +3,7 @@
 #include "c_vector.h"
 #include "dx9render.h"
 #include "sea_base.h"
+#include "splash_grid.h"
 
 //#include "../sound_service/v_sound_service.h"
 
@@ -10,13 +11,6 @@ class INIFILE;
 ///////////////////////////////////////////////////////////////////
 // CLASS DEFINITION
 ///////////////////////////////////////////////////////////////////
-struct GRID_VERTEX
-{
-    CVECTOR pos;
-    uint32_t color;
-    float tu, tv;
-};
-
 struct GRID_VERTEX2
 {
     CVECTOR pos;
@@ -34,21 +28,23 @@ class TSplash
     void Initialize(INIFILE *_ini, IDirect3DDevice9 *_device, SEA_BASE *sea, VDX9RENDER *_renderer);
     void Release();
     void Start(const CVECTOR &_pos, const CVECTOR &_dir);
-    bool Process(uint32_t dTime);
-    bool Process2(uint32_t dTime);
-    void PostProcess();
-    void PostProcess2();
-    void Realize(uint32_t dTime);
-    void Realize2(uint32_t dTime);
+    // Write the grid of the splash, splashes of one age share their profile
+    bool Process(uint32_t dTime, storm::SplashProfiles &profiles, GRID_VERTEX *vertices);
+    bool Process2(uint32_t dTime, GRID_VERTEX2 *vertices);
     bool Enabled();
 
-    static bool startRender;
+    // All splashes of a frame go into one buffer and are drawn at once
+    static GRID_VERTEX *LockGrids();
+    static void UnlockGrids();
+    static void RealizeGrids(uint32_t count);
+    static GRID_VERTEX2 *LockPlanes();
+    static void UnlockPlanes();
+    static void RealizePlanes(uint32_t count);
+
     static uint64_t lockTicks, fillTicks, unlockTicks, realizeTicks;
-    static uint32_t processCount, topIndex, topIndex2;
+    static uint32_t processCount;
 
   private:
-    float HeightF(uint32_t time, float _r, float _k);
-
     bool enabled;
 
     static VDX9RENDER *renderer;
@@ -0,0 +1,159 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "splash_grid.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// TSplash::HeightF as it was
+float ReferenceHeight(uint32_t time, float r)
+{
+    const auto rK = (GRID_LENGTH - r) / GRID_LENGTH;
+    auto k = static_cast<float>(time) / SPLASH_FADE_TIME;
+    if (k > 1.0f)
+        k = 1.0f;
+    k = 1.f - k;
+    return (.55f + k * fabsf(cosf(rK * 10.f + time / 7e2f))) * rK * rK;
+}
+
+// The vertex fill of TSplash::Process as it was, every vertex of every splash
+void ReferenceFill(uint32_t time, uint32_t ambient, const CVECTOR &center, float growK, float midY,
+                   GRID_VERTEX *vertices)
+{
+    const auto stepSize = static_cast<float>(GRID_LENGTH) / static_cast<float>(GRID_STEPS);
+    const auto halfSize = GRID_LENGTH / 2.0f;
+
+    const int dt = time - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2;
+    uint32_t alpha;
+    if (time < SPLASH_FADE_IN_TIME)
+        alpha = static_cast<uint32_t>(255.f * time / SPLASH_FADE_IN_TIME);
+    else if (dt < 0)
+        alpha = 0xFF;
+    else
+        alpha = static_cast<uint32_t>(255.f -
+                                      dt * 255.f / (SPLASH_FADE_TIME - SPLASH_FRAMES_COUNT * SPLASH_FRAME_DELAY / 2));
+    alpha = (alpha << 24) | (0x00FFFFFF & ambient);
+
+    for (int z = 0; z < GRID_STEPS; ++z)
+        for (int x = 0; x < GRID_STEPS; ++x)
+        {
+            vertices->pos.x = center.x + growK * (stepSize * x - halfSize);
+            vertices->pos.z = center.z + growK * (stepSize * z - halfSize);
+
+            if ((x > 0) && (z > 0) && (x < GRID_STEPS - 1) && (z < GRID_STEPS - 1))
+            {
+                const auto cx = (center.x + stepSize * x) - halfSize;
+                const auto cz = (center.z + stepSize * z) - halfSize;
+                const auto rho = sqrtf((cx - center.x) * (cx - center.x) + (cz - center.z) * (cz - center.z));
+                vertices->pos.y = midY + ReferenceHeight(time, rho);
+            }
+            else
+                vertices->pos.y = midY + 2 * SPLASH_MOVE_Y;
+
+            vertices->color = alpha;
+            vertices->tu = static_cast<float>(x) / (GRID_STEPS - 1);
+            vertices->tv = static_cast<float>(z) / (GRID_STEPS - 1);
+            ++vertices;
+        }
+}
+
+struct Splash
+{
+    CVECTOR center;
+    float growK;
+    float midY;
+};
+
+std::vector<Splash> MakeBroadside(size_t count)
+{
+    std::vector<Splash> splashes;
+    std::mt19937 rng(1805);
+    std::uniform_real_distribution<float> x(-400.0f, 400.0f), z(-60.0f, 60.0f), grow(1.0f, 1.6f), y(-1.0f, 1.0f);
+    for (size_t i = 0; i < count; i++)
+        splashes.push_back({CVECTOR(x(rng), 0.0f, z(rng)), grow(rng), y(rng)});
+    return splashes;
+}
+
+} // namespace
+
+TEST_CASE("Splash profiles expand to the old grids", "[ball_splash]")
+{
+    const auto time = GENERATE(as<uint32_t>{}, 0u, 16u, 350u, 700u, 2080u, 3000u, 4700u);
+    constexpr uint32_t ambient = 0x00A0B0C0;
+
+    storm::SplashProfile profile;
+    profile.build(time, ambient);
+    REQUIRE(profile.time() == time);
+
+    GRID_VERTEX expected[storm::SplashProfile::kVertices];
+    GRID_VERTEX actual[storm::SplashProfile::kVertices];
+    for (const auto &splash : MakeBroadside(50))
+    {
+        ReferenceFill(time, ambient, splash.center, splash.growK, splash.midY, expected);
+        profile.expand(splash.center, splash.growK, splash.midY, actual);
+        for (int i = 0; i < storm::SplashProfile::kVertices; i++)
+        {
+            REQUIRE(actual[i].pos.x == expected[i].pos.x);
+            REQUIRE(actual[i].pos.z == expected[i].pos.z);
+            // the old radius picked up the rounding of the splash position
+            REQUIRE(actual[i].pos.y == Approx(expected[i].pos.y).margin(1e-4));
+            REQUIRE(actual[i].color == expected[i].color);
+            REQUIRE(actual[i].tu == expected[i].tu);
+            REQUIRE(actual[i].tv == expected[i].tv);
+        }
+    }
+}
+
+TEST_CASE("Splashes of one age share a profile", "[ball_splash]")
+{
+    storm::SplashProfiles profiles;
+    const auto *first = &profiles.get(300, 0x808080);
+    CHECK(&profiles.get(300, 0x808080) == first);
+    CHECK(&profiles.get(316, 0x808080) != first);
+    CHECK(&profiles.get(300, 0x404040) != first);
+    CHECK(profiles.size() == 3);
+
+    // the next frame rebuilds in the same storage
+    profiles.clear();
+    CHECK(profiles.size() == 0);
+    const auto &next = profiles.get(316, 0x808080);
+    CHECK(&next == first);
+    CHECK(next.time() == 316);
+}
+
+TEST_CASE("Splash grid benchmark", "[.][ball_splash][benchmark]")
+{
+    // a broadside: two hundred balls land in one frame
+    const auto splashes = MakeBroadside(200);
+    std::vector<GRID_VERTEX> vertices(splashes.size() * storm::SplashProfile::kVertices);
+
+    BENCHMARK("every vertex, 200 splashes")
+    {
+        auto *out = vertices.data();
+        for (const auto &splash : splashes)
+        {
+            ReferenceFill(400, 0x808080, splash.center, splash.growK, splash.midY, out);
+            out += storm::SplashProfile::kVertices;
+        }
+        return vertices.back().pos.y;
+    };
+
+    storm::SplashProfiles profiles;
+    BENCHMARK("shared profile, 200 splashes")
+    {
+        profiles.clear();
+        auto *out = vertices.data();
+        for (const auto &splash : splashes)
+        {
+            profiles.get(400, 0x808080).expand(splash.center, splash.growK, splash.midY, out);
+            out += storm::SplashProfile::kVertices;
+        }
+        return vertices.back().pos.y;
+    };
+}
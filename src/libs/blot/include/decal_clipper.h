@@ -0,0 +1,77 @@
+#pragma once
+
+#include "c_vector.h"
+#include "types3d.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Triangles of a model in its own space, bucketed in a uniform grid
+ *
+ * Filled once per model and read-only afterwards, so any number of decals can be clipped against it at once.
+ */
+class DecalMesh final
+{
+  public:
+    void clear();
+
+    void addTriangle(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2);
+    // convex polygon, triangulated as a fan
+    void addPolygon(const CVECTOR *v, int32_t nv);
+
+    // must be called after the last add and before clipping
+    void build(float cellSize = 2.0f);
+
+    [[nodiscard]] size_t size() const
+    {
+        return triangles_.size() / 3;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return triangles_.empty();
+    }
+
+    [[nodiscard]] const CVECTOR *triangle(uint32_t index) const
+    {
+        return &triangles_[index * 3];
+    }
+
+    // triangles whose bounds touch the box, in the order they were added
+    void query(const CVECTOR &min, const CVECTOR &max, std::vector<uint32_t> &out) const;
+
+  private:
+    void cellRange(const CVECTOR &min, const CVECTOR &max, int32_t (&from)[3], int32_t (&to)[3]) const;
+
+    std::vector<CVECTOR> triangles_;
+
+    CVECTOR origin_;
+    float invCellSize_ = 0.0f;
+    int32_t cells_[3]{};
+    // triangle indices of cell c are cellTriangles_[cellStart_[c] .. cellStart_[c + 1])
+    std::vector<uint32_t> cellStart_;
+    std::vector<uint32_t> cellTriangles_;
+};
+
+// Triangles of a decal, three vertices each
+struct DecalClip
+{
+    std::vector<CVECTOR> vertices;
+    // -0.1 * dir plus 100 times the sum of the face normals, where the decal looks from
+    CVECTOR normal;
+};
+
+/**
+ * \brief Cuts the triangles facing against dir out of the convex volume given by the planes
+ *
+ * Does what Blots did through MODEL::Clip and its static AddPolygon: polygons are clipped as GEOM clips them,
+ * back faces are skipped, and at most maxTriangles are taken. All state lives in the call.
+ */
+DecalClip ClipDecal(const DecalMesh &mesh, const PLANE *planes, int32_t nplanes, const CVECTOR &center, float radius,
+                    const CVECTOR &dir, uint32_t maxTriangles);
+
+} // namespace storm
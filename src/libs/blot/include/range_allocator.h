@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace storm
+{
+
+/**
+ * \brief First fit allocator of ranges in a fixed size buffer
+ *
+ * Free ranges are merged with their neighbours, so allocated ranges never move and nothing has to be repacked.
+ */
+class RangeAllocator final
+{
+  public:
+    static constexpr uint32_t kInvalid = 0xFFFFFFFFu;
+
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    void reset(uint32_t capacity);
+
+    // returns the start of the range or kInvalid if there is no free range that big
+    uint32_t allocate(uint32_t size);
+    void free(uint32_t start, uint32_t size);
+
+    [[nodiscard]] uint32_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // end of the last allocated range
+    [[nodiscard]] uint32_t end() const;
+
+    [[nodiscard]] uint32_t used() const
+    {
+        return used_;
+    }
+
+  private:
+    uint32_t capacity_ = 0;
+    uint32_t used_ = 0;
+    // start -> size
+    std::map<uint32_t, uint32_t> free_;
+};
+
+} // namespace storm
@@ -15,28 +15,30 @@
 #include "entity.h"
 #include "shared/messages.h"
 
+#include <algorithm>
+
 CREATE_CLASS(Blots)
 
 #define BLOTS_RADIUS 0.6f
 
 //============================================================================================
 
-CVECTOR Blots::clipTriangles[3 * 32];
-int32_t Blots::numClipTriangles;
-CVECTOR Blots::dir, Blots::normal;
-
 // ============================================================================================
 // Construction, destruction
 // ============================================================================================
 
 Blots::Blots()
-    : model(0), vrt{}
+    : model(0), vrt{}, vrtRanges(BLOTS_VERTICES), isHullBuilt(false)
 {
     for (int32_t i = 0; i < BLOTS_MAX; i++)
+    {
         blot[i].isUsed = 0;
+        blot[i].isPending = 0;
+        blot[i].numTrgs = 0;
+    }
     rs = nullptr;
     textureID = -1;
-    useVrt = 0;
+    vBuffer = -1;
     blotsInfo = nullptr;
     pCharAttributeRoot = nullptr;
     updateBlot = 0;
@@ -46,6 +48,8 @@ Blots::~Blots()
 {
     if (rs && textureID >= 0)
         rs->TextureRelease(textureID);
+    if (rs && vBuffer >= 0)
+        rs->ReleaseVertexBuffer(vBuffer);
 }
 
 // Initialization
@@ -61,6 +65,10 @@ bool Blots::Init()
     // core.SetLayerType(realize, layer_type_t::realize);
     // core.AddToLayer(realize, GetId(), 1000);
     textureID = rs->TextureCreate("blot.tga");
+    // Blots stay for minutes, so the buffer is only written where they change
+    vBuffer = rs->CreateVertexBuffer(BLOTS_FVF, BLOTS_VERTICES * sizeof(Vertex), D3DUSAGE_WRITEONLY, D3DPOOL_MANAGED);
+    if (vBuffer < 0)
+        throw std::runtime_error("Blots: can't create vertex buffer");
     return true;
     // UNGUARD
 }
@@ -72,6 +80,8 @@ uint64_t Blots::ProcessMessage(MESSAGE &message)
     {
     case MSG_BLOTS_SETMODEL:
         model = message.EntityID();
+        hull.clear();
+        isHullBuilt = false;
         pCharAttributeRoot = message.AttributePointer();
         if (pCharAttributeRoot)
         {
@@ -122,6 +132,7 @@ void Blots::Hit(MESSAGE &message)
         return;
     i = j;
     // Fall direction of the cannonball
+    CVECTOR dir;
     dir.x = message.Float();
     dir.y = message.Float();
     dir.z = message.Float();
@@ -133,50 +144,95 @@ void Blots::Hit(MESSAGE &message)
 // Add blot
 void Blots::AddBlot(int32_t i, int32_t rnd, const CVECTOR &lpos, const CVECTOR &dir, float time)
 {
-    // Model of a ship
-    auto *m = static_cast<MODEL *>(core.GetEntityPointer(model));
-    if (!m)
+    if (blot[i].isUsed && !blot[i].isPending)
+        FreeBlot(i);
+    if (!blot[i].isPending)
+        pendingBlots.push_back(i);
+    // Blot information
+    blot[i].isUsed = true;
+    blot[i].isPending = true;
+    blot[i].lastAlpha = 0xff;
+    blot[i].numTrgs = 0;
+    blot[i].liveTime = time;
+    blot[i].pos = lpos;
+    blot[i].dir = dir;
+    blot[i].rnd = rnd;
+    blot[i].startIndex = -1;
+}
+
+// Create the blots added since the last frame
+void Blots::CreateBlots(MODEL *m)
+{
+    if (pendingBlots.empty())
         return;
-    blot[i].isUsed = false;
-    auto pos = m->mtx * CVECTOR(lpos);
-    this->dir = m->mtx * CVECTOR(dir) - m->mtx.Pos();
-    // bounding box
-    static PLANE p[6];
-    p[0].Nx = 0.0f;
-    p[0].Ny = 1.0f;
-    p[0].Nz = 0.0f;
-    p[0].D = (pos.y + BLOTS_RADIUS);
-    p[1].Nx = 0.0f;
-    p[1].Ny = -1.0f;
-    p[1].Nz = 0.0f;
-    p[1].D = -(pos.y - BLOTS_RADIUS);
-    p[2].Nx = 0.0f;
-    p[2].Ny = 0.0f;
-    p[2].Nz = 1.0f;
-    p[2].D = (pos.z + BLOTS_RADIUS);
-    p[3].Nx = 0.0f;
-    p[3].Ny = 0.0f;
-    p[3].Nz = -1.0f;
-    p[3].D = -(pos.z - BLOTS_RADIUS);
-    p[4].Nx = 1.0f;
-    p[4].Ny = 0.0f;
-    p[4].Nz = 0.0f;
-    p[4].D = (pos.x + BLOTS_RADIUS);
-    p[5].Nx = -1.0f;
-    p[5].Ny = 0.0f;
-    p[5].Nz = 0.0f;
-    p[5].D = -(pos.x - BLOTS_RADIUS);
+    // a model without clip faces is looked at once
+    if (m && !isHullBuilt)
+        BuildHull(m);
+
+    std::vector<std::vector<Vertex>> created(pendingBlots.size());
+    if (m)
+    {
+        for (size_t n = 0; n < pendingBlots.size(); n++)
+            ClipBlot(m->mtx, blot[pendingBlots[n]], created[n]);
+    }
+
+    for (size_t n = 0; n < pendingBlots.size(); n++)
+    {
+        const auto i = pendingBlots[n];
+        blot[i].isPending = false;
+        blot[i].isUsed = false;
+        const auto numVrt = static_cast<uint32_t>(created[n].size());
+        if (numVrt == 0)
+            continue;
+        auto start = vrtRanges.allocate(numVrt);
+        if (start == storm::RangeAllocator::kInvalid)
+        {
+            // the free vertices are split into ranges too small for the blot
+            core.Trace("Blots: vertex buffer fragmented, %u of %u vertices used, packing the blots", vrtRanges.used(),
+                       vrtRanges.capacity());
+            CompactVertices();
+            start = vrtRanges.allocate(numVrt);
+        }
+        if (start == storm::RangeAllocator::kInvalid)
+        {
+            core.Trace("Blots: no room for blot %d of %u vertices, it is dropped", i, numVrt);
+            SaveBlot(i);
+            continue;
+        }
+        std::copy(created[n].begin(), created[n].end(), vrt + start);
+        UpdateVertices(start, numVrt);
+        blot[i].isUsed = true;
+        blot[i].numTrgs = static_cast<uint16_t>(numVrt / 3);
+        blot[i].startIndex = start;
+        // Writing the state
+        SaveBlot(i);
+    }
+    pendingBlots.clear();
+}
+
+void Blots::ClipBlot(const CMatrix &modelMtx, const Blot &b, std::vector<Vertex> &out) const
+{
+    auto mtx(modelMtx);
+    auto pos = mtx * CVECTOR(b.pos);
+    // bounding box around the hit in global space, moved to the model space the hull is in
+    static const int32_t axis[6] = {1, 1, 2, 2, 0, 0};
+    PLANE p[6];
+    for (int32_t n = 0; n < 6; n++)
+    {
+        CVECTOR nrm(0.0f), lnrm;
+        nrm.v[axis[n]] = (n & 1) ? -1.0f : 1.0f;
+        mtx.MulToInvNorm(nrm, lnrm);
+        p[n].Nx = lnrm.x;
+        p[n].Ny = lnrm.y;
+        p[n].Nz = lnrm.z;
+        p[n].D = (nrm | pos) + BLOTS_RADIUS - (nrm | mtx.Pos());
+    }
     // Cut out the triangles in the box
-    numClipTriangles = 0;
-    normal = -0.1f * dir;
-    // don't collide with the patch and masts
-    auto *root = m->GetNode(0);
-    SetNodesCollision(root, true);
-    m->Clip(p, 6, pos, BLOTS_RADIUS, AddPolygon);
-    SetNodesCollision(root, false);
-    if (numClipTriangles <= 0)
+    const auto clip = storm::ClipDecal(hull, p, 6, b.pos, BLOTS_RADIUS * 1.75f, b.dir, BLOTS_NTRGS);
+    if (clip.vertices.empty())
         return;
     // transformation matrix to the local coordinate system of the hole
+    const auto normal = mtx * clip.normal - mtx.Pos();
     CMatrix uvmtx;
     if (!uvmtx.BuildViewMatrix(pos, pos + normal * 1.0f, CVECTOR(0.0f, 1.0f, 0.0f)))
     {
@@ -186,33 +242,20 @@ void Blots::AddBlot(int32_t i, int32_t rnd, const CVECTOR &lpos, const CVECTOR &
                 return;
         }
     }
-    // Blot information
-    blot[i].isUsed = true;
-    blot[i].lastAlpha = 0xff;
-    blot[i].numTrgs = static_cast<uint16_t>(numClipTriangles);
-    blot[i].liveTime = time;
-    blot[i].pos = lpos;
-    blot[i].dir = dir;
-    blot[i].rnd = rnd;
-    blot[i].startIndex = useVrt;
-    useVrt += numClipTriangles * 3;
-    Assert(useVrt < sizeof(vrt) / sizeof(Vertex));
-    // Convert triangles to the local coordinate system of the ship
-    auto mtx(m->mtx);
-    mtx.Transposition();
-    auto *v = vrt + blot[i].startIndex;
-    numClipTriangles *= 3;
+    // The triangles are in the local coordinate system of the ship already
+    const auto rnd = b.rnd;
     auto baseU = 0.0f;
     auto baseV = 0.0f;
     if (rnd & 1)
         baseU += 0.5f;
     if (rnd & 2)
         baseV += 0.5f;
-    for (int32_t n = 0; n < numClipTriangles; n++)
+    out.resize(clip.vertices.size());
+    for (size_t n = 0; n < out.size(); n++)
     {
-        v[n].pos = mtx * clipTriangles[n];
-        v[n].c = 0xffffffff;
-        auto uv = uvmtx * clipTriangles[n];
+        out[n].pos = clip.vertices[n];
+        out[n].c = 0xffffffff;
+        auto uv = uvmtx * (mtx * clip.vertices[n]);
         uv.x = (0.5f + uv.x * 0.5f / BLOTS_RADIUS);
         uv.y = (0.5f + uv.y * 0.5f / BLOTS_RADIUS);
         if (uv.x < 0.0f)
@@ -227,11 +270,111 @@ void Blots::AddBlot(int32_t i, int32_t rnd, const CVECTOR &lpos, const CVECTOR &
             uv.x = 1.0f - uv.x;
         if (rnd & 8)
             uv.y = 1.0f - uv.y;
-        v[n].u = baseU + uv.x * 0.5f;
-        v[n].v = baseV + uv.y * 0.5f;
+        out[n].u = baseU + uv.x * 0.5f;
+        out[n].v = baseV + uv.y * 0.5f;
+    }
+}
+
+void Blots::BuildHull(MODEL *m)
+{
+    // Everything the blots used to be clipped against: the model without its rigging, but with all of its faces
+    std::vector<CVECTOR> vertices;
+    auto *root = m->GetNode(0);
+    SetNodesCollision(root, true);
+    m->GetTriangles(vertices);
+    SetNodesCollision(root, false);
+
+    // The triangles come in global space, the hull is kept in the space of the model
+    hull.clear();
+    CVECTOR v[3];
+    for (size_t n = 0; n + 2 < vertices.size(); n += 3)
+    {
+        for (int32_t k = 0; k < 3; k++)
+            m->mtx.MulToInv(vertices[n + k], v[k]);
+        hull.addTriangle(v[0], v[1], v[2]);
+    }
+    hull.build();
+    isHullBuilt = true;
+}
+
+void Blots::FreeBlot(int32_t i)
+{
+    blot[i].isUsed = false;
+    if (blot[i].startIndex < 0)
+        return;
+    // Degenerate triangles are left in place of the blot until the range is taken again
+    const int32_t numVrt = blot[i].numTrgs * 3;
+    std::fill(vrt + blot[i].startIndex, vrt + blot[i].startIndex + numVrt, Vertex{});
+    UpdateVertices(blot[i].startIndex, numVrt);
+    vrtRanges.free(blot[i].startIndex, numVrt);
+    blot[i].startIndex = -1;
+    blot[i].numTrgs = 0;
+}
+
+// Move the vertices of the blots to the start of the buffer, so the free ones make one range
+void Blots::CompactVertices()
+{
+    std::vector<int32_t> placed;
+    for (int32_t i = 0; i < BLOTS_MAX; i++)
+        if (blot[i].isUsed && !blot[i].isPending && blot[i].startIndex >= 0)
+            placed.push_back(i);
+    std::sort(placed.begin(), placed.end(),
+              [this](int32_t a, int32_t b) { return blot[a].startIndex < blot[b].startIndex; });
+
+    const auto oldEnd = static_cast<int32_t>(vrtRanges.end());
+    vrtRanges.reset(BLOTS_VERTICES);
+    for (const auto i : placed)
+    {
+        const int32_t numVrt = blot[i].numTrgs * 3;
+        const auto start = static_cast<int32_t>(vrtRanges.allocate(numVrt));
+        // the blots go in the order they lie, so a range only moves down over vertices already moved
+        std::copy(vrt + blot[i].startIndex, vrt + blot[i].startIndex + numVrt, vrt + start);
+        blot[i].startIndex = start;
+    }
+    std::fill(vrt + vrtRanges.end(), vrt + oldEnd, Vertex{});
+    UpdateVertices(0, oldEnd);
+}
+
+void Blots::UpdateVertices(int32_t start, int32_t count)
+{
+    dirtyRanges.emplace_back(start, start + count);
+}
+
+void Blots::UploadVertices()
+{
+    if (dirtyRanges.empty())
+        return;
+    // Neighbouring ranges go in one lock
+    std::sort(dirtyRanges.begin(), dirtyRanges.end());
+    size_t merged = 0;
+    for (size_t n = 1; n < dirtyRanges.size(); n++)
+    {
+        if (dirtyRanges[n].first <= dirtyRanges[merged].second)
+            dirtyRanges[merged].second = std::max(dirtyRanges[merged].second, dirtyRanges[n].second);
+        else
+            dirtyRanges[++merged] = dirtyRanges[n];
+    }
+    dirtyRanges.resize(merged + 1);
+
+    auto *vb = rs->GetVertexBuffer(vBuffer);
+    for (const auto &[from, to] : dirtyRanges)
+    {
+        uint8_t *data = nullptr;
+        if (vb && SUCCEEDED(rs->VBLock(vb, from * sizeof(Vertex), (to - from) * sizeof(Vertex), &data, 0)))
+        {
+            memcpy(data, vrt + from, (to - from) * sizeof(Vertex));
+            rs->VBUnlock(vb);
+        }
     }
-    // Writing the state
-    SaveBlot(i);
+    dirtyRanges.clear();
+}
+
+void Blots::RestoreRender()
+{
+    // Everything that is drawn goes to the new buffer on the next frame
+    dirtyRanges.clear();
+    if (vrtRanges.end() > 0)
+        UpdateVertices(0, static_cast<int32_t>(vrtRanges.end()));
 }
 
 void Blots::SetNodesCollision(NODE *n, bool isSet)
@@ -357,12 +500,13 @@ void Blots::Realize(uint32_t delta_time)
 {
     // Updating the state
     blotsInfo = pCharAttributeRoot->FindAClass(pCharAttributeRoot, "ship.blots");
+    // Model of a ship
+    auto *m = static_cast<MODEL *>(core.GetEntityPointer(model));
+    CreateBlots(m);
     updateBlot++;
     if (updateBlot >= BLOTS_MAX)
         updateBlot = 0;
     SaveBlot(updateBlot);
-    // Model of a ship
-    auto *m = static_cast<MODEL *>(core.GetEntityPointer(model));
     if (!m)
         return;
     // Distance from camera
@@ -394,73 +538,7 @@ void Blots::Realize(uint32_t delta_time)
 
         if (blot[i].liveTime >= BLOTS_TIME)
         {
-            blot[i].isUsed = false;
-            const auto startIndex = blot[i].startIndex;
-            const int32_t numDelVerts = blot[i].numTrgs * 3;
-
-            // -----------------------------------------------
-            // !!! begin Checks
-            blot[i].startIndex = -10000;
-            blot[i].numTrgs = 0;
-            static Vertex vr[3 * BLOTS_NTRGS * BLOTS_MAX];
-            for (int32_t n = 0; n < BLOTS_MAX; n++)
-            {
-                if (!blot[n].isUsed)
-                    continue;
-                auto *const v1 = vr + n * BLOTS_NTRGS * 3;
-                auto *const v2 = vrt + blot[n].startIndex;
-                for (int32_t v = 0; v < blot[n].numTrgs * 3; v++)
-                    v1[v] = v2[v];
-            }
-            // !!! end Checks
-            // -----------------------------------------------
-
-            // Remove triangles from the array
-            int32_t j;
-            for (j = 0; j < BLOTS_MAX; j++)
-            {
-                if (!blot[j].isUsed)
-                    continue;
-                if (blot[j].startIndex > startIndex)
-                    blot[j].startIndex -= numDelVerts;
-            }
-            j = useVrt - (startIndex + numDelVerts);
-            if (j > 0)
-                memcpy(vrt + startIndex, vrt + startIndex + numDelVerts, j * sizeof(Vertex));
-            useVrt -= numDelVerts;
-            Assert(useVrt >= 0);
-
-            // -----------------------------------------------
-            // !!! begin Checks
-            Assert(j % 3 == 0);
-            int32_t nnn = 0;
-            for (j = 0; j < BLOTS_MAX; j++)
-            {
-                if (!blot[j].isUsed)
-                    continue;
-                nnn += blot[j].numTrgs * 3;
-                Assert(blot[j].startIndex + blot[j].numTrgs * 3 <= useVrt);
-            }
-            Assert(nnn == useVrt);
-            for (int32_t n = 0; n < BLOTS_MAX; n++)
-            {
-                if (!blot[n].isUsed)
-                    continue;
-                auto *const v1 = vr + n * BLOTS_NTRGS * 3;
-                auto *const v2 = vrt + blot[n].startIndex;
-                for (int32_t v = 0; v < blot[n].numTrgs * 3; v++)
-                {
-                    Assert(v1[v].pos.x == v2[v].pos.x);
-                    Assert(v1[v].pos.y == v2[v].pos.y);
-                    Assert(v1[v].pos.z == v2[v].pos.z);
-                    Assert(v1[v].c == v2[v].c);
-                    Assert(v1[v].u == v2[v].u);
-                    Assert(v1[v].v == v2[v].v);
-                }
-            }
-            // !!! end Checks
-            // -----------------------------------------------
-
+            FreeBlot(i);
             continue;
         }
         // Transparency over time
@@ -473,6 +551,7 @@ void Blots::Realize(uint32_t delta_time)
         color = static_cast<int32_t>((1.0f - k) * 255.0f);
         if (color != blot[i].lastAlpha)
         {
+            blot[i].lastAlpha = static_cast<uint8_t>(color);
             // Update the vertices
             // Colour
             color = 0xff000000 | (color << 16) | (color << 8) | color;
@@ -482,34 +561,12 @@ void Blots::Realize(uint32_t delta_time)
             auto *const v = vrt + blot[i].startIndex;
             for (int32_t j = 0; j < numVrt; j++)
                 v[j].c = color;
+            UpdateVertices(blot[i].startIndex, numVrt);
         }
     }
+    UploadVertices();
     // Draw
-    if (useVrt > 3)
-        rs->DrawPrimitiveUP(D3DPT_TRIANGLELIST, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1, useVrt / 3, vrt,
-                            sizeof(Vertex), "Blot");
-}
-
-bool Blots::AddPolygon(const CVECTOR *v, int32_t nv)
-{
-    if (numClipTriangles >= BLOTS_NTRGS)
-        return false;
-    if (nv < 3)
-        return true;
-    // Normal
-    const auto norm = (v[0] - v[1]) ^ (v[0] - v[2]);
-    if ((norm | dir) >= 0.0f)
-        return true;
-    normal += 100.0f * norm;
-    // Add
-    for (int32_t i = 2; i < nv; i++)
-    {
-        clipTriangles[numClipTriangles * 3 + 0] = v[0];
-        clipTriangles[numClipTriangles * 3 + 1] = v[i - 1];
-        clipTriangles[numClipTriangles * 3 + 2] = v[i];
-        numClipTriangles++;
-        if (numClipTriangles >= BLOTS_NTRGS)
-            return false;
-    }
-    return true;
+    const auto numVrt = static_cast<int32_t>(vrtRanges.end());
+    if (numVrt > 3)
+        rs->DrawPrimitive(D3DPT_TRIANGLELIST, vBuffer, sizeof(Vertex), 0, numVrt / 3, "Blot");
 }
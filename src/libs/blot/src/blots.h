@@ -10,14 +10,21 @@
 
 #pragma once
 
+#include "decal_clipper.h"
 #include "dx9render.h"
 #include "model.h"
+#include "range_allocator.h"
 #include "vma.hpp"
 
+#include <utility>
+#include <vector>
+
 #define BLOTS_NTRGS 32    // Triangles in 1 blot
 #define BLOTS_MAX 256     // Total blots
 #define BLOTS_TIME 120.0f // Blot lifetime
 #define BLOTS_DIST 150.0f // Distance of visibility in meters
+#define BLOTS_VERTICES (3 * BLOTS_NTRGS * BLOTS_MAX)
+#define BLOTS_FVF (D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1)
 
 class Blots : public Entity
 {
@@ -32,6 +39,7 @@ class Blots : public Entity
         int32_t startIndex;   // Starting index in the array
         int32_t rnd;
         CVECTOR pos, dir;
+        uint8_t isPending; // Waits for CreateBlots
     };
 
     struct Vertex
@@ -64,15 +72,16 @@ class Blots : public Entity
         case Stage::realize:
             Realize(delta);
             break;
-            /*case Stage::lost_render:
-                LostRender(delta); break;
-            case Stage::restore_render:
-                RestoreRender(delta); break;*/
+        case Stage::restore_render:
+            RestoreRender();
+            break;
         }
     }
 
     // Work
     void Realize(uint32_t delta_time);
+    // The renderer brings the vertex buffer back empty
+    void RestoreRender();
 
     // --------------------------------------------------------------------------------------------
     // Encapsulation
@@ -80,8 +89,21 @@ class Blots : public Entity
   private:
     // Register a hit
     void Hit(MESSAGE &message);
-    // Add a blot
+    // Queue a blot, it is created with the others of the frame
     void AddBlot(int32_t i, int32_t rnd, const CVECTOR &pos, const CVECTOR &dir, float time);
+    // Clip all queued blots at once
+    void CreateBlots(MODEL *m);
+    // Cut the triangles of a blot out of the hull
+    void ClipBlot(const CMatrix &modelMtx, const Blot &b, std::vector<Vertex> &out) const;
+    // Take the hull of the model to clip the blots against
+    void BuildHull(MODEL *m);
+    // Release the vertices of a blot
+    void FreeBlot(int32_t i);
+    // Pack the vertices of the blots when the free ones are too fragmented for a new blot
+    void CompactVertices();
+    // Vertices to send to the buffer
+    void UpdateVertices(int32_t start, int32_t count);
+    void UploadVertices();
     //
     void SetNodesCollision(NODE *n, bool isSet);
     // Save blot parameters
@@ -97,13 +119,15 @@ class Blots : public Entity
     ATTRIBUTES *pCharAttributeRoot;
 
     Blot blot[BLOTS_MAX];
-    Vertex vrt[3 * BLOTS_NTRGS * BLOTS_MAX];
-    int32_t useVrt;
+    // Copy of the vertex buffer
+    Vertex vrt[BLOTS_VERTICES];
+    int32_t vBuffer;
+    storm::RangeAllocator vrtRanges;
+    std::vector<std::pair<int32_t, int32_t>> dirtyRanges;
 
-    int32_t updateBlot;
+    storm::DecalMesh hull;
+    bool isHullBuilt;
+    std::vector<int32_t> pendingBlots;
 
-    static bool AddPolygon(const CVECTOR *v, int32_t nv);
-    static CVECTOR clipTriangles[3 * BLOTS_NTRGS];
-    static int32_t numClipTriangles;
-    static CVECTOR dir, normal;
+    int32_t updateBlot;
 };
@@ -0,0 +1,251 @@
+#include "decal_clipper.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace storm
+{
+
+namespace
+{
+
+constexpr int32_t kMaxCells = 128;
+// a triangle cut by six planes has at most nine vertices
+constexpr int32_t kMaxPolygon = 16;
+
+using Polygon = std::array<CVECTOR, kMaxPolygon>;
+
+float Distance(const PLANE &plane, const CVECTOR &v)
+{
+    return plane.Nx * v.x + plane.Ny * v.y + plane.Nz * v.z - plane.D;
+}
+
+// GEOM ClipByPlane with the polygon passed in, keeps the part behind the plane
+int32_t ClipByPlane(const PLANE &plane, Polygon &poly, int32_t n)
+{
+    int32_t inside = 0;
+    for (int32_t i = 0; i < n; i++)
+        if (Distance(plane, poly[i]) < 0.0)
+            inside++;
+    if (inside == n || inside == 0)
+        return inside;
+
+    // needs to be clipped
+    float sign[2];
+    for (int32_t i = 0; i < n; i++)
+    {
+        sign[0] = Distance(plane, poly[i]);
+        if (!(sign[0] > 0.0))
+            continue;
+
+        // poly[i] is outside, the edge from the previous vertex enters it
+        auto i3 = i - 1;
+        if (i3 < 0)
+            i3 = n - 1;
+        sign[1] = Distance(plane, poly[i3]);
+        if (sign[1] > 0.0)
+            continue;
+        double k = sign[0] / (sign[0] - sign[1]);
+        CVECTOR cr0;
+        cr0.x = static_cast<float>(poly[i].x + k * (poly[i3].x - poly[i].x));
+        cr0.y = static_cast<float>(poly[i].y + k * (poly[i3].y - poly[i].y));
+        cr0.z = static_cast<float>(poly[i].z + k * (poly[i3].z - poly[i].z));
+
+        auto ii = i + 1;
+        if (ii >= n)
+            ii = 0;
+        if (Distance(plane, poly[ii]) <= 0.0)
+        {
+            // the next vertex is inside, make room for the second cross point
+            for (i3 = n; i3 > ii; i3--)
+                poly[i3] = poly[i3 - 1];
+            if (i > ii)
+                i++;
+            n++;
+        }
+        else
+        {
+            // drop the following outside vertices
+            for (;;)
+            {
+                i3 = ii;
+                ii++;
+                if (ii >= n)
+                    ii = 0;
+                if (Distance(plane, poly[ii]) <= 0)
+                    break;
+                for (auto i4 = i3; i4 < n - 1; i4++)
+                    poly[i4] = poly[i4 + 1];
+                n--;
+                if (i3 < i)
+                    i--;
+                if (i3 < ii)
+                    ii--;
+            }
+        }
+
+        i3 = ii - 1;
+        if (i3 < 0)
+            i3 = n - 1;
+        sign[0] = Distance(plane, poly[ii]);
+        sign[1] = Distance(plane, poly[i3]);
+        k = sign[0] / (sign[0] - sign[1]);
+        CVECTOR cr1;
+        cr1.x = static_cast<float>(poly[ii].x + k * (poly[i3].x - poly[ii].x));
+        cr1.y = static_cast<float>(poly[ii].y + k * (poly[i3].y - poly[ii].y));
+        cr1.z = static_cast<float>(poly[ii].z + k * (poly[i3].z - poly[ii].z));
+
+        poly[i] = cr0;
+        i3 = i + 1;
+        if (i3 >= n)
+            i3 = 0;
+        poly[i3] = cr1;
+        break;
+    }
+    return n;
+}
+
+} // namespace
+
+void DecalMesh::clear()
+{
+    triangles_.clear();
+    cellStart_.clear();
+    cellTriangles_.clear();
+    invCellSize_ = 0.0f;
+}
+
+void DecalMesh::addTriangle(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2)
+{
+    triangles_.push_back(v0);
+    triangles_.push_back(v1);
+    triangles_.push_back(v2);
+}
+
+void DecalMesh::addPolygon(const CVECTOR *v, int32_t nv)
+{
+    for (int32_t i = 2; i < nv; i++)
+        addTriangle(v[0], v[i - 1], v[i]);
+}
+
+void DecalMesh::build(float cellSize)
+{
+    cellStart_.clear();
+    cellTriangles_.clear();
+    if (triangles_.empty())
+        return;
+
+    CVECTOR min = triangles_.front(), max = triangles_.front();
+    for (const auto &v : triangles_)
+    {
+        min.x = std::min(min.x, v.x), min.y = std::min(min.y, v.y), min.z = std::min(min.z, v.z);
+        max.x = std::max(max.x, v.x), max.y = std::max(max.y, v.y), max.z = std::max(max.z, v.z);
+    }
+    const auto extent = max - min;
+    cellSize = std::max({cellSize, extent.x / kMaxCells, extent.y / kMaxCells, extent.z / kMaxCells, 1e-3f});
+    origin_ = min;
+    invCellSize_ = 1.0f / cellSize;
+    for (int32_t a = 0; a < 3; a++)
+        cells_[a] = std::clamp(static_cast<int32_t>(extent.v[a] * invCellSize_) + 1, 1, kMaxCells);
+
+    // counting pass, then the triangles into their cells
+    const auto numCells = static_cast<size_t>(cells_[0]) * cells_[1] * cells_[2];
+    cellStart_.assign(numCells + 1, 0);
+    const auto forEachCell = [&](uint32_t t, auto &&func) {
+        const auto *v = triangle(t);
+        CVECTOR tmin = v[0], tmax = v[0];
+        for (int32_t i = 1; i < 3; i++)
+        {
+            tmin.x = std::min(tmin.x, v[i].x), tmin.y = std::min(tmin.y, v[i].y), tmin.z = std::min(tmin.z, v[i].z);
+            tmax.x = std::max(tmax.x, v[i].x), tmax.y = std::max(tmax.y, v[i].y), tmax.z = std::max(tmax.z, v[i].z);
+        }
+        int32_t from[3], to[3];
+        cellRange(tmin, tmax, from, to);
+        for (auto z = from[2]; z <= to[2]; z++)
+            for (auto y = from[1]; y <= to[1]; y++)
+                for (auto x = from[0]; x <= to[0]; x++)
+                    func((static_cast<size_t>(z) * cells_[1] + y) * cells_[0] + x);
+    };
+
+    const auto count = static_cast<uint32_t>(size());
+    for (uint32_t t = 0; t < count; t++)
+        forEachCell(t, [&](size_t cell) { cellStart_[cell + 1]++; });
+    for (size_t c = 0; c < numCells; c++)
+        cellStart_[c + 1] += cellStart_[c];
+    cellTriangles_.resize(cellStart_[numCells]);
+    std::vector<uint32_t> fill(cellStart_.begin(), cellStart_.end() - 1);
+    for (uint32_t t = 0; t < count; t++)
+        forEachCell(t, [&](size_t cell) { cellTriangles_[fill[cell]++] = t; });
+}
+
+void DecalMesh::cellRange(const CVECTOR &min, const CVECTOR &max, int32_t (&from)[3], int32_t (&to)[3]) const
+{
+    for (int32_t a = 0; a < 3; a++)
+    {
+        from[a] = std::clamp(static_cast<int32_t>(std::floor((min.v[a] - origin_.v[a]) * invCellSize_)), 0,
+                             cells_[a] - 1);
+        to[a] = std::clamp(static_cast<int32_t>(std::floor((max.v[a] - origin_.v[a]) * invCellSize_)), 0,
+                           cells_[a] - 1);
+    }
+}
+
+void DecalMesh::query(const CVECTOR &min, const CVECTOR &max, std::vector<uint32_t> &out) const
+{
+    out.clear();
+    if (cellStart_.empty())
+        return;
+    int32_t from[3], to[3];
+    cellRange(min, max, from, to);
+    for (auto z = from[2]; z <= to[2]; z++)
+        for (auto y = from[1]; y <= to[1]; y++)
+            for (auto x = from[0]; x <= to[0]; x++)
+            {
+                const auto cell = (static_cast<size_t>(z) * cells_[1] + y) * cells_[0] + x;
+                out.insert(out.end(), cellTriangles_.begin() + cellStart_[cell],
+                           cellTriangles_.begin() + cellStart_[cell + 1]);
+            }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+DecalClip ClipDecal(const DecalMesh &mesh, const PLANE *planes, int32_t nplanes, const CVECTOR &center, float radius,
+                    const CVECTOR &dir, uint32_t maxTriangles)
+{
+    DecalClip clip;
+    clip.normal = -0.1f * dir;
+
+    std::vector<uint32_t> candidates;
+    mesh.query(center - CVECTOR(radius, radius, radius), center + CVECTOR(radius, radius, radius), candidates);
+
+    uint32_t numTriangles = 0;
+    Polygon poly;
+    for (const auto t : candidates)
+    {
+        if (numTriangles >= maxTriangles)
+            break;
+        const auto *v = mesh.triangle(t);
+        std::copy(v, v + 3, poly.begin());
+        int32_t nv = 3;
+        for (int32_t p = 0; p < nplanes && nv > 0; p++)
+            nv = ClipByPlane(planes[p], poly, nv);
+        if (nv < 3)
+            continue;
+
+        // back faces are skipped
+        const auto norm = (poly[0] - poly[1]) ^ (poly[0] - poly[2]);
+        if ((norm | dir) >= 0.0f)
+            continue;
+        clip.normal += 100.0f * norm;
+
+        for (int32_t i = 2; i < nv && numTriangles < maxTriangles; i++, numTriangles++)
+        {
+            clip.vertices.push_back(poly[0]);
+            clip.vertices.push_back(poly[i - 1]);
+            clip.vertices.push_back(poly[i]);
+        }
+    }
+    return clip;
+}
+
+} // namespace storm
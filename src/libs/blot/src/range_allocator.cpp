@@ -0,0 +1,75 @@
+#include "range_allocator.h"
+
+#include <iterator>
+
+namespace storm
+{
+
+RangeAllocator::RangeAllocator(uint32_t capacity)
+{
+    reset(capacity);
+}
+
+void RangeAllocator::reset(uint32_t capacity)
+{
+    capacity_ = capacity;
+    used_ = 0;
+    free_.clear();
+    if (capacity > 0)
+        free_.emplace(0, capacity);
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size)
+{
+    if (size == 0)
+        return kInvalid;
+    for (auto it = free_.begin(); it != free_.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        const auto start = it->first;
+        const auto rest = it->second - size;
+        free_.erase(it);
+        if (rest > 0)
+            free_.emplace(start + size, rest);
+        used_ += size;
+        return start;
+    }
+    return kInvalid;
+}
+
+void RangeAllocator::free(uint32_t start, uint32_t size)
+{
+    if (size == 0)
+        return;
+    used_ -= size;
+    auto it = free_.emplace(start, size).first;
+
+    // merge with the following range
+    const auto next = std::next(it);
+    if (next != free_.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        free_.erase(next);
+    }
+    // and with the preceding one
+    if (it != free_.begin())
+    {
+        const auto prev = std::prev(it);
+        if (prev->first + prev->second == it->first)
+        {
+            prev->second += it->second;
+            free_.erase(it);
+        }
+    }
+}
+
+uint32_t RangeAllocator::end() const
+{
+    if (free_.empty())
+        return capacity_;
+    const auto &last = *free_.rbegin();
+    return last.first + last.second == capacity_ ? last.first : capacity_;
+}
+
+} // namespace storm
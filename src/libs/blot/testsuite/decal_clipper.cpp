@@ -0,0 +1,341 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "decal_clipper.h"
+#include "range_allocator.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// GEOM::Clip with the Blots::AddPolygon callback as they were, over all triangles in order
+class ReferenceClipper
+{
+  public:
+    storm::DecalClip clip(const std::vector<CVECTOR> &triangles, const PLANE *planes, int32_t nplanes,
+                          const CVECTOR &dir_, uint32_t maxTriangles)
+    {
+        maxTrgs = maxTriangles;
+        numClipTriangles = 0;
+        clipTriangles.clear();
+        dir = dir_;
+        normal = -0.1f * dir;
+        for (size_t t = 0; t < triangles.size(); t += 3)
+        {
+            for (int32_t v = 0; v < 3; v++)
+                poly[v] = triangles[t + v];
+            int32_t nverts = 3;
+            for (int32_t p = 0; p < nplanes; p++)
+            {
+                nverts = ClipByPlane(planes[p], nverts);
+                if (nverts == 0)
+                    break;
+            }
+            if (nverts > 0 && AddPolygon(poly, nverts) == false)
+                break;
+        }
+        return {clipTriangles, normal};
+    }
+
+  private:
+    int32_t ClipByPlane(const PLANE &plane, int32_t n)
+    {
+        int32_t inside = 0;
+        CVECTOR cr0, cr1;
+        int32_t i;
+        for (i = 0; i < n; i++)
+            if (plane.Nx * poly[i].x + plane.Ny * poly[i].y + plane.Nz * poly[i].z - plane.D < 0.0)
+                inside++;
+        if (inside == n || inside == 0)
+            return inside;
+
+        float sign[4];
+        int32_t ii, i3, i4;
+        for (i = 0; i < n; i++)
+        {
+            sign[0] = plane.Nx * poly[i].x + plane.Ny * poly[i].y + plane.Nz * poly[i].z - plane.D;
+            if (sign[0] > 0.0)
+            {
+                i3 = i - 1;
+                if (i3 < 0)
+                    i3 = n - 1;
+                sign[1] = plane.Nx * poly[i3].x + plane.Ny * poly[i3].y + plane.Nz * poly[i3].z - plane.D;
+                if (sign[1] > 0.0)
+                    continue;
+                double k = sign[0] / (sign[0] - sign[1]);
+                cr0.x = static_cast<float>(poly[i].x + k * (poly[i3].x - poly[i].x));
+                cr0.y = static_cast<float>(poly[i].y + k * (poly[i3].y - poly[i].y));
+                cr0.z = static_cast<float>(poly[i].z + k * (poly[i3].z - poly[i].z));
+
+                ii = i + 1;
+                if (ii >= n)
+                    ii = 0;
+                if (plane.Nx * poly[ii].x + plane.Ny * poly[ii].y + plane.Nz * poly[ii].z - plane.D <= 0.0)
+                {
+                    for (i3 = n; i3 > ii; i3--)
+                        poly[i3] = poly[i3 - 1];
+                    if (i > ii)
+                        i++;
+                    n++;
+                    goto ClipEPH;
+                }
+            ClipBPH:
+                i3 = ii;
+                ii++;
+                if (ii >= n)
+                    ii = 0;
+                if (plane.Nx * poly[ii].x + plane.Ny * poly[ii].y + plane.Nz * poly[ii].z - plane.D <= 0)
+                    goto ClipEPH;
+                for (i4 = i3; i4 < n - 1; i4++)
+                    poly[i4] = poly[i4 + 1];
+                n--;
+                if (i3 < i)
+                    i--;
+                if (i3 < ii)
+                    ii--;
+                goto ClipBPH;
+            ClipEPH:
+                i3 = ii - 1;
+                if (i3 < 0)
+                    i3 = n - 1;
+
+                sign[0] = plane.Nx * poly[ii].x + plane.Ny * poly[ii].y + plane.Nz * poly[ii].z - plane.D;
+                sign[1] = plane.Nx * poly[i3].x + plane.Ny * poly[i3].y + plane.Nz * poly[i3].z - plane.D;
+                k = sign[0] / (sign[0] - sign[1]);
+                cr1.x = static_cast<float>(poly[ii].x + k * (poly[i3].x - poly[ii].x));
+                cr1.y = static_cast<float>(poly[ii].y + k * (poly[i3].y - poly[ii].y));
+                cr1.z = static_cast<float>(poly[ii].z + k * (poly[i3].z - poly[ii].z));
+
+                poly[i] = cr0;
+                i3 = i + 1;
+                if (i3 >= n)
+                    i3 = 0;
+                poly[i3] = cr1;
+                break;
+            }
+        }
+        return n;
+    }
+
+    bool AddPolygon(const CVECTOR *v, int32_t nv)
+    {
+        if (numClipTriangles >= maxTrgs)
+            return false;
+        if (nv < 3)
+            return true;
+        const auto norm = (v[0] - v[1]) ^ (v[0] - v[2]);
+        if ((norm | dir) >= 0.0f)
+            return true;
+        normal += 100.0f * norm;
+        for (int32_t i = 2; i < nv; i++)
+        {
+            clipTriangles.push_back(v[0]);
+            clipTriangles.push_back(v[i - 1]);
+            clipTriangles.push_back(v[i]);
+            numClipTriangles++;
+            if (numClipTriangles >= maxTrgs)
+                return false;
+        }
+        return true;
+    }
+
+    CVECTOR poly[256];
+    std::vector<CVECTOR> clipTriangles;
+    uint32_t numClipTriangles = 0;
+    uint32_t maxTrgs = 0;
+    CVECTOR dir, normal;
+};
+
+// A wavy hull side of small triangles, as dense as a ship model
+std::vector<CVECTOR> MakeHull(int32_t rows, int32_t columns, float step)
+{
+    std::vector<CVECTOR> triangles;
+    const auto point = [&](int32_t r, int32_t c) {
+        const auto y = r * step;
+        const auto z = c * step;
+        return CVECTOR(2.0f * sinf(z * 0.13f) + 0.5f * cosf(y * 0.7f), y, z);
+    };
+    for (int32_t r = 0; r < rows; r++)
+        for (int32_t c = 0; c < columns; c++)
+        {
+            const auto a = point(r, c), b = point(r + 1, c), d = point(r, c + 1), e = point(r + 1, c + 1);
+            triangles.insert(triangles.end(), {a, b, e, a, e, d});
+            // and the same from the inside, so both facings are there
+            triangles.insert(triangles.end(), {a, e, b, a, d, e});
+        }
+    return triangles;
+}
+
+// The box Blots clips with, turned by the model rotation
+void MakeBox(const CVECTOR &center, float radius, float angle, PLANE (&p)[6])
+{
+    static const int32_t axis[6] = {1, 1, 2, 2, 0, 0};
+    for (int32_t n = 0; n < 6; n++)
+    {
+        CVECTOR nrm(0.0f);
+        nrm.v[axis[n]] = (n & 1) ? -1.0f : 1.0f;
+        const CVECTOR rot(nrm.x * cosf(angle) - nrm.z * sinf(angle), nrm.y, nrm.x * sinf(angle) + nrm.z * cosf(angle));
+        p[n].Nx = rot.x;
+        p[n].Ny = rot.y;
+        p[n].Nz = rot.z;
+        p[n].D = (rot | center) + radius;
+    }
+}
+
+void RequireEqual(const storm::DecalClip &a, const storm::DecalClip &b)
+{
+    REQUIRE(a.vertices.size() == b.vertices.size());
+    for (size_t i = 0; i < a.vertices.size(); i++)
+    {
+        REQUIRE(a.vertices[i].x == b.vertices[i].x);
+        REQUIRE(a.vertices[i].y == b.vertices[i].y);
+        REQUIRE(a.vertices[i].z == b.vertices[i].z);
+    }
+    REQUIRE(a.normal.x == b.normal.x);
+    REQUIRE(a.normal.y == b.normal.y);
+    REQUIRE(a.normal.z == b.normal.z);
+}
+
+} // namespace
+
+TEST_CASE("Decal clipping matches the old model clipper", "[blot]")
+{
+    const auto triangles = MakeHull(40, 120, 0.25f);
+    storm::DecalMesh mesh;
+    for (size_t t = 0; t < triangles.size(); t += 3)
+        mesh.addTriangle(triangles[t], triangles[t + 1], triangles[t + 2]);
+    mesh.build();
+    REQUIRE(mesh.size() == triangles.size() / 3);
+
+    const auto radius = GENERATE(0.6f, 1.5f);
+    const auto maxTriangles = GENERATE(32u, 1000u);
+
+    ReferenceClipper reference;
+    std::mt19937 rng(31337);
+    std::uniform_real_distribution<float> y(0.0f, 10.0f), z(0.0f, 30.0f), angle(-3.0f, 3.0f);
+    size_t clipped = 0;
+    for (int32_t n = 0; n < 200; n++)
+    {
+        const auto hy = y(rng);
+        const auto hz = z(rng);
+        // hits on the hull side
+        const CVECTOR center(2.0f * sinf(hz * 0.13f) + 0.5f * cosf(hy * 0.7f), hy, hz);
+        const auto a = angle(rng);
+        const CVECTOR dir(cosf(a), 0.3f * sinf(a), sinf(a));
+        PLANE p[6];
+        MakeBox(center, radius, a * 0.25f, p);
+
+        const auto expected = reference.clip(triangles, p, 6, dir, maxTriangles);
+        const auto actual = storm::ClipDecal(mesh, p, 6, center, radius * 1.75f, dir, maxTriangles);
+        RequireEqual(actual, expected);
+        clipped += !actual.vertices.empty();
+    }
+    CHECK(clipped > 150);
+}
+
+TEST_CASE("Released vertex ranges are merged and reused", "[blot]")
+{
+    storm::RangeAllocator ranges(100);
+    const auto a = ranges.allocate(30);
+    const auto b = ranges.allocate(30);
+    const auto c = ranges.allocate(30);
+    CHECK(a == 0);
+    CHECK(b == 30);
+    CHECK(c == 60);
+    CHECK(ranges.end() == 90);
+    CHECK(ranges.allocate(20) == storm::RangeAllocator::kInvalid);
+
+    // a hole in the middle does not move the others
+    ranges.free(b, 30);
+    CHECK(ranges.end() == 90);
+    CHECK(ranges.used() == 60);
+    CHECK(ranges.allocate(12) == 30);
+
+    // freeing the neighbours merges everything back
+    ranges.free(30, 12);
+    ranges.free(c, 30);
+    CHECK(ranges.end() == 30);
+    ranges.free(a, 30);
+    CHECK(ranges.end() == 0);
+    CHECK(ranges.used() == 0);
+    CHECK(ranges.allocate(100) == 0);
+}
+
+TEST_CASE("Fragmented vertex ranges fit a blot once packed", "[blot]")
+{
+    // blots of at most 96 vertices in room for 4 of them, as in Blots
+    storm::RangeAllocator ranges(4 * 96);
+    std::vector<std::pair<uint32_t, uint32_t>> blots;
+    for (const uint32_t size : {60u, 90u, 60u, 90u, 60u})
+        blots.emplace_back(ranges.allocate(size), size);
+    ranges.free(blots[1].first, blots[1].second);
+    ranges.free(blots[3].first, blots[3].second);
+    blots.erase(blots.begin() + 3);
+    blots.erase(blots.begin() + 1);
+
+    // 204 vertices are free, but in no range of 96
+    CHECK(ranges.capacity() - ranges.used() == 204);
+    CHECK(ranges.allocate(96) == storm::RangeAllocator::kInvalid);
+
+    // Blots::CompactVertices: the blots are allocated again in the order they lie
+    ranges.reset(ranges.capacity());
+    uint32_t end = 0;
+    for (auto &[start, size] : blots)
+    {
+        start = ranges.allocate(size);
+        CHECK(start == end);
+        end += size;
+    }
+    CHECK(ranges.end() == 180);
+    CHECK(ranges.allocate(96) == 180);
+}
+
+TEST_CASE("Decal clipping benchmark", "[.][blot][benchmark]")
+{
+    const auto triangles = MakeHull(60, 240, 0.25f);
+    storm::DecalMesh mesh;
+    for (size_t t = 0; t < triangles.size(); t += 3)
+        mesh.addTriangle(triangles[t], triangles[t + 1], triangles[t + 2]);
+    mesh.build();
+
+    std::vector<std::pair<CVECTOR, CVECTOR>> hits;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> y(0.0f, 15.0f), z(0.0f, 60.0f), angle(-3.0f, 3.0f);
+    for (int32_t n = 0; n < 64; n++)
+    {
+        const auto a = angle(rng);
+        const auto hy = y(rng);
+        const auto hz = z(rng);
+        hits.emplace_back(CVECTOR(2.0f * sinf(hz * 0.13f) + 0.5f * cosf(hy * 0.7f), hy, hz),
+                          CVECTOR(cosf(a), 0.0f, sinf(a)));
+    }
+
+    ReferenceClipper reference;
+    BENCHMARK("every triangle, 64 blots")
+    {
+        size_t n = 0;
+        for (const auto &[center, dir] : hits)
+        {
+            PLANE p[6];
+            MakeBox(center, 0.6f, 0.0f, p);
+            n += reference.clip(triangles, p, 6, dir, 32).vertices.size();
+        }
+        return n;
+    };
+    BENCHMARK("grid clipper, 64 blots")
+    {
+        size_t n = 0;
+        for (const auto &[center, dir] : hits)
+        {
+            PLANE p[6];
+            MakeBox(center, 0.6f, 0.0f, p);
+            n += storm::ClipDecal(mesh, p, 6, center, 0.6f * 1.75f, dir, 32).vertices.size();
+        }
+        return n;
+    };
+}
@@ -2,10 +2,30 @@
 
 #include "object.h"
 
+// what the scripts know of a cannon ball from AIBalls
+struct CANNON_BALL
+{
+    int32_t iOwner;        // ball owner(character index)
+    uint32_t dwGoodIndex;  // ball type
+    uint32_t dwCannonType; // cannon type
+    float fDistance;       // distance flown from the cannon
+};
+
 class CANNON_TRACE_BASE : public COLLISION_OBJECT
 {
   public:
     ~CANNON_TRACE_BASE() override = default;
 
     virtual float Cannon_Trace(int32_t iBallOwner, const CVECTOR &src, const CVECTOR &dst) = 0;
+
+    // objects collecting their hits keep them for Cannon_SendHits, the others trace as Cannon_Trace does
+    virtual float Cannon_CollectTrace(const CANNON_BALL &ball, const CVECTOR &src, const CVECTOR &dst)
+    {
+        return Cannon_Trace(ball.iOwner, src, dst);
+    }
+
+    // sends the scripts the hits collected in the frame at once
+    virtual void Cannon_SendHits()
+    {
+    }
 };
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "c_vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Static triangle soup with a bounding volume hierarchy
+ *
+ * Unlike COLLIDE/MODEL traces the mesh keeps no per-trace state, so any number of threads can trace it at once
+ * after build(). Used by offline bakers which need millions of rays against fixed geometry.
+ */
+class TraceMesh final
+{
+  public:
+    static constexpr uint32_t kNoTriangle = 0xFFFFFFFFu;
+
+    void clear();
+    void reserve(size_t triangles);
+
+    void addTriangle(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2);
+    // convex polygon, triangulated as a fan
+    void addPolygon(const CVECTOR *v, int32_t nv);
+    // a triangle list, three vertices each
+    void addTriangles(const std::vector<CVECTOR> &vertices);
+
+    // must be called after the last add and before tracing
+    void build();
+
+    // returns the fraction of src->dst to the nearest hit, or 2.0f if nothing is hit (same as COLLIDE::Trace)
+    float trace(const CVECTOR &src, const CVECTOR &dst, uint32_t *hitTriangle = nullptr) const;
+
+    [[nodiscard]] size_t size() const
+    {
+        return triangles_.size();
+    }
+
+    [[nodiscard]] const CVECTOR &vertex(uint32_t triangle, uint32_t index) const
+    {
+        return triangles_[triangle].v[index];
+    }
+
+    // not normalized, (v1 - v0) ^ (v2 - v0)
+    [[nodiscard]] CVECTOR normal(uint32_t triangle) const;
+
+    // 64 bit FNV-1a over the vertices in insertion order
+    [[nodiscard]] uint64_t contentHash() const;
+    // the hash a mesh made of the triangle list would have, without making it
+    [[nodiscard]] static uint64_t contentHash(const std::vector<CVECTOR> &vertices);
+
+  private:
+    struct Triangle
+    {
+        CVECTOR v[3];
+    };
+
+    struct Node
+    {
+        CVECTOR min, max;
+        // leaf: first triangle index and count, inner: left child index and 0
+        uint32_t first;
+        uint32_t count;
+        uint32_t right;
+    };
+
+    uint32_t buildNode(uint32_t first, uint32_t count, uint32_t depth);
+
+    std::vector<Triangle> triangles_;
+    std::vector<uint32_t> order_;
+    std::vector<Node> nodes_;
+};
+
+} // namespace storm
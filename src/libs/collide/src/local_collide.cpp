@@ -91,8 +91,8 @@ int32_t LCOLL::SetBox(const CVECTOR &boxSize, const CMatrix &transform, bool tes
     // F0(v0,v1,v2), F1(v0,v1,v2,v3)...
     addVerts = nullptr;
 
-    const auto its = core.GetEntityIds(layerIndex_);
-    col->Clip(its, &plane[0], 6, boxCenter, boxRadius, AddPolyColl, nullptr, 0);
+    const auto its = core.GetLayerSnapshot(layerIndex_);
+    col->Clip(its.ids(), &plane[0], 6, boxCenter, boxRadius, AddPolyColl, nullptr, 0);
     return 0;
 }
 
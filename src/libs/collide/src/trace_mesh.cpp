@@ -0,0 +1,255 @@
+#include "trace_mesh.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace storm
+{
+
+namespace
+{
+
+constexpr uint32_t kLeafSize = 4;
+constexpr uint32_t kMaxDepth = 48;
+constexpr float kMissResult = 2.0f;
+constexpr float kBoxPad = 1e-4f;
+
+CVECTOR Min(const CVECTOR &a, const CVECTOR &b)
+{
+    return CVECTOR(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+CVECTOR Max(const CVECTOR &a, const CVECTOR &b)
+{
+    return CVECTOR(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+// slab test, returns entry distance or a value > tMax on miss
+float IntersectBox(const CVECTOR &min, const CVECTOR &max, const CVECTOR &org, const CVECTOR &invDir, float tMax)
+{
+    float t0 = 0.0f, t1 = tMax;
+    for (int32_t i = 0; i < 3; i++)
+    {
+        float tNear = (min.v[i] - org.v[i]) * invDir.v[i];
+        float tFar = (max.v[i] - org.v[i]) * invDir.v[i];
+        if (tNear > tFar)
+            std::swap(tNear, tFar);
+        // NaN from 0 * inf leaves the interval unchanged
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+        if (t0 > t1)
+            return tMax + 1.0f;
+    }
+    return t0;
+}
+
+uint64_t HashVertex(uint64_t hash, const CVECTOR &v)
+{
+    for (const float f : v.v)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        for (int32_t b = 0; b < 4; b++)
+        {
+            hash ^= (bits >> (b * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+} // namespace
+
+void TraceMesh::clear()
+{
+    triangles_.clear();
+    order_.clear();
+    nodes_.clear();
+}
+
+void TraceMesh::reserve(size_t triangles)
+{
+    triangles_.reserve(triangles);
+}
+
+void TraceMesh::addTriangle(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2)
+{
+    triangles_.push_back({{v0, v1, v2}});
+}
+
+void TraceMesh::addPolygon(const CVECTOR *v, int32_t nv)
+{
+    for (int32_t i = 2; i < nv; i++)
+        addTriangle(v[0], v[i - 1], v[i]);
+}
+
+void TraceMesh::addTriangles(const std::vector<CVECTOR> &vertices)
+{
+    triangles_.reserve(triangles_.size() + vertices.size() / 3);
+    for (size_t i = 2; i < vertices.size(); i += 3)
+        addTriangle(vertices[i - 2], vertices[i - 1], vertices[i]);
+}
+
+void TraceMesh::build()
+{
+    nodes_.clear();
+    order_.resize(triangles_.size());
+    for (uint32_t i = 0; i < order_.size(); i++)
+        order_[i] = i;
+
+    if (triangles_.empty())
+        return;
+
+    nodes_.reserve(triangles_.size() * 2 / kLeafSize + 1);
+    buildNode(0, static_cast<uint32_t>(triangles_.size()), 0);
+}
+
+uint32_t TraceMesh::buildNode(uint32_t first, uint32_t count, uint32_t depth)
+{
+    // nodes_ grows during recursion, so the node is always addressed by index
+    const auto index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    CVECTOR bmin(1e30f), bmax(-1e30f), cmin(1e30f), cmax(-1e30f);
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        const auto &t = triangles_[order_[i]];
+        const auto centroid = (t.v[0] + t.v[1] + t.v[2]) / 3.0f;
+        bmin = Min(bmin, Min(t.v[0], Min(t.v[1], t.v[2])));
+        bmax = Max(bmax, Max(t.v[0], Max(t.v[1], t.v[2])));
+        cmin = Min(cmin, centroid);
+        cmax = Max(cmax, centroid);
+    }
+    // the boxes are tested in single precision, the faces in double, so rays grazing a box are not lost
+    const auto pad = (bmax - bmin) * kBoxPad + CVECTOR(kBoxPad);
+    nodes_[index].min = bmin - pad;
+    nodes_[index].max = bmax + pad;
+
+    const auto extent = cmax - cmin;
+    int32_t axis = 0;
+    if (extent.y > extent.v[axis])
+        axis = 1;
+    if (extent.z > extent.v[axis])
+        axis = 2;
+
+    if (count <= kLeafSize || depth >= kMaxDepth || extent.v[axis] <= 0.0f)
+    {
+        nodes_[index].first = first;
+        nodes_[index].count = count;
+        return index;
+    }
+
+    // median split keeps the tree balanced and the build deterministic
+    const uint32_t half = count / 2;
+    std::nth_element(order_.begin() + first, order_.begin() + first + half, order_.begin() + first + count,
+                     [this, axis](uint32_t a, uint32_t b) {
+                         const auto &ta = triangles_[a];
+                         const auto &tb = triangles_[b];
+                         const float ca = ta.v[0].v[axis] + ta.v[1].v[axis] + ta.v[2].v[axis];
+                         const float cb = tb.v[0].v[axis] + tb.v[1].v[axis] + tb.v[2].v[axis];
+                         return ca < cb || (ca == cb && a < b);
+                     });
+
+    const uint32_t left = buildNode(first, half, depth + 1);
+    const uint32_t right = buildNode(first + half, count - half, depth + 1);
+    nodes_[index].first = left;
+    nodes_[index].right = right;
+    nodes_[index].count = 0;
+    return index;
+}
+
+float TraceMesh::trace(const CVECTOR &src, const CVECTOR &dst, uint32_t *hitTriangle) const
+{
+    if (hitTriangle)
+        *hitTriangle = kNoTriangle;
+    if (nodes_.empty())
+        return kMissResult;
+
+    const auto dir = dst - src;
+    const CVECTOR invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    const DVECTOR srcD(src);
+    const DVECTOR dirD = DVECTOR(dst) - srcD;
+
+    float best = 1.0f;
+    uint32_t bestTriangle = kNoTriangle;
+
+    uint32_t stack[kMaxDepth * 2 + 2];
+    uint32_t sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const auto &node = nodes_[stack[--sp]];
+        if (IntersectBox(node.min, node.max, src, invDir, best) > best)
+            continue;
+
+        if (node.count == 0)
+        {
+            stack[sp++] = node.right;
+            stack[sp++] = node.first;
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            // the face test of GEOM::Trace, so rays through edges and vertices hit what they hit in the game:
+            // double precision, edges of front faces are hit, edges of back faces are not
+            const auto &t = triangles_[order_[i]];
+            const DVECTOR v0(t.v[0]);
+            const auto a = DVECTOR(t.v[1]) - v0;
+            const auto b = DVECTOR(t.v[2]) - v0;
+            const auto pvec = dirD ^ b;
+            const auto det = a | pvec;
+            if (det == 0.0)
+                continue;
+            const auto c = srcD - v0;
+            const auto u = c | pvec;
+            const auto v = dirD | (c ^ a);
+            if (det < 0.0 ? !(u < 0.0 && u > det && v < 0.0 && u + v > det)
+                          : !(u >= 0.0 && u <= det && v >= 0.0 && u + v <= det))
+                continue;
+            // distance to the plane of the face, the ends of the segment are not hit
+            const auto dist = (c | (a ^ b)) / det;
+            if (dist <= 0.0 || dist >= 1.0)
+                continue;
+            const auto d = static_cast<float>(dist);
+            if (d < best || (d == best && order_[i] < bestTriangle))
+            {
+                best = d;
+                bestTriangle = order_[i];
+            }
+        }
+    }
+
+    if (bestTriangle == kNoTriangle)
+        return kMissResult;
+    if (hitTriangle)
+        *hitTriangle = bestTriangle;
+    return best;
+}
+
+CVECTOR TraceMesh::normal(uint32_t triangle) const
+{
+    const auto &t = triangles_[triangle];
+    return (t.v[1] - t.v[0]) ^ (t.v[2] - t.v[0]);
+}
+
+uint64_t TraceMesh::contentHash() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto &t : triangles_)
+        for (const auto &v : t.v)
+            hash = HashVertex(hash, v);
+    return hash;
+}
+
+uint64_t TraceMesh::contentHash(const std::vector<CVECTOR> &vertices)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i + 3 <= vertices.size(); i += 3)
+        for (size_t v = i; v < i + 3; v++)
+            hash = HashVertex(hash, vertices[v]);
+    return hash;
+}
+
+} // namespace storm
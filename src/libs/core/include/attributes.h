@@ -6,6 +6,7 @@
 #include <string_view>
 #include <vector>
 
+#include "attributes_arena.h"
 #include "storm_assert.h"
 
 class VSTRING_CODEC
@@ -22,10 +23,20 @@ class VSTRING_CODEC
     virtual void VariableChanged() = 0;
 };
 
+namespace storm
+{
+class AttributesReader;
+class AttributesWriter;
+class AttributeValueView;
+} // namespace storm
+
 class ATTRIBUTES final
 {
     // TODO: remove with another iteration of rewriting this
     friend class COMPILER;
+    friend class storm::AttributesReader;
+    friend class storm::AttributesWriter;
+    friend class storm::AttributeValueView;
 
     class LegacyProxy;
 
@@ -46,6 +57,9 @@ class ATTRIBUTES final
     [[nodiscard]] bool HasValue() const noexcept;
     [[nodiscard]] const std::string &GetValue() const;
     [[nodiscard]] LegacyProxy GetThisAttr() const;
+    // the value converted the way scripts do it, parsed once until the value changes
+    [[nodiscard]] int32_t GetValueAsInt() const;
+    [[nodiscard]] float GetValueAsFloat() const;
     void SetName(const std::string_view &new_name);
     [[deprecated("Pass attribute value by string_view instead")]]
     void SetValue(const char *new_value);
@@ -85,14 +99,35 @@ private:
     ATTRIBUTES(VSTRING_CODEC &string_codec, ATTRIBUTES *parent, const std::string_view &name);
     ATTRIBUTES(VSTRING_CODEC &string_codec, ATTRIBUTES *parent, uint32_t name_code);
 
+    using Children = std::vector<ATTRIBUTES *, storm::ArenaAllocator<ATTRIBUTES *>>;
+
     void Release() const noexcept;
     ATTRIBUTES *CreateNewAttribute(uint32_t name_code);
+    ATTRIBUTES *AddChild(uint32_t name_code);
+    void DestroyChild(ATTRIBUTES *child) noexcept;
+    void ClearChildren() noexcept;
+    void TakeChildren(ATTRIBUTES &other) noexcept;
+    storm::AttributesArena *ChildArena();
+    void StoreValue(const std::string_view &value);
+    // moves the value of another node here, after its children so the arena is known
+    void TakeValue(ATTRIBUTES &other) noexcept;
+    void ResetValue();
+    // the value is about to change, views get a copy and parsed numbers are forgotten
+    void ValueChanged();
 
     VSTRING_CODEC &stringCodec_;
     uint32_t nameCode_{};
     std::optional<std::string> value_;
-    std::vector<std::unique_ptr<ATTRIBUTES>> attributes_;
+    Children attributes_;
+    // children are made in the arena, nodes of a tree also live in it
+    storm::AttributesArena *arena_{nullptr};
+    // the node holds a reference of the arena, roots of trees do
+    bool ownsArena_{false};
     ATTRIBUTES *parent_{nullptr};
+    mutable storm::AttributeValueView *views_{nullptr};
+    mutable int32_t intValue_{};
+    mutable float floatValue_{};
+    mutable uint8_t parsed_{};
     bool break_{false};
     
     class LegacyProxy
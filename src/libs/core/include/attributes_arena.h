@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Memory of one attribute tree
+ *
+ * Nodes and child arrays of a tree are cut from a few large blocks, so a tree lies together in memory and building it
+ * does not go to the heap for every node. Freed pieces are reused by size. The arena lives while it is referenced or
+ * holds allocations. A tree that is the only user of its arena drops it at once instead of freeing node by node.
+ */
+class AttributesArena final
+{
+  public:
+    explicit AttributesArena(size_t reserve = 0);
+    AttributesArena(const AttributesArena &) = delete;
+    AttributesArena &operator=(const AttributesArena &) = delete;
+
+    void *allocate(size_t size);
+    void deallocate(void *p, size_t size) noexcept;
+
+    // bytes an allocation takes from a block
+    static size_t roundUp(size_t size) noexcept;
+
+    void addRef() noexcept
+    {
+        ++refs_;
+    }
+
+    void release() noexcept
+    {
+        if (--refs_ == 0)
+            delete this;
+    }
+
+    // takes over a reference of another arena whose nodes were moved into this tree
+    void adopt(AttributesArena *other);
+
+    // some value of the tree keeps its text on the heap
+    void noteHeapValue() noexcept
+    {
+        heapValues_ = true;
+    }
+
+    // nodes of the arena are used by other trees or the other way around
+    void markShared() noexcept
+    {
+        shared_ = true;
+    }
+
+    // a value of a node is read in place from outside the tree
+    void addView() noexcept
+    {
+        ++views_;
+    }
+
+    void removeView() noexcept
+    {
+        --views_;
+    }
+
+    // the tree can be dropped with the arena without destroying its nodes
+    [[nodiscard]] bool canDrop() const noexcept
+    {
+        return !shared_ && !heapValues_ && views_ == 0;
+    }
+
+    // frees everything without looking at the references, only when canDrop()
+    void drop() noexcept
+    {
+        delete this;
+    }
+
+  private:
+    static constexpr size_t kGranularity = 16;
+    static constexpr size_t kMaxSmall = 1024;
+    static constexpr size_t kMinBlock = 2048;
+    static constexpr size_t kMaxBlock = 64 * 1024;
+
+    struct FreeItem
+    {
+        FreeItem *next;
+    };
+
+    ~AttributesArena();
+
+    void *allocateBlock(size_t size);
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte *current_ = nullptr;
+    std::byte *end_ = nullptr;
+    size_t nextBlock_ = kMinBlock;
+    std::array<FreeItem *, kMaxSmall / kGranularity> free_{};
+    std::unordered_set<void *> large_;
+    std::vector<AttributesArena *> adopted_;
+    // references and allocations alive
+    size_t refs_ = 0;
+    size_t views_ = 0;
+    bool heapValues_ = false;
+    bool shared_ = false;
+};
+
+// Allocator of child arrays, from the arena when there is one
+template <typename T> class ArenaAllocator
+{
+  public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(AttributesArena *arena) noexcept : arena_(arena)
+    {
+    }
+
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena())
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(arena_ ? arena_->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        if (arena_)
+            arena_->deallocate(p, n * sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    [[nodiscard]] AttributesArena *arena() const noexcept
+    {
+        return arena_;
+    }
+
+    template <typename U> bool operator==(const ArenaAllocator<U> &other) const noexcept
+    {
+        return arena_ == other.arena();
+    }
+
+    template <typename U> bool operator!=(const ArenaAllocator<U> &other) const noexcept
+    {
+        return arena_ != other.arena();
+    }
+
+  private:
+    AttributesArena *arena_ = nullptr;
+};
+
+} // namespace storm
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "attributes.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Writes attribute trees in the binary form used by saves
+ *
+ * A tree is a presence flag, 0 for nullptr, followed by the nodes in depth-first order: name, value and number of
+ * children, all counts as varints. Names go to a dictionary shared by every tree written since reset(): the first use
+ * of a name stores its text, later ones only its index. Values are stored with their length.
+ */
+class AttributesWriter final
+{
+  public:
+    AttributesWriter();
+
+    // appends the tree to out, nullptr is written as an empty tree
+    void write(const ATTRIBUTES *root, std::string &out);
+
+    // starts a new dictionary
+    void reset();
+
+  private:
+    void writeName(const ATTRIBUTES &node, std::string &out);
+
+    static constexpr uint32_t kNoIndex = 0xffffffff;
+
+    // name code -> index in the dictionary
+    std::unordered_map<uint32_t, uint32_t> names_;
+    std::array<std::pair<uint32_t, uint32_t>, 256> recent_;
+    std::vector<std::pair<ATTRIBUTES *const *, ATTRIBUTES *const *>> stack_;
+};
+
+/**
+ * \brief Reads attribute trees written by AttributesWriter
+ *
+ * Children are merged into the attributes that already exist under the same name, as script loading always did.
+ */
+class AttributesReader final
+{
+  public:
+    // reads one tree at offset into root and moves offset past it, false if the data is broken
+    bool read(const char *data, size_t size, size_t &offset, ATTRIBUTES &root);
+
+    // starts a new dictionary
+    void reset();
+
+  private:
+    struct Node
+    {
+        uint32_t nameCode;
+        bool hasValue;
+        std::string_view value;
+        uint32_t children;
+    };
+
+    struct Level
+    {
+        ATTRIBUTES *node;
+        uint32_t children;
+        // the node had children before, so the read ones are looked up among them
+        bool merge;
+    };
+
+    bool readNode(const char *data, size_t size, size_t &offset, VSTRING_CODEC &codec, Node &node);
+
+    // index in the dictionary -> name code of the string codec
+    std::vector<uint32_t> names_;
+    std::vector<Level> stack_;
+};
+
+void WriteVarint(uint32_t value, std::string &out);
+bool ReadVarint(const char *data, size_t size, size_t &offset, uint32_t &value);
+
+} // namespace storm
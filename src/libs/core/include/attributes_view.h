@@ -0,0 +1,61 @@
+#pragma once
+
+#include "attributes.h"
+
+#include <string>
+
+namespace storm
+{
+
+/**
+ * \brief Value of an attribute read in place
+ *
+ * The view looks at the string kept in the attribute instead of copying it. Before the attribute gets another value or
+ * goes away it hands the old one to the view, so the view always shows the value the attribute had when it was
+ * attached. Views of one attribute are linked into a list the attribute walks when its value changes.
+ */
+class AttributeValueView final
+{
+  public:
+    AttributeValueView() = default;
+    AttributeValueView(const AttributeValueView &other);
+    AttributeValueView(AttributeValueView &&other) noexcept;
+    AttributeValueView &operator=(const AttributeValueView &other);
+    AttributeValueView &operator=(AttributeValueView &&other) noexcept;
+    ~AttributeValueView();
+
+    // an attribute without a value is seen as an empty string
+    void attach(const ATTRIBUTES &attribute);
+    void reset() noexcept;
+
+    explicit operator bool() const noexcept
+    {
+        return value_ != nullptr;
+    }
+
+    [[nodiscard]] const std::string &get() const noexcept
+    {
+        return *value_;
+    }
+
+    // the attribute while it still holds the value, nullptr once the value was handed over
+    [[nodiscard]] const ATTRIBUTES *attribute() const noexcept
+    {
+        return attribute_;
+    }
+
+  private:
+    friend ATTRIBUTES;
+
+    void unlink() noexcept;
+    // the attribute is about to change, keep a copy of the value
+    void detach();
+
+    const ATTRIBUTES *attribute_ = nullptr;
+    const std::string *value_ = nullptr;
+    AttributeValueView *prev_ = nullptr;
+    AttributeValueView *next_ = nullptr;
+    std::string copy_;
+};
+
+} // namespace storm
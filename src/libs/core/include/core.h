@@ -7,6 +7,7 @@
 // common includes
 #include "controls.h"
 #include "engine_version.hpp"
+#include "entity_layer.h"
 #include "message.h"
 #include "os_window.hpp"
 #include "platform/platform.hpp"
@@ -124,6 +125,7 @@ class Core
     virtual entity_container_cref GetEntityIds(layer_type_t index) const = 0;
     virtual entity_container_cref GetEntityIds(layer_index_t index) const = 0;
     virtual entity_container_cref GetEntityIds(const char *name) const = 0;
+    virtual storm::LayerSnapshot GetLayerSnapshot(layer_index_t index) const = 0;
     virtual void SetLayerType(layer_index_t index, layer_type_t type) = 0;
     virtual void SetLayerFrozen(layer_index_t index, bool freeze) = 0;
     virtual void RemoveFromLayer(layer_index_t index, entid_t id) = 0;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "entity.h"
+
+namespace storm
+{
+
+class EntityLayer;
+
+/**
+ * \brief Members of an entity layer as they were when the snapshot was taken
+ *
+ * The ids never change while the snapshot is held, whatever is added to the layer or removed from it, so a snapshot
+ * kept over frames is iterated with no lookup and only taken again when the layer changed.
+ */
+class LayerSnapshot final
+{
+  public:
+    LayerSnapshot() = default;
+
+    [[nodiscard]] entity_container_cref ids() const;
+
+    [[nodiscard]] auto begin() const
+    {
+        return ids().begin();
+    }
+
+    [[nodiscard]] auto end() const
+    {
+        return ids().end();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return ids().size();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return ids().empty();
+    }
+
+    // the version of the layer the ids are of
+    [[nodiscard]] uint32_t version() const
+    {
+        return version_;
+    }
+
+    // if members of the layer were added or removed since the snapshot
+    [[nodiscard]] bool stale() const;
+
+    // takes the snapshot again when it is stale
+    void update();
+
+  private:
+    friend class EntityLayer;
+
+    std::shared_ptr<const std::vector<entid_t>> ids_;
+    const EntityLayer *layer_ = nullptr;
+    uint32_t version_ = 0;
+};
+
+/**
+ * \brief Entity ids of a layer in the order of priority
+ *
+ * The ids are copied on change only while a snapshot of them is held, and every change of the members moves the
+ * version on.
+ */
+class EntityLayer final
+{
+  public:
+    EntityLayer();
+
+    // after the members of the same priority
+    void insert(entid_t id, priority_t priority);
+    bool erase(entid_t id, priority_t priority);
+    void clear();
+
+    [[nodiscard]] entity_container_cref ids() const
+    {
+        return *ids_;
+    }
+
+    [[nodiscard]] uint32_t version() const
+    {
+        return version_;
+    }
+
+    [[nodiscard]] LayerSnapshot snapshot() const;
+
+  private:
+    // the ids to change, not shared with any snapshot
+    std::vector<entid_t> &modify();
+
+    std::vector<priority_t> priorities_;
+    std::shared_ptr<std::vector<entid_t>> ids_;
+    uint32_t version_ = 0;
+};
+
+inline bool LayerSnapshot::stale() const
+{
+    return layer_ != nullptr && layer_->version() != version_;
+}
+
+inline void LayerSnapshot::update()
+{
+    if (stale())
+        *this = layer_->snapshot();
+}
+
+} // namespace storm
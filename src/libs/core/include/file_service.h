@@ -3,6 +3,7 @@
 #include "ifs.h"
 #include "v_file_service.h"
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #define _MAX_OPEN_INI_FILES 1024
@@ -89,6 +90,8 @@ class FILE_SERVICE : public VFILE_SERVICE
     // Resource paths
     bool ResourcePathsFirstScan = true; // Since some code may call this statically, we use a flag to know if this is the first time
     std::unordered_map<std::string, std::string> ResourcePaths;
+    // paths are converted on the threads reading resources too
+    std::mutex ResourcePathsMutex;
 
   public:
     FILE_SERVICE();
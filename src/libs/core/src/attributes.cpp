@@ -1,16 +1,34 @@
 #include "attributes.h"
 
+#include "attributes_view.h"
 #include "string_compare.hpp"
 #include "platform/platform.hpp"
 
+#include <charconv>
+#include <new>
+
+#include <fast_float/fast_float.h>
+
+namespace
+{
+// values up to this length are kept in the node itself
+const size_t kInlineValue = std::string().capacity();
+
+// numbers already parsed from the value
+constexpr uint8_t kIntParsed = 1;
+constexpr uint8_t kFloatParsed = 2;
+} // namespace
+
 ATTRIBUTES::ATTRIBUTES(VSTRING_CODEC *p): ATTRIBUTES(*p)
 {
 }
 
 ATTRIBUTES::ATTRIBUTES(ATTRIBUTES &&other) noexcept
-    : stringCodec_(other.stringCodec_), nameCode_(other.stringCodec_.Convert("root")), value_(std::move(other.value_)),
-      attributes_(std::move(other.attributes_)), break_(other.break_)
+    : stringCodec_(other.stringCodec_), nameCode_(other.stringCodec_.Convert("root")), break_(other.break_)
 {
+    other.ValueChanged();
+    TakeChildren(other);
+    TakeValue(other);
 }
 
 ATTRIBUTES & ATTRIBUTES::operator=(ATTRIBUTES &&other) noexcept
@@ -18,8 +36,14 @@ ATTRIBUTES & ATTRIBUTES::operator=(ATTRIBUTES &&other) noexcept
     stringCodec_ = other.stringCodec_;
     // Do not update name code
     // nameCode_ = other.nameCode_;
-    value_ = std::move(other.value_);
-    attributes_ = std::move(other.attributes_);
+    ValueChanged();
+    other.ValueChanged();
+    if (this != &other)
+    {
+        ClearChildren();
+        TakeChildren(other);
+        TakeValue(other);
+    }
     // Do not update parent
     // parent_ = other.parent_;
     break_ = other.break_;
@@ -29,6 +53,18 @@ ATTRIBUTES & ATTRIBUTES::operator=(ATTRIBUTES &&other) noexcept
 ATTRIBUTES::~ATTRIBUTES()
 {
     Release();
+    ValueChanged();
+    if (ownsArena_ && arena_->canDrop())
+    {
+        // nothing in the tree needs its destructor, all of it goes with the arena
+        attributes_ = Children();
+        arena_->drop();
+        return;
+    }
+    ClearChildren();
+    attributes_ = Children();
+    if (ownsArena_)
+        arena_->release();
 }
 
 void ATTRIBUTES::SetBreak(bool set_break)
@@ -78,10 +114,10 @@ void ATTRIBUTES::SetValue(const char *new_value)
 {
     if (new_value == nullptr)
     {
-        value_.reset();
+        ResetValue();
     }
     else {
-        value_ = new_value;
+        StoreValue(new_value);
     }
 
     if (break_)
@@ -90,7 +126,7 @@ void ATTRIBUTES::SetValue(const char *new_value)
 
 void ATTRIBUTES::SetValue(const std::string_view &new_value)
 {
-    value_ = new_value;
+    StoreValue(new_value);
 
     if (break_)
         stringCodec_.VariableChanged();
@@ -103,15 +139,15 @@ size_t ATTRIBUTES::GetAttributesNum() const
 
 ATTRIBUTES * ATTRIBUTES::GetAttributeClass(const std::string_view &name) const
 {
-    for (const auto &attribute : attributes_)
+    for (auto *attribute : attributes_)
         if (storm::iEquals(name, attribute->GetThisName()))
-            return attribute.get();
+            return attribute;
     return nullptr;
 }
 
 ATTRIBUTES * ATTRIBUTES::GetAttributeClass(uint32_t n) const
 {
-    return n >= attributes_.size() ? nullptr : attributes_[n].get();
+    return n >= attributes_.size() ? nullptr : attributes_[n];
 }
 
 ATTRIBUTES *ATTRIBUTES::VerifyAttributeClass(const std::string_view &name)
@@ -145,13 +181,37 @@ ATTRIBUTES::LegacyProxy ATTRIBUTES::GetAttribute(size_t n) const
 
 ATTRIBUTES::LegacyProxy ATTRIBUTES::GetAttribute(const std::string_view &name) const
 {
-    for (const auto &attribute : attributes_)
+    for (const auto *attribute : attributes_)
         if (storm::iEquals(name, attribute->GetThisName())) {
             return attribute->value_;
         }
     return {};
 }
 
+int32_t ATTRIBUTES::GetValueAsInt() const
+{
+    if (!(parsed_ & kIntParsed))
+    {
+        intValue_ = 0;
+        if (value_)
+            std::from_chars(value_->data(), value_->data() + value_->size(), intValue_);
+        parsed_ |= kIntParsed;
+    }
+    return intValue_;
+}
+
+float ATTRIBUTES::GetValueAsFloat() const
+{
+    if (!(parsed_ & kFloatParsed))
+    {
+        floatValue_ = 0.0f;
+        if (value_)
+            fast_float::from_chars(value_->data(), value_->data() + value_->size(), floatValue_);
+        parsed_ |= kFloatParsed;
+    }
+    return floatValue_;
+}
+
 uint32_t ATTRIBUTES::GetAttributeAsDword(const char *name, uint32_t def) const
 {
     uint32_t vDword = def;
@@ -222,20 +282,19 @@ bool ATTRIBUTES::SetAttributeUseFloat(const char *name, float val)
 
 ATTRIBUTES & ATTRIBUTES::CreateAttribute(const std::string_view &name)
 {
-    const auto &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name));
-    return *attr;
+    return *AddChild(stringCodec_.Convert(name.data()));
 }
 
 ATTRIBUTES * ATTRIBUTES::CreateAttribute(const std::string_view &name, const char *attribute)
 {
-    const auto &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name));
+    auto *attr = AddChild(stringCodec_.Convert(name.data()));
 
     if (attribute)
     {
-        attr->value_ = attribute;
+        attr->StoreValue(attribute);
     }
 
-    return attr.get();
+    return attr;
 }
 
 size_t ATTRIBUTES::SetAttribute(const std::string_view &name, const char *attribute)
@@ -254,7 +313,7 @@ bool ATTRIBUTES::DeleteAttributeClassX(ATTRIBUTES *pA)
         return false;
     if (pA == this)
     {
-        attributes_.clear();
+        ClearChildren();
     }
     else
     {
@@ -265,12 +324,10 @@ bool ATTRIBUTES::DeleteAttributeClassX(ATTRIBUTES *pA)
         //            return removed_it != pAttributes.end();
         for (uint32_t n = 0; n < attributes_.size(); n++)
         {
-            if (attributes_[n].get() == pA)
+            if (attributes_[n] == pA)
             {
-                for (auto i = n; i < attributes_.size() - 1; i++)
-                    attributes_[i] = std::move(attributes_[i + 1]);
-
-                attributes_.pop_back();
+                DestroyChild(pA);
+                attributes_.erase(attributes_.begin() + n);
                 return true;
             }
             if (attributes_[n]->DeleteAttributeClassX(pA))
@@ -347,9 +404,9 @@ ATTRIBUTES * ATTRIBUTES::FindAClass(ATTRIBUTES *pRoot, const char *access_string
 
 ATTRIBUTES * ATTRIBUTES::GetAttributeClassByCode(uint32_t name_code) const
 {
-    for (const auto &attribute : attributes_)
+    for (auto *attribute : attributes_)
         if (name_code == attribute->nameCode_)
-            return attribute.get();
+            return attribute;
     return nullptr;
 }
 
@@ -363,14 +420,14 @@ ATTRIBUTES * ATTRIBUTES::VerifyAttributeClassByCode(uint32_t name_code)
 
 ATTRIBUTES * ATTRIBUTES::CreateAttribute(uint32_t name_code, const char *attribute)
 {
-    const auto &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name_code));
+    auto *attr = AddChild(name_code);
 
     if (attribute)
     {
-        attr->value_ = attribute;
+        attr->StoreValue(attribute);
     }
 
-    return attr.get();
+    return attr;
 }
 
 size_t ATTRIBUTES::SetAttribute(uint32_t name_code, const char *attribute)
@@ -382,24 +439,21 @@ size_t ATTRIBUTES::SetAttribute(uint32_t name_code, const char *attribute)
         {
             if (attribute)
             {
-                attributes_[n]->value_ = attribute;
+                attributes_[n]->StoreValue(attribute);
             }
             else
             {
-                attributes_[n]->value_.reset();
+                attributes_[n]->ResetValue();
             }
             return n;
         }
     }
 
-    auto &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name_code));
+    auto *attr = AddChild(name_code);
 
     if (attribute)
     {
-        attributes_[n]->value_ = attribute;
-    }
-    else {
-        attributes_[n]->value_.reset();
+        attr->StoreValue(attribute);
     }
 
     return attributes_.size() - 1;
@@ -412,14 +466,12 @@ size_t ATTRIBUTES::SetAttribute(uint32_t name_code, const std::string_view &attr
     {
         if (attributes_[n]->nameCode_ == name_code)
         {
-            attributes_[n]->value_ = attribute;
+            attributes_[n]->StoreValue(attribute);
             return n;
         }
     }
 
-    auto &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name_code));
-
-    attributes_[n]->value_ = attribute;
+    AddChild(name_code)->StoreValue(attribute);
 
     return attributes_.size() - 1;
 }
@@ -441,8 +493,111 @@ VSTRING_CODEC & ATTRIBUTES::GetStringCodec() const noexcept
 
 ATTRIBUTES * ATTRIBUTES::CreateNewAttribute(uint32_t name_code)
 {
-    const std::unique_ptr<ATTRIBUTES> &attr = attributes_.emplace_back(new ATTRIBUTES(stringCodec_, this, name_code));
-    return attr.get();
+    return AddChild(name_code);
+}
+
+storm::AttributesArena *ATTRIBUTES::ChildArena()
+{
+    // a root gets its arena with the first child
+    if (!arena_)
+    {
+        arena_ = new storm::AttributesArena();
+        arena_->addRef();
+        ownsArena_ = true;
+    }
+    if (attributes_.empty() && attributes_.get_allocator().arena() != arena_)
+        attributes_ = Children(storm::ArenaAllocator<ATTRIBUTES *>(arena_));
+    return arena_;
+}
+
+ATTRIBUTES *ATTRIBUTES::AddChild(uint32_t name_code)
+{
+    auto *arena = ChildArena();
+    auto *child = new (arena->allocate(sizeof(ATTRIBUTES))) ATTRIBUTES(stringCodec_, this, name_code);
+    child->arena_ = arena;
+    child->attributes_ = Children(storm::ArenaAllocator<ATTRIBUTES *>(arena));
+    attributes_.push_back(child);
+    return child;
+}
+
+void ATTRIBUTES::DestroyChild(ATTRIBUTES *child) noexcept
+{
+    auto *arena = child->arena_;
+    child->~ATTRIBUTES();
+    arena->deallocate(child, sizeof(ATTRIBUTES));
+}
+
+void ATTRIBUTES::ClearChildren() noexcept
+{
+    for (auto *attribute : attributes_)
+        DestroyChild(attribute);
+    attributes_.clear();
+}
+
+void ATTRIBUTES::TakeChildren(ATTRIBUTES &other) noexcept
+{
+    if (other.attributes_.empty())
+        return;
+
+    // the children stay where they are, this tree keeps their arena alive
+    auto *from = other.arena_;
+    auto *previous = static_cast<storm::AttributesArena *>(nullptr);
+    if (from != arena_)
+    {
+        if (other.ownsArena_)
+        {
+            other.arena_ = nullptr;
+            other.ownsArena_ = false;
+        }
+        else
+        {
+            from->addRef();
+            from->markShared();
+        }
+
+        if (ownsArena_ || !arena_)
+        {
+            previous = ownsArena_ ? arena_ : nullptr;
+            arena_ = from;
+            ownsArena_ = true;
+        }
+        else
+            arena_->adopt(from);
+    }
+
+    attributes_ = std::move(other.attributes_);
+    for (auto *attribute : attributes_)
+        attribute->parent_ = this;
+    if (previous)
+        previous->release();
+}
+
+void ATTRIBUTES::StoreValue(const std::string_view &value)
+{
+    ValueChanged();
+    value_ = value;
+    if (arena_ && value_->capacity() > kInlineValue)
+        arena_->noteHeapValue();
+}
+
+void ATTRIBUTES::TakeValue(ATTRIBUTES &other) noexcept
+{
+    value_ = std::move(other.value_);
+    if (arena_ && value_ && value_->capacity() > kInlineValue)
+        arena_->noteHeapValue();
+}
+
+void ATTRIBUTES::ResetValue()
+{
+    ValueChanged();
+    value_.reset();
+}
+
+void ATTRIBUTES::ValueChanged()
+{
+    while (views_)
+        views_->detach();
+    parsed_ = 0;
 }
 
 ATTRIBUTES::ATTRIBUTES(VSTRING_CODEC &p) : ATTRIBUTES(p, nullptr, "root")
@@ -463,11 +618,44 @@ ATTRIBUTES ATTRIBUTES::Copy() const
 {
     ATTRIBUTES result(stringCodec_, nullptr, nameCode_);
     result.value_ = value_;
+    if (attributes_.empty())
+        return result;
 
-    for (const auto &attribute : attributes_)
+    // the copy gets an arena with one block that holds all of it
+    size_t bytes = 0;
+    std::vector<const ATTRIBUTES *> nodes{this};
+    while (!nodes.empty())
     {
-        auto &new_child = result.CreateAttribute(attribute->GetThisName());
-        new_child = attribute->Copy();
+        const auto *node = nodes.back();
+        nodes.pop_back();
+        const auto children = node->attributes_.size();
+        if (children == 0)
+            continue;
+        bytes += children * storm::AttributesArena::roundUp(sizeof(ATTRIBUTES)) +
+                 storm::AttributesArena::roundUp(children * sizeof(ATTRIBUTES *));
+        nodes.insert(nodes.end(), node->attributes_.begin(), node->attributes_.end());
+    }
+    result.arena_ = new storm::AttributesArena(bytes);
+    result.arena_->addRef();
+    result.ownsArena_ = true;
+
+    // level by level without recursion, names keep their codes
+    std::vector<std::pair<const ATTRIBUTES *, ATTRIBUTES *>> stack{{this, &result}};
+    while (!stack.empty())
+    {
+        const auto [from, to] = stack.back();
+        stack.pop_back();
+        to->ChildArena();
+        to->attributes_.reserve(from->attributes_.size());
+        for (const auto *attribute : from->attributes_)
+        {
+            auto *copy = to->AddChild(attribute->nameCode_);
+            copy->value_ = attribute->value_;
+            if (copy->value_ && copy->value_->capacity() > kInlineValue)
+                result.arena_->noteHeapValue();
+            if (!attribute->attributes_.empty())
+                stack.emplace_back(attribute, copy);
+        }
     }
 
     return result;
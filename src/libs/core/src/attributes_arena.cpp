@@ -0,0 +1,90 @@
+#include "attributes_arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace storm
+{
+
+AttributesArena::AttributesArena(size_t reserve)
+{
+    if (reserve > 0)
+    {
+        current_ = static_cast<std::byte *>(allocateBlock(roundUp(reserve)));
+        end_ = current_ + roundUp(reserve);
+    }
+}
+
+AttributesArena::~AttributesArena()
+{
+    for (auto *p : large_)
+        ::operator delete(p);
+    for (auto *arena : adopted_)
+        arena->release();
+}
+
+size_t AttributesArena::roundUp(size_t size) noexcept
+{
+    return (std::max<size_t>(size, 1) + kGranularity - 1) & ~(kGranularity - 1);
+}
+
+void *AttributesArena::allocateBlock(size_t size)
+{
+    return blocks_.emplace_back(new std::byte[size]).get();
+}
+
+void *AttributesArena::allocate(size_t size)
+{
+    size = roundUp(size);
+    ++refs_;
+    if (size > kMaxSmall)
+    {
+        auto *p = ::operator new(size);
+        large_.insert(p);
+        return p;
+    }
+
+    // pieces of the same size freed before
+    auto &item = free_[size / kGranularity - 1];
+    if (item)
+    {
+        auto *p = item;
+        item = item->next;
+        return p;
+    }
+
+    if (static_cast<size_t>(end_ - current_) < size)
+    {
+        const auto blockSize = std::max(nextBlock_, size);
+        nextBlock_ = std::min(nextBlock_ * 2, kMaxBlock);
+        current_ = static_cast<std::byte *>(allocateBlock(blockSize));
+        end_ = current_ + blockSize;
+    }
+    auto *p = current_;
+    current_ += size;
+    return p;
+}
+
+void AttributesArena::deallocate(void *p, size_t size) noexcept
+{
+    size = roundUp(size);
+    if (size > kMaxSmall)
+    {
+        large_.erase(p);
+        ::operator delete(p);
+    }
+    else
+    {
+        auto &item = free_[size / kGranularity - 1];
+        item = new (p) FreeItem{item};
+    }
+    release();
+}
+
+void AttributesArena::adopt(AttributesArena *other)
+{
+    adopted_.push_back(other);
+    shared_ = true;
+}
+
+} // namespace storm
@@ -0,0 +1,203 @@
+#include "attributes_serializer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace storm
+{
+
+namespace
+{
+
+// the string codec converts names through a buffer of this size
+constexpr uint32_t kMaxNameLength = 1023;
+
+bool ReadBytes(const char *data, size_t size, size_t &offset, uint32_t length, std::string_view &bytes)
+{
+    if (length > size - offset)
+        return false;
+    bytes = std::string_view(data + offset, length);
+    offset += length;
+    return true;
+}
+
+} // namespace
+
+void WriteVarint(uint32_t value, std::string &out)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(const char *data, size_t size, size_t &offset, uint32_t &value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        if (offset >= size)
+            return false;
+        const auto byte = static_cast<uint8_t>(data[offset++]);
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+AttributesWriter::AttributesWriter()
+{
+    reset();
+}
+
+void AttributesWriter::write(const ATTRIBUTES *root, std::string &out)
+{
+    WriteVarint(root ? 1 : 0, out);
+    if (!root)
+        return;
+
+    // depth first without recursion, the stack holds the children left on each level
+    stack_.clear();
+    const ATTRIBUTES *node = root;
+    for (;;)
+    {
+        writeName(*node, out);
+        if (node->value_)
+        {
+            const auto &value = *node->value_;
+            WriteVarint(static_cast<uint32_t>(value.size()) + 1, out);
+            out.append(value);
+        }
+        else
+            WriteVarint(0, out);
+        const auto &children = node->attributes_;
+        WriteVarint(static_cast<uint32_t>(children.size()), out);
+        if (!children.empty())
+            stack_.emplace_back(children.data(), children.data() + children.size());
+
+        while (!stack_.empty() && stack_.back().first == stack_.back().second)
+            stack_.pop_back();
+        if (stack_.empty())
+            break;
+        node = *(stack_.back().first++);
+    }
+}
+
+void AttributesWriter::writeName(const ATTRIBUTES &node, std::string &out)
+{
+    // a tree has few distinct names, most of them are found in the small table
+    const auto code = node.GetThisNameCode();
+    auto &recent = recent_[(code ^ (code >> 16)) % recent_.size()];
+    if (recent.second != kNoIndex && recent.first == code)
+    {
+        WriteVarint(recent.second, out);
+        return;
+    }
+    if (const auto it = names_.find(code); it != names_.end())
+    {
+        recent = *it;
+        WriteVarint(it->second, out);
+        return;
+    }
+    const auto index = static_cast<uint32_t>(names_.size());
+    names_.emplace(code, index);
+    recent = {code, index};
+    WriteVarint(index, out);
+
+    // the first use of a name is followed by its text
+    const auto *name = node.GetStringCodec().Convert(code);
+    const auto length = static_cast<uint32_t>(std::min<size_t>(strlen(name), kMaxNameLength));
+    WriteVarint(length, out);
+    out.append(name, length);
+}
+
+void AttributesWriter::reset()
+{
+    names_.clear();
+    recent_.fill({0, kNoIndex});
+}
+
+bool AttributesReader::readNode(const char *data, size_t size, size_t &offset, VSTRING_CODEC &codec, Node &node)
+{
+    uint32_t index;
+    if (!ReadVarint(data, size, offset, index) || index > names_.size())
+        return false;
+    if (index == names_.size())
+    {
+        uint32_t length;
+        std::string_view name;
+        if (!ReadVarint(data, size, offset, length) || length > kMaxNameLength ||
+            !ReadBytes(data, size, offset, length, name))
+            return false;
+        names_.push_back(codec.Convert(name.data(), static_cast<int32_t>(name.size())));
+    }
+    node.nameCode = names_[index];
+
+    uint32_t value;
+    if (!ReadVarint(data, size, offset, value))
+        return false;
+    node.hasValue = value > 0;
+    node.value = {};
+    if (node.hasValue && !ReadBytes(data, size, offset, value - 1, node.value))
+        return false;
+
+    return ReadVarint(data, size, offset, node.children);
+}
+
+bool AttributesReader::read(const char *data, size_t size, size_t &offset, ATTRIBUTES &root)
+{
+    uint32_t present;
+    if (!ReadVarint(data, size, offset, present) || present > 1)
+        return false;
+    if (!present)
+        return true;
+
+    auto &codec = root.GetStringCodec();
+    Node node;
+    if (!readNode(data, size, offset, codec, node))
+        return false;
+    root.nameCode_ = node.nameCode;
+    if (node.hasValue)
+        root.SetValue(node.value);
+    else
+        root.ResetValue();
+
+    stack_.clear();
+    if (node.children > 0)
+        stack_.push_back({&root, node.children, !root.attributes_.empty()});
+    while (!stack_.empty())
+    {
+        auto &level = stack_.back();
+        if (level.children == 0)
+        {
+            stack_.pop_back();
+            continue;
+        }
+        level.children--;
+
+        if (!readNode(data, size, offset, codec, node))
+            return false;
+        auto *parent = level.node;
+        ATTRIBUTES *child = level.merge ? parent->GetAttributeClassByCode(node.nameCode) : nullptr;
+        if (!child)
+            child = parent->AddChild(node.nameCode);
+        if (node.hasValue)
+            child->StoreValue(node.value);
+        else
+            child->ResetValue();
+
+        if (node.children > 0)
+            stack_.push_back({child, node.children, !child->attributes_.empty()});
+    }
+    return true;
+}
+
+void AttributesReader::reset()
+{
+    names_.clear();
+}
+
+} // namespace storm
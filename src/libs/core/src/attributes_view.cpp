@@ -0,0 +1,107 @@
+#include "attributes_view.h"
+
+namespace storm
+{
+
+AttributeValueView::AttributeValueView(const AttributeValueView &other)
+{
+    *this = other;
+}
+
+AttributeValueView::AttributeValueView(AttributeValueView &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+AttributeValueView &AttributeValueView::operator=(const AttributeValueView &other)
+{
+    if (this == &other)
+        return *this;
+    if (other.attribute_)
+        attach(*other.attribute_);
+    else if (other.value_)
+    {
+        reset();
+        copy_ = other.copy_;
+        value_ = &copy_;
+    }
+    else
+        reset();
+    return *this;
+}
+
+AttributeValueView &AttributeValueView::operator=(AttributeValueView &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+    if (other.attribute_)
+        attach(*other.attribute_);
+    else if (other.value_)
+    {
+        reset();
+        copy_ = std::move(other.copy_);
+        value_ = &copy_;
+    }
+    else
+        reset();
+    other.reset();
+    return *this;
+}
+
+AttributeValueView::~AttributeValueView()
+{
+    unlink();
+}
+
+void AttributeValueView::attach(const ATTRIBUTES &attribute)
+{
+    reset();
+    if (!attribute.value_)
+    {
+        value_ = &copy_;
+        return;
+    }
+
+    attribute_ = &attribute;
+    value_ = &*attribute.value_;
+    next_ = attribute.views_;
+    if (next_)
+        next_->prev_ = this;
+    attribute.views_ = this;
+    // nodes of a tree are freed without their destructors only when nothing looks at them
+    if (attribute.parent_ && attribute.arena_)
+        attribute.arena_->addView();
+}
+
+void AttributeValueView::reset() noexcept
+{
+    unlink();
+    value_ = nullptr;
+    copy_.clear();
+}
+
+void AttributeValueView::unlink() noexcept
+{
+    if (!attribute_)
+        return;
+    if (prev_)
+        prev_->next_ = next_;
+    else
+        attribute_->views_ = next_;
+    if (next_)
+        next_->prev_ = prev_;
+    if (attribute_->parent_ && attribute_->arena_)
+        attribute_->arena_->removeView();
+    attribute_ = nullptr;
+    prev_ = nullptr;
+    next_ = nullptr;
+}
+
+void AttributeValueView::detach()
+{
+    copy_ = *value_;
+    value_ = &copy_;
+    unlink();
+}
+
+} // namespace storm
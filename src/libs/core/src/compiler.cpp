@@ -1,5 +1,6 @@
 #include "compiler.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 
@@ -26,6 +27,8 @@
 #define INVALID_ARRAY_INDEX 0xffffffff
 #endif
 #define INVALID_OFFSET 0xffffffff
+// stands for the SCodec strings count in saves with binary attributes
+#define BINARY_ATTRIBUTES_MARK 0xffffffff
 #define DSL_INI_VALUE 0
 #define SBUPDATE 4
 #define DEF_COMPILE_EXPRESSIONS
@@ -53,6 +56,7 @@ auto GetCacheFolder()
     return cache_folder;
 }
 constexpr auto kCacheStateFile = "state";
+constexpr uint32_t kSegmentEvictionPeriod = 1000; // ms between looks for idle segments
 
 bool ReadCacheFingerprint(uint64_t &fingerprint)
 {
@@ -103,12 +107,13 @@ using std::chrono::system_clock;
 
 COMPILER::COMPILER()
     : bBreakOnError(false), pRunCodeBase(nullptr), CompilerStage(CS_SYSTEM), pEventMessage(nullptr), SegmentsNum(0),
-      InstructionPointer(0), pBuffer(nullptr), ProgramDirectory(nullptr), bCompleted(false), bEntityUpdate(true),
+      nScriptTime(0), nSegmentIdleTime(0), nEvictionCheckTime(0), InstructionPointer(0), pBuffer(nullptr),
+      bBinaryAttributes(false), ProgramDirectory(nullptr), bCompleted(false), bEntityUpdate(true),
       pDebExpBuffer(nullptr), nDebExpBufferSize(0), pRun_fi(nullptr), bRuntimeLog(false),
-      nRuntimeLogEventsBufferSize(0), nRuntimeLogEventsNum(0), nRuntimeTicks(0), bFirstRun(true), bWriteCodeFile(false),
-      bDebugInfo(false), DebugSourceLine(0), pCompileTokenTempBuffer(nullptr), bDebugExpressionRun(false),
-      bTraceMode(true), nDebugTraceLineCode(0), nIOBufferSize(0), pIOBuffer(nullptr), rAP(nullptr),
-      script_cache_mode_(kCacheDisabled)
+      nRuntimeLogEventsBufferSize(0), nRuntimeLogEventsNum(0), nRuntimeTicks(0), bFirstRun(true),
+      bWriteCodeFile(false), bDebugInfo(false), DebugSourceLine(0), pCompileTokenTempBuffer(nullptr),
+      bDebugExpressionRun(false), bTraceMode(true), nDebugTraceLineCode(0),
+      nIOBufferSize(0), pIOBuffer(nullptr), rAP(nullptr), script_cache_mode_(kCacheDisabled)
 
 {
     LabelTable.SetStringDataSize(sizeof(uint32_t));
@@ -161,6 +166,7 @@ void COMPILER::Release()
     }
     SegmentTable.clear();
     SegmentsNum = 0;
+    EvictedSegments.clear();
     LabelTable.Release();
     LabelUpdateTable.Release();
     Token.Reset();
@@ -460,6 +466,7 @@ void COMPILER::LoadPreprocess()
             bRuntimeLog = true;
 
         script_cache_mode_ = engine_ini->GetInt("script", "cache_mode", kCacheDisabled);
+        nSegmentIdleTime = engine_ini->GetInt("script", "segment_idle_time", 0);
         if (script_cache_mode_ < kCacheDisabled || script_cache_mode_ > kCacheEnabledNoRuntimeCheck)
         {
             script_cache_mode_ = kCacheDisabled;
@@ -627,7 +634,7 @@ void COMPILER::SetEventHandler(const char *event_name, const char *func_name, in
         return;
     }
 
-    if (!FuncTab.GetFunc(fi, func_code))
+    if (!GetScriptFunc(fi, func_code))
     {
         SetError("func not found eror");
         return;
@@ -782,7 +789,7 @@ VDATA *COMPILER::ProcessEvent(const char *event_name)
     RDTSC_E(dwRDTSC);
 
     // VANO CHANGES - remove in release
-    if (core_internal.Controls->GetDebugAsyncKeyState('5') < 0 &&
+    if (core_internal.Controls && core_internal.Controls->GetDebugAsyncKeyState('5') < 0 &&
         core_internal.Controls->GetDebugAsyncKeyState(VK_SHIFT) < 0)
     {
         core_internal.Trace("evnt: %d, %s", dwRDTSC, event_name);
@@ -816,12 +823,112 @@ uint32_t COMPILER::GetSegmentIndex(uint32_t segment_id)
     return INVALID_SEGMENT_INDEX;
 }
 
+uint32_t COMPILER::GetResidentSegmentsSize() const
+{
+    uint32_t size = 0;
+    for (uint32_t n = 0; n < SegmentsNum; n++)
+    {
+        if (!SegmentTable[n].bUnload)
+            size += SegmentTable[n].BCode_Buffer_size;
+    }
+    return size;
+}
+
+// segments unused for nSegmentIdleTime are unloaded, but only those whose unloading can't be seen by scripts:
+// a global variable would lose its value, so segments with them stay. Event handlers stay set on an evicted segment,
+// the first event it handles loads it back under its old id
+void COMPILER::EvictIdleSegments()
+{
+    if (pRun_fi != nullptr)
+        return;
+
+    // the first segment is the program itself
+    for (uint32_t n = 1; n < SegmentsNum; n++)
+    {
+        auto &segment = SegmentTable[n];
+        if (segment.bUnload || nScriptTime - segment.last_use < nSegmentIdleTime)
+            continue;
+        if (VarTab.HasSegmentID(segment.id))
+        {
+            segment.last_use = nScriptTime;
+            continue;
+        }
+
+        EVICTED_SEGMENT evicted;
+        evicted.name = segment.name;
+        evicted.id = segment.id;
+        FuncInfo fi;
+        for (uint32_t func_code = 0; func_code < FuncTab.GetFuncNum(); func_code++)
+        {
+            if (FuncTab.GetFuncX(fi, func_code) && fi.segment_id == segment.id)
+                evicted.functions.push_back(func_code);
+        }
+        FuncTab.InvalidateBySegmentID(segment.id);
+        if (segment.Files_list)
+        {
+            segment.Files_list->Release();
+        }
+        segment.bUnload = true;
+        EvictedSegments.push_back(std::move(evicted));
+
+        core_internal.Trace("Segment %s evicted, %u bytes of script code resident", segment.name.c_str(),
+                            GetResidentSegmentsSize());
+    }
+}
+
+bool COMPILER::LoadEvictedSegment(uint32_t func_code)
+{
+    for (const auto &segment : EvictedSegments)
+    {
+        if (std::find(segment.functions.begin(), segment.functions.end(), func_code) == segment.functions.end())
+            continue;
+
+        const std::string name = segment.name;
+        const COMPILER_STAGE stage = CompilerStage;
+        const bool bRes = BC_LoadSegment(name.c_str());
+        CompilerStage = stage;
+        core_internal.Trace("Segment %s loaded on call, %u bytes of script code resident", name.c_str(),
+                            GetResidentSegmentsSize());
+        return bRes;
+    }
+    return false;
+}
+
+// get func info, a function of an evicted segment loads it back
+bool COMPILER::GetScriptFunc(FuncInfo &fi, uint32_t func_code)
+{
+    return FuncTab.GetFunc(fi, func_code) || (LoadEvictedSegment(func_code) && FuncTab.GetFunc(fi, func_code));
+}
+
+void COMPILER::SetSegmentIdleTime(uint32_t idle_time)
+{
+    nSegmentIdleTime = idle_time;
+}
+
+// drop the record of an evicted segment together with the defines it left behind
+bool COMPILER::ForgetEvictedSegment(const char *segment_name)
+{
+    for (auto it = EvictedSegments.begin(); it != EvictedSegments.end(); ++it)
+    {
+        if (it->name == segment_name)
+        {
+            DefTab.InvalidateBySegmentID(it->id);
+            EvictedSegments.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
 // function release global variables, functions and labels reference for segment
 // mark segment for subsequent unload (on ProcessFrame)
 void COMPILER::UnloadSegment(const char *segment_name)
 {
     //    OFFSET_INFO offset_info;
 
+    if (ForgetEvictedSegment(segment_name))
+        return;
+
     for (uint32_t n = 0; n < SegmentsNum; n++)
     {
         if (strcmp(SegmentTable[n].name.c_str(), segment_name) == 0)
@@ -853,6 +960,12 @@ bool COMPILER::BC_SegmentIsLoaded(const char *file_name)
         if (strcmp(SegmentTable[n].name.c_str(), file_name) == 0)
             return true;
     }
+    // evicted segments are still loaded for scripts, they come back on the first call
+    for (const auto &segment : EvictedSegments)
+    {
+        if (segment.name == file_name)
+            return true;
+    }
     return false;
 }
 
@@ -879,10 +992,20 @@ bool COMPILER::BC_LoadSegment(const char *file_name)
             return true;
         }
     }
-
-    // compute new segment id --------------------------
+    // an evicted segment comes back under its id, the event handlers left on it name the segment by it
     uint32_t id = 0;
     bool found = false;
+    for (const auto &segment : EvictedSegments)
+    {
+        if (segment.name == file_name)
+        {
+            id = segment.id;
+            found = true;
+        }
+    }
+    ForgetEvictedSegment(file_name);
+
+    // compute new segment id --------------------------
     while (!found)
     {
         found = true;
@@ -891,6 +1014,11 @@ bool COMPILER::BC_LoadSegment(const char *file_name)
             if (SegmentTable[n].id == id)
                 found = false;
         }
+        for (const auto &segment : EvictedSegments)
+        {
+            if (segment.id == id)
+                found = false;
+        }
         if (!found)
             id++;
     }
@@ -906,6 +1034,7 @@ bool COMPILER::BC_LoadSegment(const char *file_name)
     SegmentTable[index].name = strdup(file_name);
     SegmentTable[index].id = id;
     SegmentTable[index].bUnload = false;
+    SegmentTable[index].last_use = nScriptTime;
     SegmentTable[index].pData = nullptr;
     SegmentTable[index].pCode = nullptr;
     SegmentTable[index].BCode_Program_size = 0;
@@ -1093,6 +1222,14 @@ void COMPILER::ProcessFrame(uint32_t DeltaTime)
     if (core_internal.Timer.Ring)
         AddRuntimeEvent();
 
+    nScriptTime += DeltaTime;
+    // the look walks the variable and event tables for every idle segment, so it isn't done each frame
+    if (nSegmentIdleTime != 0 && nScriptTime - nEvictionCheckTime >= kSegmentEvictionPeriod)
+    {
+        nEvictionCheckTime = nScriptTime;
+        EvictIdleSegments();
+    }
+
     for (uint32_t n = 0; n < SegmentsNum; n++)
     {
         if (!SegmentTable[n].bUnload)
@@ -3658,8 +3795,7 @@ bool COMPILER::BC_CallFunction(uint32_t func_code, uint32_t &ip, DATA *&pVResult
 
     CompilerStage = CS_RUNTIME;
 
-    // get func info
-    if (!FuncTab.GetFunc(call_fi, func_code))
+    if (!GetScriptFunc(call_fi, func_code))
     {
         SetError("Invalid function call");
         return false;
@@ -3885,7 +4021,7 @@ bool COMPILER::BC_Execute(uint32_t function_code, DATA *&pVReturnResult, const c
 
     if (pDbgExpSource == nullptr)
     {
-        if (!FuncTab.GetFunc(fi, function_code))
+        if (!GetScriptFunc(fi, function_code))
         {
             SetError("Invalid function: %s", fi.name.c_str());
             return false;
@@ -3920,6 +4056,7 @@ bool COMPILER::BC_Execute(uint32_t function_code, DATA *&pVReturnResult, const c
             SetError("Segment (%s) not loaded", SegmentTable[segment_index].name.c_str());
             return false;
         }
+        SegmentTable[segment_index].last_use = nScriptTime;
 
         // Trace("-----------------------------------------------------------------");
         // Trace("Execute function: %s",fi.name);
@@ -5501,7 +5638,7 @@ bool COMPILER::BC_Execute(uint32_t function_code, DATA *&pVReturnResult, const c
                     pV->Set("error");
                     break; /*return false;*/
                 }
-                pV->Set(to_string(rAP->GetThisAttr()));
+                pV->SetValueOf(*rAP);
                 break;
             default:
                 SetError("invalid argument for STACK_PUSH");
@@ -6342,7 +6479,8 @@ bool COMPILER::ReadVariable(char *name, /* DWORD code,*/ bool bDim, uint32_t a_i
                 {
                     ReadData(nullptr, sizeof(uint64_t));
                     ATTRIBUTES TA(&SCodec);
-                    ReadAttributesData(&TA, nullptr);
+                    if (!LoadAttributesData(&TA))
+                        return false;
                 }
                 else
                     Assert(false);
@@ -6392,13 +6530,14 @@ bool COMPILER::ReadVariable(char *name, /* DWORD code,*/ bool bDim, uint32_t a_i
 
             if (pV->AttributesClass == nullptr)
                 pV->AttributesClass = new ATTRIBUTES(&SCodec);
-            ReadAttributesData(pV->AttributesClass, nullptr);
+            if (!LoadAttributesData(pV->AttributesClass))
+                return false;
         }
         else
         {
-            ATTRIBUTES *pTA = new ATTRIBUTES(&SCodec);
-            ReadAttributesData(pTA, nullptr);
-            delete pTA;
+            ATTRIBUTES TA(&SCodec);
+            if (!LoadAttributesData(&TA))
+                return false;
         }
         break;
     case VAR_REFERENCE:
@@ -6629,15 +6768,9 @@ bool COMPILER::SaveState(std::fstream &fileS)
     // 1. Program Directory
     SaveString(ProgramDirectory);
 
-    // 4. SCodec data
-    WriteVDword(SCodec.GetNum());
-    for (n = 0; n < SCodec.GetNum(); n++)
-    {
-        if (n == 0)
-            SaveString(SCodec.Get());
-        else
-            SaveString(SCodec.GetNext());
-    }
+    // 4. SCodec data, attribute names are now saved with the attributes
+    WriteVDword(BINARY_ATTRIBUTES_MARK);
+    AttributesWriter.reset();
 
     const uint32_t nSegNum = 1; // SegmentsNum;
     // 2. Data Segments
@@ -6739,7 +6872,9 @@ bool COMPILER::LoadState(std::fstream &fileS)
 
     // 4. SCodec data
     const uint32_t nSCStringsNum = ReadVDword();
-    for (n = 0; n < nSCStringsNum; n++)
+    bBinaryAttributes = nSCStringsNum == BINARY_ATTRIBUTES_MARK;
+    AttributesReader.reset();
+    for (n = 0; !bBinaryAttributes && n < nSCStringsNum; n++)
     {
         pString = ReadString();
         if (pString)
@@ -6789,6 +6924,25 @@ bool COMPILER::LoadState(std::fstream &fileS)
     return true;
 }
 
+bool COMPILER::LoadAttributesData(ATTRIBUTES *pRoot)
+{
+    if (!bBinaryAttributes)
+    {
+        ReadAttributesData(pRoot, nullptr);
+        return true;
+    }
+
+    size_t offset = dwCurPointer;
+    if (!AttributesReader.read(pBuffer, dwMaxSize, offset, *pRoot))
+    {
+        SetError("Load - broken attributes data");
+        return false;
+    }
+    dwCurPointer = static_cast<uint32_t>(offset);
+    return true;
+}
+
+// attributes of saves made before the binary format
 void COMPILER::ReadAttributesData(ATTRIBUTES *pRoot, ATTRIBUTES *pParent)
 {
     uint32_t nSubClassesNum;
@@ -6835,25 +6989,9 @@ void COMPILER::ReadAttributesData(ATTRIBUTES *pRoot, ATTRIBUTES *pParent)
 
 void COMPILER::SaveAttributesData(ATTRIBUTES *pRoot)
 {
-    if (pRoot == nullptr)
-    {
-        WriteVDword(0);      // number of subclasses
-        SaveString(nullptr); // attribute name
-        SaveString(nullptr); // attribute value
-        return;
-    }
-    WriteVDword(pRoot->GetAttributesNum()); // number of subclasses
-
-    // save attribute name
-    // SaveString(pRoot->GetThisName());
-    WriteVDword(pRoot->GetThisNameCode());
-
-    // save attribute value
-    SaveString(pRoot->GetThisAttr());
-    for (uint32_t n = 0; n < pRoot->GetAttributesNum(); n++)
-    {
-        SaveAttributesData(pRoot->GetAttributeClass(n));
-    }
+    AttributesBuffer.clear();
+    AttributesWriter.write(pRoot, AttributesBuffer);
+    SaveData(AttributesBuffer.data(), static_cast<uint32_t>(AttributesBuffer.size()));
 }
 
 void COMPILER::AddPostEvent(S_EVENTMSG *pEM)
@@ -3,6 +3,7 @@
 #include <string_view>
 #include <tuple>
 
+#include "attributes_serializer.h"
 #include "data.h"
 #include "message.h"
 #include "s_deftab.h"
@@ -33,6 +34,7 @@ struct SEGMENT_DESC
     uint32_t id;
     uint32_t lines;
     bool bUnload;
+    uint32_t last_use; // script time of the last call into the segment
     //--------------
     char *pData;
     char *pCode;
@@ -48,6 +50,14 @@ struct OFFSET_INFO
     uint32_t segment_id;
 };
 
+// segment unloaded while idle, it is loaded again on the first call into one of its functions
+struct EVICTED_SEGMENT
+{
+    std::string name;
+    uint32_t id; // kept from reuse, the defines of the segment stay registered under it
+    std::vector<uint32_t> functions;
+};
+
 struct EXTDATA_HEADER
 {
     char sFileInfo[32];
@@ -120,6 +130,12 @@ class COMPILER : public VIRTUAL_COMPILER
 
     void UnloadSegment(const char *segment_name);
     uint32_t GetSegmentIndex(uint32_t segment_id);
+    void EvictIdleSegments();
+    bool LoadEvictedSegment(uint32_t func_code);
+    bool GetScriptFunc(FuncInfo &fi, uint32_t func_code);
+    bool ForgetEvictedSegment(const char *segment_name);
+    uint32_t GetResidentSegmentsSize() const;
+    void SetSegmentIdleTime(uint32_t idle_time);
 
     void ProcessFrame(uint32_t DeltaTime);
     bool Run();
@@ -224,6 +240,7 @@ class COMPILER : public VIRTUAL_COMPILER
     bool FindReferencedVariableByRootA(ATTRIBUTES *pA, uint32_t &var_index, uint32_t &array_index);
     ATTRIBUTES *TraceARoot(ATTRIBUTES *pA, const char *&pAccess);
     void SaveAttributesData(ATTRIBUTES *pRoot);
+    bool LoadAttributesData(ATTRIBUTES *pRoot);
     void ReadAttributesData(ATTRIBUTES *pRoot, ATTRIBUTES *pParent);
     void WriteVDword(uint32_t v);
     uint32_t ReadVDword();
@@ -296,12 +313,22 @@ private:
     MESSAGE *pEventMessage;
     std::vector<SEGMENT_DESC> SegmentTable;
     uint32_t SegmentsNum;
+    std::vector<EVICTED_SEGMENT> EvictedSegments;
+    uint32_t nScriptTime;        // ms of frames processed
+    uint32_t nSegmentIdleTime;   // ms a segment may stay unused before it is evicted, 0 keeps all segments
+    uint32_t nEvictionCheckTime; // script time of the last look for idle segments
     uint32_t RunningSegmentID;
     uint32_t InstructionPointer;
 
     char *pBuffer;
     uint32_t dwCurPointer, dwMaxSize;
 
+    // attribute trees of saves share one name dictionary, older saves use the codes of SCodec
+    storm::AttributesWriter AttributesWriter;
+    storm::AttributesReader AttributesReader;
+    std::string AttributesBuffer;
+    bool bBinaryAttributes;
+
     char *ProgramDirectory;
     bool bCompleted;
     bool bEntityUpdate;
@@ -992,6 +992,11 @@ entity_container_cref CoreImpl::GetEntityIds(const char *name) const
     return entity_manager_.GetEntityIds(name);
 }
 
+storm::LayerSnapshot CoreImpl::GetLayerSnapshot(layer_index_t index) const
+{
+    return entity_manager_.GetLayerSnapshot(index);
+}
+
 void CoreImpl::SetLayerType(layer_index_t index, layer_type_t type)
 {
     entity_manager_.SetLayerType(index, type);
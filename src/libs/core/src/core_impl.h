@@ -126,6 +126,7 @@ class CoreImpl final : public CorePrivate
     entity_container_cref GetEntityIds(layer_type_t type) const override;
     entity_container_cref GetEntityIds(layer_index_t index) const override;
     entity_container_cref GetEntityIds(const char *name) const override;
+    storm::LayerSnapshot GetLayerSnapshot(layer_index_t index) const override;
     void SetLayerType(layer_index_t index, layer_type_t type) override;
     void SetLayerFrozen(layer_index_t index, bool freeze) override;
     void RemoveFromLayer(layer_index_t index, entid_t id) override;
@@ -49,6 +49,7 @@ DATA::DATA(DATA &&data) noexcept(false)
     lValue = data.lValue;
     fValue = data.fValue;
     sValue = std::move(data.sValue);
+    sView = std::move(data.sView);
     bArray = data.bArray;
     bEntity = data.bEntity;
     pVCompiler = data.pVCompiler;
@@ -74,6 +75,7 @@ DATA & DATA::operator=(const DATA &data)
     lValue = data.lValue;
     fValue = data.fValue;
     sValue = data.sValue;
+    sView = data.sView;
     bArray = data.bArray;
     bEntity = data.bEntity;
     pVCompiler = data.pVCompiler;
@@ -342,6 +344,7 @@ void DATA::Set(std::string value)
     }
     Data_type = VAR_STRING;
 
+    sView.reset();
     sValue = std::move(value);
 }
 
@@ -365,6 +368,7 @@ void DATA::Set(const char *value)
     }
     Data_type = VAR_STRING;
 
+    sView.reset();
     if (value != nullptr)
     {
         sValue = value;
@@ -375,6 +379,38 @@ void DATA::Set(const char *value)
     }
 }
 
+void DATA::SetValueOf(const ATTRIBUTES &attribute)
+{
+    if (Data_type == VAR_REFERENCE)
+    {
+        if (pReference)
+        {
+            pReference->SetValueOf(attribute);
+            return;
+        }
+        Error(UNINIT_REF);
+        return;
+    }
+    if (bArray)
+    {
+        Error(NO_INDEX);
+        return;
+    }
+    Data_type = VAR_STRING;
+
+    sValue.clear();
+    sView.attach(attribute);
+}
+
+void DATA::OwnString()
+{
+    if (sView)
+    {
+        sValue = sView.get();
+        sView.reset();
+    }
+}
+
 void DATA::Set(const char *attribute_name, const char *attribute_value)
 {
     // if(bRef)
@@ -557,6 +593,7 @@ bool DATA::Get(const char *&value)
     }
     if (Data_type == VAR_STRING)
     {
+        OwnString();
         value = sValue.c_str();
         return true;
     }
@@ -980,6 +1017,7 @@ void DATA::ClearType()
     Data_type = UNKNOWN;
     pReference = nullptr;
     sValue.clear();
+    sView.reset();
 }
 
 void DATA::SetType(S_TOKEN_TYPE _element_type, uint32_t array_size)
@@ -1089,13 +1127,20 @@ bool DATA::Convert(S_TOKEN_TYPE type)
         case VAR_INTEGER:
             Data_type = VAR_INTEGER;
             lValue = 0;
-            std::from_chars(sValue.data(), sValue.data() + sValue.length(), lValue);
+            // a string still read from an attribute was parsed there before
+            if (const auto *attribute = sView.attribute())
+                lValue = attribute->GetValueAsInt();
+            else
+                std::from_chars(String().data(), String().data() + String().length(), lValue);
             return true;
         case FLOAT_NUMBER:
         case VAR_FLOAT:
             Data_type = VAR_FLOAT;
             fValue = 0.0f;
-            fast_float::from_chars(sValue.data(), sValue.data() + sValue.length(), fValue);
+            if (const auto *attribute = sView.attribute())
+                fValue = attribute->GetValueAsFloat();
+            else
+                fast_float::from_chars(String().data(), String().data() + String().length(), fValue);
             return true;
         case STRING:
         case VAR_STRING:
@@ -1122,34 +1167,30 @@ bool DATA::Convert(S_TOKEN_TYPE type)
         case VAR_STRING:
             if (!AttributesClass)
                 break;
-            if (!AttributesClass->GetThisAttr())
+            if (!AttributesClass->HasValue())
                 break;
-            Set(to_string(AttributesClass->GetThisAttr()));
+            SetValueOf(*AttributesClass);
             AttributesClass = nullptr;
             return true;
         case NUMBER:
         case VAR_INTEGER:
             if (!AttributesClass)
                 break;
-            if (!AttributesClass->GetThisAttr())
+            if (!AttributesClass->HasValue())
                 break;
-            Set(to_string(AttributesClass->GetThisAttr()));
+            lValue = AttributesClass->GetValueAsInt();
             AttributesClass = nullptr;
             Data_type = VAR_INTEGER;
-            lValue = 0;
-            std::from_chars(sValue.data(), sValue.data() + sValue.length(), lValue);
             return true;
         case FLOAT_NUMBER:
         case VAR_FLOAT:
             if (!AttributesClass)
                 break;
-            if (!AttributesClass->GetThisAttr())
+            if (!AttributesClass->HasValue())
                 break;
-            Set(to_string(AttributesClass->GetThisAttr()));
+            fValue = AttributesClass->GetValueAsFloat();
             AttributesClass = nullptr;
             Data_type = VAR_FLOAT;
-            fValue = 0.0f;
-            fast_float::from_chars(sValue.data(), sValue.data() + sValue.length(), fValue);
             return true;
         }
         break;
@@ -1293,7 +1334,7 @@ bool DATA::Neg()
         Set(lValue);
         break;
     case VAR_STRING:
-        if (sValue.empty())
+        if (String().empty())
             lValue = 1;
         else
             lValue = 0;
@@ -1649,7 +1690,7 @@ bool DATA::Plus(DATA *pV)
             break;
         case VAR_STRING:
             Convert(VAR_STRING);
-            Set(sValue + pV->sValue);
+            Set(String() + pV->String());
             break;
         default:
             return false;
@@ -1666,7 +1707,7 @@ bool DATA::Plus(DATA *pV)
             break;
         case VAR_STRING:
             Convert(VAR_STRING);
-            Set(sValue + pV->sValue);
+            Set(String() + pV->String());
             break;
         default:
             return false;
@@ -1676,21 +1717,21 @@ bool DATA::Plus(DATA *pV)
         switch (pV->GetType())
         {
         case VAR_AREFERENCE:
-            if (!pV->AttributesClass || !pV->AttributesClass->GetThisAttr())
+            if (!pV->AttributesClass || !pV->AttributesClass->HasValue())
                 break;
-            Set(sValue + to_string(pV->AttributesClass->GetThisAttr()));
+            Set(String() + pV->AttributesClass->GetValue());
             break;
         case VAR_INTEGER:
-            Set(sValue + std::to_string(pV->lValue));
+            Set(String() + std::to_string(pV->lValue));
             break;
         case VAR_FLOAT:
-            Set(sValue + fmt::format("{}", pV->fValue));
+            Set(String() + fmt::format("{}", pV->fValue));
             break;
         case VAR_STRING:
-            Set(sValue + pV->sValue);
+            Set(String() + pV->String());
             break;
         case VAR_PTR:
-            Set(sValue + std::to_string(pV->pValue));
+            Set(String() + std::to_string(pV->pValue));
             break;
         default:
             return false;
@@ -1947,25 +1988,25 @@ bool DATA::Compare(DATA *pV, char opA, char opB)
             switch (opA)
             {
             case '=':
-                return sValue == pV->sValue;
+                return String() == pV->String();
 
             case '!':
-                return sValue!= pV->sValue;
+                return String() != pV->String();
 
             case '>':
                 if (opB == '=')
                 {
-                    return std::size(sValue) >= std::size(pV->sValue);
+                    return std::size(String()) >= std::size(pV->String());
                 }
-                return std::size(sValue) > std::size(pV->sValue);
+                return std::size(String()) > std::size(pV->String());
 
             case '<':
                 if (opB == '=')
                 {
-                    return std::size(sValue) <= std::size(pV->sValue);
+                    return std::size(String()) <= std::size(pV->String());
                 }
 
-                return std::size(sValue) < std::size(pV->sValue);
+                return std::size(String()) < std::size(pV->String());
             }
             break;
         default:
@@ -2075,7 +2116,11 @@ bool DATA::Copy(DATA *pV)
         Set(pV->fValue);
         break;
     case VAR_STRING:
-        Set(pV->sValue);
+        // a string read from an attribute is shared, not copied
+        if (const auto *attribute = pV->sView.attribute())
+            SetValueOf(*attribute);
+        else
+            Set(pV->String());
         break;
     case VAR_OBJECT:
         Set(pV->object_id);
@@ -2725,22 +2770,22 @@ bool DATA::CompareAndSetResult(DATA *pV, S_TOKEN_TYPE op)
             switch (op)
             {
             case OP_BOOL_EQUAL:
-                Set(static_cast<int32_t>(storm::iEquals(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(storm::iEquals(String(), pV->String())));
                 break;
             case OP_GREATER:
-                Set(static_cast<int32_t>(storm::iGreater(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(storm::iGreater(String(), pV->String())));
                 break;
             case OP_GREATER_OR_EQUAL:
-                Set(static_cast<int32_t>(storm::iGreaterOrEqual(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(storm::iGreaterOrEqual(String(), pV->String())));
                 break;
             case OP_LESSER:
-                Set(static_cast<int32_t>(storm::iLess(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(storm::iLess(String(), pV->String())));
                 break;
             case OP_LESSER_OR_EQUAL:
-                Set(static_cast<int32_t>(storm::iLessOrEqual(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(storm::iLessOrEqual(String(), pV->String())));
                 break;
             case OP_NOT_EQUAL:
-                Set(static_cast<int32_t>(!storm::iEquals(sValue, pV->sValue)));
+                Set(static_cast<int32_t>(!storm::iEquals(String(), pV->String())));
                 break;
             case OP_BOOL_AND:
             case OP_BOOL_OR:
@@ -2789,7 +2834,7 @@ bool DATA::BoolConvert()
             Set(0);
         break;
     case VAR_STRING:
-        Set(static_cast<int32_t>(!sValue.empty()));
+        Set(static_cast<int32_t>(!String().empty()));
         break;
     case VAR_PTR:
         if (pValue != 0)
@@ -2850,6 +2895,7 @@ float DATA::GetFloat()
 
 const char *DATA::GetString()
 {
+    OwnString();
     return sValue.c_str();
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attributes_view.h"
 #include "token.h"
 #include "v_data.h"
 
@@ -38,6 +39,8 @@ class DATA : public VDATA
     uintptr_t pValue;
     float fValue;
     std::string sValue;
+    // string read from an attribute in place of sValue
+    storm::AttributeValueView sView;
 
     bool bEntity;
     entid_t object_id;
@@ -49,6 +52,14 @@ class DATA : public VDATA
     std::vector<DATA> ArrayPTR;
     uint32_t nGlobalVarTableIndex;
 
+    const std::string &String() const
+    {
+        return sView ? sView.get() : sValue;
+    }
+
+    // copies the viewed string into sValue, for callers that keep the pointer
+    void OwnString();
+
   public:
     ATTRIBUTES *AttributesClass;
     // ATTRIBUTES Attributes;
@@ -81,6 +92,8 @@ class DATA : public VDATA
     void Set(std::string value) override;
     void Set(const char* value) override;
     void Set(const char *attribute_name, const char *attribute_value) override;
+    // string value of the attribute without copying it
+    void SetValueOf(const ATTRIBUTES &attribute);
     bool Get(int32_t &value) override;
     bool Get(float &value) override;
     bool Get(const char *&value) override;
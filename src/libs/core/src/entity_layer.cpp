@@ -0,0 +1,76 @@
+#include "entity_layer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
+namespace storm
+{
+
+entity_container_cref LayerSnapshot::ids() const
+{
+    static const std::vector<entid_t> null;
+    return ids_ ? *ids_ : null;
+}
+
+EntityLayer::EntityLayer() : ids_(std::make_shared<std::vector<entid_t>>())
+{
+}
+
+void EntityLayer::insert(entid_t id, priority_t priority)
+{
+    auto &ids = modify();
+
+    // duplicate assert
+    assert(std::ranges::find(ids, id) == std::end(ids));
+
+    const auto targetIdx = std::distance(std::begin(priorities_), std::ranges::upper_bound(priorities_, priority));
+
+    priorities_.insert(std::begin(priorities_) + targetIdx, priority);
+    ids.insert(std::begin(ids) + targetIdx, id);
+}
+
+bool EntityLayer::erase(entid_t id, priority_t priority)
+{
+    const auto ssize = std::ssize(priorities_);
+
+    const auto lowerIdx = std::distance(std::begin(priorities_), std::ranges::lower_bound(priorities_, priority));
+
+    // look through this priority only
+    for (auto i = lowerIdx; i < ssize && priorities_[i] == priority; ++i)
+    {
+        if ((*ids_)[i] == id)
+        {
+            auto &ids = modify();
+            priorities_.erase(std::begin(priorities_) + i);
+            ids.erase(std::begin(ids) + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void EntityLayer::clear()
+{
+    modify().clear();
+    priorities_.clear();
+}
+
+LayerSnapshot EntityLayer::snapshot() const
+{
+    LayerSnapshot snapshot;
+    snapshot.ids_ = ids_;
+    snapshot.layer_ = this;
+    snapshot.version_ = version_;
+    return snapshot;
+}
+
+std::vector<entid_t> &EntityLayer::modify()
+{
+    ++version_;
+    if (ids_.use_count() > 1)
+        ids_ = std::make_shared<std::vector<entid_t>>(*ids_);
+    return *ids_;
+}
+
+} // namespace storm
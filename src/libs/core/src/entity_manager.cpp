@@ -57,17 +57,7 @@ void EntityManager::AddToLayer(const layer_index_t index, EntityInternalData &da
     data.mask |= 1 << index;
     data.priorities[index] = priority;
 
-    auto &layer = layers_[index];
-    auto &priorities = layer.priorities;
-    auto &entity_ids = layer.entity_ids;
-
-    // duplicate assert
-    assert(std::ranges::find(entity_ids, data.id) == std::end(entity_ids));
-
-    const auto targetIdx = std::distance(std::begin(priorities), std::ranges::upper_bound(priorities, priority));
-
-    priorities.insert(std::begin(priorities) + targetIdx, priority);
-    entity_ids.insert(std::begin(entity_ids) + targetIdx, data.id);
+    layers_[index].members.insert(data.id, priority);
 }
 
 void EntityManager::RemoveFromLayer(const layer_index_t index, EntityInternalData &data)
@@ -76,28 +66,8 @@ void EntityManager::RemoveFromLayer(const layer_index_t index, EntityInternalDat
 
     auto &mask = data.mask;
 
-    const auto priority = data.priorities[index];
-    const auto id = data.id;
-
-    auto &layer = layers_[index];
-    auto &priorities = layer.priorities;
-    auto &entity_ids = layer.entity_ids;
-
-    const auto ssize = std::ssize(priorities);
-
-    const auto lowerIdx = std::distance(std::begin(priorities), std::ranges::lower_bound(priorities, priority));
-    assert(lowerIdx < ssize);
-
-    // look through this priority only
-    for (auto i = lowerIdx; i < ssize && priorities[i] == priority; ++i)
-    {
-        if (entity_ids[i] == id)
-        {
-            priorities.erase(std::begin(priorities) + i);
-            entity_ids.erase(std::begin(entity_ids) + i);
-            break;
-        }
-    }
+    [[maybe_unused]] const auto erased = layers_[index].members.erase(data.id, data.priorities[index]);
+    assert(erased);
 
     // clear layer flag
     mask &= ~(1 << index);
@@ -194,8 +164,7 @@ void EntityManager::EraseAll()
     // clear containers
     for (auto &layer : layers_)
     {
-        layer.entity_ids.clear();
-        layer.priorities.clear();
+        layer.members.clear();
     }
     entities_.clear();
     freeIndices_.clear();
@@ -234,7 +203,7 @@ entity_container_cref EntityManager::GetEntityIds(const layer_type_t type) const
 
         if (it->type == type)
         {
-            std::ranges::copy(it->entity_ids, std::back_inserter(result));
+            std::ranges::copy(it->members.ids(), std::back_inserter(result));
         }
     }
 
@@ -280,7 +249,14 @@ entity_container_cref EntityManager::GetEntityIds(const layer_index_t index) con
 {
     assert(index < kMaxLayerNum);
 
-    return layers_[index].entity_ids;
+    return layers_[index].members.ids();
+}
+
+storm::LayerSnapshot EntityManager::GetLayerSnapshot(const layer_index_t index) const
+{
+    assert(index < kMaxLayerNum);
+
+    return layers_[index].members.snapshot();
 }
 
 entid_t EntityManager::GetEntityId(const char *name) const
@@ -9,6 +9,7 @@
 
 #include "entity.h"
 #include "entity_container_cache.h"
+#include "entity_layer.h"
 
 class EntityManager final
 {
@@ -19,6 +20,7 @@ class EntityManager final
     entity_container_cref GetEntityIds(const char *name) const;
     entity_container_cref GetEntityIds(uint32_t hash) const;
     entity_container_cref GetEntityIds(layer_index_t index) const;
+    storm::LayerSnapshot GetLayerSnapshot(layer_index_t index) const;
     entid_t GetEntityId(const char *name) const;
     bool IsEntityValid(entid_t id) const;
     layer_type_t GetLayerType(layer_index_t index) const;
@@ -63,8 +65,7 @@ class EntityManager final
 
     struct Layer
     {
-        std::vector<priority_t> priorities;
-        std::vector<entid_t> entity_ids;
+        storm::EntityLayer members;
 
         layer_type_t type;
         bool frozen;
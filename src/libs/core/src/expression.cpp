@@ -855,8 +855,7 @@ void COMPILER::BC_ProcessExpression_L7(DATA *value, bool bSkip)
             {
             }
         }
-        pString = pRoot->GetThisAttr();
-        value->Set(pString);
+        value->SetValueOf(*pRoot);
         break;
     }
 }
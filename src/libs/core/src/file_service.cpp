@@ -478,6 +478,7 @@ std::string FILE_SERVICE::ConvertPathResource(const char *path)
 #ifdef _WIN32
     return std::string(path);
 #else
+    std::lock_guard lock(ResourcePathsMutex);
     if (ResourcePathsFirstScan)
     {
         ScanResourcePaths();
@@ -2429,12 +2429,11 @@ DATA *COMPILER::BC_CallIntFunction(uint32_t func_code, DATA *&pVResult, uint32_t
             break;
         }
         pA = pV->GetAClass();
+        pV = SStack.Push();
         if (pA)
-            pChar = pA->GetThisAttr();
+            pV->SetValueOf(*pA);
         else
-            pChar = "AClass ERROR n1";
-        pV = SStack.Push();
-        pV->Set(pChar);
+            pV->Set("AClass ERROR n1");
         pVResult = pV;
         return pV;
     case FUNC_GET_ATTRIBUTE_NAME:
@@ -2565,7 +2564,7 @@ DATA *COMPILER::BC_CallIntFunction(uint32_t func_code, DATA *&pVResult, uint32_t
         pA = pV->GetAClass();
 
         std::sort(std::execution::seq, std::begin(pA->attributes_), std::end(pA->attributes_),
-                  [](const std::unique_ptr<ATTRIBUTES> &lhs, const std::unique_ptr<ATTRIBUTES> &rhs) {
+                  [](const ATTRIBUTES *lhs, const ATTRIBUTES *rhs) {
                       return strcmp(lhs->GetThisName(), rhs->GetThisName()) < 0;
                   });
 
@@ -248,6 +248,22 @@ void S_EVENTTAB::InvalidateBySegmentID(uint32_t segment_id)
     }
 }
 
+bool S_EVENTTAB::HasSegmentID(uint32_t segment_id) const
+{
+    for (uint32_t ti = 0; ti < HASHTABLE_SIZE; ti++)
+    {
+        for (uint32_t n = 0; n < Event_num[ti]; n++)
+        {
+            for (uint32_t i = 0; i < pTable[ti][n].elements; i++)
+            {
+                if (pTable[ti][n].pFuncInfo[i].segment_id == segment_id)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
 uint32_t S_EVENTTAB::FindEvent(const char *event_name)
 {
     if (event_name == nullptr)
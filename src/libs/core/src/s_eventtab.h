@@ -49,6 +49,7 @@ class S_EVENTTAB
     void Release();
     void Clear();
     void InvalidateBySegmentID(uint32_t segment_id);
+    bool HasSegmentID(uint32_t segment_id) const; // return true if a handler of segment is set
     uint32_t FindEvent(const char *event_name);
     void ProcessFrame();
 };
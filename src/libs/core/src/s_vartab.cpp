@@ -100,6 +100,19 @@ void VarTable::InvalidateBySegmentID(uint32_t segment_id)
     }
 }
 
+bool VarTable::HasSegmentID(uint32_t segment_id) const
+{
+    for (const auto &vi : vars_)
+    {
+        if (vi.segment_id == segment_id)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 size_t VarTable::FindVar(const std::string &var_name) const
 {
     auto result = hash_table_.find(var_name);
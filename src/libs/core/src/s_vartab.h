@@ -49,6 +49,8 @@ class VarTable
     const VarInfo *GetVarX(size_t var_index) const;
     // invalidate all segment's vars
     void InvalidateBySegmentID(uint32_t segment_id);
+    // returns true if any var belongs to segment
+    bool HasSegmentID(uint32_t segment_id) const;
     // get var index by name
     size_t FindVar(const std::string &var_name) const;
     // set var's array size, returns true if successful
@@ -0,0 +1,221 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "attributes.h"
+
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+class Codec final : public VSTRING_CODEC
+{
+  public:
+    uint32_t GetNum() override
+    {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    uint32_t Convert(const char *pString) override
+    {
+        const auto [it, added] = codes_.emplace(pString, static_cast<uint32_t>(names_.size()));
+        if (added)
+            names_.emplace_back(pString);
+        return it->second;
+    }
+
+    uint32_t Convert(const char *pString, int32_t iLen) override
+    {
+        return Convert(std::string(pString, iLen).c_str());
+    }
+
+    const char *Convert(uint32_t code) override
+    {
+        return names_.at(code).c_str();
+    }
+
+    void VariableChanged() override
+    {
+    }
+
+  private:
+    std::map<std::string, uint32_t> codes_;
+    std::vector<std::string> names_;
+};
+
+// ATTRIBUTES as it was, every node and child list on the heap
+struct ReferenceNode
+{
+    uint32_t nameCode;
+    std::optional<std::string> value;
+    std::vector<std::unique_ptr<ReferenceNode>> children;
+    ReferenceNode *parent = nullptr;
+
+    ReferenceNode *add(uint32_t code)
+    {
+        auto &child = children.emplace_back(new ReferenceNode{code, {}, {}, this});
+        return child.get();
+    }
+
+    [[nodiscard]] std::unique_ptr<ReferenceNode> copy() const
+    {
+        auto result = std::make_unique<ReferenceNode>(ReferenceNode{nameCode, value, {}, nullptr});
+        for (const auto &child : children)
+        {
+            auto c = child->copy();
+            c->parent = result.get();
+            result->children.push_back(std::move(c));
+        }
+        return result;
+    }
+};
+
+// items of ships of characters: wide on top, a few levels deep
+template <typename AddChild> void BuildTree(size_t nodes, AddChild &&add)
+{
+    std::mt19937 rng(2024);
+    size_t made = 0;
+    add(size_t{0}, 0u, made);
+    for (size_t n = 1; n < nodes; n++)
+        add(std::uniform_int_distribution<size_t>(n > 64 ? n - 64 : 0, n - 1)(rng), static_cast<uint32_t>(rng() % 40),
+            made);
+}
+
+size_t Count(const ATTRIBUTES &root)
+{
+    size_t n = 1;
+    for (uint32_t i = 0; i < root.GetAttributesNum(); i++)
+        n += Count(*root.GetAttributeClass(i));
+    return n;
+}
+
+} // namespace
+
+TEST_CASE("Attributes created in an arena are freed and reused", "[core][attributes]")
+{
+    Codec codec;
+    auto root = std::make_unique<ATTRIBUTES>(codec);
+    for (int i = 0; i < 500; i++)
+    {
+        auto *ship = root->CreateAttribute("ship" + std::to_string(i), "frigate");
+        ship->SetAttribute("cargo", std::string_view("sugar"));
+        ship->CreateAttribute("crew", nullptr)->SetAttributeUseDword("count", i);
+    }
+    CHECK(Count(*root) == 1 + 500 * 4);
+
+    // deleting and creating again many times does not keep growing
+    for (int i = 0; i < 500; i += 2)
+        CHECK(root->DeleteAttributeClassX(root->GetAttributeClass("ship" + std::to_string(i))));
+    CHECK(root->GetAttributesNum() == 250);
+    for (int i = 0; i < 250; i++)
+        root->CreateAttribute("boat" + std::to_string(i), "");
+    CHECK(root->GetAttributesNum() == 500);
+    CHECK(root->GetAttributeClass("ship1")->GetAttributeClass("crew")->GetAttributeAsDword("count") == 1);
+
+    root->DeleteAttributeClassX(root.get());
+    CHECK(root->GetAttributesNum() == 0);
+    root->CreateAttribute("again", "1");
+    CHECK(std::string(root->GetAttribute("again")) == "1");
+}
+
+TEST_CASE("Copies moved between trees outlive their sources", "[core][attributes]")
+{
+    Codec codec;
+    auto source = std::make_unique<ATTRIBUTES>(codec);
+    auto *goods = source->CreateAttribute("goods", nullptr);
+    for (int i = 0; i < 100; i++)
+        goods->SetAttribute("item" + std::to_string(i),
+                            std::string_view(i % 2 ? "short" : "a value long enough to live on the heap"));
+
+    auto target = std::make_unique<ATTRIBUTES>(codec);
+    auto *cargo = target->CreateAttribute("ship", nullptr)->CreateAttribute("cargo", "old");
+    cargo->CreateAttribute("rum", "5");
+
+    // as CopyAttributes does it, into a node inside another tree
+    *cargo = goods->Copy();
+    // and a whole root
+    auto other = std::make_unique<ATTRIBUTES>(codec);
+    *other = source->Copy();
+    // the children of a node in the middle of a tree
+    ATTRIBUTES taken(std::move(*source->GetAttributeClass("goods")));
+
+    source.reset();
+    CHECK(cargo->GetAttributesNum() == 100);
+    CHECK(cargo->GetAttributeClass("rum") == nullptr);
+    CHECK(std::string(cargo->GetAttribute("item4")) == "a value long enough to live on the heap");
+    CHECK(cargo->GetAttributeClass("item4")->GetParent() == cargo);
+    CHECK(taken.GetAttributesNum() == 100);
+    CHECK(taken.GetAttributeClass(3)->GetParent() == &taken);
+    CHECK(Count(*other) == 102);
+
+    // new children of the node come from its own tree
+    cargo->CreateAttribute("sugar", "1");
+    taken.CreateAttribute("more", "2");
+    target.reset();
+    CHECK(std::string(taken.GetAttribute("more")) == "2");
+    other.reset();
+}
+
+TEST_CASE("Long values moved into a tree are freed with it", "[core][attributes]")
+{
+    // nothing else in the tree keeps its value on the heap, so the arena would be dropped without destroying nodes
+    Codec codec;
+    auto target = std::make_unique<ATTRIBUTES>(codec);
+    auto *ship = target->CreateAttribute("ship", "short");
+    auto *name = ship->CreateAttribute("name", "short");
+
+    ATTRIBUTES source(codec);
+    source.SetValue("a value long enough to live on the heap");
+    *name = source.Copy();
+    auto *cargo = ship->CreateAttribute("cargo", nullptr);
+    *cargo = std::move(source);
+
+    ATTRIBUTES moved(std::move(*name));
+    CHECK(std::string(moved.GetThisAttr()) == "a value long enough to live on the heap");
+    CHECK(std::string(cargo->GetThisAttr()) == "a value long enough to live on the heap");
+    *name = std::move(moved);
+    CHECK(std::string(ship->GetAttribute("name")) == "a value long enough to live on the heap");
+
+    // the leak checker finds the values if the arena is dropped with them
+    target.reset();
+}
+
+TEST_CASE("Attribute arena benchmark", "[.][core][attributes][benchmark]")
+{
+    Codec codec;
+    std::vector<uint32_t> codes;
+    for (int i = 0; i < 40; i++)
+        codes.push_back(codec.Convert(("name" + std::to_string(i)).c_str()));
+
+    BENCHMARK("heap nodes, build, copy and delete 100k")
+    {
+        auto root = std::make_unique<ReferenceNode>(ReferenceNode{0, {}, {}, nullptr});
+        std::vector<ReferenceNode *> nodes;
+        BuildTree(100000, [&](size_t parent, uint32_t name, size_t &made) {
+            auto *node = made++ ? nodes[parent]->add(codes[name]) : root.get();
+            node->value = std::to_string(made);
+            nodes.push_back(node);
+        });
+        auto copy = root->copy();
+        return copy->children.size();
+    };
+
+    BENCHMARK("arena nodes, build, copy and delete 100k")
+    {
+        ATTRIBUTES root(codec);
+        std::vector<ATTRIBUTES *> nodes;
+        BuildTree(100000, [&](size_t parent, uint32_t name, size_t &made) {
+            auto *node = made++ ? nodes[parent]->CreateAttribute(codes[name], nullptr) : &root;
+            node->SetValue(std::to_string(made));
+            nodes.push_back(node);
+        });
+        const auto copy = root.Copy();
+        return copy.GetAttributesNum();
+    };
+}
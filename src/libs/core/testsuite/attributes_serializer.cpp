@@ -0,0 +1,387 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "attributes_serializer.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Case independent codec handing out codes in the order names come, like STRING_CODEC does in a bucket
+class TestCodec final : public VSTRING_CODEC
+{
+  public:
+    explicit TestCodec(uint32_t first = 0) : first_(first)
+    {
+    }
+
+    uint32_t GetNum() override
+    {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    uint32_t Convert(const char *pString) override
+    {
+        auto key = std::string(pString);
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+        const auto [it, added] = codes_.emplace(key, first_ + static_cast<uint32_t>(names_.size()));
+        if (added)
+            names_.emplace_back(pString);
+        return it->second;
+    }
+
+    uint32_t Convert(const char *pString, int32_t iLen) override
+    {
+        return Convert(std::string(pString, iLen).c_str());
+    }
+
+    const char *Convert(uint32_t code) override
+    {
+        return names_.at(code - first_).c_str();
+    }
+
+    void VariableChanged() override
+    {
+    }
+
+  private:
+    uint32_t first_;
+    std::map<std::string, uint32_t> codes_;
+    std::vector<std::string> names_;
+};
+
+// COMPILER::SaveAttributesData and ReadAttributesData as they were, with SaveString for names and values
+class ReferenceSerializer
+{
+  public:
+    void save(const ATTRIBUTES *root)
+    {
+        if (root == nullptr)
+        {
+            writeVDword(0);
+            saveString(nullptr);
+            saveString(nullptr);
+            return;
+        }
+        writeVDword(static_cast<uint32_t>(root->GetAttributesNum()));
+        writeVDword(root->GetThisNameCode());
+        saveString(root->GetThisAttr());
+        for (uint32_t n = 0; n < root->GetAttributesNum(); n++)
+            save(root->GetAttributeClass(n));
+    }
+
+    void read(ATTRIBUTES *root, ATTRIBUTES *parent)
+    {
+        if (root == nullptr)
+        {
+            const auto subclasses = readVDword();
+            const auto nameCode = readVDword();
+            auto *value = readString();
+            // a value that was not saved leaves a new attribute without one
+            root = parent->GetAttributeClassByCode(nameCode);
+            if (!root)
+                root = parent->CreateAttribute(nameCode, value);
+            else if (value)
+                root->SetValue(std::string_view(value));
+            delete[] value;
+            for (uint32_t n = 0; n < subclasses; n++)
+                read(nullptr, root);
+            return;
+        }
+        const auto subclasses = readVDword();
+        root->SetNameCode(readVDword());
+        auto *value = readString();
+        if (value)
+            root->SetValue(std::string_view(value));
+        for (uint32_t n = 0; n < subclasses; n++)
+            read(nullptr, root);
+        delete[] value;
+    }
+
+    std::string buffer;
+    size_t pointer = 0;
+
+  private:
+    void writeVDword(uint32_t v)
+    {
+        if (v < 0xfe)
+            buffer.push_back(static_cast<char>(v));
+        else if (v < 0xffff)
+        {
+            buffer.push_back(static_cast<char>(0xfe));
+            const auto w = static_cast<uint16_t>(v);
+            buffer.append(reinterpret_cast<const char *>(&w), sizeof(w));
+        }
+        else
+        {
+            buffer.push_back(static_cast<char>(0xff));
+            buffer.append(reinterpret_cast<const char *>(&v), sizeof(v));
+        }
+    }
+
+    uint32_t readVDword()
+    {
+        const auto b = static_cast<uint8_t>(buffer[pointer++]);
+        if (b < 0xfe)
+            return b;
+        if (b == 0xfe)
+        {
+            uint16_t w;
+            std::copy_n(&buffer[pointer], sizeof(w), reinterpret_cast<char *>(&w));
+            pointer += sizeof(w);
+            return w;
+        }
+        uint32_t v;
+        std::copy_n(&buffer[pointer], sizeof(v), reinterpret_cast<char *>(&v));
+        pointer += sizeof(v);
+        return v;
+    }
+
+    void saveString(const char *s)
+    {
+        if (s == nullptr)
+        {
+            writeVDword(0);
+            return;
+        }
+        const auto n = static_cast<uint32_t>(strlen(s) + 1);
+        writeVDword(n);
+        buffer.append(s, n);
+    }
+
+    char *readString()
+    {
+        const auto n = readVDword();
+        if (n == 0)
+            return nullptr;
+        auto *s = new char[n];
+        std::copy_n(&buffer[pointer], n, s);
+        pointer += n;
+        return s;
+    }
+};
+
+// A tree shaped like the characters of a late game: many similar subtrees with few distinct names
+void FillTree(ATTRIBUTES &root, size_t nodes, uint32_t seed)
+{
+    static const char *names[] = {"ship", "cargo", "goods", "quantity", "price", "crew", "skill", "perks", "id",
+                                  "name", "Rank", "location", "items", "quest", "state", "money"};
+    std::mt19937 rng(seed);
+    std::vector<ATTRIBUTES *> nodesList{&root};
+    for (size_t n = 1; n < nodes; n++)
+    {
+        auto *parent = nodesList[std::uniform_int_distribution<size_t>(0, nodesList.size() - 1)(rng)];
+        auto name = std::string(names[rng() % std::size(names)]);
+        if (rng() % 3 == 0)
+            name += std::to_string(rng() % 50);
+        auto &child = parent->CreateAttribute(name);
+        switch (rng() % 4)
+        {
+        case 0:
+            break;
+        case 1:
+            child.SetValue(std::string_view(""));
+            break;
+        default:
+            child.SetValue(std::to_string(rng() % 100000));
+        }
+        nodesList.push_back(&child);
+    }
+}
+
+void RequireSame(const ATTRIBUTES &a, const ATTRIBUTES &b)
+{
+    std::vector<std::pair<const ATTRIBUTES *, const ATTRIBUTES *>> stack{{&a, &b}};
+    while (!stack.empty())
+    {
+        const auto [x, y] = stack.back();
+        stack.pop_back();
+        REQUIRE(std::string(x->GetThisName()) == y->GetThisName());
+        REQUIRE(x->HasValue() == y->HasValue());
+        if (x->HasValue())
+            REQUIRE(x->GetValue() == y->GetValue());
+        REQUIRE(x->GetAttributesNum() == y->GetAttributesNum());
+        for (uint32_t n = 0; n < x->GetAttributesNum(); n++)
+        {
+            REQUIRE(x->GetAttributeClass(n)->GetParent() == x);
+            REQUIRE(y->GetAttributeClass(n)->GetParent() == y);
+            stack.emplace_back(x->GetAttributeClass(n), y->GetAttributeClass(n));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Attribute trees survive a binary round trip", "[core][attributes]")
+{
+    TestCodec codec;
+    std::vector<ATTRIBUTES> trees;
+    for (uint32_t n = 0; n < 4; n++)
+    {
+        trees.emplace_back(codec);
+        FillTree(trees.back(), 2000, n);
+    }
+    trees[2].SetValue(std::string_view("root value"));
+    trees[3].GetAttributeClass(0)->SetValue(std::string("with\0zero", 9));
+
+    storm::AttributesWriter writer;
+    std::string data;
+    for (const auto &tree : trees)
+        writer.write(&tree, data);
+    writer.write(nullptr, data);
+
+    // the codes of another codec differ, the names are what is saved
+    TestCodec loadCodec(1000);
+    storm::AttributesReader reader;
+    size_t offset = 0;
+    for (const auto &tree : trees)
+    {
+        ATTRIBUTES loaded(loadCodec);
+        REQUIRE(reader.read(data.data(), data.size(), offset, loaded));
+        RequireSame(tree, loaded);
+    }
+    ATTRIBUTES empty(loadCodec);
+    REQUIRE(reader.read(data.data(), data.size(), offset, empty));
+    CHECK(empty.GetAttributesNum() == 0);
+    CHECK(offset == data.size());
+
+    // the dictionary makes it much smaller than the old strings
+    ReferenceSerializer reference;
+    for (const auto &tree : trees)
+        reference.save(&tree);
+    CHECK(data.size() < reference.buffer.size());
+}
+
+TEST_CASE("Loaded attributes merge into existing ones", "[core][attributes]")
+{
+    TestCodec codec;
+    ATTRIBUTES saved(codec);
+    saved.CreateAttribute("ship", "frigate");
+    saved.CreateAttribute("cargo", nullptr)->CreateAttribute("rum", "10");
+
+    storm::AttributesWriter writer;
+    std::string data;
+    writer.write(&saved, data);
+
+    ATTRIBUTES loaded(codec);
+    loaded.CreateAttribute("Cargo", "old")->CreateAttribute("sugar", "5");
+    storm::AttributesReader reader;
+    size_t offset = 0;
+    REQUIRE(reader.read(data.data(), data.size(), offset, loaded));
+
+    REQUIRE(loaded.GetAttributesNum() == 2);
+    const auto *cargo = loaded.GetAttributeClass("cargo");
+    REQUIRE(cargo);
+    CHECK_FALSE(cargo->HasValue());
+    CHECK(cargo->GetAttributesNum() == 2);
+    CHECK(std::string(cargo->GetAttribute("rum")) == "10");
+    CHECK(std::string(loaded.GetAttribute("ship")) == "frigate");
+}
+
+TEST_CASE("Broken attribute data is rejected", "[core][attributes]")
+{
+    TestCodec codec;
+    ATTRIBUTES tree(codec);
+    FillTree(tree, 300, 11);
+    storm::AttributesWriter writer;
+    std::string data;
+    writer.write(&tree, data);
+
+    // every cut of the data is too short
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        ATTRIBUTES loaded(codec);
+        storm::AttributesReader reader;
+        size_t offset = 0;
+        REQUIRE_FALSE(reader.read(data.data(), size, offset, loaded));
+        REQUIRE(offset <= size);
+    }
+
+    // random damage may read or fail, but stays inside the data
+    std::mt19937 rng(4242);
+    for (int32_t n = 0; n < 3000; n++)
+    {
+        auto damaged = data;
+        for (auto hits = rng() % 4 + 1; hits > 0; hits--)
+            damaged[rng() % damaged.size()] = static_cast<char>(rng());
+        if (n % 3 == 0)
+            damaged.resize(rng() % damaged.size());
+        ATTRIBUTES loaded(codec);
+        storm::AttributesReader reader;
+        size_t offset = 0;
+        reader.read(damaged.data(), damaged.size(), offset, loaded);
+        REQUIRE(offset <= damaged.size());
+    }
+    for (int32_t n = 0; n < 3000; n++)
+    {
+        std::string noise(rng() % 64, '\0');
+        for (auto &c : noise)
+            c = static_cast<char>(rng());
+        ATTRIBUTES loaded(codec);
+        storm::AttributesReader reader;
+        size_t offset = 0;
+        reader.read(noise.data(), noise.size(), offset, loaded);
+        REQUIRE(offset <= noise.size());
+    }
+}
+
+TEST_CASE("Copied attributes keep names, values and parents", "[core][attributes]")
+{
+    TestCodec codec;
+    ATTRIBUTES tree(codec);
+    FillTree(tree, 5000, 3);
+    tree.SetValue(std::string_view("top"));
+
+    const auto names = codec.GetNum();
+    const auto copy = tree.Copy();
+    RequireSame(tree, copy);
+    CHECK(copy.GetParent() == nullptr);
+    // the names are not converted again
+    CHECK(codec.GetNum() == names);
+
+    // copying over a script variable moves the copy into it
+    ATTRIBUTES target(codec);
+    target = tree.Copy();
+    RequireSame(tree, target);
+}
+
+TEST_CASE("Attribute serialisation benchmark", "[.][core][attributes][benchmark]")
+{
+    TestCodec codec;
+    ATTRIBUTES tree(codec);
+    FillTree(tree, 1000000, 5);
+
+    BENCHMARK("old strings, save and load 1M nodes")
+    {
+        ReferenceSerializer reference;
+        reference.save(&tree);
+        ATTRIBUTES loaded(codec);
+        reference.read(&loaded, nullptr);
+        return loaded.GetAttributesNum();
+    };
+
+    std::string data;
+    BENCHMARK("binary, save and load 1M nodes")
+    {
+        data.clear();
+        storm::AttributesWriter writer;
+        writer.write(&tree, data);
+        ATTRIBUTES loaded(codec);
+        storm::AttributesReader reader;
+        size_t offset = 0;
+        reader.read(data.data(), data.size(), offset, loaded);
+        return loaded.GetAttributesNum();
+    };
+
+    BENCHMARK("copy 1M nodes")
+    {
+        return tree.Copy().GetAttributesNum();
+    };
+}
@@ -0,0 +1,218 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "attributes_view.h"
+
+#include <catch2/catch.hpp>
+
+#include <charconv>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+class Codec final : public VSTRING_CODEC
+{
+  public:
+    uint32_t GetNum() override
+    {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    uint32_t Convert(const char *pString) override
+    {
+        const auto [it, added] = codes_.emplace(pString, static_cast<uint32_t>(names_.size()));
+        if (added)
+            names_.emplace_back(pString);
+        return it->second;
+    }
+
+    uint32_t Convert(const char *pString, int32_t iLen) override
+    {
+        return Convert(std::string(pString, iLen).c_str());
+    }
+
+    const char *Convert(uint32_t code) override
+    {
+        return names_.at(code).c_str();
+    }
+
+    void VariableChanged() override
+    {
+    }
+
+  private:
+    std::map<std::string, uint32_t> codes_;
+    std::vector<std::string> names_;
+};
+
+} // namespace
+
+TEST_CASE("Attribute values are viewed in place until they change", "[core][attributes]")
+{
+    Codec codec;
+    ATTRIBUTES root(codec);
+    auto *name = root.CreateAttribute("name", "Ebony wood from the Main");
+    auto *empty = root.CreateAttribute("empty", nullptr);
+
+    storm::AttributeValueView view;
+    CHECK_FALSE(view);
+    view.attach(*name);
+    REQUIRE(view);
+    CHECK(&view.get() == &name->GetValue());
+    CHECK(view.attribute() == name);
+
+    // copies look at the same string
+    auto copy = view;
+    CHECK(&copy.get() == &name->GetValue());
+    auto moved = std::move(copy);
+    CHECK_FALSE(copy);
+    CHECK(&moved.get() == &name->GetValue());
+
+    // writing keeps what was read
+    name->SetValue(std::string_view("Sandal"));
+    CHECK(view.get() == "Ebony wood from the Main");
+    CHECK(moved.get() == "Ebony wood from the Main");
+    CHECK(view.attribute() == nullptr);
+    CHECK(copy.attribute() == nullptr);
+
+    view.attach(*empty);
+    CHECK(view);
+    CHECK(view.get().empty());
+    empty->SetValue(std::string_view("now set"));
+    CHECK(view.get().empty());
+
+    view.attach(*name);
+    moved.attach(*name);
+    view.reset();
+    CHECK_FALSE(view);
+    name->SetValue(std::string_view("Silk"));
+    CHECK(moved.get() == "Sandal");
+}
+
+TEST_CASE("Attribute views outlive their attributes", "[core][attributes]")
+{
+    Codec codec;
+    auto root = std::make_unique<ATTRIBUTES>(codec);
+    auto *goods = root->CreateAttribute("goods", nullptr);
+    for (int i = 0; i < 50; i++)
+        goods->CreateAttribute("item" + std::to_string(i), nullptr)->SetAttribute("quantity", std::to_string(i * 10));
+
+    std::vector<storm::AttributeValueView> views(4);
+    views[0].attach(*goods->GetAttributeClass("item3")->GetAttributeClass("quantity"));
+    views[1].attach(*goods->GetAttributeClass("item4")->GetAttributeClass("quantity"));
+    views[2].attach(*goods->GetAttributeClass("item5")->GetAttributeClass("quantity"));
+    views[3] = views[2];
+
+    CHECK(root->DeleteAttributeClassX(goods->GetAttributeClass("item3")));
+    CHECK(views[0].get() == "30");
+
+    // the tree is taken apart node by node while it is looked at
+    auto other = std::make_unique<ATTRIBUTES>(codec);
+    *other = root->Copy();
+    root.reset();
+    CHECK(views[1].get() == "40");
+    CHECK(views[3].get() == "50");
+    CHECK(views[3].attribute() == nullptr);
+
+    views[0].attach(*other->GetAttributeClass("goods")->GetAttributeClass("item6")->GetAttributeClass("quantity"));
+    views[0].reset();
+    other.reset();
+}
+
+TEST_CASE("Numbers are parsed from attribute values once", "[core][attributes]")
+{
+    Codec codec;
+    ATTRIBUTES root(codec);
+    auto *price = root.CreateAttribute("price", "125");
+    CHECK(price->GetValueAsInt() == 125);
+    CHECK(price->GetValueAsFloat() == 125.0f);
+
+    price->SetValue(std::string_view("12.5"));
+    CHECK(price->GetValueAsInt() == 12);
+    CHECK(price->GetValueAsFloat() == 12.5f);
+
+    root.SetAttribute("price", std::string_view("abc"));
+    CHECK(price->GetValueAsInt() == 0);
+    CHECK(price->GetValueAsFloat() == 0.0f);
+
+    root.SetAttribute("price", std::string_view("7"));
+    CHECK(price->GetValueAsInt() == 7);
+    root.SetAttribute("price", std::string_view());
+    CHECK(price->GetValueAsInt() == 0);
+    root.SetAttributeUseDword("price", 7);
+    CHECK(price->GetValueAsInt() == 7);
+    CHECK(root.Copy().GetAttributeClass("price")->GetValueAsInt() == 7);
+}
+
+TEST_CASE("Attribute view benchmark", "[.][core][attributes][benchmark]")
+{
+    // the trade of the colonies: every character looks at the goods in the hold against the store prices
+    Codec codec;
+    ATTRIBUTES characters(codec);
+    ATTRIBUTES store(codec);
+    const std::vector<std::string> goodsNames = {"Balls", "Grapes", "Knippels", "Bombs", "Sailcloth", "Planks",
+                                                 "Food", "Weapon", "Medicament", "Wheat", "Clothes", "Fruits",
+                                                 "Coffee", "Chocolate", "Tobacco", "Sugar", "Cotton", "Leather",
+                                                 "Ebony", "Mahogany", "Cinnamon", "Copra", "Paprika", "Powder"};
+    for (const auto &name : goodsNames)
+    {
+        auto *item = store.CreateAttribute(name, nullptr);
+        item->SetAttribute("price", std::to_string(name.size() * 17));
+        item->SetAttribute("type", std::string_view(name.size() % 2 ? "trade goods" : "contraband goods"));
+    }
+    std::vector<ATTRIBUTES *> holds;
+    for (int i = 0; i < 400; i++)
+    {
+        auto *hold =
+            characters.CreateAttribute("character" + std::to_string(i), nullptr)->CreateAttribute("Ship", nullptr);
+        hold = hold->CreateAttribute("Cargo", nullptr)->CreateAttribute("Goods", nullptr);
+        for (size_t g = 0; g < goodsNames.size(); g++)
+            hold->SetAttribute(goodsNames[g], std::to_string((i * 31 + g * 7) % 2000));
+        holds.push_back(hold);
+    }
+
+    // a stack entry of the script machine as it was, every read copies the value
+    BENCHMARK("copied values")
+    {
+        std::string value;
+        int64_t total = 0;
+        for (auto *hold : holds)
+            for (uint32_t g = 0; g < hold->GetAttributesNum(); g++)
+            {
+                const auto *item = store.GetAttributeClass(g);
+                value = to_string(hold->GetAttributeClass(g)->GetThisAttr());
+                int32_t quantity = 0;
+                std::from_chars(value.data(), value.data() + value.size(), quantity);
+                value = to_string(item->GetAttributeClass("type")->GetThisAttr());
+                if (value == "contraband goods")
+                    continue;
+                value = to_string(item->GetAttributeClass("price")->GetThisAttr());
+                int32_t price = 0;
+                std::from_chars(value.data(), value.data() + value.size(), price);
+                total += quantity * price;
+            }
+        return total;
+    };
+
+    BENCHMARK("viewed values")
+    {
+        storm::AttributeValueView value;
+        int64_t total = 0;
+        for (auto *hold : holds)
+            for (uint32_t g = 0; g < hold->GetAttributesNum(); g++)
+            {
+                const auto *item = store.GetAttributeClass(g);
+                value.attach(*hold->GetAttributeClass(g));
+                const auto quantity = value.attribute()->GetValueAsInt();
+                value.attach(*item->GetAttributeClass("type"));
+                if (value.get() == "contraband goods")
+                    continue;
+                value.attach(*item->GetAttributeClass("price"));
+                total += quantity * value.attribute()->GetValueAsInt();
+            }
+        return total;
+    };
+}
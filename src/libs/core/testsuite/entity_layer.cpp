@@ -0,0 +1,212 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "entity_layer.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// members of a layer as EntityManager kept them: ids ordered by priority, the newest last among equals
+class Reference final
+{
+  public:
+    void insert(entid_t id, priority_t priority)
+    {
+        const auto it = std::upper_bound(members_.begin(), members_.end(), priority,
+                                         [](priority_t p, const auto &m) { return p < m.first; });
+        members_.insert(it, {priority, id});
+    }
+
+    bool erase(entid_t id)
+    {
+        const auto it = std::find_if(members_.begin(), members_.end(), [id](const auto &m) { return m.second == id; });
+        if (it == members_.end())
+            return false;
+        members_.erase(it);
+        return true;
+    }
+
+    [[nodiscard]] std::vector<entid_t> ids() const
+    {
+        std::vector<entid_t> ids;
+        for (const auto &m : members_)
+            ids.push_back(m.second);
+        return ids;
+    }
+
+    [[nodiscard]] priority_t priority(entid_t id) const
+    {
+        return std::find_if(members_.begin(), members_.end(), [id](const auto &m) { return m.second == id; })->first;
+    }
+
+    [[nodiscard]] const std::vector<std::pair<priority_t, entid_t>> &members() const
+    {
+        return members_;
+    }
+
+  private:
+    std::vector<std::pair<priority_t, entid_t>> members_;
+};
+
+} // namespace
+
+TEST_CASE("Entity layer keeps the order of priority", "[core]")
+{
+    std::mt19937 gen(98);
+    std::uniform_int_distribution<priority_t> priority(0, 20);
+    std::uniform_int_distribution<int32_t> percent(0, 99);
+
+    storm::EntityLayer layer;
+    Reference reference;
+    entid_t next = 1;
+    for (int32_t i = 0; i < 2000; i++)
+    {
+        const auto &members = reference.members();
+        if (members.empty() || percent(gen) < 60)
+        {
+            const auto p = priority(gen);
+            layer.insert(next, p);
+            reference.insert(next, p);
+            next++;
+        }
+        else
+        {
+            const auto id = members[std::uniform_int_distribution<size_t>(0, members.size() - 1)(gen)].second;
+            const auto p = reference.priority(id);
+            REQUIRE(layer.erase(id, p));
+            reference.erase(id);
+            CHECK_FALSE(layer.erase(id, p));
+        }
+        REQUIRE(layer.ids() == reference.ids());
+    }
+
+    layer.clear();
+    CHECK(layer.ids().empty());
+}
+
+TEST_CASE("Layer snapshot keeps its members while the layer changes", "[core]")
+{
+    storm::EntityLayer layer;
+    for (entid_t id = 1; id <= 5; id++)
+        layer.insert(id, 10);
+
+    // taking and updating snapshots changes nothing
+    const auto version = layer.version();
+    auto snapshot = layer.snapshot();
+    CHECK_FALSE(snapshot.stale());
+    snapshot.update();
+    CHECK(snapshot.version() == version);
+    CHECK(layer.version() == version);
+    CHECK(&snapshot.ids() == &layer.ids());
+
+    // nor does erasing what is not there
+    CHECK_FALSE(layer.erase(42, 10));
+    CHECK_FALSE(layer.erase(3, 11));
+    CHECK_FALSE(snapshot.stale());
+
+    layer.insert(6, 5);
+    REQUIRE(layer.erase(2, 10));
+    CHECK(snapshot.stale());
+    CHECK(snapshot.ids() == std::vector<entid_t>{1, 2, 3, 4, 5});
+    CHECK(layer.ids() == std::vector<entid_t>{6, 1, 3, 4, 5});
+
+    // iterated while the layer changes
+    std::vector<entid_t> seen;
+    for (const auto id : snapshot)
+    {
+        seen.push_back(id);
+        layer.insert(id + 100, 0);
+    }
+    CHECK(seen == std::vector<entid_t>{1, 2, 3, 4, 5});
+
+    snapshot.update();
+    CHECK_FALSE(snapshot.stale());
+    CHECK(snapshot.ids() == layer.ids());
+    CHECK(snapshot.size() == 10);
+
+    layer.clear();
+    CHECK(snapshot.stale());
+    CHECK(snapshot.size() == 10);
+    snapshot.update();
+    CHECK(snapshot.empty());
+
+    // a snapshot of no layer is empty and never stale
+    storm::LayerSnapshot none;
+    CHECK(none.empty());
+    CHECK_FALSE(none.stale());
+    none.update();
+    CHECK(none.begin() == none.end());
+}
+
+TEST_CASE("Entity layer copies its members only for a snapshot", "[core]")
+{
+    storm::EntityLayer layer;
+    const auto *ids = &layer.ids();
+    for (entid_t id = 1; id <= 100; id++)
+        layer.insert(id, static_cast<priority_t>(id % 7));
+    layer.erase(50, 1);
+    CHECK(&layer.ids() == ids);
+
+    {
+        const auto snapshot = layer.snapshot();
+        layer.insert(1000, 3);
+        CHECK(&layer.ids() != ids);
+        CHECK(&snapshot.ids() == ids);
+    }
+
+    // the copy is not shared any more
+    ids = &layer.ids();
+    layer.insert(1001, 3);
+    CHECK(&layer.ids() == ids);
+}
+
+TEST_CASE("Entity layer benchmark", "[.][core][benchmark]")
+{
+    // a battle frame at night: every flare of 20 ships is traced against the sails and the sun layers, both
+    // looked up per flare, and the sun trace layer was copied for it
+    constexpr size_t kShips = 20;
+    constexpr size_t kFlares = 12;
+    storm::EntityLayer sails;
+    storm::EntityLayer sun;
+    for (entid_t id = 1; id <= kShips; id++)
+    {
+        sails.insert(id, 1);
+        sun.insert(id, 1);
+        sun.insert(id + 1000, 2);
+    }
+    sun.insert(5000, 3);
+
+    // besides the flares a frame looks up layers of masts, sun glow, lightning, rain, shadows and sea reflections
+    constexpr size_t kOther = 12;
+    WARN("battle frame of " << kShips << " ships with " << kFlares << " flares each, layer lookups "
+                            << kShips * kFlares * 2 + kOther << " -> " << 2 + kOther);
+
+    BENCHMARK("look up and copy per flare")
+    {
+        size_t sum = 0;
+        for (size_t f = 0; f < kShips * kFlares; f++)
+        {
+            sum += sails.ids().size();
+            const auto its = sun.ids();
+            sum += its.size();
+        }
+        return sum;
+    };
+    auto sailsTrace = sails.snapshot();
+    auto sunTrace = sun.snapshot();
+    BENCHMARK("update snapshots once a frame")
+    {
+        sailsTrace.update();
+        sunTrace.update();
+        size_t sum = 0;
+        for (size_t f = 0; f < kShips * kFlares; f++)
+            sum += sailsTrace.size() + sunTrace.size();
+        return sum;
+    };
+}
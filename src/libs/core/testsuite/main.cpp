@@ -0,0 +1,8 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#ifdef _WIN32
+#define CATCH_CONFIG_WINDOWS_CRTDBG
+#endif
+
+#include <catch2/catch.hpp>
@@ -0,0 +1,138 @@
+#include "compiler.h"
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+
+constexpr auto kMainScript = R"(
+int result;
+
+void Main()
+{
+    LoadSegment("lib.c");
+}
+
+int CallLib()
+{
+    string name = "LibWork";
+    call name(2);
+    return result;
+}
+)";
+
+// no globals and no handlers of its own, so nothing keeps it resident
+constexpr auto kLibScript = R"(
+void LibWork(int n)
+{
+    result = result + n;
+}
+
+int OnLibEvent()
+{
+    result = result + 100;
+    return result;
+}
+)";
+
+constexpr uint32_t kIdleTime = 1000; // one eviction period of the compiler as well
+
+// scripts on disk for the compiler, the folder is lower case for the resource path lookup on Linux
+class ScriptFolder final
+{
+  public:
+    ScriptFolder() : path_(std::filesystem::temp_directory_path() / "storm_script_segments")
+    {
+        std::filesystem::create_directories(path_);
+        std::ofstream(path_ / "main.c") << kMainScript;
+        std::ofstream(path_ / "lib.c") << kLibScript;
+    }
+
+    ~ScriptFolder()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    std::string string() const
+    {
+        return path_.string();
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+int32_t GetResult(VDATA *data)
+{
+    int32_t value = -1;
+    REQUIRE(data != nullptr);
+    REQUIRE(data->Get(value));
+    return value;
+}
+
+} // namespace
+
+TEST_CASE("Evicted script segments are loaded back when used", "[core][script]")
+{
+    const ScriptFolder folder;
+
+    COMPILER compiler;
+    compiler.SetProgramDirectory(folder.string().c_str());
+    REQUIRE(compiler.CreateProgram("main.c"));
+    compiler.SetSegmentIdleTime(kIdleTime);
+    compiler.Run();
+
+    const uint32_t resident = compiler.GetResidentSegmentsSize();
+    compiler.ProcessFrame(kIdleTime * 2);
+    const uint32_t evicted = compiler.GetResidentSegmentsSize();
+    REQUIRE(evicted < resident);
+
+    SECTION("a call into the segment from an event loads it")
+    {
+        compiler.SetEventHandler("call_lib", "CallLib", 0);
+        CHECK(GetResult(compiler.ProcessEvent("call_lib")) == 2);
+        CHECK(compiler.GetResidentSegmentsSize() == resident);
+
+        compiler.ProcessFrame(kIdleTime * 2);
+        CHECK(compiler.GetResidentSegmentsSize() == evicted);
+        CHECK(GetResult(compiler.ProcessEvent("call_lib")) == 4);
+    }
+
+    SECTION("a handler set on the segment loads it and its events bring it back")
+    {
+        compiler.SetEventHandler("lib_event", "OnLibEvent", 0);
+        CHECK(compiler.GetResidentSegmentsSize() == resident);
+
+        compiler.ProcessFrame(kIdleTime * 2);
+        CHECK(compiler.GetResidentSegmentsSize() == evicted);
+        CHECK(GetResult(compiler.ProcessEvent("lib_event")) == 100);
+        CHECK(compiler.GetResidentSegmentsSize() == resident);
+
+        // the handler is still the segment's, unloading it removes the handler
+        compiler.UnloadSegment("lib.c");
+        CHECK(compiler.ProcessEvent("lib_event") == nullptr);
+    }
+
+    SECTION("segments are looked at once a period")
+    {
+        compiler.SetEventHandler("call_lib", "CallLib", 0);
+        compiler.ProcessEvent("call_lib");
+        compiler.ProcessFrame(kIdleTime / 2);
+        compiler.ProcessEvent("call_lib");
+
+        // a look a period after the last one finds the segment in use
+        compiler.ProcessFrame(kIdleTime / 2);
+        CHECK(compiler.GetResidentSegmentsSize() == resident);
+
+        // idle long enough, but the last look is too recent
+        compiler.ProcessFrame(kIdleTime * 3 / 5);
+        CHECK(compiler.GetResidentSegmentsSize() == resident);
+
+        compiler.ProcessFrame(kIdleTime * 2 / 5);
+        CHECK(compiler.GetResidentSegmentsSize() == evicted);
+    }
+}
@@ -29,6 +29,8 @@ class VGEOMETRY : public SERVICE
     ~VGEOMETRY() override{};
     virtual GEOS *CreateGeometry(const char *file_name, const char *light_file_name, int32_t flags,
                                  const char *lmPath = nullptr) = 0;
+    // starts reading the files of a model on other threads, the files are taken when the model is created next
+    virtual void PrefetchGeometry(const char *file_name, const char *light_file_name = nullptr) = 0;
     virtual void DeleteGeometry(GEOS *) = 0;
     virtual ANIMATION *LoadAnimation(const char *anim) = 0;
     virtual void SetTechnique(const char *name) = 0;
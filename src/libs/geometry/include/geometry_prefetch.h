@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Reads the files of a model on worker threads ahead of its creation
+ *
+ * A model is read with its nodes, as NODER creates one for every label of the "geometry" group at any depth, the
+ * levels of detail of the nodes and their light files. The files are taken by the thread that creates the geometry,
+ * which waits for a file still being read and reads itself the ones that were not prefetched. The read callback runs
+ * on the workers.
+ */
+class GeometryPrefetch final
+{
+  public:
+    // reads a whole file, false if there is none
+    using read_type = std::function<bool(const std::string &fileName, std::vector<char> &data)>;
+
+    enum class Taken
+    {
+        None,
+        Missing,
+        Read
+    };
+
+    // levels of detail looked for after a node, as MODEL_LOD_LEVELS of the models
+    static constexpr uint32_t kLodLevels = 2;
+
+    explicit GeometryPrefetch(read_type read, size_t threads = 2, size_t memoryLimit = size_t(256) << 20);
+    GeometryPrefetch(const GeometryPrefetch &) = delete;
+    GeometryPrefetch &operator=(const GeometryPrefetch &) = delete;
+    ~GeometryPrefetch();
+
+    // file names as GEOMETRY::CreateGeometry makes them
+    static std::string modelFile(const std::string &modelName);
+    static std::string lightFile(const std::string &modelName, const std::string &lightName);
+
+    // names of the labels of the "geometry" group in a geometry file
+    static std::vector<std::string> nodeLabels(const std::vector<char> &data);
+
+    // starts reading a model, the files read before and not taken are dropped
+    void prefetch(const std::string &modelName, const std::string &lightName = {});
+
+    // the file moves to data if it was read
+    Taken take(const std::string &fileName, std::vector<char> &data);
+
+    // the file as it was prefetched, read on this thread if it was not, false if there is none
+    bool load(const std::string &fileName, std::vector<char> &data);
+
+    // waits for the files in flight and drops all
+    void clear();
+
+    // bytes of the files read and not taken
+    [[nodiscard]] size_t memory() const;
+
+  private:
+    enum class State
+    {
+        Queued,
+        Reading,
+        Missing,
+        Read
+    };
+
+    struct Entry
+    {
+        State state = State::Queued;
+        std::vector<char> data;
+    };
+
+    struct Job
+    {
+        std::string fileName;
+        // the model name of the node, none for a light file
+        std::string node;
+        // 0 for the node itself, the level of detail otherwise
+        uint32_t lod;
+        uint32_t generation;
+    };
+
+    void queueFile(const std::string &fileName, const std::string &node, uint32_t lod);
+    void queueNode(const std::string &node, uint32_t lod);
+    void worker();
+
+    read_type read_;
+    size_t threads_;
+    size_t memoryLimit_;
+
+    std::string base_;
+    std::string light_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::deque<Job> jobs_;
+    size_t memory_ = 0;
+    size_t reading_ = 0;
+    // moves on when the files are dropped, the reads of the ones before are thrown away
+    uint32_t generation_ = 0;
+    bool stop_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable jobReady_;
+    std::condition_variable fileReady_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace storm
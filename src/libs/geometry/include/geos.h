@@ -12,6 +12,7 @@ Import library main header
 
 #include <cstdint>
 #include <fstream>
+#include <vector>
 
 class GEOS
 {
@@ -231,6 +232,21 @@ class GEOS
     };
 
     virtual void Draw(const PLANE *pl, int32_t np, MATERIAL_FUNC mtf) const = 0;
+    // one object as Draw draws it, to be drawn later with DrawObject
+    struct DRAW_OBJECT
+    {
+        int32_t object;
+        ID vertex_buff; // device buffer
+        int32_t stride;
+        ID index_buff;
+        int32_t start_vertex, num_vertices;
+        int32_t start_index, ntriangles;
+        const MATERIAL *material;
+    };
+    // adds the objects Draw would draw, in its order
+    virtual void Collect(const PLANE *pl, int32_t np, std::vector<DRAW_OBJECT> &objects) const = 0;
+    // draws the object, sets its material before only with bMaterial
+    virtual void DrawObject(const DRAW_OBJECT &obj, bool bMaterial, MATERIAL_FUNC mtf) const = 0;
 
     //-----------------------------------------
     // collision, ray shooting
@@ -251,6 +267,9 @@ class GEOS
     virtual bool Clip(const PLANE *planes, int32_t nplanes, const VERTEX &center, float radius,
                       ADD_POLYGON_FUNC addpoly) = 0;
 
+    // all the collision triangles in local coord-system, three vertices each, with no limit on their number as in Clip
+    virtual void GetTriangles(std::vector<VERTEX> &vertices) const = 0;
+
     // Get detail info on last ray hit or clip
     virtual bool GetCollisionDetails(TRACE_INFO &ti) const = 0;
 
@@ -279,10 +298,8 @@ class GEOM_SERVICE
 {
   public:
     virtual ~GEOM_SERVICE(){};
-    virtual std::fstream OpenFile(const char *fname) = 0;
-    virtual bool ReadFile(std::fstream &fileS, void *data, int32_t bytes) = 0;
-    virtual int FileSize(const char *fname) = 0;
-    virtual void CloseFile(std::fstream &fileS) = 0;
+    // reads the whole file, false if there is no light file, throws if there is no geometry file
+    virtual bool LoadFile(const char *fname, std::vector<char> &data) = 0;
     virtual void *malloc(int32_t bytes) = 0;
     virtual void free(void *ptr) = 0;
 
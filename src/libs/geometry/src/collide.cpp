@@ -389,3 +389,24 @@ rec_continue:;
 
     return false;
 }
+
+//--------------------------------------------------------------------------------------------
+//
+//--------------------------------------------------------------------------------------------
+void GEOM::GetTriangles(std::vector<VERTEX> &vertices) const
+{
+    if (!(rhead.flags & FLAGS_BSP_PRESENT))
+        return;
+    vertices.reserve(vertices.size() + btrg.size() * 3);
+    for (const auto &trg : btrg)
+    {
+        // "fix" for broken models
+        if (trg.getIndex(0) >= vrt.size() || trg.getIndex(1) >= vrt.size() || trg.getIndex(2) >= vrt.size())
+            continue;
+        for (int32_t v = 0; v < 3; v++)
+        {
+            const auto &vr = vrt[trg.getIndex(v)];
+            vertices.push_back({vr.x, vr.y, vr.z});
+        }
+    }
+}
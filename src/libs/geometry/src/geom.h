@@ -60,6 +60,8 @@ class GEOM : public GEOS
     int32_t traceid;
     DVECTOR src, dst;
 
+    bool IsObjectVisible(int32_t o, const PLANE *pl, int32_t np) const;
+
   public:
     GEOM(const char *fname, const char *lightname, GEOM_SERVICE &srv, int32_t flags);
     virtual ~GEOM();
@@ -88,9 +90,12 @@ class GEOM : public GEOS
 
     virtual void GetInfo(INFO &i) const;
     virtual void Draw(const PLANE *pl, int32_t np, MATERIAL_FUNC mtf) const;
+    virtual void Collect(const PLANE *pl, int32_t np, std::vector<DRAW_OBJECT> &objects) const;
+    virtual void DrawObject(const DRAW_OBJECT &obj, bool bMaterial, MATERIAL_FUNC mtf) const;
 
     virtual float Trace(VERTEX &src, VERTEX &dst);
     virtual bool Clip(const PLANE *planes, int32_t nplanes, const VERTEX &center, float radius, ADD_POLYGON_FUNC addpoly);
+    virtual void GetTriangles(std::vector<VERTEX> &vertices) const;
     virtual bool GetCollisionDetails(TRACE_INFO &ti) const;
 
     virtual int32_t FindTexture(int32_t start_index, int32_t name_id);
@@ -10,6 +10,7 @@ Import library main file
 #include "geom.h"
 #include <storm/config.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <fmt/format.h>
@@ -19,21 +20,38 @@ Import library main file
 
 namespace
 {
+// reads the parts of a file loaded at once in the order they were written
+class FileCursor
+{
+  public:
+    explicit FileCursor(const std::vector<char> &data) : data_(data)
+    {
+    }
+
+    bool read(void *dst, size_t bytes)
+    {
+        const auto size = std::min(bytes, data_.size() - pos_);
+        if (size > 0)
+            memcpy(dst, data_.data() + pos_, size);
+        pos_ += size;
+        return size == bytes;
+    }
+
+  private:
+    const std::vector<char> &data_;
+    size_t pos_ = 0;
+};
+
 std::vector<uint32_t> getColData(GEOM_SERVICE &srv, const std::string_view &file_name)
 {
     std::vector<uint32_t> result;
 
-    auto ltfl = srv.OpenFile(file_name.data());
-    if (ltfl.is_open())
+    std::vector<char> data;
+    if (srv.LoadFile(file_name.data(), data))
     {
-        const auto file_size = srv.FileSize(file_name.data());
-        if (file_size > 0)
-        {
-            result.resize(file_size / sizeof(uint32_t));
-            srv.ReadFile(ltfl, result.data(), file_size);
-        }
+        result.resize(data.size() / sizeof(uint32_t));
+        FileCursor(data).read(result.data(), result.size() * sizeof(uint32_t));
     }
-    srv.CloseFile(ltfl);
 
     return result;
 }
@@ -54,32 +72,34 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
         colData = getColData(srv, lightname);
     }
 
-    auto file = srv.OpenFile(fname);
+    std::vector<char> data;
+    srv.LoadFile(fname, data);
+    FileCursor file(data);
     // read header
-    srv.ReadFile(file, &rhead, sizeof(RDF_HEAD));
+    file.read(&rhead, sizeof(RDF_HEAD));
     if (rhead.version != RDF_VERSION)
         throw std::runtime_error("invalid version");
 
     // read names
     globname = static_cast<char *>(srv.malloc(rhead.name_size));
-    srv.ReadFile(file, globname, rhead.name_size);
+    file.read(globname, rhead.name_size);
 
     names = static_cast<int32_t *>(srv.malloc(rhead.names * sizeof(int32_t)));
-    srv.ReadFile(file, names, rhead.names * sizeof(int32_t));
+    file.read(names, rhead.names * sizeof(int32_t));
 
     // load textures
     tname = static_cast<int32_t *>(srv.malloc(rhead.ntextures * sizeof(int32_t)));
     tlookup = static_cast<int32_t *>(srv.malloc(rhead.ntextures * sizeof(int32_t)));
-    srv.ReadFile(file, tname, rhead.ntextures * sizeof(int32_t));
+    file.read(tname, rhead.ntextures * sizeof(int32_t));
 
     // read materials
     auto *rmat = static_cast<RDF_MATERIAL *>(srv.malloc(sizeof(RDF_MATERIAL) * rhead.nmaterials));
-    srv.ReadFile(file, rmat, sizeof(RDF_MATERIAL) * rhead.nmaterials);
+    file.read(rmat, sizeof(RDF_MATERIAL) * rhead.nmaterials);
     material = static_cast<MATERIAL *>(srv.malloc(sizeof(MATERIAL) * rhead.nmaterials));
 
     // read lights
     auto *rlig = static_cast<RDF_LIGHT *>(srv.malloc(sizeof(RDF_LIGHT) * rhead.nlights));
-    srv.ReadFile(file, rlig, sizeof(RDF_LIGHT) * rhead.nlights);
+    file.read(rlig, sizeof(RDF_LIGHT) * rhead.nlights);
     light = static_cast<LIGHT *>(srv.malloc(sizeof(LIGHT) * rhead.nlights));
     for (int32_t l = 0; l < rhead.nlights; l++)
     {
@@ -109,7 +129,7 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
 
     // read labels
     auto *lab = static_cast<RDF_LABEL *>(srv.malloc(sizeof(RDF_LABEL) * rhead.nlabels));
-    srv.ReadFile(file, lab, sizeof(RDF_LABEL) * rhead.nlabels);
+    file.read(lab, sizeof(RDF_LABEL) * rhead.nlabels);
     label = static_cast<LABEL *>(srv.malloc(sizeof(LABEL) * rhead.nlabels));
     for (int32_t lb = 0; lb < rhead.nlabels; lb++)
     {
@@ -125,7 +145,7 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
     // read objects
     auto *obj = static_cast<RDF_OBJECT *>(srv.malloc(sizeof(RDF_OBJECT) * rhead.nobjects));
     atriangles = static_cast<int32_t *>(srv.malloc(sizeof(int32_t) * rhead.nobjects));
-    srv.ReadFile(file, obj, sizeof(RDF_OBJECT) * rhead.nobjects);
+    file.read(obj, sizeof(RDF_OBJECT) * rhead.nobjects);
     object = static_cast<OBJECT *>(srv.malloc(sizeof(OBJECT) * rhead.nobjects));
     for (int32_t o = 0; o < rhead.nobjects; o++)
     {
@@ -149,13 +169,13 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
     // read triangles
     idx_buff = srv.CreateIndexBuffer(rhead.ntriangles * sizeof(RDF_TRIANGLE));
     auto *trg = static_cast<RDF_TRIANGLE *>(srv.LockIndexBuffer(idx_buff));
-    srv.ReadFile(file, trg, sizeof(RDF_TRIANGLE) * rhead.ntriangles);
+    file.read(trg, sizeof(RDF_TRIANGLE) * rhead.ntriangles);
     srv.UnlockIndexBuffer(idx_buff);
 
     auto nvertices = 0;
     // read vertex buffers
     auto *rvb = static_cast<RDF_VERTEXBUFF *>(srv.malloc(rhead.nvrtbuffs * sizeof(RDF_VERTEXBUFF)));
-    srv.ReadFile(file, rvb, rhead.nvrtbuffs * sizeof(RDF_VERTEXBUFF));
+    file.read(rvb, rhead.nvrtbuffs * sizeof(RDF_VERTEXBUFF));
     vbuff = static_cast<VERTEX_BUFFER *>(srv.malloc(rhead.nvrtbuffs * sizeof(VERTEX_BUFFER)));
     int32_t v;
     for (v = 0; v < rhead.nvrtbuffs; v++)
@@ -173,7 +193,7 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
     for (v = 0; v < rhead.nvrtbuffs; v++)
     {
         auto *vrt = static_cast<RDF_VERTEX0 *>(srv.LockVertexBuffer(vbuff[v].dev_buff));
-        srv.ReadFile(file, vrt, vbuff[v].size);
+        file.read(vrt, vbuff[v].size);
         for (int32_t vr = 0; vr < vbuff[v].nverts; vr++)
         {
             auto *prv = (RDF_VERTEX0 *)((uint8_t *)(vrt) + vbuff[v].stride * vr);
@@ -192,16 +212,16 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
     if (rhead.flags & FLAGS_BSP_PRESENT)
     {
         RDF_BSPHEAD bhead;
-        srv.ReadFile(file, &bhead, sizeof(RDF_BSPHEAD));
+        file.read(&bhead, sizeof(RDF_BSPHEAD));
 
         sroot = std::vector<BSP_NODE>(bhead.nnodes);
-        srv.ReadFile(file, sroot.data(), sroot.size() * sizeof(BSP_NODE));
+        file.read(sroot.data(), sroot.size() * sizeof(BSP_NODE));
 
         vrt = std::vector<CVECTOR>(bhead.nvertices);
-        srv.ReadFile(file, vrt.data(), vrt.size() * sizeof(RDF_BSPVERTEX));
+        file.read(vrt.data(), vrt.size() * sizeof(RDF_BSPVERTEX));
 
         btrg = std::vector<RDF_BSPTRIANGLE>(bhead.ntriangles);
-        srv.ReadFile(file, btrg.data(), btrg.size() * sizeof(RDF_BSPTRIANGLE));
+        file.read(btrg.data(), btrg.size() * sizeof(RDF_BSPTRIANGLE));
 
         if constexpr (storm::kValidateCollisionData)  {
             const bool valid = std::all_of(std::begin(btrg), std::end(btrg), [this](const auto &triangle) {
@@ -215,8 +235,6 @@ GEOM::GEOM(const char *fname, const char *lightname, GEOM_SERVICE &_srv, int32_t
         }
     }
 
-    srv.CloseFile(file);
-
     for (int32_t t = 0; t < rhead.ntextures; t++)
         tlookup[t] = srv.CreateTexture(&globname[tname[t]]);
     for (int32_t m = 0; m < rhead.nmaterials; m++)
@@ -266,25 +284,29 @@ GEOM::~GEOM()
     srv.free(globname);
 }
 
+bool GEOM::IsObjectVisible(int32_t o, const PLANE *pl, int32_t np) const
+{
+    if (!(object[o].flags & VISIBLE))
+        return false;
+    // clip by external planes
+    for (int32_t cp = 0; cp < np; cp++)
+    {
+        const auto dist = object[o].center.x * pl[cp].nrm.x + object[o].center.y * pl[cp].nrm.y +
+                          object[o].center.z * pl[cp].nrm.z - pl[cp].d;
+        if (dist > object[o].radius)
+            return false;
+        // if(dist<-object[o].radius)    break;
+    }
+    return true;
+}
+
 // visible analyze and draw all objects
 void GEOM::Draw(const PLANE *pl, int32_t np, MATERIAL_FUNC mtf) const
 {
     srv.SetIndexBuffer(idx_buff);
     for (int32_t o = 0; o < rhead.nobjects; o++)
     {
-        if (!(object[o].flags & VISIBLE))
-            continue;
-        // clip by external planes
-        int32_t cp;
-        for (cp = 0; cp < np; cp++)
-        {
-            const auto dist = object[o].center.x * pl[cp].nrm.x + object[o].center.y * pl[cp].nrm.y +
-                              object[o].center.z * pl[cp].nrm.z - pl[cp].d;
-            if (dist > object[o].radius)
-                break;
-            // if(dist<-object[o].radius)    break;
-        }
-        if (cp < np)
+        if (!IsObjectVisible(o, pl, np))
             continue;
 
         auto *const vb = &vbuff[object[o].vertex_buff];
@@ -297,6 +319,32 @@ void GEOM::Draw(const PLANE *pl, int32_t np, MATERIAL_FUNC mtf) const
     }
 }
 
+void GEOM::Collect(const PLANE *pl, int32_t np, std::vector<DRAW_OBJECT> &objects) const
+{
+    for (int32_t o = 0; o < rhead.nobjects; o++)
+    {
+        if (!IsObjectVisible(o, pl, np))
+            continue;
+
+        const auto &vb = vbuff[object[o].vertex_buff];
+        objects.push_back({o, vb.dev_buff, vb.stride, idx_buff, object[o].start_vertex, object[o].num_vertices,
+                           object[o].striangle * 3, object[o].ntriangles, &material[object[o].material]});
+    }
+}
+
+void GEOM::DrawObject(const DRAW_OBJECT &obj, bool bMaterial, MATERIAL_FUNC mtf) const
+{
+    srv.SetIndexBuffer(obj.index_buff);
+    srv.SetVertexBuffer(obj.stride, obj.vertex_buff);
+    if (bMaterial)
+    {
+        srv.SetMaterial(*obj.material);
+        if (mtf != nullptr)
+            mtf(*obj.material);
+    }
+    srv.DrawIndexedPrimitive(obj.start_vertex, obj.num_vertices, obj.stride, obj.start_index, obj.ntriangles);
+}
+
 bool GEOM::GetCollisionDetails(TRACE_INFO &ti) const
 {
     if (!(rhead.flags & FLAGS_BSP_PRESENT) || traceid == -1)
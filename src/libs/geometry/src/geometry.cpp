@@ -154,6 +154,11 @@ GEOS *GEOMETRY::CreateGeometry(const char *file_name, const char *light_file_nam
     return gp;
 }
 
+void GEOMETRY::PrefetchGeometry(const char *file_name, const char *light_file_name)
+{
+    GSR.PrefetchGeometry(file_name, light_file_name);
+}
+
 ANIMATION *GEOMETRY::LoadAnimation(const char *anim)
 {
     return nullptr;
@@ -186,41 +191,37 @@ void GEOM_SERVICE_R::SetRenderService(VDX9RENDER *render_service)
         RenderService->CreateVertexDeclaration(VertexElements, &vertexDecl_);
 }
 
-std::fstream GEOM_SERVICE_R::OpenFile(const char *fname)
+bool GEOM_SERVICE_R::ReadFile(const std::string &fname, std::vector<char> &data)
+{
+    auto fileS = fio->_CreateFile(fname.c_str(), std::ios::binary | std::ios::in);
+    if (!fileS.is_open())
+        return false;
+    data.resize(fio->_GetFileSize(fname.c_str()));
+    fio->_ReadFile(fileS, data.data(), data.size());
+    fio->_CloseFile(fileS);
+    return true;
+}
+
+bool GEOM_SERVICE_R::LoadFile(const char *fname, std::vector<char> &data)
 {
     if (RenderService)
     {
         RenderService->ProgressView();
     }
-    auto fileS = fio->_CreateFile(fname, std::ios::binary | std::ios::in);
-    if (!fileS.is_open())
+    if (Prefetched.load(fname, data))
     {
-        if (storm::iEquals(&fname[strlen(fname) - 4], ".col"))
-        {
-            //    core.Trace("geometry::can't open file %s", fname);
-        }
-        else
-        {
-            throw std::runtime_error("can't open geometry file");
-        }
+        return true;
     }
-
-    return fileS;
-}
-
-int GEOM_SERVICE_R::FileSize(const char *fname)
-{
-    return fio->_GetFileSize(fname);
-}
-
-bool GEOM_SERVICE_R::ReadFile(std::fstream &fileS, void *data, int32_t bytes)
-{
-    return fio->_ReadFile(fileS, data, bytes);
+    if (storm::iEquals(&fname[strlen(fname) - 4], ".col"))
+    {
+        return false;
+    }
+    throw std::runtime_error("can't open geometry file");
 }
 
-void GEOM_SERVICE_R::CloseFile(std::fstream &fileS)
+void GEOM_SERVICE_R::PrefetchGeometry(const char *file_name, const char *light_file_name)
 {
-    fio->_CloseFile(fileS);
+    Prefetched.prefetch(file_name, light_file_name ? light_file_name : "");
 }
 
 void *GEOM_SERVICE_R::malloc(int32_t bytes)
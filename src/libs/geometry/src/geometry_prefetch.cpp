@@ -0,0 +1,233 @@
+#include "geometry_prefetch.h"
+
+#include "rdf.h"
+#include "string_compare.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace storm
+{
+
+GeometryPrefetch::GeometryPrefetch(read_type read, size_t threads, size_t memoryLimit)
+    : read_(std::move(read)), threads_(std::max<size_t>(threads, 1)), memoryLimit_(memoryLimit)
+{
+}
+
+GeometryPrefetch::~GeometryPrefetch()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    jobReady_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+std::string GeometryPrefetch::modelFile(const std::string &modelName)
+{
+    return "resource\\models\\" + modelName + ".gm";
+}
+
+std::string GeometryPrefetch::lightFile(const std::string &modelName, const std::string &lightName)
+{
+    size_t skip = 0;
+    while (skip < 2 && skip < lightName.size() && lightName[skip] == '\\')
+        skip++;
+    return "resource\\models\\" + modelName + "_" + lightName.substr(skip) + ".col";
+}
+
+std::vector<std::string> GeometryPrefetch::nodeLabels(const std::vector<char> &data)
+{
+    RDF_HEAD head;
+    if (data.size() < sizeof(head))
+        return {};
+    std::memcpy(&head, data.data(), sizeof(head));
+    if (head.version != RDF_VERSION || head.name_size < 0 || head.names < 0 || head.ntextures < 0 ||
+        head.nmaterials < 0 || head.nlights < 0 || head.nlabels < 0)
+        return {};
+
+    // the parts before the labels
+    const auto globname = sizeof(head);
+    const auto names = globname + head.name_size;
+    const auto labels = names + head.names * sizeof(int32_t) + head.ntextures * sizeof(int32_t) +
+                        head.nmaterials * sizeof(RDF_MATERIAL) + head.nlights * sizeof(RDF_LIGHT);
+    if (labels + head.nlabels * sizeof(RDF_LABEL) > data.size())
+        return {};
+
+    const auto name = [&](int32_t offset) -> std::string {
+        if (offset < 0 || offset >= head.name_size)
+            return {};
+        const auto *s = data.data() + globname + offset;
+        return std::string(s, strnlen(s, head.name_size - offset));
+    };
+
+    // labels refer to the first of the names equal to the group
+    int32_t group = -1;
+    for (int32_t n = 0; n < head.names && group < 0; n++)
+    {
+        int32_t offset;
+        std::memcpy(&offset, data.data() + names + n * sizeof(int32_t), sizeof(offset));
+        if (iEquals(name(offset), std::string("geometry")))
+            group = offset;
+    }
+    if (group < 0)
+        return {};
+
+    std::vector<std::string> result;
+    for (int32_t l = 0; l < head.nlabels; l++)
+    {
+        RDF_LABEL label;
+        std::memcpy(&label, data.data() + labels + l * sizeof(RDF_LABEL), sizeof(label));
+        if (label.group_name == group)
+            result.push_back(name(label.name));
+    }
+    return result;
+}
+
+void GeometryPrefetch::prefetch(const std::string &modelName, const std::string &lightName)
+{
+    {
+        std::lock_guard lock(mutex_);
+        generation_++;
+        jobs_.clear();
+        entries_.clear();
+        memory_ = 0;
+
+        base_ = modelName;
+        light_ = lightName;
+        queueNode(modelName, 0);
+
+        while (workers_.size() < threads_)
+            workers_.emplace_back([this] { worker(); });
+    }
+    jobReady_.notify_all();
+}
+
+GeometryPrefetch::Taken GeometryPrefetch::take(const std::string &fileName, std::vector<char> &data)
+{
+    std::unique_lock lock(mutex_);
+    auto it = entries_.end();
+    fileReady_.wait(lock, [&] {
+        it = entries_.find(fileName);
+        return it == entries_.end() || (it->second.state != State::Queued && it->second.state != State::Reading);
+    });
+    if (it == entries_.end())
+        return Taken::None;
+
+    auto taken = Taken::Missing;
+    if (it->second.state == State::Read)
+    {
+        memory_ -= it->second.data.size();
+        data = std::move(it->second.data);
+        taken = Taken::Read;
+    }
+    entries_.erase(it);
+    return taken;
+}
+
+bool GeometryPrefetch::load(const std::string &fileName, std::vector<char> &data)
+{
+    switch (take(fileName, data))
+    {
+    case Taken::Read:
+        return true;
+    case Taken::Missing:
+        return false;
+    default:
+        return read_(fileName, data);
+    }
+}
+
+void GeometryPrefetch::clear()
+{
+    std::unique_lock lock(mutex_);
+    generation_++;
+    jobs_.clear();
+    entries_.clear();
+    memory_ = 0;
+    fileReady_.wait(lock, [this] { return reading_ == 0; });
+}
+
+size_t GeometryPrefetch::memory() const
+{
+    std::lock_guard lock(mutex_);
+    return memory_;
+}
+
+void GeometryPrefetch::queueFile(const std::string &fileName, const std::string &node, uint32_t lod)
+{
+    if (entries_.contains(fileName))
+        return;
+    entries_[fileName];
+    jobs_.push_back({fileName, node, lod, generation_});
+}
+
+void GeometryPrefetch::queueNode(const std::string &node, uint32_t lod)
+{
+    // the light file is read first by the geometry
+    const auto name = lod > 0 ? node + "_lod" + std::to_string(lod) : node;
+    if (!light_.empty())
+        queueFile(lightFile(name, light_), {}, 0);
+    queueFile(modelFile(name), node, lod);
+}
+
+void GeometryPrefetch::worker()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        jobReady_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (stop_)
+            return;
+
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        auto it = entries_.find(job.fileName);
+        if (it == entries_.end())
+            continue;
+        if (memory_ >= memoryLimit_)
+        {
+            // left to the thread creating the geometry
+            entries_.erase(it);
+            fileReady_.notify_all();
+            continue;
+        }
+        it->second.state = State::Reading;
+        reading_++;
+
+        lock.unlock();
+        std::vector<char> data;
+        const auto exists = read_(job.fileName, data);
+        std::vector<std::string> labels;
+        if (exists && !job.node.empty() && job.lod == 0)
+            labels = nodeLabels(data);
+        lock.lock();
+
+        reading_--;
+        if (job.generation == generation_)
+        {
+            it = entries_.find(job.fileName);
+            it->second.state = exists ? State::Read : State::Missing;
+            if (exists)
+            {
+                memory_ += data.size();
+                it->second.data = std::move(data);
+            }
+
+            // what NODER creates after the geometry of a node, the children of every node are named after the root
+            if (exists && !job.node.empty())
+            {
+                if (job.lod < kLodLevels)
+                    queueNode(job.node, job.lod + 1);
+                for (const auto &label : labels)
+                    queueNode(base_ + "_" + label, 0);
+                jobReady_.notify_all();
+            }
+        }
+        fileReady_.notify_all();
+    }
+}
+
+} // namespace storm
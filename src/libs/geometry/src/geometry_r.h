@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dx9render.h"
+#include "geometry_prefetch.h"
 #include "vma.hpp"
 #include <geometry.h>
 
@@ -16,6 +17,7 @@ class GEOMETRY final : public VGEOMETRY
     bool Init();
     bool LoadState(ENTITY_STATE *state);
     GEOS *CreateGeometry(const char *file_name, const char *light_file_name, int32_t flags, const char *lmPath);
+    void PrefetchGeometry(const char *file_name, const char *light_file_name);
     void DeleteGeometry(GEOS *);
     ANIMATION *LoadAnimation(const char *anim);
     void SetTechnique(const char *name);
@@ -38,13 +40,16 @@ class GEOM_SERVICE_R final : public GEOM_SERVICE
     uint32_t CurentVertexBufferSize;
     bool bCaustic;
 
+    // files of the model to be created next, read on other threads
+    storm::GeometryPrefetch Prefetched{ReadFile};
+
+    static bool ReadFile(const std::string &fname, std::vector<char> &data);
+
   public:
     void SetRenderService(VDX9RENDER *render_service);
 
-    std::fstream OpenFile(const char *fname);
-    int FileSize(const char *fname);
-    bool ReadFile(std::fstream &fileS, void *data, int32_t bytes);
-    void CloseFile(std::fstream &fileS);
+    bool LoadFile(const char *fname, std::vector<char> &data);
+    void PrefetchGeometry(const char *file_name, const char *light_file_name);
     void *malloc(int32_t bytes);
     void free(void *ptr);
 
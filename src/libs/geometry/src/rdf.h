@@ -40,7 +40,7 @@ BSP_TRIANGLE - bsp triangles
 // header
 //------------------------------------------------------------
 
-#define RDF_VERSION '1.05'
+#define RDF_VERSION (('1' << 24) | ('.' << 16) | ('0' << 8) | '5') // '1.05'
 
 enum RDF_FLAGS
 {
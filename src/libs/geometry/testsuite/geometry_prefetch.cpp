@@ -0,0 +1,827 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "geometry_prefetch.h"
+#include "geos.h"
+#include "matrix.h"
+#include "rdf.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using storm::GeometryPrefetch;
+using Files = std::vector<std::pair<std::string, std::optional<std::vector<char>>>>;
+
+struct Label
+{
+    std::string group;
+    std::string name;
+};
+
+template <typename T> void Put(std::vector<char> &data, const T &value)
+{
+    const auto *p = reinterpret_cast<const char *>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+// a geometry file as the RDF format lays it out: the labels, and an object of a texture over the vertices
+std::vector<char> GeometryFile(const std::vector<Label> &labels, int32_t vertices = 6, int32_t seed = 0)
+{
+    std::string globname;
+    std::vector<int32_t> names;
+    const auto name = [&](const std::string &s) {
+        const auto offset = static_cast<int32_t>(globname.size());
+        globname += s;
+        globname += '\0';
+        names.push_back(offset);
+        return offset;
+    };
+    std::map<std::string, int32_t> groups;
+    std::vector<std::pair<int32_t, int32_t>> offsets;
+    for (const auto &label : labels)
+    {
+        if (!groups.contains(label.group))
+            groups[label.group] = name(label.group);
+        offsets.emplace_back(groups[label.group], name(label.name));
+    }
+    const auto texture = name("ships\\planks" + std::to_string(seed % 3));
+    const auto object = name("hull");
+
+    RDF_HEAD head{};
+    head.version = RDF_VERSION;
+    head.name_size = static_cast<int32_t>(globname.size());
+    head.names = static_cast<int32_t>(names.size());
+    head.ntextures = 1;
+    head.nmaterials = 1;
+    head.nlabels = static_cast<int32_t>(labels.size());
+    head.nobjects = 1;
+    head.ntriangles = vertices / 3;
+    head.nvrtbuffs = 1;
+    head.bbox_size = CVECTOR(1.0f, 1.0f, 1.0f);
+    head.radius = 1.0f;
+
+    std::vector<char> data;
+    Put(data, head);
+    data.insert(data.end(), globname.begin(), globname.end());
+    for (const auto n : names)
+        Put(data, n);
+    Put(data, texture);
+
+    RDF_MATERIAL material{};
+    material.name = object;
+    material.diffuse = 1.0f;
+    material.texture_type[0] = TEXTURE_BASE;
+    Put(data, material);
+
+    for (const auto &[group, label] : offsets)
+    {
+        RDF_LABEL rdfLabel{};
+        rdfLabel.group_name = group;
+        rdfLabel.name = label;
+        rdfLabel.m[3][0] = static_cast<float>(label + seed);
+        Put(data, rdfLabel);
+    }
+
+    RDF_OBJECT rdfObject{};
+    rdfObject.name = object;
+    rdfObject.flags = VISIBLE;
+    rdfObject.radius = 1.0f;
+    rdfObject.ntriangles = head.ntriangles;
+    rdfObject.nvertices = vertices;
+    Put(data, rdfObject);
+
+    for (int32_t t = 0; t < head.ntriangles; t++)
+        Put(data, RDF_TRIANGLE{{static_cast<uint16_t>(t * 3), static_cast<uint16_t>(t * 3 + 1),
+                                static_cast<uint16_t>(t * 3 + 2)}});
+    Put(data, RDF_VERTEXBUFF{0, vertices * static_cast<int32_t>(sizeof(RDF_VERTEX0))});
+    for (int32_t v = 0; v < vertices; v++)
+    {
+        RDF_VERTEX0 vertex{};
+        vertex.pos = CVECTOR(static_cast<float>(v), static_cast<float>(seed), 0.0f);
+        vertex.norm = CVECTOR(0.0f, 1.0f, 0.0f);
+        vertex.color = seed;
+        Put(data, vertex);
+    }
+    return data;
+}
+
+// resource files and what the tests know about them
+class Disk final
+{
+  public:
+    void model(const std::string &name, const std::vector<Label> &labels, int32_t vertices = 6)
+    {
+        files_[GeometryPrefetch::modelFile(name)] = GeometryFile(labels, vertices, static_cast<int32_t>(files_.size()));
+        vertices_[name] = vertices;
+        // labels refer to the first group name of any case
+        const auto group = std::find_if(labels.begin(), labels.end(), [](const Label &label) {
+            return std::equal(label.group.begin(), label.group.end(), std::begin("geometry"), std::end("geometry") - 1,
+                              [](char a, char b) { return std::tolower(a) == b; });
+        });
+        auto &nodes = nodes_[name];
+        for (const auto &label : labels)
+            if (group != labels.end() && label.group == group->group)
+                nodes.push_back(label.name);
+    }
+
+    // a color for every vertex of the model
+    void light(const std::string &name, const std::string &light)
+    {
+        auto &data = files_[GeometryPrefetch::lightFile(name, light)];
+        for (int32_t v = 0; v < vertices_.at(name); v++)
+            Put(data, static_cast<uint32_t>(0xFF000000 | files_.size() << 12 | v));
+    }
+
+    [[nodiscard]] bool exists(const std::string &fileName) const
+    {
+        return files_.contains(fileName);
+    }
+
+    bool read(const std::string &fileName, std::vector<char> &data)
+    {
+        std::this_thread::sleep_for(latency);
+        std::lock_guard lock(mutex_);
+        const auto it = files_.find(fileName);
+        if (it == files_.end())
+            return false;
+        data = it->second;
+        return true;
+    }
+
+    [[nodiscard]] const std::vector<std::string> &nodes(const std::string &name) const
+    {
+        static const std::vector<std::string> none;
+        const auto it = nodes_.find(name);
+        return it == nodes_.end() ? none : it->second;
+    }
+
+    std::chrono::microseconds latency{0};
+
+  private:
+    std::map<std::string, std::vector<char>> files_;
+    std::map<std::string, std::vector<std::string>> nodes_;
+    std::map<std::string, int32_t> vertices_;
+    std::mutex mutex_;
+};
+
+// the geometries of a model in the order NODER::Init creates them
+template <typename Create>
+void Walk(const Disk &disk, Create &&create, const std::string &base, const std::string &node)
+{
+    create(node);
+    for (uint32_t l = 1; l <= GeometryPrefetch::kLodLevels; l++)
+    {
+        const auto lod = node + "_lod" + std::to_string(l);
+        if (!disk.exists(GeometryPrefetch::modelFile(lod)))
+            break;
+        create(lod);
+    }
+    for (const auto &label : disk.nodes(node))
+        Walk(disk, create, base, base + "_" + label);
+}
+
+// the files of a model in the order its geometry is created, a light file may be missing
+template <typename Load>
+void Mount(const Disk &disk, Load &&load, const std::string &base, const std::string &node, const std::string &light,
+           Files &files)
+{
+    Walk(
+        disk,
+        [&](const std::string &name) {
+            if (!light.empty())
+            {
+                const auto fileName = GeometryPrefetch::lightFile(name, light);
+                files.emplace_back(fileName, load(fileName));
+            }
+            const auto fileName = GeometryPrefetch::modelFile(name);
+            files.emplace_back(fileName, load(fileName));
+        },
+        base, node);
+}
+
+Files MountAsRead(Disk &disk, const std::string &model, const std::string &light)
+{
+    Files files;
+    Mount(
+        disk,
+        [&](const std::string &fileName) -> std::optional<std::vector<char>> {
+            std::vector<char> data;
+            if (!disk.read(fileName, data))
+                return {};
+            return data;
+        },
+        model, model, light, files);
+    return files;
+}
+
+Files MountPrefetched(Disk &disk, GeometryPrefetch &prefetch, const std::string &model, const std::string &light,
+                      size_t &readsAfter)
+{
+    Files files;
+    prefetch.prefetch(model, light);
+    readsAfter = 0;
+    Mount(
+        disk,
+        [&](const std::string &fileName) -> std::optional<std::vector<char>> {
+            std::vector<char> data;
+            switch (prefetch.take(fileName, data))
+            {
+            case GeometryPrefetch::Taken::Read:
+                return data;
+            case GeometryPrefetch::Taken::Missing:
+                return {};
+            default:
+                readsAfter++;
+                if (!disk.read(fileName, data))
+                    return {};
+                return data;
+            }
+        },
+        model, model, light, files);
+    return files;
+}
+
+// a ship with masts, yards of a mast as nodes of it, a hull part, fire places and levels of detail for some of the
+// nodes
+void Ship(Disk &disk, const std::string &model, int32_t vertices = 6)
+{
+    disk.model(model, {{"geometry", "hull1"}, {"geometry", "mast1"}, {"cannonl", "cannonl1"}, {"geometry", "mast2"}},
+               vertices);
+    disk.model(model + "_lod1", {{"geometry", "hull1"}}, vertices);
+    disk.model(model + "_lod2", {}, vertices);
+    disk.model(model + "_hull1", {{"paths", "deck"}, {"geometry", "shatter1"}, {"fireplaces", "fire1"}}, vertices);
+    disk.model(model + "_shatter1", {}, vertices);
+    disk.model(model + "_hull1_lod2", {}, vertices); // no first level, not created
+    disk.model(model + "_mast1",
+               {{"geometry", "rey_a1"}, {"geometry", "rey_b1"}, {"mast1", "flag1"}, {"fireplace", "fire2"}}, vertices);
+    disk.model(model + "_mast1_lod1", {}, vertices);
+    disk.model(model + "_mast2", {{"GEOMETRY", "rey_a2"}}, vertices);
+    disk.model(model + "_rey_a1", {}, vertices);
+    disk.model(model + "_rey_b1", {}, vertices);
+    disk.model(model + "_rey_a2", {{"geometry", "rope1"}}, vertices);
+    disk.model(model + "_rey_a2_rope1", {}, vertices); // not named after the root
+}
+
+// the device and the files of the geometry service, buffers in memory
+class MemoryService final : public GEOM_SERVICE
+{
+  public:
+    using load_type = std::function<bool(const std::string &fileName, std::vector<char> &data)>;
+
+    explicit MemoryService(load_type load) : load_(std::move(load))
+    {
+    }
+
+    // as GEOM_SERVICE_R does
+    bool LoadFile(const char *fname, std::vector<char> &data) override
+    {
+        if (load_(fname, data))
+            return true;
+        if (std::string_view(fname).ends_with(".col"))
+            return false;
+        throw std::runtime_error("can't open geometry file");
+    }
+
+    void *malloc(int32_t bytes) override
+    {
+        return new char[bytes];
+    }
+
+    void free(void *ptr) override
+    {
+        delete[] static_cast<char *>(ptr);
+    }
+
+    GEOS::ID CreateTexture(const char *fname) override
+    {
+        textures.emplace_back(fname);
+        return static_cast<GEOS::ID>(textures.size() - 1);
+    }
+
+    void ReleaseTexture(GEOS::ID tex) override
+    {
+    }
+
+    void SetMaterial(const GEOS::MATERIAL &mt) override
+    {
+    }
+
+    GEOS::ID CreateVertexBuffer(int32_t type, int32_t size) override
+    {
+        return createBuffer(size);
+    }
+
+    void *LockVertexBuffer(GEOS::ID vb) override
+    {
+        return buffers[vb].data();
+    }
+
+    void UnlockVertexBuffer(GEOS::ID vb) override
+    {
+    }
+
+    void ReleaseVertexBuffer(GEOS::ID vb) override
+    {
+    }
+
+    GEOS::ID CreateIndexBuffer(int32_t size) override
+    {
+        return createBuffer(size);
+    }
+
+    void *LockIndexBuffer(GEOS::ID ib) override
+    {
+        return buffers[ib].data();
+    }
+
+    void UnlockIndexBuffer(GEOS::ID ib) override
+    {
+    }
+
+    void ReleaseIndexBuffer(GEOS::ID ib) override
+    {
+    }
+
+    void SetIndexBuffer(GEOS::ID ibuff) override
+    {
+    }
+
+    void SetVertexBuffer(int32_t vsize, GEOS::ID vbuff) override
+    {
+    }
+
+    void DrawIndexedPrimitive(int32_t minv, int32_t numv, int32_t vrtsize, int32_t startidx, int32_t numtrg) override
+    {
+    }
+
+    GEOS::ID CreateLight(GEOS::LIGHT) override
+    {
+        return 0;
+    }
+
+    void ActivateLight(GEOS::ID n) override
+    {
+    }
+
+    void SetCausticMode(bool bSet) override
+    {
+    }
+
+    std::vector<std::string> textures;
+    std::vector<std::vector<char>> buffers;
+
+  private:
+    GEOS::ID createBuffer(int32_t size)
+    {
+        buffers.emplace_back(size);
+        return static_cast<GEOS::ID>(buffers.size() - 1);
+    }
+
+    load_type load_;
+};
+
+// what a geometry holds once it is created, its buffers as they were filled
+std::vector<char> State(const GEOS &geo, const MemoryService &srv)
+{
+    std::vector<char> state;
+    const auto put = [&](const auto &value) { Put(state, value); };
+    const auto putString = [&](const char *s) { state.insert(state.end(), s, s + strlen(s) + 1); };
+
+    GEOS::INFO info;
+    geo.GetInfo(info);
+    put(info);
+    for (int32_t l = 0; l < info.nlabels; l++)
+    {
+        GEOS::LABEL label;
+        geo.GetLabel(l, label);
+        put(label.m);
+        putString(label.group_name);
+        putString(label.name);
+    }
+    for (int32_t m = 0; m < info.nmaterials; m++)
+    {
+        GEOS::MATERIAL material;
+        geo.GetMaterial(m, material);
+        put(material.diffuse);
+        for (int32_t t = 0; t < 4; t++)
+            if (material.texture_type[t] != GEOS::TEXTURE_NONE)
+                putString(srv.textures[material.texture[t]].c_str());
+    }
+    for (int32_t o = 0; o < info.nobjects; o++)
+    {
+        GEOS::OBJECT object;
+        geo.GetObj(o, object);
+        put(object.flags);
+        put(object.ntriangles);
+        put(object.num_vertices);
+        putString(object.name);
+    }
+    const auto &indices = srv.buffers[geo.GetIndexBuffer()];
+    state.insert(state.end(), indices.begin(), indices.end());
+    for (int32_t vb = 0; vb < info.nvrtbuffs; vb++)
+    {
+        const auto &vertices = srv.buffers[geo.GetVertexBuffer(vb)];
+        state.insert(state.end(), vertices.begin(), vertices.end());
+    }
+    return state;
+}
+
+// the geometries of a model created as GEOMETRY::CreateGeometry does, and what they hold
+using Geometries = std::vector<std::pair<std::string, std::vector<char>>>;
+
+Geometries Create(const Disk &disk, MemoryService::load_type load, const std::string &model, const std::string &light)
+{
+    MemoryService srv(std::move(load));
+    Geometries geometries;
+    Walk(
+        disk,
+        [&](const std::string &name) {
+            const auto fileName = GeometryPrefetch::modelFile(name);
+            const auto lightName = GeometryPrefetch::lightFile(name, light);
+            std::unique_ptr<GEOS> geo;
+            try
+            {
+                geo.reset(CreateGeometry(fileName.c_str(), light.empty() ? nullptr : lightName.c_str(), srv, 0));
+            }
+            catch (const std::exception &)
+            {
+                // a node with no geometry file is left out
+                geometries.emplace_back(fileName, std::vector<char>());
+                return;
+            }
+            geometries.emplace_back(fileName, State(*geo, srv));
+        },
+        model, model);
+    return geometries;
+}
+
+// masts, hull parts and fire places as SHIP::Mount finds them in the nodes of its model
+struct ShipParts
+{
+    struct Part
+    {
+        std::string node;
+        int32_t number;
+        // the line through the box of the node in ship space, up from the bottom
+        std::array<float, 6> line;
+
+        bool operator==(const Part &) const = default;
+    };
+
+    std::vector<Part> masts;
+    std::vector<Part> hulls;
+    // in the space of their node, as FirePlace::Init takes them
+    std::vector<std::array<float, 3>> firePlaces;
+
+    bool operator==(const ShipParts &) const = default;
+};
+
+// the nodes created as NODER::Init does, and scanned as ScanShipForFirePlaces, BuildMasts and BuildHulls do
+ShipParts MountShip(const Disk &disk, MemoryService::load_type load, const std::string &model,
+                    const std::string &light)
+{
+    MemoryService srv(std::move(load));
+    ShipParts parts;
+    const auto prefixed = [](const std::string &name, std::string_view prefix) {
+        const auto lower = [](char a, char b) { return a == std::tolower(b); };
+        return name.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), name.begin(), lower);
+    };
+
+    std::function<void(const std::string &, const std::string &, const CMatrix &)> node;
+    node = [&](const std::string &name, const std::string &fullName, const CMatrix &glob) {
+        const auto fileName = GeometryPrefetch::modelFile(fullName);
+        const auto lightName = GeometryPrefetch::lightFile(fullName, light);
+        std::unique_ptr<GEOS> geo;
+        try
+        {
+            geo.reset(CreateGeometry(fileName.c_str(), light.empty() ? nullptr : lightName.c_str(), srv, 0));
+        }
+        catch (const std::exception &)
+        {
+            // a node with no geometry file is left out, as in Create
+            return;
+        }
+        // the levels of detail are created as well, but the ship does not look into them
+        for (uint32_t l = 1; l <= GeometryPrefetch::kLodLevels; l++)
+        {
+            const auto lod = fullName + "_lod" + std::to_string(l);
+            if (!disk.exists(GeometryPrefetch::modelFile(lod)))
+                break;
+            const auto lodLight = GeometryPrefetch::lightFile(lod, light);
+            const std::unique_ptr<GEOS> lodGeo(CreateGeometry(GeometryPrefetch::modelFile(lod).c_str(),
+                                                              light.empty() ? nullptr : lodLight.c_str(), srv, 0));
+        }
+        GEOS::INFO info;
+        geo->GetInfo(info);
+
+        for (int32_t l = 0; l < info.nlabels; l++)
+        {
+            GEOS::LABEL label;
+            geo->GetLabel(l, label);
+            if (std::string_view(label.group_name) == "fireplace" || std::string_view(label.group_name) == "fireplaces")
+                parts.firePlaces.push_back({label.m[3][0], label.m[3][1], label.m[3][2]});
+        }
+
+        const bool mast = prefixed(name, "mast");
+        if (mast || prefixed(name, "shatter"))
+        {
+            const CVECTOR size(info.boxsize.x, info.boxsize.y, info.boxsize.z);
+            const CVECTOR center(info.boxcenter.x, info.boxcenter.y, info.boxcenter.z);
+            CMatrix mtx = glob;
+            const CVECTOR up = mtx * (center + size / 2.0f);
+            const CVECTOR down = mtx * (center - size / 2.0f);
+            const CVECTOR mid = (up + down) / 2.0f;
+            const auto number = std::stoi(name.substr(mast ? 4 : 7));
+            // the first mast is along x
+            const bool first = mast && number == 1;
+            ShipParts::Part part{name,
+                                 number,
+                                 {mid.x, down.y, first ? down.z : mid.z, mid.x, up.y, first ? up.z : mid.z}};
+            (mast ? parts.masts : parts.hulls).push_back(std::move(part));
+        }
+
+        const auto geometry = geo->FindName("geometry");
+        for (int32_t l = -1; (l = geo->FindLabelG(l + 1, geometry)) > -1;)
+        {
+            GEOS::LABEL label;
+            geo->GetLabel(l, label);
+            CMatrix local;
+            local.Vx() = CVECTOR(label.m[0][0], label.m[0][1], label.m[0][2]);
+            local.Vy() = CVECTOR(label.m[1][0], label.m[1][1], label.m[1][2]);
+            local.Vz() = CVECTOR(label.m[2][0], label.m[2][1], label.m[2][2]);
+            local.Pos() = CVECTOR(label.m[3][0], label.m[3][1], label.m[3][2]);
+            CMatrix childGlob;
+            childGlob.EqMultiply(local, glob);
+            node(label.name, model + "_" + label.name, childGlob);
+        }
+    };
+    node(model, model, CMatrix());
+    return parts;
+}
+
+} // namespace
+
+TEST_CASE("Geometry prefetch finds the nodes of a geometry file", "[geometry]")
+{
+    const auto data =
+        GeometryFile({{"geometry", "hull1"}, {"cannonr", "c1"}, {"geometry", "mast1"}, {"x", "geometry"}});
+    CHECK(GeometryPrefetch::nodeLabels(data) == std::vector<std::string>{"hull1", "mast1"});
+    // as GEOM::FindLabelG, only of the first group name of any case
+    CHECK(GeometryPrefetch::nodeLabels(GeometryFile({{"Geometry", "hull1"}, {"geometry", "mast1"}})) ==
+          std::vector<std::string>{"hull1"});
+    CHECK(GeometryPrefetch::nodeLabels(GeometryFile({{"cannonr", "c1"}})).empty());
+    CHECK(GeometryPrefetch::nodeLabels(GeometryFile({})).empty());
+
+    // cut before the end of the labels or not a geometry file
+    const auto labelsEnd = data.size() - sizeof(RDF_OBJECT) - 2 * sizeof(RDF_TRIANGLE) - sizeof(RDF_VERTEXBUFF) -
+                           6 * sizeof(RDF_VERTEX0);
+    for (size_t size = 0; size < labelsEnd; size += 7)
+        CHECK(GeometryPrefetch::nodeLabels(std::vector<char>(data.begin(), data.begin() + size)).empty());
+    auto broken = data;
+    broken[0] = 'x';
+    CHECK(GeometryPrefetch::nodeLabels(broken).empty());
+
+    CHECK(GeometryPrefetch::modelFile("ships\\a\\a") == "resource\\models\\ships\\a\\a.gm");
+    CHECK(GeometryPrefetch::lightFile("a_lod1", "\\\\day") == "resource\\models\\a_lod1_day.col");
+    CHECK(GeometryPrefetch::lightFile("a", "\\\\\\day") == "resource\\models\\a_\\day.col");
+}
+
+TEST_CASE("Prefetched ship mounts as the one read on demand", "[geometry]")
+{
+    const std::string model = "ships\\Frigate\\Frigate";
+    for (const std::string light : {"", "\\\\evening"})
+    {
+        Disk disk;
+        Ship(disk, model);
+        if (!light.empty())
+        {
+            disk.light(model, light);
+            disk.light(model + "_mast1", light);
+            disk.light(model + "_mast1_lod1", light); // the rest have none
+        }
+
+        const auto expected = MountAsRead(disk, model, light);
+        REQUIRE(expected.size() == (light.empty() ? 12 : 24));
+
+        disk.latency = std::chrono::microseconds(50);
+        GeometryPrefetch prefetch([&](const std::string &fileName, std::vector<char> &data) {
+            return disk.read(fileName, data);
+        });
+        for (int32_t i = 0; i < 3; i++)
+        {
+            size_t readsAfter;
+            const auto files = MountPrefetched(disk, prefetch, model, light, readsAfter);
+            CHECK(files == expected);
+            CHECK(readsAfter == 0);
+            CHECK(prefetch.memory() == 0);
+        }
+
+        // no memory left to read ahead
+        GeometryPrefetch none(
+            [&](const std::string &fileName, std::vector<char> &data) { return disk.read(fileName, data); }, 2, 0);
+        size_t readsAfter;
+        CHECK(MountPrefetched(disk, none, model, light, readsAfter) == expected);
+        CHECK(readsAfter == expected.size());
+    }
+}
+
+TEST_CASE("Prefetched ship creates the geometry of the one read on demand", "[geometry]")
+{
+    const std::string model = "ships\\Frigate\\Frigate";
+    for (const std::string light : {"", "\\\\evening"})
+    {
+        Disk disk;
+        Ship(disk, model);
+        if (!light.empty())
+        {
+            disk.light(model, light);
+            disk.light(model + "_mast1", light);
+            disk.light(model + "_mast1_lod1", light);
+        }
+
+        const auto read = [&](const std::string &fileName, std::vector<char> &data) {
+            return disk.read(fileName, data);
+        };
+        const auto expected = Create(disk, read, model, light);
+        REQUIRE(expected.size() == 12);
+        // the light colors went into the vertices
+        const auto unlit = Create(
+            disk,
+            [&](const std::string &fileName, std::vector<char> &data) {
+                return !fileName.ends_with(".col") && disk.read(fileName, data);
+            },
+            model, light);
+        CHECK((unlit.front().second != expected.front().second) == !light.empty());
+
+        disk.latency = std::chrono::microseconds(50);
+        std::mutex readsMutex;
+        std::map<std::string, int32_t> reads;
+        GeometryPrefetch prefetch([&](const std::string &fileName, std::vector<char> &data) {
+            {
+                std::lock_guard lock(readsMutex);
+                reads[fileName]++;
+            }
+            return disk.read(fileName, data);
+        });
+        const auto load = [&](const std::string &fileName, std::vector<char> &data) {
+            return prefetch.load(fileName, data);
+        };
+        for (int32_t i = 0; i < 3; i++)
+        {
+            prefetch.prefetch(model, light);
+            CHECK(Create(disk, load, model, light) == expected);
+            CHECK(prefetch.memory() == 0);
+        }
+        // every file once a mount, by the workers or on demand
+        for (const auto &[fileName, count] : reads)
+            CHECK(count <= 3);
+        for (const auto &[fileName, state] : expected)
+            CHECK(reads[fileName] == 3);
+    }
+}
+
+TEST_CASE("Prefetched ship mounts the masts, hull parts and fire places of the one read on demand", "[geometry]")
+{
+    const std::string model = "ships\\Frigate\\Frigate";
+    for (const std::string light : {"", "\\\\evening"})
+    {
+        Disk disk;
+        Ship(disk, model);
+        if (!light.empty())
+            disk.light(model + "_mast1", light);
+
+        const auto read = [&](const std::string &fileName, std::vector<char> &data) {
+            return disk.read(fileName, data);
+        };
+        const auto expected = MountShip(disk, read, model, light);
+        REQUIRE(expected.masts.size() == 2);
+        CHECK(expected.masts[0].node == "mast1");
+        CHECK(expected.masts[1].number == 2);
+        REQUIRE(expected.hulls.size() == 1);
+        CHECK(expected.hulls[0].node == "shatter1");
+        CHECK(expected.firePlaces.size() == 2);
+
+        disk.latency = std::chrono::microseconds(50);
+        GeometryPrefetch prefetch(read);
+        const auto load = [&](const std::string &fileName, std::vector<char> &data) {
+            return prefetch.load(fileName, data);
+        };
+        for (int32_t i = 0; i < 3; i++)
+        {
+            prefetch.prefetch(model, light);
+            CHECK(MountShip(disk, load, model, light) == expected);
+            CHECK(prefetch.memory() == 0);
+        }
+    }
+}
+
+TEST_CASE("Geometry prefetch drops the files of another model", "[geometry]")
+{
+    Disk disk;
+    Ship(disk, "ships\\Lugger\\Lugger");
+    Ship(disk, "ships\\Brig\\Brig");
+    GeometryPrefetch prefetch([&](const std::string &fileName, std::vector<char> &data) {
+        return disk.read(fileName, data);
+    });
+
+    std::vector<char> data;
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger"), data) == GeometryPrefetch::Taken::None);
+
+    prefetch.prefetch("ships\\Lugger\\Lugger");
+    REQUIRE(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger"), data) == GeometryPrefetch::Taken::Read);
+    CHECK(data == GeometryFile({{"geometry", "hull1"}, {"geometry", "mast1"}, {"cannonl", "cannonl1"},
+                                {"geometry", "mast2"}}));
+    // taken once
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger"), data) == GeometryPrefetch::Taken::None);
+    // the files of a node are known once the node is read
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger_hull1"), data) ==
+          GeometryPrefetch::Taken::Read);
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger_hull1_lod1"), data) ==
+          GeometryPrefetch::Taken::Missing);
+
+    prefetch.prefetch("ships\\Brig\\Brig");
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Lugger\\Lugger_mast1"), data) ==
+          GeometryPrefetch::Taken::None);
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Brig\\Brig"), data) == GeometryPrefetch::Taken::Read);
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Brig\\Brig_mast1"), data) == GeometryPrefetch::Taken::Read);
+
+    prefetch.clear();
+    CHECK(prefetch.memory() == 0);
+    CHECK(prefetch.take(GeometryPrefetch::modelFile("ships\\Brig\\Brig_mast2"), data) == GeometryPrefetch::Taken::None);
+}
+
+TEST_CASE("Geometry prefetch benchmark", "[.][geometry][benchmark]")
+{
+    // a ship of 10 geometry files of 430 KB read from a slow disk, while the scripts prepare the ship
+    const std::string model = "ships\\Frigate\\Frigate";
+    Disk disk;
+    Ship(disk, model, 12000);
+    disk.latency = std::chrono::microseconds(1500);
+    const auto work = [](std::chrono::microseconds time) {
+        const auto end = std::chrono::steady_clock::now() + time;
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    };
+    constexpr auto kScripts = std::chrono::microseconds(3000);
+    const auto read = [&](const std::string &fileName, std::vector<char> &data) { return disk.read(fileName, data); };
+
+    GeometryPrefetch prefetch(read);
+    const auto load = [&](const std::string &fileName, std::vector<char> &data) {
+        return prefetch.load(fileName, data);
+    };
+    BENCHMARK("mount reading on demand")
+    {
+        work(kScripts);
+        return Create(disk, read, model, "").size();
+    };
+    BENCHMARK("mount prefetched")
+    {
+        prefetch.prefetch(model);
+        work(kScripts);
+        return Create(disk, load, model, "").size();
+    };
+
+    // what is left on the main thread once the files are read: the geometry copied into its buffers
+    std::map<std::string, std::vector<char>> files;
+    Walk(
+        disk,
+        [&](const std::string &name) {
+            std::vector<char> data;
+            if (read(GeometryPrefetch::modelFile(name), data))
+                files[GeometryPrefetch::modelFile(name)] = std::move(data);
+        },
+        model, model);
+    disk.latency = {};
+    BENCHMARK("create the geometry of files in memory")
+    {
+        return Create(
+                   disk,
+                   [&](const std::string &fileName, std::vector<char> &data) {
+                       const auto it = files.find(fileName);
+                       if (it == files.end())
+                           return false;
+                       data = it->second;
+                       return true;
+                   },
+                   model, "")
+            .size();
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "trace_mesh.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Builds the island depth map from a TraceMesh snapshot of the island geometry
+ *
+ * The map is split into square tiles which worker threads take one by one, so the bake can be cancelled
+ * between tiles and reports progress as the fraction of finished tiles. Every texel depends only on the
+ * mesh and its own position, so the result does not depend on the number of threads. Texels are coded as ISLAND
+ * reads them: 2 for land and the shallows around it, 255 for open sea and the depth down to 20 in between.
+ */
+class DepthMapBaker final
+{
+  public:
+    static constexpr uint32_t kTileSize = 64;
+
+    struct Params
+    {
+        CVECTOR boxCenter;
+        uint32_t size;
+        float stepX, stepZ;
+    };
+
+    explicit DepthMapBaker(const TraceMesh &mesh);
+    DepthMapBaker(const DepthMapBaker &) = delete;
+    DepthMapBaker &operator=(const DepthMapBaker &) = delete;
+    ~DepthMapBaker();
+
+    // starts the bake and returns immediately, 0 threads means one per hardware thread
+    void start(const Params &params, uint32_t threads = 0);
+    // bakes on the calling thread
+    void bakeSerial(const Params &params);
+
+    void wait();
+    void cancel();
+
+    // 0..1
+    [[nodiscard]] float progress() const;
+    [[nodiscard]] bool done() const;
+    [[nodiscard]] bool cancelled() const;
+
+    // size * size texels, row by row along z
+    [[nodiscard]] const std::vector<uint8_t> &map() const
+    {
+        return map_;
+    }
+
+  private:
+    void prepare(const Params &params);
+    void worker();
+    void bakeTile(uint32_t tile);
+    uint8_t bakeTexel(uint32_t x, uint32_t z) const;
+    bool camomileTrace(const CVECTOR &src) const;
+
+    const TraceMesh &mesh_;
+    Params params_{};
+    uint32_t tilesX_{};
+    uint32_t tileCount_{};
+    std::vector<uint8_t> map_;
+
+    std::atomic<uint32_t> nextTile_{};
+    std::atomic<uint32_t> tilesDone_{};
+    std::atomic<bool> cancel_{};
+    std::vector<std::thread> workers_;
+};
+
+} // namespace storm
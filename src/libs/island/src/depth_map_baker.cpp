@@ -0,0 +1,159 @@
+#include "depth_map_baker.h"
+
+#include "math_inlines.h"
+
+#include <algorithm>
+
+#define HMAP_START 2.0f
+#define HMAP_NUMBERS (255.0f - HMAP_START)
+#define HMAP_MAXHEIGHT -20.0f
+
+namespace storm
+{
+
+DepthMapBaker::DepthMapBaker(const TraceMesh &mesh) : mesh_(mesh)
+{
+}
+
+DepthMapBaker::~DepthMapBaker()
+{
+    cancel();
+    wait();
+}
+
+void DepthMapBaker::prepare(const Params &params)
+{
+    cancel();
+    wait();
+
+    params_ = params;
+    tilesX_ = (params.size + kTileSize - 1) / kTileSize;
+    tileCount_ = tilesX_ * tilesX_;
+    map_.assign(static_cast<size_t>(params.size) * params.size, 255);
+
+    nextTile_ = 0;
+    tilesDone_ = 0;
+    cancel_ = false;
+}
+
+void DepthMapBaker::start(const Params &params, uint32_t threads)
+{
+    prepare(params);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, tileCount_);
+
+    workers_.reserve(threads);
+    for (uint32_t i = 0; i < threads; i++)
+        workers_.emplace_back([this] { worker(); });
+}
+
+void DepthMapBaker::bakeSerial(const Params &params)
+{
+    prepare(params);
+    worker();
+}
+
+void DepthMapBaker::wait()
+{
+    for (auto &thread : workers_)
+        thread.join();
+    workers_.clear();
+}
+
+void DepthMapBaker::cancel()
+{
+    cancel_ = true;
+}
+
+float DepthMapBaker::progress() const
+{
+    return tileCount_ ? static_cast<float>(tilesDone_) / static_cast<float>(tileCount_) : 1.0f;
+}
+
+bool DepthMapBaker::done() const
+{
+    return tilesDone_ == tileCount_;
+}
+
+bool DepthMapBaker::cancelled() const
+{
+    return cancel_ && !done();
+}
+
+void DepthMapBaker::worker()
+{
+    while (!cancel_)
+    {
+        const uint32_t tile = nextTile_++;
+        if (tile >= tileCount_)
+            break;
+        bakeTile(tile);
+        ++tilesDone_;
+    }
+}
+
+void DepthMapBaker::bakeTile(uint32_t tile)
+{
+    const uint32_t x1 = (tile % tilesX_) * kTileSize;
+    const uint32_t z1 = (tile / tilesX_) * kTileSize;
+    const uint32_t x2 = std::min(x1 + kTileSize, params_.size);
+    const uint32_t z2 = std::min(z1 + kTileSize, params_.size);
+
+    for (uint32_t z = z1; z < z2; z++)
+        for (uint32_t x = x1; x < x2; x++)
+            map_[x + z * params_.size] = bakeTexel(x, z);
+}
+
+uint8_t DepthMapBaker::bakeTexel(uint32_t x, uint32_t z) const
+{
+    const float fXX = (static_cast<float>(x) - static_cast<float>(params_.size) / 2.0f) * params_.stepX;
+    const float fZZ = (static_cast<float>(z) - static_cast<float>(params_.size) / 2.0f) * params_.stepZ;
+
+    CVECTOR vSrc(fXX, 0.0f, fZZ), vDst(fXX, -500.0f, fZZ + 0.001f);
+    vSrc += params_.boxCenter;
+    vDst += params_.boxCenter;
+    const float fRes = mesh_.trace(vSrc, vDst);
+    if (fRes <= 1.0f) // island ocean floor exist
+    {
+        float fHeight = sqrtf(~(fRes * (vDst - vSrc)));
+        if (fHeight > -HMAP_MAXHEIGHT)
+            fHeight = -HMAP_MAXHEIGHT;
+        if (camomileTrace(vSrc))
+            return static_cast<uint8_t>(HMAP_START);
+        return static_cast<uint8_t>(HMAP_START + static_cast<float>(HMAP_NUMBERS) * fHeight / -HMAP_MAXHEIGHT);
+    }
+
+    // check for up direction
+    vDst = CVECTOR(fXX, 1500.0f, fZZ + 0.001f) + params_.boxCenter;
+    if (mesh_.trace(vSrc, vDst) <= 1.0f || camomileTrace(vSrc))
+        return static_cast<uint8_t>(HMAP_START);
+    return 255;
+}
+
+bool DepthMapBaker::camomileTrace(const CVECTOR &src) const
+{
+    const float fRadius = 100.0f;
+    const int32_t iNumPetal = 8;
+    int32_t iNumInner = 0;
+
+    for (int32_t i = 0; i < iNumPetal; i++)
+    {
+        const float fAng = static_cast<float>(i) / static_cast<float>(iNumPetal) * PIm2;
+        const CVECTOR vDst = src + CVECTOR(cosf(fAng) * fRadius, 0.0f, sinf(fAng) * fRadius);
+
+        uint32_t triangle;
+        if (mesh_.trace(src, vDst, &triangle) > 1.0f)
+            continue;
+        const CVECTOR vCross = !mesh_.normal(triangle);
+        if ((vCross | !(vDst - src)) > 0.0f)
+            iNumInner++;
+        if (iNumInner > 1)
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace storm
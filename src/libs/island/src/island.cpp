@@ -8,6 +8,7 @@
 #include "shared/sea_ai/script_defines.h"
 #include "tga.h"
 #include <cstdio>
+#include <thread>
 
 CREATE_CLASS(ISLAND)
 
@@ -376,38 +377,46 @@ bool ISLAND::GetDepth(float x, float z, float *fRes)
     return true;
 }
 
-bool ISLAND::ActivateCamomileTrace(CVECTOR &vSrc)
+uint64_t ISLAND::GeometryKey()
 {
-    const float fRadius = 100.0f;
-    const int32_t iNumPetal = 8;
-    int32_t iNumInner = 0;
-
-    for (int32_t i = 0; i < iNumPetal; i++)
+    // placement, bounds and sizes of every island node, known without walking the faces
+    std::vector<CVECTOR> key;
+    GEOS::INFO ginfo;
+    auto &&entities = core.GetEntityIds(ISLAND_TRACE);
+    for (auto ent_id : entities)
     {
-        TRIANGLE trg;
-        CVECTOR vDst, vCross;
-        float fAng, fCos, fSin, fRes;
-
-        fAng = static_cast<float>(i) / static_cast<float>(iNumPetal) * PIm2;
-        fCos = cosf(fAng);
-        fSin = sinf(fAng);
-
-        vDst = vSrc + CVECTOR(fCos * fRadius, 0.0f, fSin * fRadius);
-        fRes = Trace(vSrc, vDst);
-        if (fRes > 1.0f)
+        auto *pM = static_cast<MODEL *>(core.GetEntityPointer(ent_id));
+        if (pM == nullptr)
             continue;
-        auto *pEnt = static_cast<MODEL *>(core.GetEntityPointer(pCollide->GetObjectID()));
-        Assert(pEnt);
-        pEnt->GetCollideTriangle(trg);
-        vCross = !((trg.vrt[1] - trg.vrt[0]) ^ (trg.vrt[2] - trg.vrt[0]));
-        fRes = vCross | (!(vDst - vSrc));
-        if (fRes > 0.0f)
-            iNumInner++;
-        if (iNumInner > 1)
-            return true;
+
+        uint32_t i = 0;
+        while (NODE *pN = pM->GetNode(i++))
+        {
+            pN->geo->GetInfo(ginfo);
+            key.insert(key.end(),
+                       {pN->glob_mtx.Vx(), pN->glob_mtx.Vy(), pN->glob_mtx.Vz(), pN->glob_mtx.Pos(),
+                        CVECTOR(ginfo.boxcenter.x, ginfo.boxcenter.y, ginfo.boxcenter.z),
+                        CVECTOR(ginfo.boxsize.x, ginfo.boxsize.y, ginfo.boxsize.z),
+                        CVECTOR(ginfo.radius, static_cast<float>(ginfo.ntriangles), static_cast<float>(ginfo.nobjects)),
+                        CVECTOR(static_cast<float>(ginfo.nvrtbuffs), static_cast<float>(ginfo.nmaterials),
+                                static_cast<float>(ginfo.nlabels)),
+                        CVECTOR(static_cast<float>(pN->flags), 0.0f, 0.0f)});
+        }
     }
+    return storm::TraceMesh::contentHash(key);
+}
 
-    return false;
+void ISLAND::CollectTraceTriangles(std::vector<CVECTOR> &vertices)
+{
+    // the whole island in global space, with every face of it, Clip would leave out the ones past the GEOM limits
+    vertices.clear();
+    auto &&entities = core.GetEntityIds(ISLAND_TRACE);
+    for (auto ent_id : entities)
+    {
+        auto *pM = static_cast<MODEL *>(core.GetEntityPointer(ent_id));
+        if (pM)
+            pM->GetTriangles(vertices);
+    }
 }
 
 void ISLAND::CalcBoxParameters(CVECTOR &_vBoxCenter, CVECTOR &_vBoxSize)
@@ -579,9 +588,24 @@ bool ISLAND::CreateHeightMap(const std::string_view &pDir, const std::string_vie
     rIsland.x2 = vBoxCenter.x + vBoxSize.x / 2.0f;
     rIsland.y2 = vBoxCenter.z + vBoxSize.z / 2.0f;
 
-    bool bLoad = mzDepth.Load(fileName + ".zap");
+    // the key of the island geometry tells a stale depth map, the faces are only collected to bake a new one
+    sprintf_s(str_tmp, "%016llx", static_cast<unsigned long long>(GeometryKey()));
+    const std::string sGeometryHash = str_tmp;
 
-    if (!bLoad)
+    bool bStale = false;
+    if (auto pI = fio->OpenIniFile(iniName.c_str()))
+    {
+        if (pI->ReadString("Main", "GeometryHash", str_tmp, sizeof(str_tmp) - 1, "") && str_tmp[0] &&
+            sGeometryHash != str_tmp)
+        {
+            core.Trace("Island: geometry changed, depth map %s is stale and will be rebuilt", fileName.c_str());
+            bStale = true;
+        }
+    }
+
+    bool bLoad = !bStale && mzDepth.Load(fileName + ".zap");
+
+    if (!bLoad && !bStale)
     {
         auto fileS = fio->_CreateFile(fileName.c_str(), std::ios::binary | std::ios::in);
         if (fileS.is_open())
@@ -617,6 +641,10 @@ bool ISLAND::CreateHeightMap(const std::string_view &pDir, const std::string_vie
         auto pI = fio->OpenIniFile(iniName.c_str());
         Assert(pI.get());
 
+        // maps made before the hash was stored are trusted once and stamped with the current geometry
+        if (!pI->ReadString("Main", "GeometryHash", str_tmp, sizeof(str_tmp) - 1, "") || !str_tmp[0])
+            pI->WriteString("Main", "GeometryHash", sGeometryHash.c_str());
+
         CVECTOR vTmpBoxCenter, vTmpBoxSize;
         pI->ReadString("Main", "vBoxCenter", str_tmp, sizeof(str_tmp) - 1, "1.0,1.0,1.0");
         sscanf(str_tmp, "%f,%f,%f", &vTmpBoxCenter.x, &vTmpBoxCenter.y, &vTmpBoxCenter.z);
@@ -654,56 +682,35 @@ bool ISLAND::CreateHeightMap(const std::string_view &pDir, const std::string_vie
     fStep1divDX = 1.0f / fStepDX;
     fStep1divDZ = 1.0f / fStepDZ;
 
-    pDepthMap = new uint8_t[iDMapSize * iDMapSize];
+    storm::TraceMesh traceMesh;
+    {
+        std::vector<CVECTOR> vTriangles;
+        CollectTraceTriangles(vTriangles);
+        traceMesh.addTriangles(vTriangles);
+    }
+    traceMesh.build();
 
-    float fEarthPercent = 0.0f;
-    float fX, fZ;
+    storm::DepthMapBaker baker(traceMesh);
+    baker.start({vBoxCenter, iDMapSize, fStepDX, fStepDZ});
 
-    for (fZ = 0; fZ < static_cast<float>(iDMapSize); fZ += 1.0f)
+    const auto tStart = std::chrono::steady_clock::now();
+    int32_t iReported = 0;
+    while (!baker.done())
     {
-        if ((static_cast<int32_t>(fZ) & 127) == 127)
-            core.Trace("Z = %.0f", fZ);
-        for (fX = 0; fX < static_cast<float>(iDMapSize); fX += 1.0f)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto iPercent = static_cast<int32_t>(baker.progress() * 100.0f);
+        if (iPercent / 10 > iReported / 10)
         {
-            int32_t iIdx = static_cast<int32_t>(fX) + static_cast<int32_t>(fZ) * iDMapSize;
-            pDepthMap[iIdx] = 255;
-            float fXX = (fX - static_cast<float>(iDMapSize) / 2.0f) * fStepDX;
-            float fZZ = (fZ - static_cast<float>(iDMapSize) / 2.0f) * fStepDZ;
-            CVECTOR vSrc(fXX, 0.0f, fZZ), vDst(fXX, -500.0f, fZZ + 0.001f);
-            vSrc += vBoxCenter;
-            vDst += vBoxCenter;
-            float fRes = Trace(vSrc, vDst);
-            Assert(isnan(fRes) == false);
-            if (fRes <= 1.0f) // island ocean floor exist
-            {
-                float fHeight = sqrtf(~(fRes * (vDst - vSrc)));
-                if (fHeight > -HMAP_MAXHEIGHT)
-                {
-                    fHeight = -HMAP_MAXHEIGHT;
-                }
-                // Activate camomile trace!
-                if (ActivateCamomileTrace(vSrc))
-                    pDepthMap[iIdx] = static_cast<uint8_t>(HMAP_START);
-                else
-                    pDepthMap[iIdx] = static_cast<unsigned char>(
-                        (HMAP_START + static_cast<float>(HMAP_NUMBERS) * fHeight / -HMAP_MAXHEIGHT));
-            }
-            else // check for up direction
-            {
-                vSrc = CVECTOR(fXX, 0.0f, fZZ);
-                vDst = CVECTOR(fXX, 1500.0f, fZZ + 0.001f);
-                vSrc += vBoxCenter;
-                vDst += vBoxCenter;
-                float fRes = Trace(vSrc, vDst);
-                if (fRes <= 1.0f || ActivateCamomileTrace(vSrc))
-                {
-                    pDepthMap[iIdx] = static_cast<uint8_t>(HMAP_START);
-                }
-            }
-            if (pDepthMap[iIdx] == static_cast<uint8_t>(HMAP_START))
-                fEarthPercent += 1.0f;
+            iReported = iPercent;
+            core.Trace("Island: depth map %d%%", iPercent);
         }
     }
+    baker.wait();
+    core.Trace("Island: depth map %s baked in %.1f sec", fileName.c_str(),
+               std::chrono::duration<float>(std::chrono::steady_clock::now() - tStart).count());
+
+    pDepthMap = new uint8_t[iDMapSize * iDMapSize];
+    std::copy(baker.map().begin(), baker.map().end(), pDepthMap);
 
     vBoxSize /= 2.0f;
     vRealBoxSize /= 2.0f;
@@ -726,6 +733,7 @@ bool ISLAND::CreateHeightMap(const std::string_view &pDir, const std::string_vie
     pI->WriteString("Main", "vBoxCenter", str);
     sprintf_s(str, "%f,%f,%f", vBoxSize.x, vBoxSize.y, vBoxSize.z);
     pI->WriteString("Main", "vBoxSize", str);
+    pI->WriteString("Main", "GeometryHash", sGeometryHash.c_str());
 
     return true;
 }
@@ -3,6 +3,7 @@
 #include "ai_flow_graph.h"
 #include "island_base.h"
 #include "collide.h"
+#include "depth_map_baker.h"
 #include "dx9render.h"
 #include "geometry.h"
 #include "model.h"
@@ -89,7 +90,8 @@ class ISLAND : public ISLAND_BASE
 
     // depth map section
     bool CreateHeightMap(const std::string_view &pDir, const std::string_view &pName);
-    bool ActivateCamomileTrace(CVECTOR &vSrc);
+    uint64_t GeometryKey();
+    void CollectTraceTriangles(std::vector<CVECTOR> &vertices);
     inline float GetDepthCheck(uint32_t iX, uint32_t iZ);
     inline float GetDepthNoCheck(uint32_t iX, uint32_t iZ);
 
@@ -0,0 +1,440 @@
+#include "depth_map_baker.h"
+
+#include "geos.h"
+#include "math_inlines.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// texels of land and of the shallows around it, and of the open sea
+constexpr uint8_t kLand = 2;
+constexpr uint8_t kOpenSea = 255;
+
+// round island rising from -30 to +40 with a lagoon in the middle, as a height field grid
+std::vector<CVECTOR> islandTriangles()
+{
+    constexpr int32_t kCells = 48;
+    constexpr float kCellSize = 10.0f;
+
+    auto height = [](float x, float z) {
+        const float r = sqrtf(x * x + z * z);
+        return 40.0f - r * 0.4f - (r < 40.0f ? (40.0f - r) * 1.5f : 0.0f);
+    };
+
+    std::vector<CVECTOR> vertices;
+    for (int32_t z = 0; z < kCells; z++)
+        for (int32_t x = 0; x < kCells; x++)
+        {
+            CVECTOR v[4];
+            const int32_t dx[] = {0, 1, 1, 0};
+            const int32_t dz[] = {0, 0, 1, 1};
+            for (int32_t i = 0; i < 4; i++)
+            {
+                const float fx = (static_cast<float>(x + dx[i]) - kCells / 2.0f) * kCellSize;
+                const float fz = (static_cast<float>(z + dz[i]) - kCells / 2.0f) * kCellSize;
+                v[i] = CVECTOR(fx, height(fx, fz), fz);
+            }
+            vertices.insert(vertices.end(), {v[0], v[1], v[2], v[0], v[2], v[3]});
+        }
+    return vertices;
+}
+
+void buildIsland(storm::TraceMesh &mesh)
+{
+    mesh.addTriangles(islandTriangles());
+    mesh.build();
+}
+
+storm::DepthMapBaker::Params params()
+{
+    return {CVECTOR(3.0f, 0.0f, -7.0f), 200, 2.5f, 2.5f};
+}
+
+template <typename T> void Put(std::vector<char> &data, const T &value)
+{
+    const auto *p = reinterpret_cast<const char *>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+// a geometry file of one collision triangle, as the RDF format lays it out: a BSP of one node on the plane of the face
+std::vector<char> TriangleFile(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2)
+{
+    constexpr int32_t kRdfVersion = ('1' << 24) | ('.' << 16) | ('0' << 8) | '5';
+    constexpr int32_t kBspPresent = 2;
+
+    std::vector<char> data;
+    Put(data, kRdfVersion);
+    Put(data, kBspPresent);
+    for (int32_t i = 0; i < 9; i++) // names, textures, materials, lights, labels, objects, triangles, vertex buffers
+        Put(data, int32_t(0));
+    for (int32_t i = 0; i < 7; i++) // bounding box and radius
+        Put(data, 0.0f);
+
+    Put(data, int32_t(1)); // nodes
+    Put(data, int32_t(3)); // vertices
+    Put(data, int32_t(1)); // triangles
+    const auto norm = !((v1 - v0) ^ (v2 - v0));
+    Put(data, norm);
+    Put(data, norm | v0);
+    Put(data, uint32_t(1) << 24); // no children, one face
+    Put(data, int32_t(0));
+    Put(data, v0);
+    Put(data, v1);
+    Put(data, v2);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const uint8_t index[3] = {i, 0, 0};
+        Put(data, index);
+    }
+    return data;
+}
+
+// geometry service without a device, collision geometry needs only memory and files
+class GeometryService final : public GEOM_SERVICE
+{
+  public:
+    bool LoadFile(const char *fname, std::vector<char> &data) override
+    {
+        const auto it = files.find(fname);
+        if (it == files.end())
+            return false;
+        data = it->second;
+        return true;
+    }
+
+    void *malloc(int32_t bytes) override
+    {
+        return std::malloc(std::max(bytes, 1));
+    }
+
+    void free(void *ptr) override
+    {
+        std::free(ptr);
+    }
+
+    GEOS::ID CreateTexture(const char *) override
+    {
+        return -1;
+    }
+    void ReleaseTexture(GEOS::ID) override
+    {
+    }
+    void SetMaterial(const GEOS::MATERIAL &) override
+    {
+    }
+
+    GEOS::ID CreateVertexBuffer(int32_t, int32_t) override
+    {
+        return -1;
+    }
+    void *LockVertexBuffer(GEOS::ID) override
+    {
+        return nullptr;
+    }
+    void UnlockVertexBuffer(GEOS::ID) override
+    {
+    }
+    void ReleaseVertexBuffer(GEOS::ID) override
+    {
+    }
+
+    GEOS::ID CreateIndexBuffer(int32_t) override
+    {
+        return -1;
+    }
+    void *LockIndexBuffer(GEOS::ID) override
+    {
+        return nullptr;
+    }
+    void UnlockIndexBuffer(GEOS::ID) override
+    {
+    }
+    void ReleaseIndexBuffer(GEOS::ID) override
+    {
+    }
+
+    void SetIndexBuffer(GEOS::ID) override
+    {
+    }
+    void SetVertexBuffer(int32_t, GEOS::ID) override
+    {
+    }
+    void DrawIndexedPrimitive(int32_t, int32_t, int32_t, int32_t, int32_t) override
+    {
+    }
+
+    GEOS::ID CreateLight(GEOS::LIGHT) override
+    {
+        return -1;
+    }
+    void ActivateLight(GEOS::ID) override
+    {
+    }
+
+    void SetCausticMode(bool) override
+    {
+    }
+
+    std::map<std::string, std::vector<char>> files;
+};
+
+// the island models as ISLAND::Trace saw them through COLLIDE: the nearest hit of all models, a model per face
+class IslandModels
+{
+  public:
+    explicit IslandModels(const std::vector<CVECTOR> &vertices)
+    {
+        for (size_t i = 0; i + 3 <= vertices.size(); i += 3)
+        {
+            const auto name = std::to_string(i);
+            service_.files[name] = TriangleFile(vertices[i], vertices[i + 1], vertices[i + 2]);
+            models_.push_back({std::unique_ptr<GEOS>(CreateGeometry(name.c_str(), nullptr, service_, 0)),
+                               !((vertices[i + 1] - vertices[i]) ^ (vertices[i + 2] - vertices[i])),
+                               Min(Min(vertices[i], vertices[i + 1]), vertices[i + 2]),
+                               Max(Max(vertices[i], vertices[i + 1]), vertices[i + 2])});
+        }
+    }
+
+    float Trace(const CVECTOR &src, const CVECTOR &dst)
+    {
+        GEOS::VERTEX s{src.x, src.y, src.z};
+        GEOS::VERTEX d{dst.x, dst.y, dst.z};
+        const auto segMin = Min(src, dst);
+        const auto segMax = Max(src, dst);
+        float best = 2.0f;
+        for (const auto &model : models_)
+        {
+            // a face is hit only inside its box, the test only skips the GEOM traces that would miss
+            if (segMax.x < model.min.x || segMin.x > model.max.x || segMax.y < model.min.y ||
+                segMin.y > model.max.y || segMax.z < model.min.z || segMin.z > model.max.z)
+                continue;
+            const auto res = model.geo->Trace(s, d);
+            if (res < best)
+            {
+                best = res;
+                hit_ = &model;
+            }
+        }
+        return best;
+    }
+
+    // the collide triangle of the model hit last, as MODEL::GetCollideTriangle gives it
+    const CVECTOR &HitNormal() const
+    {
+        return hit_->normal;
+    }
+
+  private:
+    struct Model
+    {
+        std::unique_ptr<GEOS> geo;
+        CVECTOR normal, min, max;
+    };
+
+    static CVECTOR Min(const CVECTOR &a, const CVECTOR &b)
+    {
+        return CVECTOR(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    }
+
+    static CVECTOR Max(const CVECTOR &a, const CVECTOR &b)
+    {
+        return CVECTOR(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    GeometryService service_;
+    std::vector<Model> models_;
+    const Model *hit_ = nullptr;
+};
+
+// ISLAND::ActivateCamomileTrace before the bake moved to DepthMapBaker
+bool BaselineCamomileTrace(IslandModels &island, CVECTOR &vSrc)
+{
+    const float fRadius = 100.0f;
+    const int32_t iNumPetal = 8;
+    int32_t iNumInner = 0;
+
+    for (int32_t i = 0; i < iNumPetal; i++)
+    {
+        CVECTOR vDst, vCross;
+        float fAng, fCos, fSin, fRes;
+
+        fAng = static_cast<float>(i) / static_cast<float>(iNumPetal) * PIm2;
+        fCos = cosf(fAng);
+        fSin = sinf(fAng);
+
+        vDst = vSrc + CVECTOR(fCos * fRadius, 0.0f, fSin * fRadius);
+        fRes = island.Trace(vSrc, vDst);
+        if (fRes > 1.0f)
+            continue;
+        vCross = island.HitNormal();
+        fRes = vCross | (!(vDst - vSrc));
+        if (fRes > 0.0f)
+            iNumInner++;
+        if (iNumInner > 1)
+            return true;
+    }
+
+    return false;
+}
+
+// the depth map loop of ISLAND::CreateHeightMap before the bake moved to DepthMapBaker
+std::vector<uint8_t> BaselineBake(IslandModels &island, const storm::DepthMapBaker::Params &params)
+{
+    constexpr float HMAP_START = 2.0f;
+    constexpr float HMAP_NUMBERS = 255.0f - HMAP_START;
+    constexpr float HMAP_MAXHEIGHT = -20.0f;
+
+    const int32_t iDMapSize = static_cast<int32_t>(params.size);
+    const float fStepDX = params.stepX;
+    const float fStepDZ = params.stepZ;
+    const CVECTOR vBoxCenter = params.boxCenter;
+    std::vector<uint8_t> pDepthMap(static_cast<size_t>(iDMapSize) * iDMapSize);
+
+    float fX, fZ;
+    for (fZ = 0; fZ < static_cast<float>(iDMapSize); fZ += 1.0f)
+    {
+        for (fX = 0; fX < static_cast<float>(iDMapSize); fX += 1.0f)
+        {
+            int32_t iIdx = static_cast<int32_t>(fX) + static_cast<int32_t>(fZ) * iDMapSize;
+            pDepthMap[iIdx] = 255;
+            float fXX = (fX - static_cast<float>(iDMapSize) / 2.0f) * fStepDX;
+            float fZZ = (fZ - static_cast<float>(iDMapSize) / 2.0f) * fStepDZ;
+            CVECTOR vSrc(fXX, 0.0f, fZZ), vDst(fXX, -500.0f, fZZ + 0.001f);
+            vSrc += vBoxCenter;
+            vDst += vBoxCenter;
+            float fRes = island.Trace(vSrc, vDst);
+            if (fRes <= 1.0f) // island ocean floor exist
+            {
+                float fHeight = sqrtf(~(fRes * (vDst - vSrc)));
+                if (fHeight > -HMAP_MAXHEIGHT)
+                {
+                    fHeight = -HMAP_MAXHEIGHT;
+                }
+                // Activate camomile trace!
+                if (BaselineCamomileTrace(island, vSrc))
+                    pDepthMap[iIdx] = static_cast<uint8_t>(HMAP_START);
+                else
+                    pDepthMap[iIdx] = static_cast<unsigned char>(
+                        (HMAP_START + static_cast<float>(HMAP_NUMBERS) * fHeight / -HMAP_MAXHEIGHT));
+            }
+            else // check for up direction
+            {
+                vSrc = CVECTOR(fXX, 0.0f, fZZ);
+                vDst = CVECTOR(fXX, 1500.0f, fZZ + 0.001f);
+                vSrc += vBoxCenter;
+                vDst += vBoxCenter;
+                float fRes = island.Trace(vSrc, vDst);
+                if (fRes <= 1.0f || BaselineCamomileTrace(island, vSrc))
+                {
+                    pDepthMap[iIdx] = static_cast<uint8_t>(HMAP_START);
+                }
+            }
+        }
+    }
+    return pDepthMap;
+}
+
+} // namespace
+
+TEST_CASE("Depth map bake matches the bake of the island models", "[island]")
+{
+    const auto vertices = islandTriangles();
+    IslandModels island(vertices);
+    const auto reference = BaselineBake(island, params());
+
+    // the island has every kind of texel: land, shallows and open sea
+    CHECK(std::count(reference.begin(), reference.end(), kLand) > 0);
+    CHECK(std::count(reference.begin(), reference.end(), kOpenSea) > 0);
+    CHECK(std::count_if(reference.begin(), reference.end(), [](uint8_t t) { return t > kLand && t < kOpenSea; }) > 0);
+
+    storm::TraceMesh mesh;
+    buildIsland(mesh);
+    storm::DepthMapBaker baker(mesh);
+    baker.start(params());
+    baker.wait();
+    REQUIRE(baker.done());
+    CHECK(baker.map() == reference);
+}
+
+TEST_CASE("Parallel depth map bake matches serial bake", "[island]")
+{
+    storm::TraceMesh mesh;
+    buildIsland(mesh);
+
+    storm::DepthMapBaker serial(mesh);
+    serial.bakeSerial(params());
+    REQUIRE(serial.done());
+    const auto &reference = serial.map();
+    REQUIRE(reference.size() == 200u * 200u);
+
+    // the island has every kind of texel: land, shallows and open sea
+    CHECK(std::count(reference.begin(), reference.end(), kLand) > 0);
+    CHECK(std::count(reference.begin(), reference.end(), kOpenSea) > 0);
+    CHECK(std::count_if(reference.begin(), reference.end(), [](uint8_t t) { return t > kLand && t < kOpenSea; }) > 0);
+
+    for (const uint32_t threads : {1u, 3u, 8u})
+    {
+        storm::DepthMapBaker parallel(mesh);
+        parallel.start(params(), threads);
+        parallel.wait();
+        REQUIRE(parallel.done());
+        CHECK(parallel.progress() == 1.0f);
+        CHECK(parallel.map() == reference);
+    }
+}
+
+TEST_CASE("Depth map bake can be cancelled", "[island]")
+{
+    storm::TraceMesh mesh;
+    buildIsland(mesh);
+
+    storm::DepthMapBaker baker(mesh);
+    baker.start(params(), 2);
+    baker.cancel();
+    baker.wait();
+    CHECK(baker.progress() <= 1.0f);
+    CHECK(baker.cancelled() != baker.done());
+}
+
+TEST_CASE("Trace mesh returns the nearest hit", "[island]")
+{
+    storm::TraceMesh mesh;
+    for (const float y : {-10.0f, -5.0f, -20.0f})
+        mesh.addTriangle(CVECTOR(-1.0f, y, -1.0f), CVECTOR(1.0f, y, -1.0f), CVECTOR(0.0f, y, 1.0f));
+    mesh.build();
+
+    uint32_t triangle;
+    CHECK(mesh.trace(CVECTOR(0.0f), CVECTOR(0.0f, -100.0f, 0.0f), &triangle) == Approx(0.05f));
+    CHECK(triangle == 1);
+    CHECK(mesh.trace(CVECTOR(0.0f), CVECTOR(0.0f, 100.0f, 0.0f), &triangle) > 1.0f);
+    CHECK(triangle == storm::TraceMesh::kNoTriangle);
+    CHECK(mesh.trace(CVECTOR(5.0f, 0.0f, 0.0f), CVECTOR(5.0f, -100.0f, 0.0f)) > 1.0f);
+}
+
+TEST_CASE("Trace mesh hash is known before the mesh is made", "[island]")
+{
+    std::vector<CVECTOR> vertices;
+    for (const float y : {-10.0f, -5.0f, -20.0f})
+        for (const auto &v : {CVECTOR(-1.0f, y, -1.0f), CVECTOR(1.0f, y, -1.0f), CVECTOR(0.0f, y, 1.0f)})
+            vertices.push_back(v);
+
+    storm::TraceMesh mesh;
+    mesh.addTriangles(vertices);
+    CHECK(mesh.size() == 3);
+    CHECK(storm::TraceMesh::contentHash(vertices) == mesh.contentHash());
+    mesh.build();
+    CHECK(storm::TraceMesh::contentHash(vertices) == mesh.contentHash());
+
+    vertices[4].y += 0.001f;
+    CHECK(storm::TraceMesh::contentHash(vertices) != mesh.contentHash());
+}
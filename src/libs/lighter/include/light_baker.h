@@ -0,0 +1,90 @@
+//============================================================================================
+//    LightBaker
+//--------------------------------------------------------------------------------------------
+//    Shadow tracing and smoothing of the location lighter on all cores
+//============================================================================================
+
+#pragma once
+
+#include "l_types.h"
+#include "trace_mesh.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class OctTree;
+
+class LightBaker
+{
+    // --------------------------------------------------------------------------------------------
+    // Construction, destruction
+    // --------------------------------------------------------------------------------------------
+  public:
+    LightBaker();
+    LightBaker(const LightBaker &) = delete;
+    LightBaker &operator=(const LightBaker &) = delete;
+    virtual ~LightBaker();
+
+    // Set the scene, every vertex must have numLights shadow values, the data must live until the bake ends
+    void SetScene(Vertex *vrt, int32_t numVrt, const Triangle *trg, int32_t numTrg, const Light *lights,
+                  int32_t numLights);
+
+    // Trace shadows, fills Shadow::v and Shadow::sm
+    void StartTrace(uint32_t threads = 0);
+    // Smooth shadows, fills Shadow::sm
+    void StartSmooth(float smoothRad, bool smoothNorm, uint32_t threads = 0);
+
+    // Wait for the current step and apply its result, returns false if the step was cancelled
+    bool Finish();
+    void Cancel();
+
+    // Step is started and not finished yet
+    bool IsBusy() const;
+    // All work of the step is done, Finish will not block
+    bool IsReady() const;
+    float GetProgress() const;
+
+    // --------------------------------------------------------------------------------------------
+    // Encapsulation
+    // --------------------------------------------------------------------------------------------
+  private:
+    enum class Step
+    {
+        none,
+        trace,
+        smooth,
+    };
+
+    void Start(Step s, int32_t items, uint32_t threads);
+    void Worker();
+    // Shading of one triangle from every light, the order of accumulation is kept by Finish
+    void TraceTriangle(int32_t t, float *res) const;
+    void SmoothVertex(int32_t v, std::vector<OctFndVerts> &found) const;
+    void ApplyTrace();
+
+  private:
+    Vertex *vrt;
+    int32_t numVrt;
+    const Triangle *trg;
+    int32_t numTrg;
+    const Light *lights;
+    int32_t numLights;
+    float radius;
+
+    storm::TraceMesh mesh;
+    std::unique_ptr<OctTree> octTree;
+
+    float smoothRad;
+    bool smoothNorm;
+    // Triangle shading, numTrg * numLights
+    std::vector<float> trgShadow;
+
+    Step step;
+    int32_t numItems;
+    std::atomic<int32_t> nextItem;
+    std::atomic<int32_t> doneItems;
+    std::atomic<bool> isCancel;
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,303 @@
+//============================================================================================
+//    LightBaker
+//--------------------------------------------------------------------------------------------
+//    Shadow tracing and smoothing of the location lighter on all cores
+//============================================================================================
+
+#include "light_baker.h"
+
+#include "oct_tree.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Number of triangles or vertices taken by a worker at once
+#define LIGHTBKR_CHUNK 64
+
+// ============================================================================================
+// Construction, destruction
+// ============================================================================================
+
+LightBaker::LightBaker()
+    : octTree(std::make_unique<OctTree>())
+{
+    vrt = nullptr;
+    numVrt = 0;
+    trg = nullptr;
+    numTrg = 0;
+    lights = nullptr;
+    numLights = 0;
+    radius = 0.0f;
+    smoothRad = 0.2f;
+    smoothNorm = true;
+    step = Step::none;
+    numItems = 0;
+    nextItem = 0;
+    doneItems = 0;
+    isCancel = false;
+}
+
+LightBaker::~LightBaker()
+{
+    Cancel();
+    Finish();
+}
+
+void LightBaker::SetScene(Vertex *v, int32_t nv, const Triangle *t, int32_t nt, const Light *ls, int32_t nl)
+{
+    Cancel();
+    Finish();
+    lights = ls;
+    numLights = nl;
+    // Geometry is the same, keep the trace mesh and the tree
+    if (v == vrt && nv == numVrt && t == trg && nt == numTrg)
+        return;
+    vrt = v;
+    numVrt = nv;
+    trg = t;
+    numTrg = nt;
+    if (numVrt <= 0)
+        return;
+    // Bounds, as LGeometry calculates them
+    CVECTOR min = vrt[0].p, max = vrt[0].p;
+    for (int32_t i = 1; i < numVrt; i++)
+    {
+        min.x = std::min(min.x, vrt[i].p.x);
+        min.y = std::min(min.y, vrt[i].p.y);
+        min.z = std::min(min.z, vrt[i].p.z);
+        max.x = std::max(max.x, vrt[i].p.x);
+        max.y = std::max(max.y, vrt[i].p.y);
+        max.z = std::max(max.z, vrt[i].p.z);
+    }
+    radius = sqrtf(~(max - min));
+    // Snapshot of the geometry for tracing
+    mesh.clear();
+    mesh.reserve(numTrg);
+    for (int32_t i = 0; i < numTrg; i++)
+        mesh.addTriangle(vrt[trg[i].i[0]].p, vrt[trg[i].i[1]].p, vrt[trg[i].i[2]].p);
+    mesh.build();
+    octTree->Init(vrt, numVrt, min, max);
+}
+
+// ============================================================================================
+// Steps
+// ============================================================================================
+
+void LightBaker::StartTrace(uint32_t threads)
+{
+    Finish();
+    // Resetting the shading state
+    for (int32_t i = 0; i < numVrt; i++)
+    {
+        for (int32_t j = 0; j < numLights; j++)
+        {
+            vrt[i].shadow[j].v = 0.0;
+            vrt[i].shadow[j].nrm = 0.0;
+            vrt[i].shadow[j].sm = 0.0;
+        }
+    }
+    trgShadow.assign(static_cast<size_t>(numTrg) * numLights, 0.0f);
+    Start(Step::trace, numTrg, threads);
+}
+
+void LightBaker::StartSmooth(float rad, bool norm, uint32_t threads)
+{
+    Finish();
+    smoothRad = rad;
+    smoothNorm = norm;
+    Start(Step::smooth, numVrt, threads);
+}
+
+void LightBaker::Start(Step s, int32_t items, uint32_t threads)
+{
+    step = s;
+    numItems = items;
+    nextItem = 0;
+    doneItems = 0;
+    isCancel = false;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const auto chunks = static_cast<uint32_t>((items + LIGHTBKR_CHUNK - 1) / LIGHTBKR_CHUNK);
+    threads = std::min(threads, std::max(chunks, 1u));
+    for (uint32_t i = 0; i < threads; i++)
+        workers.emplace_back(&LightBaker::Worker, this);
+}
+
+bool LightBaker::Finish()
+{
+    for (auto &w : workers)
+        w.join();
+    workers.clear();
+    if (step == Step::none)
+        return true;
+    const auto isDone = doneItems >= numItems;
+    if (isDone && step == Step::trace)
+        ApplyTrace();
+    step = Step::none;
+    return isDone;
+}
+
+void LightBaker::Cancel()
+{
+    isCancel = true;
+}
+
+bool LightBaker::IsBusy() const
+{
+    return step != Step::none;
+}
+
+bool LightBaker::IsReady() const
+{
+    return step != Step::none && (doneItems >= numItems || isCancel);
+}
+
+float LightBaker::GetProgress() const
+{
+    if (numItems <= 0)
+        return 1.0f;
+    return std::min(doneItems.load(), numItems) / static_cast<float>(numItems);
+}
+
+void LightBaker::Worker()
+{
+    std::vector<OctFndVerts> found;
+    while (!isCancel)
+    {
+        const int32_t first = nextItem.fetch_add(LIGHTBKR_CHUNK);
+        if (first >= numItems)
+            break;
+        const int32_t last = std::min(first + LIGHTBKR_CHUNK, numItems);
+        for (int32_t i = first; i < last; i++)
+        {
+            if (step == Step::trace)
+                TraceTriangle(i, &trgShadow[static_cast<size_t>(i) * numLights]);
+            else
+                SmoothVertex(i, found);
+        }
+        doneItems += last - first;
+    }
+}
+
+// ============================================================================================
+// Tracing
+// ============================================================================================
+
+void LightBaker::TraceTriangle(int32_t idx, float *res) const
+{
+    const auto &t = trg[idx];
+    // Point from where to trace
+    auto pnt = (vrt[t.i[0]].p + vrt[t.i[1]].p + vrt[t.i[2]].p) / 3.0f;
+    pnt += t.n * 0.001f;
+    for (int32_t i = 0; i < numLights; i++)
+    {
+        const auto &lt = lights[i];
+        res[i] = 0.0f;
+        switch (lt.type)
+        {
+        case Light::t_none:
+        case Light::t_amb:
+            break;
+        case Light::t_sun:
+            if ((lt.p | t.n) >= 0.0f && mesh.trace(pnt, pnt + lt.p * radius) > 1.0f)
+                res[i] = t.sq;
+            break;
+        case Light::t_sky:
+            if (t.n.y >= 0.0f)
+            {
+                float sky = 0.0;
+                const auto rad = radius;
+                const auto rdx = radius * 0.2f;
+                if (mesh.trace(pnt, pnt + CVECTOR(0.0f, rad, 0.0f)) > 1.0f)
+                    sky += 1.0f / 5.0f;
+                if (mesh.trace(pnt, pnt + CVECTOR(rdx, rad, 0.0f)) > 1.0f)
+                    sky += 1.0f / 5.0f;
+                if (mesh.trace(pnt, pnt + CVECTOR(-rdx, rad, 0.0f)) > 1.0f)
+                    sky += 1.0f / 5.0f;
+                if (mesh.trace(pnt, pnt + CVECTOR(0.0f, rad, rdx)) > 1.0f)
+                    sky += 1.0f / 5.0f;
+                if (mesh.trace(pnt, pnt + CVECTOR(0.0f, rad, -rdx)) > 1.0f)
+                    sky += 1.0f / 5.0f;
+                res[i] = sky * t.sq;
+            }
+            break;
+        case Light::t_point:
+            if (((lt.p - pnt) | t.n) >= 0.0f && mesh.trace(pnt, lt.p) > 1.0f)
+                res[i] = t.sq;
+            break;
+        default:
+            res[i] = t.sq;
+        }
+    }
+}
+
+void LightBaker::ApplyTrace()
+{
+    // Distribute shading from triangles to vertices in the triangle order, so the sums match the serial lighter
+    for (int32_t n = 0; n < numTrg; n++)
+    {
+        const auto &t = trg[n];
+        const auto *res = &trgShadow[static_cast<size_t>(n) * numLights];
+        for (int32_t i = 0; i < numLights; i++)
+        {
+            if (lights[i].type == Light::t_none || lights[i].type == Light::t_amb)
+                continue;
+            for (int32_t k = 0; k < 3; k++)
+            {
+                vrt[t.i[k]].shadow[i].nrm += t.sq;
+                vrt[t.i[k]].shadow[i].v += res[i];
+            }
+        }
+    }
+    trgShadow.clear();
+    trgShadow.shrink_to_fit();
+    // Normalizing the result
+    for (int32_t i = 0; i < numVrt; i++)
+    {
+        for (int32_t j = 0; j < numLights; j++)
+        {
+            auto &shw = vrt[i].shadow[j];
+            if (shw.nrm > 0.0)
+                shw.v /= shw.nrm;
+            else
+                shw.v = 1.0;
+            shw.sm = shw.v;
+        }
+    }
+}
+
+// ============================================================================================
+// Smoothing
+// ============================================================================================
+
+void LightBaker::SmoothVertex(int32_t idx, std::vector<OctFndVerts> &found) const
+{
+    auto &v = vrt[idx];
+    const auto kSmoothRad = 1.0f / smoothRad;
+    // Looking for surrounding vertices
+    const auto numVerts = octTree->FindVerts(v.p, smoothRad, found);
+    // go through all the sources
+    for (int32_t n = 0; n < numLights; n++)
+    {
+        auto sm = 0.0;
+        double kNorm = 0.0f;
+        for (int32_t j = 0; j < numVerts; j++)
+        {
+            if (smoothNorm && (v.n | found[j].v->n) <= 0.6f)
+                continue;
+            double k = sqrt(found[j].r2) * kSmoothRad;
+            if (k < 0.0)
+                k = 0.0;
+            if (k > 1.0)
+                k = 1.0;
+            k = 1.0 - k;
+            sm += found[j].v->shadow[n].v * k;
+            kNorm += k;
+        }
+        if (kNorm > 0.0)
+            sm /= kNorm;
+        else
+            sm = v.shadow[n].v;
+        v.shadow[n].sm = sm;
+    }
+}
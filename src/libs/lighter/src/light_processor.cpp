@@ -10,8 +10,6 @@
 
 #include "light_processor.h"
 
-#define LIGHTPRC_TRACE_NUM 1000
-#define LIGHTPRC_SMOOTH_NUM 1000
 #define LIGHTPRC_BLUR_NUM 500
 
 // ============================================================================================
@@ -23,8 +21,8 @@ LightProcessor::LightProcessor()
 {
     geometry = nullptr;
     window = nullptr;
-    shadowTriangle = -1;
-    smoothVertex = -1;
+    isTrace = false;
+    isSmooth = false;
     blurVertex = -1;
 }
 
@@ -43,48 +41,27 @@ void LightProcessor::SetParams(LGeometry *g, Window *win, LighterLights *lit, Oc
 
 void LightProcessor::Process()
 {
-    if (shadowTriangle >= 0)
+    if (isTrace)
     {
-        if (geometry->numTrg)
+        if (!baker.IsReady())
         {
-            CalcShadows();
-            window->tracePrc = shadowTriangle / static_cast<float>(geometry->numTrg);
-        }
-        else
-            shadowTriangle = -1;
-        if (shadowTriangle == -1)
-        {
-            // Normalizing the result
-            auto *const vrt = geometry->vrt.data();
-            const auto numVrt = geometry->numVrt;
-            const auto numLights = lights->Num();
-            for (int32_t i = 0; i < numVrt; i++)
-            {
-                for (int32_t j = 0; j < numLights; j++)
-                {
-                    if (vrt[i].shadow[j].nrm > 0.0)
-                    {
-                        vrt[i].shadow[j].v /= vrt[i].shadow[j].nrm;
-                    }
-                    else
-                    {
-                        vrt[i].shadow[j].v = 1.0;
-                    }
-                    vrt[i].shadow[j].sm = vrt[i].shadow[j].v;
-                }
-            }
-            // indicate that finished
-            window->isLockCtrl = false;
-            window->tracePrc = 1.0f;
-            CalcLights();
+            window->tracePrc = baker.GetProgress();
+            return;
         }
+        baker.Finish();
+        isTrace = false;
+        // indicate that finished
+        window->isLockCtrl = false;
+        window->tracePrc = 1.0f;
+        CalcLights();
         return;
     }
-    if (smoothVertex >= 0)
+    if (isSmooth)
     {
-        SmoothShadows();
-        if (smoothVertex == -1)
+        if (baker.IsReady())
         {
+            baker.Finish();
+            isSmooth = false;
             // indicate that finished
             window->isLockCtrl = false;
             window->smoothPrc = 1.0f;
@@ -92,8 +69,9 @@ void LightProcessor::Process()
         }
         else
         {
-            if (geometry->numVrt)
-                window->smoothPrc = smoothVertex / static_cast<float>(geometry->numVrt);
+            // the shading is being written by the baker
+            window->smoothPrc = baker.GetProgress();
+            return;
         }
     }
     if (blurVertex >= 0)
@@ -114,31 +92,22 @@ void LightProcessor::Process()
     }
     if (window->isTraceShadows)
     {
-        // prepare
-        shadowTriangle = 0;
         window->isTraceShadows = false;
         window->isLockCtrl = true;
         window->tracePrc = 0.0f;
-        // Resetting the color state
-        auto *const vrt = geometry->vrt.data();
-        const auto numVrt = geometry->numVrt;
-        const auto numLights = lights->Num();
-        for (int32_t i = 0; i < numVrt; i++)
-        {
-            for (int32_t j = 0; j < numLights; j++)
-            {
-                vrt[i].shadow[j].v = 0.0f;
-                vrt[i].shadow[j].nrm = 0.0f;
-                vrt[i].shadow[j].sm = 0.0f;
-            }
-        }
+        SetBakerScene();
+        baker.StartTrace();
+        isTrace = true;
+        return;
     }
-    if (window->isSmoothShadows)
+    if (window->isSmoothShadows && !isSmooth)
     {
-        smoothVertex = 0;
         window->isSmoothShadows = false;
         window->isLockCtrl = true;
         window->smoothPrc = 0.0f;
+        SetBakerScene();
+        baker.StartSmooth(window->smoothRad, window->smoothNorm);
+        isSmooth = true;
     }
     if (window->isBlurLight)
     {
@@ -240,165 +209,22 @@ void LightProcessor::UpdateLightsParam()
     }
 }
 
-// Calculate shading
-void LightProcessor::CalcShadows()
+void LightProcessor::Bake()
 {
-    // Calculating shading
-    for (int32_t i = 0; i < LIGHTPRC_TRACE_NUM && shadowTriangle < geometry->numTrg; i++, shadowTriangle++)
-        ApplyTriangleShadows(geometry->trg[shadowTriangle]);
-    if (shadowTriangle == geometry->numTrg)
-        shadowTriangle = -1;
-}
-
-// Distribute shading from triangle to vertices
-void LightProcessor::ApplyTriangleShadows(Triangle &t)
-{
-    auto &ls = *lights;
-    const auto num = ls.Num();
-    auto *const vrt = geometry->vrt.data();
-    for (int32_t i = 0; i < num; i++)
-    {
-        // need to trace?
-        if (ls[i].type == Light::t_none || ls[i].type == Light::t_amb)
-            continue;
-        // Standardization coefficient
-        vrt[t.i[0]].shadow[i].nrm += t.sq;
-        vrt[t.i[1]].shadow[i].nrm += t.sq;
-        vrt[t.i[2]].shadow[i].nrm += t.sq;
-        // Point from where to trace
-        auto pnt = (vrt[t.i[0]].p + vrt[t.i[1]].p + vrt[t.i[2]].p) / 3.0f;
-        pnt += t.n * 0.001f;
-        // Determining shading
-        switch (ls[i].type)
-        {
-        case Light::t_sun:
-            // Sun lighting
-            if ((ls[i].p | t.n) >= 0.0f)
-            {
-                if (geometry->Trace(pnt, pnt + ls[i].p * geometry->radius) > 1.0f)
-                {
-                    vrt[t.i[0]].shadow[i].v += t.sq;
-                    vrt[t.i[1]].shadow[i].v += t.sq;
-                    vrt[t.i[2]].shadow[i].v += t.sq;
-                }
-            }
-            break;
-        case Light::t_sky:
-            // Lighting from the sky
-            if (t.n.y >= 0.0f)
-            {
-                float sky = 0.0;
-                const auto rad = geometry->radius;
-                const auto rdx = geometry->radius * 0.2f;
-                if (geometry->Trace(pnt, pnt + CVECTOR(0.0f, rad, 0.0f)) > 1.0f)
-                    sky += 1.0f / 5.0f;
-                if (geometry->Trace(pnt, pnt + CVECTOR(rdx, rad, 0.0f)) > 1.0f)
-                    sky += 1.0f / 5.0f;
-                if (geometry->Trace(pnt, pnt + CVECTOR(-rdx, rad, 0.0f)) > 1.0f)
-                    sky += 1.0f / 5.0f;
-                if (geometry->Trace(pnt, pnt + CVECTOR(0.0f, rad, rdx)) > 1.0f)
-                    sky += 1.0f / 5.0f;
-                if (geometry->Trace(pnt, pnt + CVECTOR(0.0f, rad, -rdx)) > 1.0f)
-                    sky += 1.0f / 5.0f;
-                sky *= t.sq;
-                vrt[t.i[0]].shadow[i].v += sky;
-                vrt[t.i[1]].shadow[i].v += sky;
-                vrt[t.i[2]].shadow[i].v += sky;
-            }
-            break;
-        case Light::t_point:
-            // Sun lighting
-            if (((ls[i].p - pnt) | t.n) >= 0.0f)
-            {
-                if (geometry->Trace(pnt, ls[i].p) > 1.0f)
-                {
-                    vrt[t.i[0]].shadow[i].v += t.sq;
-                    vrt[t.i[1]].shadow[i].v += t.sq;
-                    vrt[t.i[2]].shadow[i].v += t.sq;
-                }
-            }
-            break;
-        default:
-            vrt[t.i[0]].shadow[i].v += t.sq;
-            vrt[t.i[1]].shadow[i].v += t.sq;
-            vrt[t.i[2]].shadow[i].v += t.sq;
-        }
-    }
+    SetBakerScene();
+    baker.StartTrace();
+    baker.Finish();
+    window->tracePrc = 1.0f;
+    baker.StartSmooth(window->smoothRad, window->smoothNorm);
+    baker.Finish();
+    window->smoothPrc = 1.0f;
+    CalcLights();
 }
 
-// Smooth shading
-void LightProcessor::SmoothShadows()
+void LightProcessor::SetBakerScene()
 {
-    const auto lookNorm = window->smoothNorm;
-    const auto smoothRad = window->smoothRad;
-    const auto kSmoothRad = 1.0f / smoothRad;
-    double smoothRad2 = smoothRad * smoothRad;
-    auto &ls = *lights;
-    const auto num = ls.Num();
-    auto &vrt = geometry->vrt;
-    for (int32_t i = 0; i < LIGHTPRC_SMOOTH_NUM && smoothVertex < geometry->numVrt; i++, smoothVertex++)
-    {
-        auto &v = vrt[smoothVertex];
-        // Looking for surrounding vertices
-        octtree->FindVerts(v.p, smoothRad);
-        auto *const verts = octtree->verts.data();
-        const auto numVerts = octtree->numVerts;
-
-        /*if constexpr (false)
-        {
-          float r2 = smoothRad * smoothRad;
-          static Vertex* ov[16384];
-          int32_t numV = 0;
-          int32_t num = geometry->numVrt;
-          int32_t n;
-          for (n = 0; n < num; n++)
-          {
-            float r = ~(vrt[n].p - v.p);
-            if (r < r2)
-            {
-              Assert(numV < sizeof(ov)/sizeof(OctFndVerts));
-              ov[numV++] = &vrt[n];
-            }
-          }
-          if (numVerts != numV) core.Trace("numVerts(%i) != numV(%i)", numVerts, numV);
-          for (n = 0; n < numVerts; n++)
-          {
-            int32_t k;
-            for (k = 0; k < numV; k++)
-              if (verts[n].v == ov[k]) break;
-            if (k >= numV) core.Trace("k >= numV");
-          }
-        }*/
-        // Assert(numVerts > 0);
-        // go through all the sources
-        for (int32_t n = 0; n < num; n++)
-        {
-            // Set to zero
-            auto sm = 0.0;
-            double kNorm = 0.0f;
-            // All the vertices
-            for (int32_t j = 0; j < numVerts; j++)
-            {
-                if (lookNorm && (v.n | verts[j].v->n) <= 0.6f)
-                    continue;
-                double k = sqrt(verts[j].r2) * kSmoothRad;
-                if (k < 0.0)
-                    k = 0.0;
-                if (k > 1.0)
-                    k = 1.0;
-                k = 1.0 - k;
-                sm += verts[j].v->shadow[n].v * k;
-                kNorm += k;
-            }
-            if (kNorm > 0.0)
-                sm /= kNorm;
-            else
-                sm = v.shadow[n].v;
-            v.shadow[n].sm = sm;
-        }
-    }
-    if (smoothVertex >= geometry->numVrt)
-        smoothVertex = -1;
+    baker.SetScene(geometry->vrt.data(), geometry->numVrt, geometry->trg.data(), geometry->numTrg, lights->data(),
+                   lights->Num());
 }
 
 // Smooth lighting
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "l_geometry.h"
+#include "light_baker.h"
 #include "lighter_lights.h"
 #include "oct_tree.h"
 #include "window.h"
@@ -30,21 +31,19 @@ class LightProcessor
 
     // Perform Calculation Step
     void Process();
+    // Trace and smooth shadows at once, then calculate lighting
+    void Bake();
 
     // --------------------------------------------------------------------------------------------
     // Encapsulation
     // --------------------------------------------------------------------------------------------
   private:
-    // Calculate shading
-    void CalcShadows();
-    // Smooth shading
-    void SmoothShadows();
+    // Pass the prepared geometry to the baker
+    void SetBakerScene();
     // Smooth lighting
     void BlurLight();
     // Calculate lighting
     void CalcLights(int32_t lit = -1, bool isCos = true, bool isAtt = true, bool isSdw = true);
-    // Distribute shading from triangle to vertices
-    void ApplyTriangleShadows(Triangle &t);
 
   private:
     LGeometry *geometry;
@@ -52,8 +51,9 @@ class LightProcessor
     LighterLights *lights;
     VDX9RENDER *rs;
     OctTree *octtree;
+    LightBaker baker;
 
-    int32_t shadowTriangle;
-    int32_t smoothVertex;
+    bool isTrace;
+    bool isSmooth;
     int32_t blurVertex;
 };
@@ -14,6 +14,8 @@
 
 #include "entity.h"
 #include "string_compare.hpp"
+
+#include <chrono>
 // ============================================================================================
 // Construction, destruction
 // ============================================================================================
@@ -21,10 +23,11 @@
 CREATE_CLASS(Lighter)
 
 Lighter::Lighter()
-    : autoTrace(false), autoSmooth(false)
+    : autoTrace(false), autoSmooth(false), isHeadless(false)
 {
     rs = nullptr;
     initCounter = 10;
+    headlessPreset = -1;
     isInited = false;
     waitChange = 0.0f;
 }
@@ -45,6 +48,8 @@ bool Lighter::Init()
     autoSmooth = ini->GetInt(nullptr, "autosmooth", 0) != 0;
     window.isSmallSlider = ini->GetInt(nullptr, "smallslider", 0) != 0;
     geometry.useColor = ini->GetInt(nullptr, "usecolor", 0) != 0;
+    isHeadless = ini->GetInt(nullptr, "headless", 0) != 0;
+    headlessPreset = ini->GetInt(nullptr, "headlesspreset", -1);
     if (!isLoading)
         return false;
     // DX9 render
@@ -68,6 +73,16 @@ bool Lighter::Init()
 // Execution
 void Lighter::Execute(uint32_t delta_time)
 {
+    if (isHeadless)
+    {
+        // let the location add its models and lights first
+        if (!isInited && --initCounter <= 0)
+        {
+            isInited = true;
+            BakeHeadless();
+        }
+        return;
+    }
     const auto dltTime = delta_time * 0.001f;
     if (window.isSaveLight)
     {
@@ -156,7 +171,7 @@ void Lighter::PreparingData()
         window.isFailedInit = true;
         return;
     }
-    octTree.Init(&geometry);
+    octTree.Init(geometry.vrt.data(), geometry.numVrt, geometry.min, geometry.max);
     // Lighting
     lightProcessor.UpdateLightsParam();
     // Interface
@@ -165,8 +180,28 @@ void Lighter::PreparingData()
     window.isSmoothShadows = autoSmooth;
 }
 
+// Bake and save the lighting without the window
+void Lighter::BakeHeadless()
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    PreparingData();
+    if (window.isFailedInit)
+    {
+        core.Trace("Location lighter: headless bake failed, can't prepare geometry");
+        return;
+    }
+    window.LoadPreset(headlessPreset);
+    lightProcessor.Bake();
+    const auto isSaved = geometry.Save();
+    const auto time = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+    core.Trace("Location lighter: headless bake of %d vertices, %d triangles, %d lights %s in %.1f sec",
+               geometry.numVrt, geometry.numTrg, lights.Num(), isSaved ? "saved" : "not saved", time);
+}
+
 void Lighter::Realize(uint32_t delta_time)
 {
+    if (isHeadless)
+        return;
     if (core.Controls->GetAsyncKeyState(VK_DECIMAL) < 0)
     {
         window.isNoPrepared = !isInited;
@@ -55,6 +55,7 @@ class Lighter : public Entity
     void MsgLightPath(MESSAGE &message);
     void MsgAddLight(MESSAGE &message);
     void PreparingData();
+    void BakeHeadless();
 
   private:
     VDX9RENDER *rs;
@@ -66,6 +67,7 @@ class Lighter : public Entity
     LightProcessor lightProcessor;
 
     int32_t initCounter;
+    int32_t headlessPreset;
     float waitChange;
-    bool isInited, autoTrace, autoSmooth;
+    bool isInited, autoTrace, autoSmooth, isHeadless;
 };
@@ -31,6 +31,7 @@ class LighterLights
 
     int32_t Num() const;
     Light &operator[](int32_t i);
+    Light *data();
 
     // --------------------------------------------------------------------------------------------
     // Encapsulation
@@ -54,3 +55,8 @@ inline Light &LighterLights::operator[](int32_t i)
     Assert(i >= 0 && i < numLights);
     return light[i];
 }
+
+inline Light *LighterLights::data()
+{
+    return light.data();
+}
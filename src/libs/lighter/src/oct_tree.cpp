@@ -39,7 +39,6 @@ OctTree::OTNode::~OTNode()
 // ============================================================================================
 
 OctTree::OctTree()
-    : vertsPos(), vertsPosMin(), vertsPosMax(), vertsR(0)
 {
     root = nullptr;
     numVerts = 0;
@@ -54,11 +53,12 @@ OctTree::~OctTree()
 }
 
 // Initialize tree
-void OctTree::Init(LGeometry *g)
+void OctTree::Init(Vertex *v, int32_t num, const CVECTOR &min, const CVECTOR &max)
 {
-    vrt = g->vrt.data();
-    numVrt = g->numVrt;
-    root = new OTNode(g->min, g->max);
+    delete root;
+    vrt = v;
+    numVrt = num;
+    root = new OTNode(min, max);
     for (int32_t i = 0; i < numVrt; i++)
         AddVertex(root, &vrt[i]);
     Optimize(root);
@@ -126,7 +126,7 @@ bool OctTree::AddVertex(OTNode *node, Vertex *v)
             }
             Assert(c < 8);
         }
-        delete node->vrt;
+        delete[] node->vrt;
         node->vrt = nullptr;
         node->num = 0;
     }
@@ -167,33 +167,41 @@ void OctTree::Optimize(OTNode *node)
 // Find vertices in a given radius
 void OctTree::FindVerts(const CVECTOR &pos, float r)
 {
-    numVerts = 0;
-    vertsPos = pos;
-    vertsR = r * r;
+    numVerts = FindVerts(pos, r, verts);
+    maxVerts = static_cast<int32_t>(verts.size());
+}
+
+int32_t OctTree::FindVerts(const CVECTOR &pos, float r, std::vector<OctFndVerts> &res) const
+{
+    Query q;
+    q.pos = pos;
+    q.r2 = r * r;
     r += 0.000001f;
-    vertsPosMin = pos - CVECTOR(r);
-    vertsPosMax = pos + CVECTOR(r);
+    q.min = pos - CVECTOR(r);
+    q.max = pos + CVECTOR(r);
+    int32_t num = 0;
     if (root)
-        FindVerts(root);
+        FindVerts(root, q, res, num);
+    return num;
 }
 
 // Search
-void OctTree::FindVerts(OTNode *node)
+void OctTree::FindVerts(const OTNode *node, const Query &q, std::vector<OctFndVerts> &res, int32_t &num)
 {
     auto &min = node->min;
     auto &max = node->max;
     // Preliminary check
-    if (vertsPosMin.x > max.x)
+    if (q.min.x > max.x)
         return;
-    if (vertsPosMax.x < min.x)
+    if (q.max.x < min.x)
         return;
-    if (vertsPosMin.y > max.y)
+    if (q.min.y > max.y)
         return;
-    if (vertsPosMax.y < min.y)
+    if (q.max.y < min.y)
         return;
-    if (vertsPosMin.z > max.z)
+    if (q.min.z > max.z)
         return;
-    if (vertsPosMax.z < min.z)
+    if (q.max.z < min.z)
         return;
     // Refined check
 
@@ -202,22 +210,19 @@ void OctTree::FindVerts(OTNode *node)
     {
         for (int32_t i = 0; i < 8; i++)
             if (node->node[i])
-                FindVerts(node->node[i]);
+                FindVerts(node->node[i], q, res, num);
     }
     else
     {
         for (int32_t i = 0; i < node->num; i++)
         {
-            const auto r = ~(node->vrt[i]->p - vertsPos);
-            if (r < vertsR)
+            const auto r = ~(node->vrt[i]->p - q.pos);
+            if (r < q.r2)
             {
-                if (numVerts >= maxVerts)
-                {
-                    maxVerts += 1024;
-                    verts.resize(maxVerts);
-                }
-                verts[numVerts].v = node->vrt[i];
-                verts[numVerts++].r2 = r;
+                if (num >= static_cast<int32_t>(res.size()))
+                    res.resize(res.size() + 1024);
+                res[num].v = node->vrt[i];
+                res[num++].r2 = r;
             }
         }
     }
@@ -10,7 +10,9 @@
 
 #pragma once
 
-#include "l_geometry.h"
+#include "l_types.h"
+
+#include <vector>
 
 class OctTree
 {
@@ -33,9 +35,11 @@ class OctTree
     virtual ~OctTree();
 
     // Initialize tree
-    void Init(LGeometry *g);
+    void Init(Vertex *v, int32_t num, const CVECTOR &min, const CVECTOR &max);
     // Find vertices in a given radius
     void FindVerts(const CVECTOR &pos, float r);
+    // Find vertices in a given radius, safe to call from several threads
+    int32_t FindVerts(const CVECTOR &pos, float r, std::vector<OctFndVerts> &res) const;
 
     std::vector<OctFndVerts> verts;
     int32_t numVerts;
@@ -45,12 +49,18 @@ class OctTree
     // Encapsulation
     // --------------------------------------------------------------------------------------------
   private:
+    struct Query
+    {
+        CVECTOR pos, min, max;
+        float r2;
+    };
+
     // Adding vertices
     bool AddVertex(OTNode *node, Vertex *v);
     // Optimizing the tree
     void Optimize(OTNode *node);
     // Search
-    void FindVerts(OTNode *node);
+    static void FindVerts(const OTNode *node, const Query &q, std::vector<OctFndVerts> &res, int32_t &num);
 
     int32_t Check(OTNode *node, Vertex *v, int32_t num);
 
@@ -58,6 +68,4 @@ class OctTree
     Vertex *vrt;
     int32_t numVrt;
     OTNode *root;
-    CVECTOR vertsPos, vertsPosMin, vertsPosMax;
-    float vertsR;
 };
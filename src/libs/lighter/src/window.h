@@ -71,6 +71,7 @@ class Window
     void InitList(LighterLights &ls);
     void Draw(float dltTime);
     void Reset(bool isVis);
+    void LoadPreset(int32_t prs);
 
     // Checkboxes controlling actions
     bool isNeedInit;
@@ -118,7 +119,6 @@ class Window
     int32_t SelPreset();
 
     void SavePreset(int32_t prs);
-    void LoadPreset(int32_t prs);
 
     char *GenerateName(const char *f, const char *n);
 
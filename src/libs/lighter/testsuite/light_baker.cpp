@@ -0,0 +1,413 @@
+#include "light_baker.h"
+
+#include "geos.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace
+{
+
+template <typename T> void Put(std::vector<char> &data, const T &value)
+{
+    const auto *p = reinterpret_cast<const char *>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+// a geometry file of one collision triangle, as the RDF format lays it out: a BSP of one node on the plane of the face
+std::vector<char> TriangleFile(const CVECTOR &v0, const CVECTOR &v1, const CVECTOR &v2)
+{
+    constexpr int32_t kRdfVersion = ('1' << 24) | ('.' << 16) | ('0' << 8) | '5';
+    constexpr int32_t kBspPresent = 2;
+
+    std::vector<char> data;
+    Put(data, kRdfVersion);
+    Put(data, kBspPresent);
+    for (int32_t i = 0; i < 9; i++) // names, textures, materials, lights, labels, objects, triangles, vertex buffers
+        Put(data, int32_t(0));
+    for (int32_t i = 0; i < 7; i++) // bounding box and radius
+        Put(data, 0.0f);
+
+    Put(data, int32_t(1)); // nodes
+    Put(data, int32_t(3)); // vertices
+    Put(data, int32_t(1)); // triangles
+    const auto norm = !((v1 - v0) ^ (v2 - v0));
+    Put(data, norm);
+    Put(data, norm | v0);
+    Put(data, uint32_t(1) << 24); // no children, one face
+    Put(data, int32_t(0));
+    Put(data, v0);
+    Put(data, v1);
+    Put(data, v2);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const uint8_t index[3] = {i, 0, 0};
+        Put(data, index);
+    }
+    return data;
+}
+
+// geometry service without a device, collision geometry needs only memory and files
+class GeometryService final : public GEOM_SERVICE
+{
+  public:
+    bool LoadFile(const char *fname, std::vector<char> &data) override
+    {
+        const auto it = files.find(fname);
+        if (it == files.end())
+            return false;
+        data = it->second;
+        return true;
+    }
+
+    void *malloc(int32_t bytes) override
+    {
+        return std::malloc(std::max(bytes, 1));
+    }
+
+    void free(void *ptr) override
+    {
+        std::free(ptr);
+    }
+
+    GEOS::ID CreateTexture(const char *) override
+    {
+        return -1;
+    }
+    void ReleaseTexture(GEOS::ID) override
+    {
+    }
+    void SetMaterial(const GEOS::MATERIAL &) override
+    {
+    }
+
+    GEOS::ID CreateVertexBuffer(int32_t, int32_t) override
+    {
+        return -1;
+    }
+    void *LockVertexBuffer(GEOS::ID) override
+    {
+        return nullptr;
+    }
+    void UnlockVertexBuffer(GEOS::ID) override
+    {
+    }
+    void ReleaseVertexBuffer(GEOS::ID) override
+    {
+    }
+
+    GEOS::ID CreateIndexBuffer(int32_t) override
+    {
+        return -1;
+    }
+    void *LockIndexBuffer(GEOS::ID) override
+    {
+        return nullptr;
+    }
+    void UnlockIndexBuffer(GEOS::ID) override
+    {
+    }
+    void ReleaseIndexBuffer(GEOS::ID) override
+    {
+    }
+
+    void SetIndexBuffer(GEOS::ID) override
+    {
+    }
+    void SetVertexBuffer(int32_t, GEOS::ID) override
+    {
+    }
+    void DrawIndexedPrimitive(int32_t, int32_t, int32_t, int32_t, int32_t) override
+    {
+    }
+
+    GEOS::ID CreateLight(GEOS::LIGHT) override
+    {
+        return -1;
+    }
+    void ActivateLight(GEOS::ID) override
+    {
+    }
+
+    void SetCausticMode(bool) override
+    {
+    }
+
+    std::map<std::string, std::vector<char>> files;
+};
+
+// the models of a location as the lighter traces them, every triangle is a model of its own
+class LocationGeometry
+{
+  public:
+    LocationGeometry(const std::vector<Vertex> &vrt, const std::vector<Triangle> &trg)
+    {
+        for (size_t i = 0; i < trg.size(); i++)
+        {
+            const auto name = std::to_string(i);
+            service_.files[name] = TriangleFile(vrt[trg[i].i[0]].p, vrt[trg[i].i[1]].p, vrt[trg[i].i[2]].p);
+            objects_.emplace_back(CreateGeometry(name.c_str(), nullptr, service_, 0));
+        }
+    }
+
+    // LGeometry::Trace
+    float Trace(const CVECTOR &src, const CVECTOR &dst) const
+    {
+        GEOS::VERTEX s{src.x, src.y, src.z};
+        GEOS::VERTEX d{dst.x, dst.y, dst.z};
+        for (const auto &object : objects_)
+        {
+            const auto res = object->Trace(s, d);
+            if (res <= 1.0f)
+                return res;
+        }
+        return 2.0f;
+    }
+
+  private:
+    GeometryService service_;
+    std::vector<std::unique_ptr<GEOS>> objects_;
+};
+
+// Ground grid under a floating roof, lit by the sun, the sky and a lamp under the roof
+struct Scene
+{
+    std::vector<Vertex> vrt;
+    std::vector<Triangle> trg;
+    std::vector<Light> lights;
+    std::vector<lighter::Shadow> shadows;
+
+    void AddQuad(const CVECTOR &p, const CVECTOR &du, const CVECTOR &dv, int32_t cells)
+    {
+        const auto base = static_cast<int32_t>(vrt.size());
+        const auto n = !(dv ^ du);
+        for (int32_t v = 0; v <= cells; v++)
+            for (int32_t u = 0; u <= cells; u++)
+            {
+                Vertex vr{};
+                vr.p = p + du * (static_cast<float>(u) / cells) + dv * (static_cast<float>(v) / cells);
+                vr.n = n;
+                vrt.push_back(vr);
+            }
+        for (int32_t v = 0; v < cells; v++)
+            for (int32_t u = 0; u < cells; u++)
+            {
+                const int32_t i0 = base + v * (cells + 1) + u;
+                const int32_t idx[2][3] = {{i0, i0 + cells + 1, i0 + 1}, {i0 + 1, i0 + cells + 1, i0 + cells + 2}};
+                for (const auto &id : idx)
+                {
+                    Triangle t{};
+                    const auto nrm = (vrt[id[1]].p - vrt[id[0]].p) ^ (vrt[id[2]].p - vrt[id[0]].p);
+                    t.sq = sqrtf(~nrm);
+                    t.n = nrm * (1.0f / t.sq);
+                    t.i[0] = id[0];
+                    t.i[1] = id[1];
+                    t.i[2] = id[2];
+                    trg.push_back(t);
+                }
+            }
+    }
+
+    Scene()
+    {
+        AddQuad(CVECTOR(-10.0f, 0.0f, -10.0f), CVECTOR(20.0f, 0.0f, 0.0f), CVECTOR(0.0f, 0.0f, 20.0f), 24);
+        AddQuad(CVECTOR(-3.0f, 4.0f, -3.0f), CVECTOR(6.0f, 0.0f, 0.0f), CVECTOR(0.0f, 0.0f, 6.0f), 6);
+
+        Light lt{};
+        lt.type = Light::t_amb;
+        lights.push_back(lt);
+        lt.type = Light::t_sun;
+        lt.p = !CVECTOR(0.3f, 1.0f, 0.2f);
+        lights.push_back(lt);
+        lt.type = Light::t_sky;
+        lights.push_back(lt);
+        lt.type = Light::t_point;
+        lt.p = CVECTOR(1.0f, 2.0f, 0.5f);
+        lights.push_back(lt);
+
+        shadows.resize(vrt.size() * lights.size());
+        for (size_t i = 0; i < vrt.size(); i++)
+            vrt[i].shadow = &shadows[i * lights.size()];
+    }
+
+    float Radius() const
+    {
+        CVECTOR min = vrt[0].p, max = vrt[0].p;
+        for (const auto &v : vrt)
+        {
+            min = CVECTOR(std::min(min.x, v.p.x), std::min(min.y, v.p.y), std::min(min.z, v.p.z));
+            max = CVECTOR(std::max(max.x, v.p.x), std::max(max.y, v.p.y), std::max(max.z, v.p.z));
+        }
+        return sqrtf(~(max - min));
+    }
+
+    // Reference: the serial shading of the interactive lighter
+    void ReferenceTrace()
+    {
+        const LocationGeometry geometry(vrt, trg);
+        const auto radius = Radius();
+        for (auto &s : shadows)
+            s = lighter::Shadow{};
+        for (const auto &t : trg)
+        {
+            for (size_t i = 0; i < lights.size(); i++)
+            {
+                if (lights[i].type == Light::t_amb)
+                    continue;
+                float add = 0.0f;
+                auto pnt = (vrt[t.i[0]].p + vrt[t.i[1]].p + vrt[t.i[2]].p) / 3.0f;
+                pnt += t.n * 0.001f;
+                switch (lights[i].type)
+                {
+                case Light::t_sun:
+                    if ((lights[i].p | t.n) >= 0.0f && geometry.Trace(pnt, pnt + lights[i].p * radius) > 1.0f)
+                        add = t.sq;
+                    break;
+                case Light::t_sky:
+                    if (t.n.y >= 0.0f)
+                    {
+                        float sky = 0.0f;
+                        const auto rdx = radius * 0.2f;
+                        const CVECTOR dirs[] = {CVECTOR(0.0f, radius, 0.0f), CVECTOR(rdx, radius, 0.0f),
+                                                CVECTOR(-rdx, radius, 0.0f), CVECTOR(0.0f, radius, rdx),
+                                                CVECTOR(0.0f, radius, -rdx)};
+                        for (const auto &d : dirs)
+                            if (geometry.Trace(pnt, pnt + d) > 1.0f)
+                                sky += 1.0f / 5.0f;
+                        add = sky * t.sq;
+                    }
+                    break;
+                case Light::t_point:
+                    if (((lights[i].p - pnt) | t.n) >= 0.0f && geometry.Trace(pnt, lights[i].p) > 1.0f)
+                        add = t.sq;
+                    break;
+                default:
+                    break;
+                }
+                for (const auto k : t.i)
+                {
+                    vrt[k].shadow[i].nrm += t.sq;
+                    vrt[k].shadow[i].v += add;
+                }
+            }
+        }
+        for (auto &s : shadows)
+        {
+            s.v = s.nrm > 0.0 ? s.v / s.nrm : 1.0;
+            s.sm = s.v;
+        }
+    }
+
+    void ReferenceSmooth(float rad)
+    {
+        for (auto &v : vrt)
+            for (size_t n = 0; n < lights.size(); n++)
+            {
+                double sm = 0.0, kNorm = 0.0;
+                for (const auto &o : vrt)
+                {
+                    const auto r2 = ~(o.p - v.p);
+                    if (r2 >= rad * rad || (v.n | o.n) <= 0.6f)
+                        continue;
+                    const double k = 1.0 - std::min(1.0, sqrt(r2) / static_cast<double>(rad));
+                    sm += o.shadow[n].v * k;
+                    kNorm += k;
+                }
+                v.shadow[n].sm = kNorm > 0.0 ? sm / kNorm : v.shadow[n].v;
+            }
+    }
+};
+
+} // namespace
+
+TEST_CASE("Light baker matches the serial lighter on LGeometry::Trace", "[lighter]")
+{
+    Scene reference;
+    reference.ReferenceTrace();
+
+    Scene scene;
+    LightBaker baker;
+    baker.SetScene(scene.vrt.data(), static_cast<int32_t>(scene.vrt.size()), scene.trg.data(),
+                   static_cast<int32_t>(scene.trg.size()), scene.lights.data(),
+                   static_cast<int32_t>(scene.lights.size()));
+
+    baker.StartTrace(4);
+    REQUIRE(baker.Finish());
+    CHECK(baker.GetProgress() == 1.0f);
+
+    int32_t shaded = 0;
+    for (size_t i = 0; i < scene.shadows.size(); i++)
+    {
+        CHECK(scene.shadows[i].v == reference.shadows[i].v);
+        CHECK(scene.shadows[i].nrm == reference.shadows[i].nrm);
+        if (scene.shadows[i].v < 0.5)
+            shaded++;
+    }
+    // the roof casts a shadow on the ground
+    CHECK(shaded > 0);
+
+    SECTION("Smoothing")
+    {
+        reference.ReferenceSmooth(0.9f);
+        baker.StartSmooth(0.9f, true, 3);
+        REQUIRE(baker.Finish());
+        for (size_t i = 0; i < scene.shadows.size(); i++)
+            CHECK(scene.shadows[i].sm == Approx(reference.shadows[i].sm).margin(1e-9));
+    }
+
+    SECTION("Thread count does not change the result")
+    {
+        const auto first = scene.shadows;
+        baker.StartTrace(1);
+        REQUIRE(baker.Finish());
+        for (size_t i = 0; i < first.size(); i++)
+            CHECK(scene.shadows[i].v == first[i].v);
+    }
+
+    SECTION("Cancel")
+    {
+        baker.StartTrace(2);
+        baker.Cancel();
+        CHECK(baker.IsReady());
+        baker.Finish();
+        CHECK_FALSE(baker.IsBusy());
+    }
+}
+
+TEST_CASE("Shadow rays through edges hit what LGeometry::Trace hits", "[lighter]")
+{
+    Scene scene;
+    const LocationGeometry geometry(scene.vrt, scene.trg);
+    // the mesh the baker traces
+    storm::TraceMesh mesh;
+    for (const auto &t : scene.trg)
+        mesh.addTriangle(scene.vrt[t.i[0]].p, scene.vrt[t.i[1]].p, scene.vrt[t.i[2]].p);
+    mesh.build();
+
+    // vertical rays through the vertices, the edges and the faces of the roof and past it, down to its front faces
+    // and up to its back faces
+    int32_t frontHits = 0, backHits = 0, backMisses = 0;
+    for (int32_t z = -14; z <= 14; z++)
+        for (int32_t x = -14; x <= 14; x++)
+        {
+            const CVECTOR p(x * 0.25f, 4.0f, z * 0.25f);
+            const CVECTOR up(0.0f, 1.0f, 0.0f);
+            const auto down = geometry.Trace(p + up, p - up);
+            const auto upward = geometry.Trace(p - up, p + up);
+            CHECK(mesh.trace(p + up, p - up) == down);
+            CHECK(mesh.trace(p - up, p + up) == upward);
+            frontHits += down <= 1.0f;
+            if (std::abs(x) < 12 && std::abs(z) < 12)
+                (upward <= 1.0f ? backHits : backMisses)++;
+        }
+    // the roof is hit everywhere from above, and from below only inside its faces
+    CHECK(frontHits == 25 * 25);
+    CHECK(backHits > 0);
+    CHECK(backMisses > 0);
+}
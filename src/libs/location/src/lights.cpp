@@ -55,6 +55,7 @@ bool Lights::Init()
     if (!rs)
         throw std::runtime_error("No service: dx9render");
     collide = static_cast<COLLIDE *>(core.GetService("COLL"));
+    sunTrace = core.GetLayerSnapshot(SUN_TRACE);
     // read the parameters
     auto ini = fio->OpenIniFile("RESOURCE\\Ini\\lights.ini");
     if (!ini)
@@ -237,6 +238,7 @@ void Lights::Realize(uint32_t delta_time)
     rs->SetTransform(D3DTS_VIEW, CMatrix());
     rs->SetTransform(D3DTS_WORLD, CMatrix());
     const auto camPDist = -(pos.x * camMtx.Vx().z + pos.y * camMtx.Vy().z + pos.z * camMtx.Vz().z);
+    sunTrace.update();
     for (int32_t i = 0, n = 0; i < numLights; i++)
     {
         // Source
@@ -260,8 +262,8 @@ void Lights::Realize(uint32_t delta_time)
         // Visibility
         if (collide)
         {
-            const auto dist = collide->Trace(core.GetEntityIds(SUN_TRACE), pos,
-                                             CVECTOR(ls.pos.x, ls.pos.y, ls.pos.z), lampModels, numLampModels);
+            const auto dist = collide->Trace(sunTrace.ids(), pos, CVECTOR(ls.pos.x, ls.pos.y, ls.pos.z), lampModels,
+                                             numLampModels);
             isVisible = dist > 1.0f;
         }
         ls.corona += isVisible ? 0.008f * delta_time : -0.008f * delta_time;
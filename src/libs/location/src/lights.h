@@ -15,6 +15,7 @@
 
 #include "collide.h"
 #include "dx9render.h"
+#include "entity_layer.h"
 
 class Lights : public Entity
 {
@@ -160,6 +161,8 @@ class Lights : public Entity
 
     VDX9RENDER *rs;
     COLLIDE *collide;
+    // what the coronas are traced against
+    storm::LayerSnapshot sunTrace;
 
     // Installed light sources
     struct
@@ -751,7 +751,7 @@ void Player::FireFromShootgun()
     ChrsDmg chrs[16];
     int32_t numChrs = 0;
 
-    const auto ids = core.GetEntityIds(SUN_TRACE);
+    const auto ids = core.GetLayerSnapshot(SUN_TRACE);
     for (int32_t i = 0; i < 6; i++)
     {
         // Get the position where the buckshot will fall
@@ -761,7 +761,7 @@ void Player::FireFromShootgun()
         if (collide)
         {
             auto id = GetId();
-            const auto dist = collide->Trace(ids, src, dst, &id, 0);
+            const auto dist = collide->Trace(ids.ids(), src, dst, &id, 0);
             if (dist <= 1.0f && dist > (0.2f / 25.0f))
             {
                 auto dir = !(src - dst);
@@ -108,6 +108,10 @@ class MODEL : public COLLISION_OBJECT
     bool Clip(const PLANE *planes, int32_t nplanes, const CVECTOR &center, float radius,
               ADD_POLYGON_FUNC addpoly) override = 0;
 
+    // the collision triangles of the nodes open to clipping in global space, three vertices each, all of them unlike
+    // Clip which leaves out the faces past the limits of GEOM
+    virtual void GetTriangles(std::vector<CVECTOR> &vertices) = 0;
+
     const char *GetCollideMaterialName() override = 0;
     bool GetCollideTriangle(TRIANGLE &triangle) override = 0;
 
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Draws of a model collected during a frame and issued sorted by technique, material and buffers
+ *
+ * Every item names the state it needs (transform, technique and the like, kept by the caller under an index) and its
+ * material. The queue sets a state or a material only when it differs from the one of the previous draw, and items of
+ * one state and material that follow each other in the same buffers are drawn at once. Items marked as ordered, and
+ * items of a technique that blends, are drawn last in the order they were added, only joined with the item before.
+ *
+ * Each model has a queue of its own and flushes it at the end of its Realize. Sorting across models and instancing
+ * equal geometry of different models are not done yet: the owners of the models set lights, fog and render tuners
+ * around each model, and the model techniques read no per-instance streams.
+ */
+class RenderQueue final
+{
+  public:
+    // what setting the material depends on, equal materials are set once
+    struct Material
+    {
+        std::array<int32_t, 4> textures{};
+        std::array<int32_t, 4> types{};
+        float diffuse = 0.0f;
+        float specular = 0.0f;
+        float gloss = 0.0f;
+        // the material function and the material it is called with, when there is a function
+        const void *func = nullptr;
+        const void *source = nullptr;
+
+        auto operator<=>(const Material &) const = default;
+    };
+
+    struct Item
+    {
+        uint32_t state = 0;
+        uint32_t technique = 0;
+        Material material;
+        int32_t vertexBuffer = -1;
+        int32_t stride = 0;
+        int32_t indexBuffer = -1;
+        // base vertex and count, first index and triangles
+        int32_t minVertex = 0;
+        int32_t numVertices = 0;
+        int32_t startIndex = 0;
+        int32_t numTriangles = 0;
+        bool ordered = false;
+        // for the target, the geometry and its object
+        const void *source = nullptr;
+        int32_t object = 0;
+    };
+
+    class Target
+    {
+      public:
+        virtual ~Target() = default;
+        virtual void setState(uint32_t state) = 0;
+        virtual void setMaterial(const Item &item) = 0;
+        virtual void draw(const Item &item) = 0;
+    };
+
+    struct Counters
+    {
+        uint64_t items = 0;
+        uint64_t draws = 0;
+        uint64_t states = 0;
+        uint64_t materials = 0;
+        // items drawn together with the one before
+        uint64_t merged = 0;
+    };
+
+    // the sort key of a technique, the same for the same name; draws of a blending technique are ordered
+    uint32_t technique(std::string_view name, bool blended = false)
+    {
+        return technique(name, [blended] { return blended; });
+    }
+
+    // the same, blended is asked only the first time the name is seen
+    template <typename Blended> uint32_t technique(std::string_view name, Blended &&blended)
+    {
+        if (const auto it = techniques_.find(name); it != techniques_.end())
+            return it->second;
+        const auto id = static_cast<uint32_t>(techniques_.size());
+        techniques_.emplace(name, id);
+        blended_.push_back(blended());
+        return id;
+    }
+
+    void add(const Item &item);
+    [[nodiscard]] bool empty() const
+    {
+        return items_.empty();
+    }
+
+    // draws the items and forgets them
+    void flush(Target &target);
+
+    [[nodiscard]] const Counters &counters() const
+    {
+        return counters_;
+    }
+
+  private:
+    std::vector<Item> items_;
+    std::vector<uint32_t> order_;
+    // looked up by the name without making a string of it
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> techniques_;
+    std::vector<bool> blended_;
+    Counters counters_;
+};
+
+} // namespace storm
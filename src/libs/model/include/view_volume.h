@@ -0,0 +1,66 @@
+#pragma once
+
+#include "geos.h"
+#include "matrix.h"
+
+#include <cstdint>
+
+namespace storm
+{
+
+/**
+ * \brief The view of a frame as the models cull against it
+ *
+ * Keeps the four side planes in the form GEOS::Draw takes them, the near and far distances of the projection and the
+ * scale that turns a radius at a distance into a part of the screen. A sphere is outside when it is beyond one of the
+ * planes, inside when it is within all of them.
+ */
+class ViewVolume final
+{
+  public:
+    enum class Cull
+    {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+    // from the view and projection transforms, returns false when they are the ones of the last setup
+    bool setup(const CMatrix &view, const CMatrix &proj);
+
+    [[nodiscard]] Cull cull(const CVECTOR &center, float radius) const;
+
+    // radius of the sphere on the screen as a part of half of the screen height
+    [[nodiscard]] float projectedSize(const CVECTOR &center, float radius) const;
+
+    [[nodiscard]] const GEOS::PLANE *sidePlanes() const
+    {
+        return planes_;
+    }
+
+    [[nodiscard]] const CVECTOR &position() const
+    {
+        return position_;
+    }
+
+  private:
+    [[nodiscard]] float depth(const CVECTOR &point) const;
+
+    CMatrix view_;
+    CMatrix proj_;
+    bool valid_ = false;
+
+    GEOS::PLANE planes_[4]{};
+    CVECTOR position_;
+    CVECTOR forward_;
+    float forwardD_ = 0.0f;
+    // 0 and a negative far for a projection without them
+    float near_ = 0.0f;
+    float far_ = -1.0f;
+    float scale_ = 1.0f;
+};
+
+// the detail level for a projected size, 0 for the full geometry, never more than levels
+uint32_t SelectDetailLevel(float projectedSize, uint32_t levels);
+
+} // namespace storm
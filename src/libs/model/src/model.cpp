@@ -165,8 +165,6 @@ void SetChildrenTechnique(NODE *_root, const char *_name)
 //-----------------------------------------------------------------------------------
 // realize
 //-----------------------------------------------------------------------------------
-GEOS::PLANE ViewPlane[4];
-
 void MODELR::Realize(uint32_t Delta_Time)
 {
     // GUARD(MODELR::Realize)
@@ -219,6 +217,8 @@ void MODELR::Realize(uint32_t Delta_Time)
 
     CVECTOR tmp;
     root->Update(mtx, tmp);
+    // the whole model against the view before its nodes
+    const auto cull = NODER::view.cull(root->glob_mtx * root->center, root->radius);
 
     // if have animation - special render
     if (ani)
@@ -272,8 +272,16 @@ void MODELR::Realize(uint32_t Delta_Time)
             aniPos[1] = -2.0f;
         }
     }
-    else
-        root->Draw();
+    else if (cull != storm::ViewVolume::Cull::Outside)
+    {
+        rs->GetRenderState(D3DRS_TEXTUREFACTOR, &drawList.dwTextureFactor);
+        // with blending left on by the owner of the model, techniques that leave it alone blend as well
+        uint32_t dwAlphaBlend;
+        rs->GetRenderState(D3DRS_ALPHABLENDENABLE, &dwAlphaBlend);
+        drawList.bOrdered = useBlend || dwAlphaBlend != FALSE;
+        root->Draw(&drawList, cull == storm::ViewVolume::Cull::Inside);
+        DrawList();
+    }
 
     if (renderTuner)
         renderTuner->Restore(this, rs);
@@ -287,6 +295,79 @@ void MODELR::Realize(uint32_t Delta_Time)
     // UNGUARD
 }
 
+namespace
+{
+
+// sets the state of the nodes for the draws of the render queue
+class NodeDrawTarget final : public storm::RenderQueue::Target
+{
+  public:
+    NodeDrawTarget(const MODEL_DRAW_LIST &list, VDX9RENDER *rs, VGEOMETRY *gs, uint32_t dwTextureFactor)
+        : list_(list), rs_(rs), gs_(gs), dwTextureFactor_(dwTextureFactor)
+    {
+    }
+
+    void setState(uint32_t state) override
+    {
+        const auto &nodeState = list_.states[state];
+        rs_->SetTransform(D3DTS_WORLD, (D3DMATRIX *)nodeState.mtx);
+        gs_->SetTechnique(nodeState.technique);
+        if (nodeState.dwTextureFactor != dwTextureFactor_)
+        {
+            dwTextureFactor_ = nodeState.dwTextureFactor;
+            rs_->SetRenderState(D3DRS_TEXTUREFACTOR, dwTextureFactor_);
+        }
+    }
+
+    void setMaterial(const storm::RenderQueue::Item &item) override
+    {
+        bMaterial_ = true;
+    }
+
+    void draw(const storm::RenderQueue::Item &item) override
+    {
+        auto obj = list_.objects[item.object];
+        obj.num_vertices = item.numVertices;
+        obj.ntriangles = item.numTriangles;
+        static_cast<const GEOS *>(item.source)->DrawObject(obj, bMaterial_, list_.states[item.state].mtf);
+        bMaterial_ = false;
+    }
+
+    [[nodiscard]] uint32_t GetTextureFactor() const
+    {
+        return dwTextureFactor_;
+    }
+
+  private:
+    const MODEL_DRAW_LIST &list_;
+    VDX9RENDER *rs_;
+    VGEOMETRY *gs_;
+    uint32_t dwTextureFactor_;
+    bool bMaterial_ = false;
+};
+
+} // namespace
+
+void MODELR::DrawList()
+{
+    if (!drawList.states.empty())
+    {
+        uint32_t dwTextureFactor;
+        rs->GetRenderState(D3DRS_TEXTUREFACTOR, &dwTextureFactor);
+        NodeDrawTarget target(drawList, rs, GeometyService, dwTextureFactor);
+        drawList.queue.flush(target);
+
+        // the state the last node left, as when the nodes drew themselves
+        const auto &last = drawList.states.back();
+        rs->SetTransform(D3DTS_WORLD, (D3DMATRIX *)last.mtx);
+        GeometyService->SetTechnique(last.technique);
+        if (target.GetTextureFactor() != drawList.dwTextureFactor)
+            rs->SetRenderState(D3DRS_TEXTUREFACTOR, drawList.dwTextureFactor);
+    }
+    drawList.states.clear();
+    drawList.objects.clear();
+}
+
 Animation *MODELR::GetAnimation()
 {
     return ani;
@@ -490,6 +571,11 @@ bool MODELR::Clip(const PLANE *planes, int32_t nplanes, const CVECTOR &center, f
     return root->Clip();
 }
 
+void MODELR::GetTriangles(std::vector<CVECTOR> &vertices)
+{
+    static_cast<NODER *>(root)->GetTriangles(vertices);
+}
+
 extern NODE *bestTraceNode;
 //-------------------------------------------------------------------
 const char *MODELR::GetCollideMaterialName()
@@ -677,67 +763,12 @@ NODE *MODELR::GetCollideNode()
 
 void MODELR::FindPlanes(const CMatrix &view, const CMatrix &proj)
 {
-    CVECTOR v[4];
-    // left
-    v[0].x = proj.m[0][0];
-    v[0].y = 0.0f;
-    v[0].z = 1.0f;
-    // right
-    v[1].x = -proj.m[0][0];
-    v[1].y = 0.0f;
-    v[1].z = 1.0f;
-    // top
-    v[2].x = 0.0f;
-    v[2].y = -proj.m[1][1];
-    v[2].z = 1.0f;
-    // bottom
-    v[3].x = 0.0f;
-    v[3].y = proj.m[1][1];
-    v[3].z = 1.0f;
-    v[0] = !v[0];
-    v[1] = !v[1];
-    v[2] = !v[2];
-    v[3] = !v[3];
-
-    CVECTOR pos;
-
-    pos.x = -view.m[3][0] * view.m[0][0] - view.m[3][1] * view.m[0][1] - view.m[3][2] * view.m[0][2];
-    pos.y = -view.m[3][0] * view.m[1][0] - view.m[3][1] * view.m[1][1] - view.m[3][2] * view.m[1][2];
-    pos.z = -view.m[3][0] * view.m[2][0] - view.m[3][1] * view.m[2][1] - view.m[3][2] * view.m[2][2];
-
-    ViewPlane[0].nrm.x = v[0].x * view.m[0][0] + v[0].y * view.m[0][1] + v[0].z * view.m[0][2];
-    ViewPlane[0].nrm.y = v[0].x * view.m[1][0] + v[0].y * view.m[1][1] + v[0].z * view.m[1][2];
-    ViewPlane[0].nrm.z = v[0].x * view.m[2][0] + v[0].y * view.m[2][1] + v[0].z * view.m[2][2];
-
-    ViewPlane[1].nrm.x = v[1].x * view.m[0][0] + v[1].y * view.m[0][1] + v[1].z * view.m[0][2];
-    ViewPlane[1].nrm.y = v[1].x * view.m[1][0] + v[1].y * view.m[1][1] + v[1].z * view.m[1][2];
-    ViewPlane[1].nrm.z = v[1].x * view.m[2][0] + v[1].y * view.m[2][1] + v[1].z * view.m[2][2];
-
-    ViewPlane[2].nrm.x = v[2].x * view.m[0][0] + v[2].y * view.m[0][1] + v[2].z * view.m[0][2];
-    ViewPlane[2].nrm.y = v[2].x * view.m[1][0] + v[2].y * view.m[1][1] + v[2].z * view.m[1][2];
-    ViewPlane[2].nrm.z = v[2].x * view.m[2][0] + v[2].y * view.m[2][1] + v[2].z * view.m[2][2];
-
-    ViewPlane[3].nrm.x = v[3].x * view.m[0][0] + v[3].y * view.m[0][1] + v[3].z * view.m[0][2];
-    ViewPlane[3].nrm.y = v[3].x * view.m[1][0] + v[3].y * view.m[1][1] + v[3].z * view.m[1][2];
-    ViewPlane[3].nrm.z = v[3].x * view.m[2][0] + v[3].y * view.m[2][1] + v[3].z * view.m[2][2];
-
-    ViewPlane[0].nrm.x = -ViewPlane[0].nrm.x;
-    ViewPlane[0].nrm.y = -ViewPlane[0].nrm.y;
-    ViewPlane[0].nrm.z = -ViewPlane[0].nrm.z;
-    ViewPlane[1].nrm.x = -ViewPlane[1].nrm.x;
-    ViewPlane[1].nrm.y = -ViewPlane[1].nrm.y;
-    ViewPlane[1].nrm.z = -ViewPlane[1].nrm.z;
-    ViewPlane[2].nrm.x = -ViewPlane[2].nrm.x;
-    ViewPlane[2].nrm.y = -ViewPlane[2].nrm.y;
-    ViewPlane[2].nrm.z = -ViewPlane[2].nrm.z;
-    ViewPlane[3].nrm.x = -ViewPlane[3].nrm.x;
-    ViewPlane[3].nrm.y = -ViewPlane[3].nrm.y;
-    ViewPlane[3].nrm.z = -ViewPlane[3].nrm.z;
-
-    ViewPlane[0].d = (pos.x * ViewPlane[0].nrm.x + pos.y * ViewPlane[0].nrm.y + pos.z * ViewPlane[0].nrm.z);
-    ViewPlane[1].d = (pos.x * ViewPlane[1].nrm.x + pos.y * ViewPlane[1].nrm.y + pos.z * ViewPlane[1].nrm.z);
-    ViewPlane[2].d = (pos.x * ViewPlane[2].nrm.x + pos.y * ViewPlane[2].nrm.y + pos.z * ViewPlane[2].nrm.z);
-    ViewPlane[3].d = (pos.x * ViewPlane[3].nrm.x + pos.y * ViewPlane[3].nrm.y + pos.z * ViewPlane[3].nrm.z);
+    // models drawn one after another share the view, so the camera is taken only when it changes
+    if (!NODER::view.setup(view, proj))
+        return;
+    CVECTOR cang;
+    float cpersp;
+    rs->GetCamera(NODER::camera_pos, cang, cpersp);
 }
 
 void MODELR::LostRender()
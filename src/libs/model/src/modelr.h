@@ -6,6 +6,32 @@
 #include "dx9render.h"
 #include "geometry.h"
 #include "model.h"
+#include "render_queue.h"
+#include "view_volume.h"
+
+// simpler geometries of a node, <name>_lod1.gm and on, drawn when the node is small on the screen
+#define MODEL_LOD_LEVELS 2
+
+// what a model draws in a frame: the nodes that passed the checks, their geometry objects and the queue of the draws
+struct MODEL_DRAW_LIST
+{
+    // the state of the draws of a node in the render queue
+    struct NODE_STATE
+    {
+        const CMatrix *mtx;
+        const char *technique;
+        uint32_t dwTextureFactor;
+        GEOS::MATERIAL_FUNC mtf;
+    };
+
+    storm::RenderQueue queue;
+    std::vector<NODE_STATE> states;
+    std::vector<GEOS::DRAW_OBJECT> objects;
+    // as the nodes drawn so far left it
+    uint32_t dwTextureFactor;
+    // all draws in the order of the nodes, the model is blended
+    bool bOrdered;
+};
 
 class NODER : public NODE
 {
@@ -27,6 +53,11 @@ class NODER : public NODE
     float max_view_dist;
     float distance_blend;
 
+    GEOS *lod_geo[MODEL_LOD_LEVELS];
+    uint32_t num_lods;
+    void CreateLods();
+    void DeleteLods();
+
   public:
     // local radius and center of whole node with children
     float radius;
@@ -34,18 +65,23 @@ class NODER : public NODE
 
     static VGEOMETRY *gs;
     static VDX9RENDER *rs;
+    // the view of the frame, set up once for all models, and where the camera is
+    static storm::ViewVolume view;
+    static CVECTOR camera_pos;
 
     bool Init(const char *lightPath, const char *pname, const char *oname, const CMatrix &m, const CMatrix &globm,
               NODER *par, const char *lmPath) override;
     NODER();
     ~NODER() override;
-    void Draw();
+    // draws at once or adds the draws to the list, the planes are not checked when the parent is inside of them
+    void Draw(MODEL_DRAW_LIST *list = nullptr, bool bInside = false);
     float Trace(const CVECTOR &src, const CVECTOR &dst) override;
     NODER *GetNode(int32_t n);
     NODER *FindNode(const char *cNodeName);
     float Update(CMatrix &mtx, CVECTOR &cnt);
     const char *GetName() override;
     bool Clip();
+    void GetTriangles(std::vector<CVECTOR> &vertices);
 
     // unlink node
     NODE *Unlink() override;
@@ -97,8 +133,11 @@ class MODELR : public MODEL
     void AniRender();
     NODE *colideNode;
     void FindPlanes(const CMatrix &view, const CMatrix &proj);
+    void DrawList();
     IDirect3DVertexBuffer9 *d3dDestVB;
 
+    MODEL_DRAW_LIST drawList;
+
     unsigned short *idxBuff;
 
   public:
@@ -140,6 +179,7 @@ class MODELR : public MODEL
     bool GetCollideTriangle(TRIANGLE &triangle) override;
     bool Clip(const PLANE *planes, int32_t nplanes, const CVECTOR &center, float radius,
               ADD_POLYGON_FUNC addpoly) override;
+    void GetTriangles(std::vector<CVECTOR> &vertices) override;
 
     NODE *GetCollideNode() override;
 
@@ -7,6 +7,8 @@
 
 VGEOMETRY *NODER::gs = nullptr;
 VDX9RENDER *NODER::rs = nullptr;
+storm::ViewVolume NODER::view;
+CVECTOR NODER::camera_pos;
 int32_t NODER::depth = -1;
 int32_t NODER::node;
 extern int32_t clip_nps;
@@ -92,6 +94,26 @@ bool NODER::Clip()
     return retval;
 }
 
+void NODER::GetTriangles(std::vector<CVECTOR> &vertices)
+{
+    if (isReleased)
+        return;
+
+    if (flags & CLIP_ENABLE)
+    {
+        std::vector<GEOS::VERTEX> local;
+        geo->GetTriangles(local);
+        vertices.reserve(vertices.size() + local.size());
+        for (const auto &v : local)
+            vertices.push_back(glob_mtx * CVECTOR(v.x, v.y, v.z));
+    }
+
+    if (flags & CLIP_ENABLE_TREE)
+        for (int32_t l = 0; l < next.size(); l++)
+            if (next[l] != nullptr)
+                static_cast<NODER *>(next[l])->GetTriangles(vertices);
+}
+
 //-------------------------------------------------------------------
 //
 //-------------------------------------------------------------------
@@ -171,6 +193,7 @@ NODER::NODER()
 #endif
     geo = nullptr;
     parent = nullptr;
+    num_lods = 0;
 
     max_view_dist = 0.f;
 }
@@ -211,6 +234,7 @@ bool NODER::Init(const char *lightPath, const char *pname, const char *oname, co
     {
         return false;
     }
+    CreateLods();
 
     // load geometry radius and center
     GEOS::INFO gi;
@@ -276,15 +300,40 @@ NODER::~NODER()
 #endif
 
     delete geo;
+    DeleteLods();
     std::destroy(next.begin(), next.end());
 }
 
+void NODER::CreateLods()
+{
+    num_lods = 0;
+    for (uint32_t l = 0; l < MODEL_LOD_LEVELS; l++)
+    {
+        // the levels are optional, the ones after a missing one are not looked for
+        const auto lodName = fmt::format("{}_lod{}", sys_modelName_full, l + 1);
+        if (!fio->_FileOrDirectoryExists(fmt::format("resource\\models\\{}.gm", lodName).c_str()))
+            break;
+        lod_geo[l] = gs->CreateGeometry(lodName.c_str(), sys_LightPath.c_str(), 0, sys_lmPath.c_str());
+        if (!lod_geo[l])
+            break;
+        num_lods++;
+    }
+}
+
+void NODER::DeleteLods()
+{
+    for (uint32_t l = 0; l < num_lods; l++)
+        delete lod_geo[l];
+    num_lods = 0;
+}
+
 void NODER::ReleaseGeometry()
 {
     if (isReleased)
         return;
     delete geo;
     geo = nullptr;
+    DeleteLods();
     isReleased = true;
     for (int32_t i = 0; i < next.size(); i++)
     {
@@ -305,6 +354,8 @@ void NODER::RestoreGeometry()
     memcpy(ttPath, tPath, len);
     gs->SetTexturePath(sys_TexPath.c_str());
     geo = gs->CreateGeometry(sys_modelName_full.c_str(), sys_LightPath.c_str(), 0, sys_lmPath.c_str());
+    if (geo)
+        CreateLods();
     gs->SetTexturePath(ttPath);
     delete[] ttPath;
     if (!geo)
@@ -322,33 +373,26 @@ void NODER::RestoreGeometry()
 //----------------------------------------------------------
 // NODE draw
 //----------------------------------------------------------
-extern GEOS::PLANE ViewPlane[4];
 GEOS::PLANE TViewPlane[4];
 
-void NODER::Draw()
+void NODER::Draw(MODEL_DRAW_LIST *list, bool bInside)
 {
     if (isReleased)
         return;
 
     const auto cnt = glob_mtx * center;
 
-    // visibility check
-    int32_t p;
-    for (p = 0; p < 4; p++)
+    // visibility check of the node with its children
+    if (!bInside)
     {
-        const auto dist =
-            cnt.x * ViewPlane[p].nrm.x + cnt.y * ViewPlane[p].nrm.y + cnt.z * ViewPlane[p].nrm.z - ViewPlane[p].d;
-        if (dist > radius)
-            break;
+        const auto cull = view.cull(cnt, radius);
+        if (cull == storm::ViewVolume::Cull::Outside)
+            return;
+        bInside = cull == storm::ViewVolume::Cull::Inside;
     }
-    if (p < 4)
-        return;
     if (max_view_dist > 0.f)
     {
-        CVECTOR cpos, cang;
-        float cpersp;
-        rs->GetCamera(cpos, cang, cpersp);
-        const float fdist = ~(cpos - cnt);
+        const float fdist = ~(camera_pos - cnt);
         const float fmindist = (max_view_dist + radius) * (max_view_dist + radius);
         const float fmaxdist = (max_view_dist * 1.3f + radius) * (max_view_dist * 1.3f + radius);
         if (fdist > fmaxdist)
@@ -383,27 +427,31 @@ void NODER::Draw()
     if (flags & VISIBLE)
     {
         // visibility check for geometry
-        int32_t p;
-        for (p = 0; p < 4; p++)
+        const auto cull = bInside ? storm::ViewVolume::Cull::Inside : view.cull(cnt, geo_radius);
+        if (cull != storm::ViewVolume::Cull::Outside)
         {
-            const float dist =
-                cnt.x * ViewPlane[p].nrm.x + cnt.y * ViewPlane[p].nrm.y + cnt.z * ViewPlane[p].nrm.z - ViewPlane[p].d;
-            if (dist > geo_radius)
-                break;
-        }
-        if (p == 4)
-        {
-            rs->SetTransform(D3DTS_WORLD, (D3DMATRIX *)&glob_mtx);
-            gs->SetTechnique(&technique[0]);
-            if (max_view_dist > 0.f && distance_blend > 0.f)
+            const auto bDistanceBlend = max_view_dist > 0.f && distance_blend > 0.f;
+            if (list)
+            {
+                if (bDistanceBlend)
+                    list->dwTextureFactor = (static_cast<uint32_t>(255.f - 255.f * distance_blend) << 24) | 0xFFFFFF;
+            }
+            else
             {
-                gs->SetTechnique("geomdistanceblend");
-                uint32_t dwTFColor;
-                dwTFColor = (static_cast<uint32_t>(255.f - 255.f * distance_blend) << 24) | 0xFFFFFF;
-                rs->SetRenderState(D3DRS_TEXTUREFACTOR, dwTFColor);
+                rs->SetTransform(D3DTS_WORLD, (D3DMATRIX *)&glob_mtx);
+                gs->SetTechnique(&technique[0]);
+                if (bDistanceBlend)
+                {
+                    gs->SetTechnique("geomdistanceblend");
+                    uint32_t dwTFColor;
+                    dwTFColor = (static_cast<uint32_t>(255.f - 255.f * distance_blend) << 24) | 0xFFFFFF;
+                    rs->SetRenderState(D3DRS_TEXTUREFACTOR, dwTFColor);
+                }
             }
-            // transform viewplanes
-            for (p = 0; p < 4; p++)
+            // transform viewplanes, the objects are not checked against the ones the geometry is inside of
+            const auto *ViewPlane = view.sidePlanes();
+            const int32_t nPlanes = cull == storm::ViewVolume::Cull::Inside ? 0 : 4;
+            for (int32_t p = 0; p < nPlanes; p++)
             {
                 const float x = ViewPlane[p].d * ViewPlane[p].nrm.x - glob_mtx.m[3][0];
                 const float y = ViewPlane[p].d * ViewPlane[p].nrm.y - glob_mtx.m[3][1];
@@ -423,8 +471,64 @@ void NODER::Draw()
                 TViewPlane[p].d = (Nx * lx + Ny * ly + Nz * lz) * glob_mtx.m[3][3];
             }
 
-            // draw geos
-            geo->Draw(&TViewPlane[0], 4, geoMaterialFunc);
+            if (!list)
+            {
+                // draw geos
+                geo->Draw(&TViewPlane[0], nPlanes, geoMaterialFunc);
+            }
+            else
+            {
+                // the objects go to the queue, with the state they would be drawn in
+                const auto *pTechnique = bDistanceBlend ? "geomdistanceblend" : &technique[0];
+                const auto state = static_cast<uint32_t>(list->states.size());
+                list->states.push_back({&glob_mtx, pTechnique, list->dwTextureFactor, geoMaterialFunc});
+
+                // a simpler geometry when the node is small on the screen
+                const auto *drawGeo = geo;
+                if (num_lods > 0)
+                {
+                    const auto level = storm::SelectDetailLevel(view.projectedSize(cnt, geo_radius), num_lods);
+                    if (level > 0)
+                        drawGeo = lod_geo[level - 1];
+                }
+
+                const auto first = list->objects.size();
+                drawGeo->Collect(&TViewPlane[0], nPlanes, list->objects);
+                const auto techniqueKey =
+                    list->queue.technique(pTechnique, [pTechnique] { return rs->IsTechniqueBlended(pTechnique); });
+                for (auto o = first; o < list->objects.size(); o++)
+                {
+                    const auto &obj = list->objects[o];
+                    storm::RenderQueue::Item item;
+                    item.state = state;
+                    item.technique = techniqueKey;
+                    for (int32_t t = 0; t < 4; t++)
+                    {
+                        item.material.textures[t] = obj.material->texture[t];
+                        item.material.types[t] = obj.material->texture_type[t];
+                    }
+                    item.material.diffuse = obj.material->diffuse;
+                    item.material.specular = obj.material->specular;
+                    item.material.gloss = obj.material->gloss;
+                    if (geoMaterialFunc)
+                    {
+                        item.material.func = reinterpret_cast<const void *>(geoMaterialFunc);
+                        item.material.source = obj.material;
+                    }
+                    item.vertexBuffer = obj.vertex_buff;
+                    item.stride = obj.stride;
+                    item.indexBuffer = obj.index_buff;
+                    item.minVertex = obj.start_vertex;
+                    item.numVertices = obj.num_vertices;
+                    item.startIndex = obj.start_index;
+                    item.numTriangles = obj.ntriangles;
+                    // blended over what is behind, so after it
+                    item.ordered = bDistanceBlend || list->bOrdered;
+                    item.source = drawGeo;
+                    item.object = static_cast<int32_t>(o);
+                    list->queue.add(item);
+                }
+            }
         }
     }
 
@@ -432,7 +536,7 @@ void NODER::Draw()
     if (flags & VISIBLE_TREE)
         for (int32_t l = 0; l < next.size(); l++)
             if (next[l] != nullptr)
-                static_cast<NODER *>(next[l])->Draw();
+                static_cast<NODER *>(next[l])->Draw(list, bInside);
 }
 
 //----------------------------------------------------------
@@ -0,0 +1,84 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace storm
+{
+
+void RenderQueue::add(const Item &item)
+{
+    items_.push_back(item);
+    if (item.technique < blended_.size() && blended_[item.technique])
+        items_.back().ordered = true;
+}
+
+void RenderQueue::flush(Target &target)
+{
+    if (items_.empty())
+        return;
+
+    order_.resize(items_.size());
+    std::iota(order_.begin(), order_.end(), 0u);
+    // the order of adding decides among equal keys, so the parts of an object stay in place
+    std::stable_sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b) {
+        const auto &l = items_[a];
+        const auto &r = items_[b];
+        if (l.ordered || r.ordered)
+            return !l.ordered && r.ordered;
+        return std::tie(l.technique, l.material, l.vertexBuffer, l.indexBuffer, l.state, l.minVertex, l.startIndex) <
+               std::tie(r.technique, r.material, r.vertexBuffer, r.indexBuffer, r.state, r.minVertex, r.startIndex);
+    });
+
+    counters_.items += items_.size();
+    const Item *current = nullptr;
+    auto stateSet = false;
+    auto materialSet = false;
+    Item batch;
+    auto pending = false;
+    for (const auto index : order_)
+    {
+        const auto &item = items_[index];
+        if (pending && item.ordered == batch.ordered && item.state == batch.state &&
+            item.material == batch.material && item.vertexBuffer == batch.vertexBuffer &&
+            item.stride == batch.stride && item.indexBuffer == batch.indexBuffer &&
+            item.minVertex == batch.minVertex && item.startIndex == batch.startIndex + batch.numTriangles * 3)
+        {
+            // the indices go on where the batch ends, one draw for both
+            batch.numTriangles += item.numTriangles;
+            batch.numVertices = std::max(batch.numVertices, item.numVertices);
+            counters_.merged++;
+            continue;
+        }
+        if (pending)
+        {
+            target.draw(batch);
+            counters_.draws++;
+        }
+
+        if (!stateSet || current->state != item.state)
+        {
+            target.setState(item.state);
+            counters_.states++;
+            stateSet = true;
+        }
+        if (!materialSet || current->material != item.material)
+        {
+            target.setMaterial(item);
+            counters_.materials++;
+            materialSet = true;
+        }
+        current = &item;
+        batch = item;
+        pending = true;
+    }
+    if (pending)
+    {
+        target.draw(batch);
+        counters_.draws++;
+    }
+    items_.clear();
+}
+
+} // namespace storm
@@ -0,0 +1,103 @@
+#include "view_volume.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace storm
+{
+
+namespace
+{
+
+// projected sizes under which the next detail level is drawn
+constexpr float kDetailSizes[] = {0.08f, 0.025f, 0.008f};
+
+} // namespace
+
+bool ViewVolume::setup(const CMatrix &view, const CMatrix &proj)
+{
+    if (valid_ && std::memcmp(view.m, view_.m, sizeof(view_.m)) == 0 &&
+        std::memcmp(proj.m, proj_.m, sizeof(proj_.m)) == 0)
+        return false;
+    std::memcpy(view_.m, view.m, sizeof(view_.m));
+    std::memcpy(proj_.m, proj.m, sizeof(proj_.m));
+    valid_ = true;
+
+    // left, right, top and bottom in the view space
+    CVECTOR v[4] = {CVECTOR(proj.m[0][0], 0.0f, 1.0f), CVECTOR(-proj.m[0][0], 0.0f, 1.0f),
+                    CVECTOR(0.0f, -proj.m[1][1], 1.0f), CVECTOR(0.0f, proj.m[1][1], 1.0f)};
+
+    position_.x = -view.m[3][0] * view.m[0][0] - view.m[3][1] * view.m[0][1] - view.m[3][2] * view.m[0][2];
+    position_.y = -view.m[3][0] * view.m[1][0] - view.m[3][1] * view.m[1][1] - view.m[3][2] * view.m[1][2];
+    position_.z = -view.m[3][0] * view.m[2][0] - view.m[3][1] * view.m[2][1] - view.m[3][2] * view.m[2][2];
+
+    for (int32_t p = 0; p < 4; p++)
+    {
+        v[p] = !v[p];
+        auto &plane = planes_[p];
+        plane.nrm.x = -(v[p].x * view.m[0][0] + v[p].y * view.m[0][1] + v[p].z * view.m[0][2]);
+        plane.nrm.y = -(v[p].x * view.m[1][0] + v[p].y * view.m[1][1] + v[p].z * view.m[1][2]);
+        plane.nrm.z = -(v[p].x * view.m[2][0] + v[p].y * view.m[2][1] + v[p].z * view.m[2][2]);
+        plane.d = position_.x * plane.nrm.x + position_.y * plane.nrm.y + position_.z * plane.nrm.z;
+    }
+
+    forward_ = CVECTOR(view.m[0][2], view.m[1][2], view.m[2][2]);
+    forwardD_ = view.m[3][2];
+
+    // a perspective projection of D3D: z' = q * z - q * zn, w = z
+    near_ = 0.0f;
+    far_ = -1.0f;
+    const auto q = proj.m[2][2];
+    if (proj.m[2][3] == 1.0f && q != 0.0f)
+    {
+        near_ = std::max(0.0f, -proj.m[3][2] / q);
+        if (q != 1.0f)
+            far_ = q * near_ / (q - 1.0f);
+    }
+    scale_ = proj.m[1][1];
+    return true;
+}
+
+float ViewVolume::depth(const CVECTOR &point) const
+{
+    return point.x * forward_.x + point.y * forward_.y + point.z * forward_.z + forwardD_;
+}
+
+ViewVolume::Cull ViewVolume::cull(const CVECTOR &center, float radius) const
+{
+    auto inside = true;
+    for (const auto &plane : planes_)
+    {
+        const auto dist = center.x * plane.nrm.x + center.y * plane.nrm.y + center.z * plane.nrm.z - plane.d;
+        if (dist > radius)
+            return Cull::Outside;
+        if (dist > -radius)
+            inside = false;
+    }
+
+    const auto z = depth(center);
+    if (z + radius < near_ || (far_ > near_ && z - radius > far_))
+        return Cull::Outside;
+    if (z - radius < near_ || (far_ > near_ && z + radius > far_))
+        inside = false;
+    return inside ? Cull::Inside : Cull::Intersects;
+}
+
+float ViewVolume::projectedSize(const CVECTOR &center, float radius) const
+{
+    const auto z = depth(center);
+    if (z <= radius || z <= near_)
+        return 1e10f;
+    return radius * scale_ / z;
+}
+
+uint32_t SelectDetailLevel(float projectedSize, uint32_t levels)
+{
+    uint32_t level = 0;
+    while (level < levels && level < std::size(kDetailSizes) && projectedSize < kDetailSizes[level])
+        level++;
+    return level;
+}
+
+} // namespace storm
@@ -0,0 +1,269 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "render_queue.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+// a triangle as the device draws it: the state and material set, the buffers and its index
+using Triangle = std::tuple<uint32_t, storm::RenderQueue::Material, int32_t, int32_t, int32_t, int32_t>;
+
+class Recorder final : public storm::RenderQueue::Target
+{
+  public:
+    void setState(uint32_t state) override
+    {
+        state_ = state;
+        states++;
+    }
+
+    void setMaterial(const storm::RenderQueue::Item &item) override
+    {
+        material_ = item.material;
+        materials++;
+    }
+
+    void draw(const storm::RenderQueue::Item &item) override
+    {
+        for (int32_t t = 0; t < item.numTriangles; t++)
+            triangles.emplace_back(state_, material_, item.vertexBuffer, item.indexBuffer, item.minVertex,
+                                   item.startIndex + t * 3);
+        draws.push_back(item);
+    }
+
+    std::vector<Triangle> triangles;
+    std::vector<storm::RenderQueue::Item> draws;
+    size_t states = 0;
+    size_t materials = 0;
+
+  private:
+    uint32_t state_ = 0xFFFFFFFF;
+    storm::RenderQueue::Material material_;
+};
+
+// the nodes drew their objects themselves, setting everything for each one
+Recorder DrawDirect(const std::vector<storm::RenderQueue::Item> &items)
+{
+    Recorder recorder;
+    for (const auto &item : items)
+    {
+        recorder.setState(item.state);
+        recorder.setMaterial(item);
+        recorder.draw(item);
+    }
+    return recorder;
+}
+
+// a town of models: props of a few kinds, each made of objects that share textures, some fading out
+std::vector<storm::RenderQueue::Item> Scene(storm::RenderQueue &queue, std::mt19937 &gen, size_t nodes)
+{
+    const uint32_t techniques[] = {queue.technique("model"), queue.technique("modelnolight"),
+                                   queue.technique("geomdistanceblend")};
+    std::uniform_int_distribution<int32_t> kind(0, 7);
+    std::uniform_int_distribution<int32_t> percent(0, 99);
+
+    std::vector<storm::RenderQueue::Item> items;
+    for (uint32_t node = 0; node < nodes; node++)
+    {
+        const auto k = kind(gen);
+        const auto blended = percent(gen) < 10;
+        auto startIndex = 0;
+        for (int32_t object = 0; object < 1 + k % 4; object++)
+        {
+            storm::RenderQueue::Item item;
+            item.state = node;
+            item.technique = blended ? techniques[2] : techniques[k % 2];
+            // objects of a kind come in pairs of one material, kinds share some textures
+            const auto pair = object / 2;
+            item.material.textures = {10 + (k + pair) % 6, pair ? 30 : -1, -1, -1};
+            item.material.types = {1, pair ? 3 : 0, 0, 0};
+            item.material.diffuse = 1.0f;
+            item.vertexBuffer = 100 + k;
+            item.stride = 36;
+            item.indexBuffer = 200 + k;
+            // parts of an object in one material go on in the index buffer
+            item.minVertex = percent(gen) < 50 ? 0 : object * 64;
+            item.numVertices = 64;
+            item.startIndex = startIndex;
+            item.numTriangles = 1 + percent(gen) % 30;
+            startIndex += item.numTriangles * 3 + (percent(gen) < 30 ? 3 : 0);
+            item.ordered = blended;
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+} // namespace
+
+TEST_CASE("Render queue draws what the nodes drew themselves", "[model]")
+{
+    std::mt19937 gen(93);
+    storm::RenderQueue queue;
+    for (const auto nodes : {0u, 1u, 40u, 300u})
+    {
+        const auto items = Scene(queue, gen, nodes);
+        const auto direct = DrawDirect(items);
+
+        for (const auto &item : items)
+            queue.add(item);
+        Recorder queued;
+        queue.flush(queued);
+        CHECK(queue.empty());
+
+        auto expected = direct.triangles;
+        auto triangles = queued.triangles;
+        std::sort(expected.begin(), expected.end());
+        std::sort(triangles.begin(), triangles.end());
+        REQUIRE(triangles == expected);
+
+        // blended draws come last and in their order
+        std::vector<uint32_t> blended;
+        for (const auto &item : items)
+            if (item.ordered && (blended.empty() || blended.back() != item.state))
+                blended.push_back(item.state);
+        std::vector<uint32_t> blendedQueued;
+        auto afterBlended = false;
+        for (const auto &draw : queued.draws)
+        {
+            if (draw.ordered)
+            {
+                afterBlended = true;
+                if (blendedQueued.empty() || blendedQueued.back() != draw.state)
+                    blendedQueued.push_back(draw.state);
+            }
+            else
+                REQUIRE_FALSE(afterBlended);
+        }
+        CHECK(blendedQueued == blended);
+
+        CHECK(queued.draws.size() <= items.size());
+        CHECK(queued.states <= direct.states);
+        CHECK(queued.materials <= direct.materials);
+    }
+
+    const auto &counters = queue.counters();
+    CHECK(counters.merged > 0);
+    CHECK(counters.draws + counters.merged == counters.items);
+    CHECK(counters.materials < counters.items / 2);
+}
+
+TEST_CASE("Render queue keeps the order of blending techniques", "[model]")
+{
+    std::mt19937 gen(180);
+    std::uniform_int_distribution<int32_t> percent(0, 99);
+    storm::RenderQueue queue;
+    const uint32_t techniques[] = {queue.technique("locationmodel"), queue.technique("locationwindows", true),
+                                   queue.technique("locationmodelblend", true)};
+
+    // windows and glass of a house among its walls, some parts going on in the index buffer of the one before
+    std::vector<storm::RenderQueue::Item> items;
+    auto startIndex = 0;
+    for (uint32_t node = 0; node < 60; node++)
+    {
+        storm::RenderQueue::Item item;
+        item.state = node / 3;
+        item.technique = techniques[percent(gen) % 3];
+        item.material.textures = {10 + percent(gen) % 2, -1, -1, -1};
+        item.vertexBuffer = 100;
+        item.stride = 36;
+        item.indexBuffer = 200;
+        item.numVertices = 64;
+        if (percent(gen) < 40)
+            startIndex += 3;
+        item.startIndex = startIndex;
+        item.numTriangles = 1 + percent(gen) % 10;
+        startIndex += item.numTriangles * 3;
+        items.push_back(item);
+    }
+    const auto direct = DrawDirect(items);
+
+    for (const auto &item : items)
+        queue.add(item);
+    Recorder queued;
+    queue.flush(queued);
+
+    // the draws of the blending techniques come after the others, with triangles as they were submitted
+    std::vector<Triangle> expected;
+    for (size_t i = 0, t = 0; i < items.size(); t += items[i].numTriangles, i++)
+    {
+        if (items[i].technique != techniques[0])
+            expected.insert(expected.end(), direct.triangles.begin() + t,
+                            direct.triangles.begin() + t + items[i].numTriangles);
+    }
+    REQUIRE(queued.triangles.size() == direct.triangles.size());
+    const std::vector<Triangle> blended(queued.triangles.end() - expected.size(), queued.triangles.end());
+    CHECK(blended == expected);
+
+    // and only neighbours in the submission are drawn at once
+    size_t draws = 0;
+    const storm::RenderQueue::Item *prev = nullptr;
+    for (const auto &item : items)
+    {
+        if (item.technique == techniques[0])
+            continue;
+        if (!prev || prev->state != item.state || prev->material != item.material ||
+            prev->startIndex + prev->numTriangles * 3 != item.startIndex)
+            draws++;
+        prev = &item;
+    }
+    CHECK(std::count_if(queued.draws.begin(), queued.draws.end(), [](const auto &draw) { return draw.ordered; }) ==
+          draws);
+
+    SECTION("a model of one blending technique is drawn as submitted")
+    {
+        for (auto &item : items)
+            item.technique = techniques[1];
+        const auto windows = DrawDirect(items);
+        for (const auto &item : items)
+            queue.add(item);
+        Recorder recorder;
+        queue.flush(recorder);
+        CHECK(recorder.triangles == windows.triangles);
+        CHECK(recorder.draws.size() < items.size());
+    }
+}
+
+TEST_CASE("Render queue asks once whether a technique blends", "[model]")
+{
+    storm::RenderQueue queue;
+    auto asked = 0;
+    const auto blended = [&asked] {
+        asked++;
+        return true;
+    };
+    const auto windows = queue.technique("locationwindows", blended);
+    CHECK(queue.technique("locationwindows", blended) == windows);
+    CHECK(queue.technique("locationmodel", false) != windows);
+    CHECK(asked == 1);
+
+    storm::RenderQueue::Item item;
+    item.technique = windows;
+    queue.add(item);
+    Recorder recorder;
+    queue.flush(recorder);
+    REQUIRE(recorder.draws.size() == 1);
+    CHECK(recorder.draws[0].ordered);
+}
+
+TEST_CASE("Render queue benchmark", "[.][model][benchmark]")
+{
+    std::mt19937 gen(1);
+    storm::RenderQueue queue;
+    const auto items = Scene(queue, gen, 300);
+    BENCHMARK("sort and flush 300 nodes")
+    {
+        for (const auto &item : items)
+            queue.add(item);
+        Recorder recorder;
+        queue.flush(recorder);
+        return recorder.draws.size();
+    };
+}
@@ -0,0 +1,308 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "view_volume.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// the planes as MODELR::FindPlanes made them
+void FindPlanes(const CMatrix &view, const CMatrix &proj, GEOS::PLANE *planes)
+{
+    CVECTOR v[4] = {CVECTOR(proj.m[0][0], 0.0f, 1.0f), CVECTOR(-proj.m[0][0], 0.0f, 1.0f),
+                    CVECTOR(0.0f, -proj.m[1][1], 1.0f), CVECTOR(0.0f, proj.m[1][1], 1.0f)};
+    CVECTOR pos;
+    pos.x = -view.m[3][0] * view.m[0][0] - view.m[3][1] * view.m[0][1] - view.m[3][2] * view.m[0][2];
+    pos.y = -view.m[3][0] * view.m[1][0] - view.m[3][1] * view.m[1][1] - view.m[3][2] * view.m[1][2];
+    pos.z = -view.m[3][0] * view.m[2][0] - view.m[3][1] * view.m[2][1] - view.m[3][2] * view.m[2][2];
+    for (int32_t p = 0; p < 4; p++)
+    {
+        v[p] = !v[p];
+        planes[p].nrm.x = -(v[p].x * view.m[0][0] + v[p].y * view.m[0][1] + v[p].z * view.m[0][2]);
+        planes[p].nrm.y = -(v[p].x * view.m[1][0] + v[p].y * view.m[1][1] + v[p].z * view.m[1][2]);
+        planes[p].nrm.z = -(v[p].x * view.m[2][0] + v[p].y * view.m[2][1] + v[p].z * view.m[2][2]);
+        planes[p].d = pos.x * planes[p].nrm.x + pos.y * planes[p].nrm.y + pos.z * planes[p].nrm.z;
+    }
+}
+
+bool OutsidePlanes(const GEOS::PLANE *planes, const CVECTOR &c, float r)
+{
+    for (int32_t p = 0; p < 4; p++)
+        if (c.x * planes[p].nrm.x + c.y * planes[p].nrm.y + c.z * planes[p].nrm.z - planes[p].d > r)
+            return true;
+    return false;
+}
+
+constexpr auto kNear = 0.5f;
+constexpr auto kFar = 600.0f;
+
+// the point in the clip space of D3D within -w..w for x and y, and between the near and far planes
+bool OnScreen(const CMatrix &view, const CMatrix &proj, const CVECTOR &p)
+{
+    const auto vx = p.x * view.m[0][0] + p.y * view.m[1][0] + p.z * view.m[2][0] + view.m[3][0];
+    const auto vy = p.x * view.m[0][1] + p.y * view.m[1][1] + p.z * view.m[2][1] + view.m[3][1];
+    const auto vz = p.x * view.m[0][2] + p.y * view.m[1][2] + p.z * view.m[2][2] + view.m[3][2];
+    const auto x = vx * proj.m[0][0];
+    const auto y = vy * proj.m[1][1];
+    constexpr auto eps = 1e-5f;
+    return std::abs(x) <= vz * (1.0f + eps) && std::abs(y) <= vz * (1.0f + eps) && vz >= kNear * (1.0f - eps) &&
+           vz <= kFar * (1.0f + eps);
+}
+
+struct Camera
+{
+    CMatrix view;
+    CMatrix proj;
+};
+
+Camera RandomCamera(std::mt19937 &gen)
+{
+    std::uniform_real_distribution<float> pos(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> fov(0.6f, 1.6f);
+    Camera camera;
+    const CVECTOR from(pos(gen), pos(gen) * 0.2f + 20.0f, pos(gen));
+    camera.view.BuildViewMatrix(from, CVECTOR(pos(gen), 0.0f, pos(gen)), CVECTOR(0.0f, 1.0f, 0.0f));
+    camera.proj.BuildProjectionMatrix(fov(gen), 1024.0f, 768.0f, kNear, kFar);
+    return camera;
+}
+
+// a ship of the battle: the hull with masts and their yards, every node with its detail levels
+struct Node
+{
+    CVECTOR center;
+    float geoRadius = 0.0f;
+    float radius = 0.0f;
+    // triangles and objects of the full geometry, then of the levels
+    std::vector<std::pair<uint32_t, uint32_t>> levels;
+    std::vector<std::unique_ptr<Node>> next;
+};
+
+std::unique_ptr<Node> MakeNode(const CVECTOR &center, float radius, uint32_t triangles, uint32_t objects)
+{
+    auto node = std::make_unique<Node>();
+    node->center = center;
+    node->geoRadius = radius;
+    node->levels = {{triangles, objects}, {triangles * 35 / 100, (objects + 1) / 2}, {triangles / 8, 1}};
+    return node;
+}
+
+float UpdateBounds(Node &node)
+{
+    node.radius = node.geoRadius;
+    for (const auto &child : node.next)
+    {
+        const auto r = UpdateBounds(*child);
+        node.radius = std::max(node.radius, sqrtf(~(child->center - node.center)) + r);
+    }
+    return node.radius;
+}
+
+std::vector<std::unique_ptr<Node>> Battle(std::mt19937 &gen, size_t ships)
+{
+    std::uniform_real_distribution<float> pos(-1500.0f, 1500.0f);
+    std::vector<std::unique_ptr<Node>> fleet;
+    for (size_t s = 0; s < ships; s++)
+    {
+        const CVECTOR at(pos(gen), 0.0f, pos(gen));
+        auto hull = MakeNode(at, 25.0f, 6000, 12);
+        for (int32_t m = 0; m < 3; m++)
+        {
+            auto mast = MakeNode(at + CVECTOR(0.0f, 20.0f, -12.0f + 12.0f * m), 18.0f, 500, 3);
+            for (int32_t y = 0; y < 3; y++)
+                mast->next.push_back(MakeNode(at + CVECTOR(0.0f, 10.0f + 8.0f * y, -12.0f + 12.0f * m), 9.0f, 150, 2));
+            hull->next.push_back(std::move(mast));
+        }
+        UpdateBounds(*hull);
+        fleet.push_back(std::move(hull));
+    }
+    return fleet;
+}
+
+struct Drawn
+{
+    uint64_t triangles = 0;
+    uint64_t draws = 0;
+    uint64_t planeTests = 0;
+};
+
+// as the nodes drew themselves: their own sphere against the side planes, all in full detail
+void DrawReference(const Node &node, const GEOS::PLANE *planes, Drawn &drawn)
+{
+    drawn.planeTests += 2;
+    if (OutsidePlanes(planes, node.center, node.radius))
+        return;
+    if (!OutsidePlanes(planes, node.center, node.geoRadius))
+    {
+        drawn.triangles += node.levels[0].first;
+        drawn.draws += node.levels[0].second;
+    }
+    for (const auto &child : node.next)
+        DrawReference(*child, planes, drawn);
+}
+
+void DrawCulled(const Node &node, const storm::ViewVolume &view, bool inside, Drawn &drawn)
+{
+    if (!inside)
+    {
+        drawn.planeTests++;
+        const auto cull = view.cull(node.center, node.radius);
+        if (cull == storm::ViewVolume::Cull::Outside)
+            return;
+        inside = cull == storm::ViewVolume::Cull::Inside;
+    }
+    if (!inside)
+        drawn.planeTests++;
+    if (inside || view.cull(node.center, node.geoRadius) != storm::ViewVolume::Cull::Outside)
+    {
+        const auto level = storm::SelectDetailLevel(view.projectedSize(node.center, node.geoRadius),
+                                                    static_cast<uint32_t>(node.levels.size() - 1));
+        drawn.triangles += node.levels[level].first;
+        drawn.draws += node.levels[level].second;
+    }
+    for (const auto &child : node.next)
+        DrawCulled(*child, view, inside, drawn);
+}
+
+} // namespace
+
+TEST_CASE("View volume keeps the planes of the models", "[model]")
+{
+    std::mt19937 gen(94);
+    for (int32_t i = 0; i < 50; i++)
+    {
+        const auto camera = RandomCamera(gen);
+        storm::ViewVolume view;
+        REQUIRE(view.setup(camera.view, camera.proj));
+        CHECK_FALSE(view.setup(camera.view, camera.proj));
+
+        GEOS::PLANE planes[4];
+        FindPlanes(camera.view, camera.proj, planes);
+        for (int32_t p = 0; p < 4; p++)
+        {
+            CHECK(view.sidePlanes()[p].nrm.x == Approx(planes[p].nrm.x).margin(1e-5));
+            CHECK(view.sidePlanes()[p].nrm.y == Approx(planes[p].nrm.y).margin(1e-5));
+            CHECK(view.sidePlanes()[p].nrm.z == Approx(planes[p].nrm.z).margin(1e-5));
+            CHECK(view.sidePlanes()[p].d == Approx(planes[p].d).margin(1e-3));
+        }
+    }
+}
+
+TEST_CASE("View volume culls spheres as the projection clips them", "[model]")
+{
+    std::mt19937 gen(941);
+    std::uniform_real_distribution<float> pos(-400.0f, 400.0f);
+    std::uniform_real_distribution<float> size(0.1f, 60.0f);
+    std::normal_distribution<float> dir;
+
+    size_t outside = 0;
+    size_t inside = 0;
+    for (int32_t i = 0; i < 100; i++)
+    {
+        const auto camera = RandomCamera(gen);
+        storm::ViewVolume view;
+        view.setup(camera.view, camera.proj);
+        for (int32_t s = 0; s < 200; s++)
+        {
+            const CVECTOR center(pos(gen), pos(gen) * 0.1f, pos(gen));
+            const auto radius = size(gen);
+            const auto cull = view.cull(center, radius);
+
+            // points of the sphere, its center and on its surface
+            std::vector<CVECTOR> points{center};
+            for (int32_t p = 0; p < 64; p++)
+            {
+                CVECTOR d(dir(gen), dir(gen), dir(gen));
+                if (~d > 0.0f)
+                    points.push_back(center + !d * radius);
+            }
+            for (const auto &point : points)
+            {
+                const auto onScreen = OnScreen(camera.view, camera.proj, point);
+                if (cull == storm::ViewVolume::Cull::Outside)
+                    REQUIRE_FALSE(onScreen);
+                else if (cull == storm::ViewVolume::Cull::Inside)
+                    REQUIRE(onScreen);
+            }
+            outside += cull == storm::ViewVolume::Cull::Outside;
+            inside += cull == storm::ViewVolume::Cull::Inside;
+        }
+    }
+    CHECK(outside > 1000);
+    CHECK(inside > 100);
+}
+
+TEST_CASE("View volume picks detail levels by the size on the screen", "[model]")
+{
+    CMatrix view;
+    view.BuildViewMatrix(CVECTOR(0.0f, 0.0f, 0.0f), CVECTOR(0.0f, 0.0f, 1.0f), CVECTOR(0.0f, 1.0f, 0.0f));
+    CMatrix proj;
+    proj.BuildProjectionMatrix(1.0f, 1024.0f, 768.0f, 1.0f, 5000.0f);
+    storm::ViewVolume volume;
+    volume.setup(view, proj);
+
+    // the top of a sphere ahead is at its projected size on the screen
+    const CVECTOR center(0.0f, 0.0f, 100.0f);
+    CHECK(volume.projectedSize(center, 10.0f) == Approx(10.0f * proj.m[1][1] / 100.0f));
+    // the camera within the sphere
+    CHECK(volume.projectedSize(center, 150.0f) > 1.0f);
+
+    auto last = 0u;
+    for (auto distance = 10.0f; distance < 5000.0f; distance *= 1.1f)
+    {
+        const auto level = storm::SelectDetailLevel(volume.projectedSize(CVECTOR(0.0f, 0.0f, distance), 5.0f), 2);
+        CHECK(level >= last);
+        CHECK(level <= 2);
+        last = level;
+    }
+    CHECK(last == 2);
+    CHECK(storm::SelectDetailLevel(1e-6f, 0) == 0);
+    CHECK(storm::SelectDetailLevel(1e-6f, 1) == 1);
+    CHECK(storm::SelectDetailLevel(1.0f, 2) == 0);
+}
+
+TEST_CASE("View volume on a large battle", "[.][model][benchmark]")
+{
+    std::mt19937 gen(1);
+    const auto fleet = Battle(gen, 60);
+    CMatrix view;
+    view.BuildViewMatrix(CVECTOR(0.0f, 30.0f, -1600.0f), CVECTOR(0.0f, 0.0f, 0.0f), CVECTOR(0.0f, 1.0f, 0.0f));
+    CMatrix proj;
+    proj.BuildProjectionMatrix(1.1f, 1024.0f, 768.0f, 0.5f, 4000.0f);
+    storm::ViewVolume volume;
+    volume.setup(view, proj);
+    GEOS::PLANE planes[4];
+    FindPlanes(view, proj, planes);
+
+    Drawn reference;
+    Drawn culled;
+    for (const auto &ship : fleet)
+    {
+        DrawReference(*ship, planes, reference);
+        DrawCulled(*ship, volume, false, culled);
+    }
+    WARN("60 ships, triangles " << reference.triangles << " -> " << culled.triangles << ", draws " << reference.draws
+                                << " -> " << culled.draws << ", sphere tests " << reference.planeTests << " -> "
+                                << culled.planeTests);
+    CHECK(culled.triangles < reference.triangles);
+
+    BENCHMARK("reference")
+    {
+        Drawn drawn;
+        for (const auto &ship : fleet)
+            DrawReference(*ship, planes, drawn);
+        return drawn.triangles;
+    };
+    BENCHMARK("culled")
+    {
+        Drawn drawn;
+        for (const auto &ship : fleet)
+            DrawCulled(*ship, volume, false, drawn);
+        return drawn.triangles;
+    };
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "dx9render.h"
+#include "ini_particle_system.h"
+#include "v_particle_system.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define INI_PARTICLE_FVF (D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1 | D3DFVF_TEXTUREFORMAT2)
+
+namespace storm
+{
+
+/**
+ * \brief View space quads of the ini particle systems of one frame
+ *
+ * Systems add their quads while they are realized, flush() uploads them to one dynamic vertex buffer and draws
+ * every texture and technique pair with a single call. Pairs are drawn in the order they were first added.
+ */
+class IniParticleBatch final
+{
+  public:
+    explicit IniParticleBatch(VDX9RENDER *rs);
+    IniParticleBatch(const IniParticleBatch &) = delete;
+    IniParticleBatch &operator=(const IniParticleBatch &) = delete;
+    ~IniParticleBatch();
+
+    // room for 6 vertices per quad, valid until the next add or flush
+    IniParticleVertex *add(int32_t texture, const std::string &technique, uint32_t quads);
+
+    // draws with an identity view and world, the view is restored afterwards
+    void flush();
+
+  private:
+    struct Group
+    {
+        int32_t texture;
+        std::string technique;
+        std::vector<IniParticleVertex> vertices;
+    };
+
+    VDX9RENDER *rs_;
+    std::vector<Group> groups_;
+    int32_t vertexBuffer_ = -1;
+    size_t bufferVertices_ = 0;
+};
+
+/**
+ * \brief Particle system described by a particles.ini section (ship foam, sink splashes)
+ *
+ * Engine side of IniParticleSystem: follows a linked object, lays new particles on a surface object and draws
+ * through an IniParticleBatch.
+ */
+class IniParticleEmitter final : public VPARTICLE_SYSTEM
+{
+  public:
+    IniParticleEmitter(VDX9RENDER *rs, std::shared_ptr<const IniParticleParams> params);
+    ~IniParticleEmitter() override;
+
+    void Stop() override
+    {
+        system_.stop();
+    }
+
+    void SetEmitter(CVECTOR p, CVECTOR a) override;
+    void LinkToObject(entid_t id, CVECTOR linkPos) override;
+    void SetDelay(int32_t delay) override;
+
+    void SetLifeTime(uint32_t time) override
+    {
+        system_.setLifeTime(time);
+    }
+
+    void enableEmit(bool enable)
+    {
+        system_.enableEmit(enable);
+    }
+
+    void reset()
+    {
+        system_.reset();
+    }
+
+    // lays emitted particles on a COLLISION_OBJECT
+    void useSurface(entid_t surface);
+
+    void addTrackPoint(const CVECTOR &pos)
+    {
+        system_.addTrackPoint(pos);
+    }
+
+    [[nodiscard]] bool complete() const
+    {
+        return system_.complete();
+    }
+
+    void realize(uint32_t dt, IniParticleBatch &batch);
+
+  private:
+    VDX9RENDER *rs_;
+    IniParticleSystem system_;
+    std::vector<int32_t> textures_;
+
+    bool linked_ = false;
+    entid_t linkObject_{};
+    CVECTOR linkPos_;
+    CVECTOR linkDirPos_;
+
+    bool surfaced_ = false;
+    entid_t surface_{};
+};
+
+} // namespace storm
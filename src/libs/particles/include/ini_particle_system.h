@@ -0,0 +1,266 @@
+#pragma once
+
+#include "c_vector.h"
+#include "matrix.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class INIFILE;
+
+namespace storm
+{
+
+/**
+ * \brief Keyframe curve of the ini particle systems baked to one value per millisecond
+ *
+ * Particle times are whole milliseconds, so the table holds exactly what the keyframe search returns.
+ * Times past the last key take the tail value, very long tracks fall back to the search beyond kMaxTableTime.
+ */
+class ParticleTrack final
+{
+  public:
+    static constexpr size_t kMaxKeys = 16;
+    static constexpr int32_t kMaxTableTime = 0xFFFF;
+
+    struct Key
+    {
+        int32_t time = -1;
+        float value = 0.0f;
+    };
+
+    // keys as read from the ini file, a key with a negative time ends the track
+    using Keys = std::array<Key, kMaxKeys>;
+
+    void build(const Keys &keys);
+
+    [[nodiscard]] float value(int32_t time) const
+    {
+        if (time < 0)
+            return 0.0f;
+        if (static_cast<size_t>(time) < table_.size())
+            return table_[time];
+        if (time > lastTime_)
+            return tail_;
+        return search(keys_, time);
+    }
+
+    // linear search over the keys with linear interpolation between them
+    static float search(const Keys &keys, int32_t time);
+
+  private:
+    Keys keys_{};
+    std::vector<float> table_;
+    int32_t lastTime_ = -1;
+    float tail_ = 0.0f;
+};
+
+// Parameters of one particles.ini section, shared by every system made from it
+struct IniParticleParams
+{
+    std::vector<std::string> textures;
+    std::string technique;
+
+    int32_t particlesNum = 32;
+    float emissionTime = 0.0f;
+    float emissionTimeRand = 0.0f;
+    float surfaceOffset = 0.0f;
+    uint32_t color = 0xffffffff;
+
+    float windEffect = 0.0f;
+    float directionDeviation = 0.0f;
+    float gravity = 0.0f;
+    float speed = 0.0f;
+    float speedDeviation = 0.0f;
+    int32_t lifetime = 1000;
+    float spin = 0.0f;
+    float spinDeviation = 0.0f;
+    int32_t emitterIniTime = 0;
+    float weight = 0.0f;
+    float weightDeviation = 0.0f;
+    int32_t emitDelta = 0;
+    float emitRadius = 0.0f;
+    float trackPointRadius = 1.0f;
+
+    bool colorInverse = false;
+    bool uniformEmit = false;
+    bool randomDirection = false;
+    bool nonStopEmit = false;
+
+    ParticleTrack alphaTrack;
+    ParticleTrack sizeTrack;
+    ParticleTrack speedTrack;
+    ParticleTrack spinTrack;
+    ParticleTrack angleTrack;
+    ParticleTrack windTrack;
+    bool hasAngleTrack = false;
+
+    // throws if the section has no technique
+    static std::shared_ptr<const IniParticleParams> load(INIFILE &ini, const char *section);
+};
+
+// View space vertex of a particle quad, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1
+struct IniParticleVertex
+{
+    CVECTOR pos;
+    uint32_t color;
+    float tu, tv;
+};
+
+/**
+ * \brief Simulation of the old ini particle systems (ship foam, sink splashes)
+ *
+ * Particles live in a fixed pool of parallel arrays. Free slots are found through bit masks, the done count is
+ * kept up to date, and the tracks are baked, so nothing is searched per particle. rand() is called in the same
+ * order as the old per-system code did, so the same seed gives the same particles in the same slots.
+ */
+class IniParticleSystem final
+{
+  public:
+    // traces from -> to and returns the fraction of the hit like COLLISION_OBJECT::Trace
+    using SurfaceTrace = std::function<float(const CVECTOR &from, const CVECTOR &to)>;
+
+    explicit IniParticleSystem(std::shared_ptr<const IniParticleParams> params);
+
+    // particles back to the emitter and not emitted yet
+    void reset();
+
+    void setEmitter(const CVECTOR &pos, const CVECTOR &dir);
+    // moves every particle around the emitter
+    void relocate(const CVECTOR &pos);
+    void enableEmit(bool enable)
+    {
+        enableEmit_ = enable;
+    }
+
+    void setLifeTime(int32_t time)
+    {
+        lifeTime_ = time;
+    }
+
+    void setDelay(int32_t delay);
+    void setWind(const CVECTOR &dir, float power);
+    // particles head for the track points in turn, without gravity and spin, once the first point is added
+    void addTrackPoint(const CVECTOR &pos);
+    void useSurface(bool use)
+    {
+        useSurface_ = use;
+    }
+
+    void stop()
+    {
+        complete_ = true;
+    }
+
+    // returns false while delayed, particles emitted during the step are laid on the surface if it is used,
+    // the surface is traced once per step under the emitter
+    bool update(uint32_t dt, const SurfaceTrace &surface = {});
+
+    // writes 6 vertices per live particle, returns the number of particles written
+    uint32_t buildQuads(const CMatrix &view, IniParticleVertex *out) const;
+
+    [[nodiscard]] bool complete() const
+    {
+        return complete_;
+    }
+
+    [[nodiscard]] const CVECTOR &emitter() const
+    {
+        return emitter_;
+    }
+
+    [[nodiscard]] const CVECTOR &emitterDir() const
+    {
+        return emitterDir_;
+    }
+
+    [[nodiscard]] const IniParticleParams &params() const
+    {
+        return *params_;
+    }
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return count_;
+    }
+
+    [[nodiscard]] uint32_t liveCount() const
+    {
+        return liveCount_;
+    }
+
+    [[nodiscard]] bool live(uint32_t i) const
+    {
+        return live_[i] != 0;
+    }
+
+    [[nodiscard]] CVECTOR position(uint32_t i) const
+    {
+        return CVECTOR(posX_[i], posY_[i], posZ_[i]);
+    }
+
+    [[nodiscard]] float particleSize(uint32_t i) const
+    {
+        return size_[i];
+    }
+
+    [[nodiscard]] uint32_t color(uint32_t i) const
+    {
+        return color_[i];
+    }
+
+  private:
+    void setDirection(uint32_t i);
+    bool emit();
+    void kill(uint32_t i);
+    void integrate(float dt);
+    void followTrack(float dt);
+    void applyTracks(uint32_t dt);
+
+    std::shared_ptr<const IniParticleParams> params_;
+    uint32_t count_;
+
+    // per particle
+    std::vector<float> posX_, posY_, posZ_;
+    std::vector<float> dirX_, dirY_, dirZ_;
+    std::vector<float> velX_, velY_, velZ_;
+    std::vector<float> chaosX_, chaosY_, chaosZ_;
+    std::vector<float> size_, weight_, spin_, spinVal_, angle_;
+    std::vector<float> speed_, speedChaos_, speedVal_;
+    std::vector<int32_t> time_;
+    std::vector<uint32_t> trackIndex_;
+    std::vector<uint32_t> color_;
+    std::vector<uint8_t> live_;
+
+    // one bit per particle
+    std::vector<uint64_t> idleBits_;
+    std::vector<uint64_t> doneBits_;
+    uint32_t liveCount_ = 0;
+    uint32_t doneCount_ = 0;
+
+    // emitted since the last update and not laid on the surface yet
+    std::vector<uint32_t> surfaceQueue_;
+
+    std::vector<CVECTOR> track_;
+
+    CVECTOR emitter_;
+    CVECTOR emitterDir_;
+    CVECTOR windDir_;
+    float windPower_ = 0.0f;
+
+    bool enableEmit_ = true;
+    bool repeat_;
+    bool complete_ = false;
+    bool useSurface_ = false;
+    int32_t delay_ = 0;
+    int32_t lifeTime_ = 0;
+    uint32_t emitted_ = 0;
+    int32_t sinceEmission_;
+    float emissionRand_;
+};
+
+} // namespace storm
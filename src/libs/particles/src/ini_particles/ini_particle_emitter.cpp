@@ -0,0 +1,172 @@
+#include "ini_particle_emitter.h"
+
+#include "core.h"
+#include "object.h"
+
+#include <algorithm>
+
+namespace storm
+{
+
+// ============================================================================================
+// IniParticleBatch
+// ============================================================================================
+
+IniParticleBatch::IniParticleBatch(VDX9RENDER *rs) : rs_(rs)
+{
+}
+
+IniParticleBatch::~IniParticleBatch()
+{
+    if (vertexBuffer_ >= 0)
+        rs_->ReleaseVertexBuffer(vertexBuffer_);
+}
+
+IniParticleVertex *IniParticleBatch::add(int32_t texture, const std::string &technique, uint32_t quads)
+{
+    auto group = std::find_if(groups_.begin(), groups_.end(), [&](const Group &g) {
+        return g.texture == texture && g.technique == technique;
+    });
+    if (group == groups_.end())
+        group = groups_.insert(groups_.end(), Group{texture, technique, {}});
+
+    const size_t first = group->vertices.size();
+    group->vertices.resize(first + quads * 6);
+    return group->vertices.data() + first;
+}
+
+void IniParticleBatch::flush()
+{
+    size_t total = 0;
+    for (const auto &group : groups_)
+        total += group.vertices.size();
+    if (total == 0)
+        return;
+
+    if (total > bufferVertices_)
+    {
+        if (vertexBuffer_ >= 0)
+            rs_->ReleaseVertexBuffer(vertexBuffer_);
+        bufferVertices_ = std::max(total, bufferVertices_ * 2);
+        vertexBuffer_ = rs_->CreateVertexBuffer(INI_PARTICLE_FVF, bufferVertices_ * sizeof(IniParticleVertex),
+                                                D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC);
+        if (vertexBuffer_ < 0)
+            bufferVertices_ = 0;
+    }
+
+    auto *vertices = vertexBuffer_ >= 0
+                         ? static_cast<IniParticleVertex *>(rs_->LockVertexBuffer(vertexBuffer_, D3DLOCK_DISCARD))
+                         : nullptr;
+    if (vertices == nullptr)
+    {
+        for (auto &group : groups_)
+            group.vertices.clear();
+        return;
+    }
+    for (const auto &group : groups_)
+    {
+        std::copy(group.vertices.begin(), group.vertices.end(), vertices);
+        vertices += group.vertices.size();
+    }
+    rs_->UnLockVertexBuffer(vertexBuffer_);
+
+    CMatrix view;
+    rs_->GetTransform(D3DTS_VIEW, view);
+    CMatrix identity;
+    rs_->SetTransform(D3DTS_VIEW, identity);
+    rs_->SetTransform(D3DTS_WORLD, identity);
+
+    int32_t start = 0;
+    for (auto &group : groups_)
+    {
+        const auto count = static_cast<int32_t>(group.vertices.size());
+        if (count == 0)
+            continue;
+        rs_->TextureSet(0, group.texture);
+        rs_->DrawPrimitive(D3DPT_TRIANGLELIST, vertexBuffer_, sizeof(IniParticleVertex), start, count / 3,
+                           group.technique.c_str());
+        start += count;
+        group.vertices.clear();
+    }
+
+    rs_->SetTransform(D3DTS_VIEW, view);
+}
+
+// ============================================================================================
+// IniParticleEmitter
+// ============================================================================================
+
+IniParticleEmitter::IniParticleEmitter(VDX9RENDER *rs, std::shared_ptr<const IniParticleParams> params)
+    : rs_(rs), system_(std::move(params)), linkPos_(0.0f), linkDirPos_(0.0f)
+{
+    for (const auto &texture : system_.params().textures)
+    {
+        const auto id = rs_->TextureCreate(texture.c_str());
+        if (id >= 0)
+            textures_.push_back(id);
+    }
+}
+
+IniParticleEmitter::~IniParticleEmitter()
+{
+    for (const auto id : textures_)
+        rs_->TextureRelease(id);
+}
+
+void IniParticleEmitter::SetEmitter(CVECTOR p, CVECTOR a)
+{
+    system_.setEmitter(p, a);
+}
+
+void IniParticleEmitter::LinkToObject(entid_t id, CVECTOR linkPos)
+{
+    linked_ = true;
+    linkObject_ = id;
+    linkPos_ = linkPos;
+    linkDirPos_ = linkPos + system_.emitterDir();
+
+    auto *link = static_cast<COLLISION_OBJECT *>(core.GetEntityPointer(linkObject_));
+    system_.relocate(link ? link->mtx * linkPos_ : system_.emitter());
+}
+
+void IniParticleEmitter::SetDelay(int32_t delay)
+{
+    system_.setDelay(delay);
+}
+
+void IniParticleEmitter::useSurface(entid_t surface)
+{
+    surfaced_ = true;
+    surface_ = surface;
+    system_.useSurface(true);
+}
+
+void IniParticleEmitter::realize(uint32_t dt, IniParticleBatch &batch)
+{
+    if (linked_)
+    {
+        auto *link = static_cast<COLLISION_OBJECT *>(core.GetEntityPointer(linkObject_));
+        if (link)
+        {
+            const CVECTOR pos = link->mtx * linkPos_;
+            system_.setEmitter(pos, link->mtx * linkDirPos_ - pos);
+        }
+    }
+
+    // one lookup and one trace for the particles emitted this frame
+    IniParticleSystem::SurfaceTrace trace;
+    if (surfaced_)
+        if (auto *surface = static_cast<COLLISION_OBJECT *>(core.GetEntityPointer(surface_)))
+            trace = [surface](const CVECTOR &from, const CVECTOR &to) { return surface->Trace(from, to); };
+
+    if (!system_.update(dt, trace) || system_.liveCount() == 0)
+        return;
+
+    CMatrix view;
+    rs_->GetTransform(D3DTS_VIEW, view);
+    auto *vertices = batch.add(textures_.empty() ? -1 : textures_[0], system_.params().technique,
+                               system_.liveCount());
+    system_.buildQuads(view, vertices);
+}
+
+} // namespace storm
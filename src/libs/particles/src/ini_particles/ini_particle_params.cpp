@@ -0,0 +1,147 @@
+#include "ini_particle_system.h"
+
+#include "core.h"
+#include "v_file_service.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#define MAX_PS_TEXTURES 8
+
+#define PSKEY_TEXTURE "texture"
+#define PSKEY_PNUM "particles_num"
+#define PSKEY_EMISSIONTIME "emissiontime"
+#define PSKEY_EMISSIONTIMERAND "emissiontime_rand"
+#define PSKEY_TECHNIQUE "technique"
+
+#define PSKEY_SURFACEOFFSET "surfaceoffset"
+
+#define PSKEY_WINDEFFECT "windeffect"
+#define PSKEY_DDEVIATION "ddeviation"
+#define PSKEY_GRAVITY "gravity"
+#define PSKEY_INISPEED "speed"
+#define PSKEY_SDEVIATION "speed_deviation"
+#define PSKEY_LIFETIME "lifetime"
+#define PSKEY_COLORINVERSE "inversecolor"
+#define PSKEY_SPIN "spin"
+#define PSKEY_SPINDEV "spin_deviation"
+#define PSKEY_EMITTERINITIME "emitter_initime"
+#define PSKEY_UNIFORMEMIT "uniformemit"
+#define PSKEY_WEIGHT "weight"
+#define PSKEY_WEIGHTDEVIATION "weight_deviation"
+#define PSKEY_RANDOMDIRECTION "randomdirection"
+#define PSKEY_NONSTOPEMIT "nonstopemit"
+#define PSKEY_EMITDELTA "emitdelta"
+#define PSKEY_EMITRADIUS "emit_radius"
+#define PSKEY_TRACKPOINTRADIUS "trackpoint_radius"
+
+#define PSKEY_ALPHAKEY "key_alpha"
+#define PSKEY_PSIZEKEY "key_psize"
+#define PSKEY_PSPEEDKEY "key_pspeed"
+#define PSKEY_PSPINKEY "key_spin"
+#define PSKEY_PANGLEKEY "key_angle"
+#define PSKEY_WINDEFFECTKEY "key_windeffect"
+
+namespace storm
+{
+
+namespace
+{
+
+// "value,time" keys, returns false if the key is not in the section
+bool BuildTrack(INIFILE &ini, ParticleTrack &track, const char *section, const char *key_name)
+{
+    ParticleTrack::Keys keys{};
+    char buffer[MAX_PATH];
+    bool found = false;
+
+    for (size_t n = 0; n < ParticleTrack::kMaxKeys; n++)
+    {
+        bool res;
+        if (n == 0)
+        {
+            res = ini.ReadString(section, key_name, buffer, sizeof(buffer), "0,-1");
+            found = res;
+        }
+        else
+            res = ini.ReadStringNext(section, key_name, buffer, sizeof(buffer));
+
+        if (!res)
+            break;
+        for (size_t i = 0; buffer[i]; i++)
+        {
+            if (buffer[i] == ',')
+            {
+                buffer[i] = 0;
+                keys[n].value = static_cast<float>(atof(buffer));
+                keys[n].time = atol(&buffer[i + 1]);
+                break;
+            }
+        }
+    }
+
+    track.build(keys);
+    return found;
+}
+
+} // namespace
+
+std::shared_ptr<const IniParticleParams> IniParticleParams::load(INIFILE &ini, const char *section)
+{
+    auto params = std::make_shared<IniParticleParams>();
+    auto &p = *params;
+    char string[MAX_PATH];
+
+    for (size_t n = 0; n < MAX_PS_TEXTURES; n++)
+    {
+        const bool res = n == 0 ? ini.ReadString(section, PSKEY_TEXTURE, string, sizeof(string), "")
+                                : ini.ReadStringNext(section, PSKEY_TEXTURE, string, sizeof(string));
+        if (!res)
+            break;
+        p.textures.emplace_back(string);
+    }
+
+    if (!ini.ReadString(section, PSKEY_TECHNIQUE, string, sizeof(string), ""))
+    {
+        core.Trace("Particle system: %s", section);
+        throw std::runtime_error("no technique for particle system");
+    }
+    p.technique = string;
+
+    p.particlesNum = ini.GetInt(section, PSKEY_PNUM, 32);
+    p.emissionTime = ini.GetFloat(section, PSKEY_EMISSIONTIME, 0);
+    p.emissionTimeRand = ini.GetFloat(section, PSKEY_EMISSIONTIMERAND, 0);
+    p.surfaceOffset = ini.GetFloat(section, PSKEY_SURFACEOFFSET, 0);
+    p.color = ini.GetInt(section, "color", 0xffffffff);
+
+    p.windEffect = ini.GetFloat(section, PSKEY_WINDEFFECT, 0.0f);
+    p.directionDeviation = ini.GetFloat(section, PSKEY_DDEVIATION, 0.0f);
+    p.gravity = ini.GetFloat(section, PSKEY_GRAVITY, 0.0f);
+    p.speed = ini.GetFloat(section, PSKEY_INISPEED, 0.0f);
+    p.speedDeviation = ini.GetFloat(section, PSKEY_SDEVIATION, 0.0f);
+    p.lifetime = ini.GetInt(section, PSKEY_LIFETIME, 1000);
+    p.spin = ini.GetFloat(section, PSKEY_SPIN, 0.0f);
+    p.spinDeviation = ini.GetFloat(section, PSKEY_SPINDEV, 0.0f);
+    p.emitterIniTime = ini.GetInt(section, PSKEY_EMITTERINITIME, 0);
+    p.weight = ini.GetFloat(section, PSKEY_WEIGHT, 0.0f);
+    p.weightDeviation = ini.GetFloat(section, PSKEY_WEIGHTDEVIATION, 0.0f);
+    p.emitDelta = ini.GetInt(section, PSKEY_EMITDELTA, 0);
+    p.emitRadius = ini.GetFloat(section, PSKEY_EMITRADIUS, 0);
+    p.trackPointRadius = ini.GetFloat(section, PSKEY_TRACKPOINTRADIUS, 1.0f);
+
+    p.colorInverse = ini.TestKey(section, PSKEY_COLORINVERSE, nullptr);
+    p.uniformEmit = ini.TestKey(section, PSKEY_UNIFORMEMIT, nullptr);
+    p.randomDirection = ini.TestKey(section, PSKEY_RANDOMDIRECTION, nullptr);
+    p.nonStopEmit = ini.TestKey(section, PSKEY_NONSTOPEMIT, nullptr);
+
+    BuildTrack(ini, p.alphaTrack, section, PSKEY_ALPHAKEY);
+    BuildTrack(ini, p.sizeTrack, section, PSKEY_PSIZEKEY);
+    BuildTrack(ini, p.speedTrack, section, PSKEY_PSPEEDKEY);
+    BuildTrack(ini, p.spinTrack, section, PSKEY_PSPINKEY);
+    BuildTrack(ini, p.windTrack, section, PSKEY_WINDEFFECTKEY);
+    p.hasAngleTrack = BuildTrack(ini, p.angleTrack, section, PSKEY_PANGLEKEY);
+
+    return params;
+}
+
+} // namespace storm
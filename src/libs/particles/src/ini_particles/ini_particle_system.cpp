@@ -0,0 +1,457 @@
+#include "ini_particle_system.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+
+namespace storm
+{
+
+namespace
+{
+
+constexpr float kChaos = 0.0001f;
+
+float Deviation()
+{
+    return 0.5f - static_cast<float>(rand()) / RAND_MAX;
+}
+
+} // namespace
+
+// ============================================================================================
+// ParticleTrack
+// ============================================================================================
+
+float ParticleTrack::search(const Keys &keys, int32_t time)
+{
+    if (time < 0)
+        return 0;
+
+    for (size_t n = 0; n < kMaxKeys; n++)
+    {
+        // if time - return value
+        if (time == keys[n].time)
+            return keys[n].value;
+
+        if (keys[n].time < 0)
+        {
+            // if no more keys - return previous value
+            if (n == 0)
+                return 0;
+            return keys[n - 1].value;
+        }
+        // skip already processed keys
+        if (time > keys[n].time)
+            continue;
+
+        const float v1 = n == 0 ? 0.0f : keys[n - 1].value;
+        const int32_t t1 = n == 0 ? 0 : keys[n - 1].time;
+        const float v2 = keys[n].value;
+        const int32_t t2 = keys[n].time;
+
+        if (t1 == t2)
+            return keys[n].value; // input error, double key
+
+        return v1 + (time - t1) * (v2 - v1) / (t2 - t1);
+    }
+    return 0;
+}
+
+void ParticleTrack::build(const Keys &keys)
+{
+    keys_ = keys;
+
+    // the search never looks past the first negative time, and is constant after the latest key before it
+    lastTime_ = -1;
+    for (const auto &key : keys_)
+    {
+        if (key.time < 0)
+            break;
+        lastTime_ = std::max(lastTime_, key.time);
+    }
+
+    table_.clear();
+    tail_ = search(keys_, lastTime_ + 1);
+    if (lastTime_ < 0)
+        return;
+
+    table_.resize(static_cast<size_t>(std::min(lastTime_, kMaxTableTime)) + 1);
+    for (size_t t = 0; t < table_.size(); t++)
+        table_[t] = search(keys_, static_cast<int32_t>(t));
+}
+
+// ============================================================================================
+// IniParticleSystem
+// ============================================================================================
+
+IniParticleSystem::IniParticleSystem(std::shared_ptr<const IniParticleParams> params)
+    : params_(std::move(params)), count_(static_cast<uint32_t>(std::max(params_->particlesNum, 0))),
+      emitter_(0.0f), emitterDir_(0.0f), windDir_(0.0f), repeat_(params_->nonStopEmit),
+      sinceEmission_(static_cast<int32_t>(params_->emissionTime))
+{
+    emissionRand_ = static_cast<float>(params_->emissionTimeRand) * rand() / RAND_MAX;
+
+    for (auto *v : {&posX_, &posY_, &posZ_, &dirX_, &dirY_, &dirZ_, &velX_, &velY_, &velZ_, &chaosX_, &chaosY_,
+                    &chaosZ_, &size_, &weight_, &spin_, &spinVal_, &angle_, &speed_, &speedChaos_, &speedVal_})
+        v->resize(count_);
+    time_.resize(count_);
+    trackIndex_.resize(count_);
+    color_.resize(count_);
+    live_.resize(count_);
+    idleBits_.resize((count_ + 63) / 64);
+    doneBits_.resize(idleBits_.size());
+
+    reset();
+}
+
+void IniParticleSystem::reset()
+{
+    const auto &p = *params_;
+
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        posX_[n] = emitter_.x + p.emitRadius * Deviation();
+        posY_[n] = emitter_.y + p.emitRadius * Deviation();
+        posZ_[n] = emitter_.z + p.emitRadius * Deviation();
+        size_[n] = 0.0f;
+        color_[n] = p.color;
+        weight_[n] = p.weight + p.weightDeviation * Deviation();
+        speedVal_[n] = p.speed + p.speedDeviation * Deviation();
+        speed_[n] = 0.0f;
+
+        setDirection(n);
+
+        chaosX_[n] = kChaos * Deviation();
+        chaosY_[n] = kChaos * Deviation();
+        chaosZ_[n] = kChaos * Deviation();
+        speedChaos_[n] = 1.0f - 0.1f * (static_cast<float>(rand()) / RAND_MAX);
+
+        velX_[n] = dirX_[n] * speed_[n];
+        velY_[n] = dirY_[n] * speed_[n];
+        velZ_[n] = dirZ_[n] * speed_[n];
+
+        time_[n] = 0;
+        trackIndex_[n] = 0;
+        angle_[n] = 0.0f;
+        live_[n] = 0;
+
+        spinVal_[n] = p.spin + p.spinDeviation * Deviation();
+        spin_[n] = spinVal_[n];
+    }
+
+    std::fill(idleBits_.begin(), idleBits_.end(), ~uint64_t{0});
+    std::fill(doneBits_.begin(), doneBits_.end(), 0);
+    liveCount_ = 0;
+    doneCount_ = 0;
+    surfaceQueue_.clear();
+}
+
+void IniParticleSystem::setDirection(uint32_t i)
+{
+    const auto &p = *params_;
+
+    CVECTOR dir;
+    if (p.randomDirection)
+    {
+        dir.x = Deviation();
+        dir.y = Deviation();
+        dir.z = Deviation();
+    }
+    else
+    {
+        dir.x = emitterDir_.x + p.directionDeviation * Deviation();
+        dir.y = emitterDir_.y + p.directionDeviation * Deviation();
+        dir.z = emitterDir_.z + p.directionDeviation * Deviation();
+    }
+    dir = !dir;
+    dirX_[i] = dir.x;
+    dirY_[i] = dir.y;
+    dirZ_[i] = dir.z;
+}
+
+void IniParticleSystem::setEmitter(const CVECTOR &pos, const CVECTOR &dir)
+{
+    emitter_ = pos;
+    emitterDir_ = !dir;
+}
+
+void IniParticleSystem::relocate(const CVECTOR &pos)
+{
+    emitter_ = pos;
+    const float radius = params_->emitRadius;
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        posX_[n] = emitter_.x + radius * Deviation();
+        posY_[n] = emitter_.y + radius * Deviation();
+        posZ_[n] = emitter_.z + radius * Deviation();
+    }
+}
+
+void IniParticleSystem::setDelay(int32_t delay)
+{
+    delay_ = delay;
+    if (delay_ > 0)
+        for (auto &color : color_)
+            color &= 0xffffff;
+}
+
+void IniParticleSystem::setWind(const CVECTOR &dir, float power)
+{
+    windDir_ = dir;
+    windPower_ = power;
+}
+
+void IniParticleSystem::addTrackPoint(const CVECTOR &pos)
+{
+    track_.push_back(pos);
+}
+
+bool IniParticleSystem::emit()
+{
+    if (!enableEmit_)
+        return false;
+
+    // first particle which is not live, and not done unless the system repeats
+    for (size_t w = 0; w < idleBits_.size(); w++)
+    {
+        const uint64_t bits = repeat_ ? idleBits_[w] : idleBits_[w] & ~doneBits_[w];
+        if (bits == 0)
+            continue;
+        const auto n = static_cast<uint32_t>(w * 64 + std::countr_zero(bits));
+        if (n >= count_)
+            return false;
+
+        time_[n] = 0;
+        trackIndex_[n] = 0;
+        posX_[n] = emitter_.x + params_->emitRadius * Deviation();
+        posY_[n] = emitter_.y + params_->emitRadius * Deviation();
+        posZ_[n] = emitter_.z + params_->emitRadius * Deviation();
+        speed_[n] = 0.0f;
+        setDirection(n);
+        velX_[n] = dirX_[n] * speed_[n];
+        velY_[n] = dirY_[n] * speed_[n];
+        velZ_[n] = dirZ_[n] * speed_[n];
+
+        live_[n] = 1;
+        idleBits_[w] &= ~(uint64_t{1} << (n & 63));
+        liveCount_++;
+        if (useSurface_)
+            surfaceQueue_.push_back(n);
+        return true;
+    }
+    return false;
+}
+
+void IniParticleSystem::kill(uint32_t i)
+{
+    const auto &p = *params_;
+    const uint64_t bit = uint64_t{1} << (i & 63);
+
+    live_[i] = 0;
+    idleBits_[i / 64] |= bit;
+    liveCount_--;
+    if (!repeat_ && !(doneBits_[i / 64] & bit))
+    {
+        doneBits_[i / 64] |= bit;
+        doneCount_++;
+    }
+    size_[i] = 0;
+    color_[i] = p.color;
+    if (p.color != 0xffffffff)
+    {
+        color_[i] &= 0xff000000;
+        color_[i] |= 0xffffff * rand() / RAND_MAX;
+    }
+    time_[i] = 0;
+}
+
+void IniParticleSystem::integrate(float dt)
+{
+    const float gravity = params_->gravity;
+
+    // branch free over the whole pool so the compiler can vectorize it, idle particles keep their state
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        const bool live = live_[n] != 0;
+        const float px = posX_[n] + dt * (velX_[n] + chaosX_[n]);
+        const float py = posY_[n] + dt * (velY_[n] + chaosY_[n]);
+        const float pz = posZ_[n] + dt * (velZ_[n] + chaosZ_[n]);
+        const float angle = angle_[n] + dt * spin_[n];
+        const float speed = speed_[n] * speedChaos_[n];
+        posX_[n] = live ? px : posX_[n];
+        posY_[n] = live ? py - weight_[n] * gravity * dt : posY_[n];
+        posZ_[n] = live ? pz : posZ_[n];
+        angle_[n] = live ? angle : angle_[n];
+        speed_[n] = live ? speed : speed_[n];
+        velX_[n] = dirX_[n] * speed_[n];
+        velY_[n] = dirY_[n] * speed_[n];
+        velZ_[n] = dirZ_[n] * speed_[n];
+    }
+}
+
+void IniParticleSystem::followTrack(float dt)
+{
+    const auto points = static_cast<uint32_t>(track_.size());
+    const float radius = params_->trackPointRadius;
+
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        if (!live_[n])
+            continue;
+        posX_[n] += dt * (velX_[n] + chaosX_[n]);
+        posY_[n] += dt * (velY_[n] + chaosY_[n]);
+        posZ_[n] += dt * (velZ_[n] + chaosZ_[n]);
+
+        // turn to the current point, the next one is taken within the radius
+        if (trackIndex_[n] < points)
+        {
+            const CVECTOR dest = track_[trackIndex_[n]] - CVECTOR(posX_[n], posY_[n], posZ_[n]);
+            const CVECTOR dir = !dest;
+            dirX_[n] = dir.x;
+            dirY_[n] = dir.y;
+            dirZ_[n] = dir.z;
+            if (~dest < radius)
+                trackIndex_[n]++;
+        }
+
+        speed_[n] *= speedChaos_[n];
+        velX_[n] = dirX_[n] * speed_[n];
+        velY_[n] = dirY_[n] * speed_[n];
+        velZ_[n] = dirZ_[n] * speed_[n];
+    }
+}
+
+void IniParticleSystem::applyTracks(uint32_t dt)
+{
+    const auto &p = *params_;
+    const bool wind = p.windEffect != 0.0f && windPower_ != 0.0f;
+
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        if (!live_[n])
+            continue;
+        const int32_t time = time_[n];
+
+        const auto alpha = static_cast<uint32_t>(static_cast<float>(0xff) * p.alphaTrack.value(time));
+        color_[n] = ((alpha << 24) & 0xff000000) | (color_[n] & 0xffffff);
+        size_[n] = p.sizeTrack.value(time);
+        speed_[n] = speedVal_[n] * p.speedTrack.value(time);
+        spin_[n] = spinVal_[n] * p.spinTrack.value(time);
+        if (p.hasAngleTrack)
+            angle_[n] = p.angleTrack.value(time);
+
+        if (wind)
+        {
+            const float val = p.windTrack.value(time) * p.windEffect;
+            const CVECTOR move = (dt * val * windPower_) * windDir_;
+            posX_[n] += move.x;
+            posY_[n] += move.y;
+            posZ_[n] += move.z;
+        }
+    }
+}
+
+bool IniParticleSystem::update(uint32_t dt, const SurfaceTrace &surface)
+{
+    const auto &p = *params_;
+
+    if (delay_ > 0)
+    {
+        delay_ = delay_ - dt;
+        return false;
+    }
+
+    if (lifeTime_ > 0)
+    {
+        lifeTime_ = lifeTime_ - dt;
+        if (lifeTime_ <= 0)
+            repeat_ = false;
+    }
+
+    // ageing, which draws rand() for the particles done in the slot order
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        if (!live_[n])
+            continue;
+        time_[n] += dt;
+        if (time_[n] > p.lifetime)
+            kill(n);
+    }
+    if (liveCount_ > 0)
+    {
+        if (track_.empty())
+            integrate(static_cast<float>(dt));
+        else
+            followTrack(static_cast<float>(dt));
+    }
+
+    sinceEmission_ += dt;
+    if (sinceEmission_ >= (p.emissionTime + emissionRand_))
+    {
+        if (emit())
+            sinceEmission_ = 0;
+        emissionRand_ = static_cast<float>(p.emissionTimeRand) * rand() / RAND_MAX;
+    }
+
+    if (!repeat_)
+    {
+        emitted_++;
+        if (emitted_ > count_)
+            complete_ = doneCount_ == count_;
+    }
+
+    // one trace under the emitter for every particle emitted during the step, they are within the emit radius
+    if (!surfaceQueue_.empty())
+    {
+        if (surface)
+        {
+            const CVECTOR from(emitter_.x, 100.0f, emitter_.z);
+            const CVECTOR to(emitter_.x, -100.0f, emitter_.z);
+            const float height = from.y + surface(from, to) * (to.y - from.y) + p.surfaceOffset;
+            for (const auto n : surfaceQueue_)
+                posY_[n] = height;
+        }
+        surfaceQueue_.clear();
+    }
+
+    applyTracks(dt);
+    return true;
+}
+
+uint32_t IniParticleSystem::buildQuads(const CMatrix &view, IniParticleVertex *out) const
+{
+    static constexpr float kU[6] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+    static constexpr float kV[6] = {0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f};
+
+    CMatrix mtx = view;
+    uint32_t quads = 0;
+    for (uint32_t n = 0; n < count_; n++)
+    {
+        if (!live_[n])
+            continue;
+
+        const CVECTOR local = mtx * CVECTOR(posX_[n], posY_[n], posZ_[n]);
+        const float half = size_[n] / 2.0f;
+        const float c = cosf(angle_[n]) * half;
+        const float s = sinf(angle_[n]) * half;
+        // corners (-h, h), (-h, -h), (h, -h), (h, h) rotated around z
+        const float cornerX[4] = {local.x - c - s, local.x - c + s, local.x + c + s, local.x + c - s};
+        const float cornerY[4] = {local.y - s + c, local.y - s - c, local.y + s - c, local.y + s + c};
+        static constexpr uint32_t kCorner[6] = {0, 1, 2, 0, 2, 3};
+
+        auto *v = out + quads * 6;
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            v[i].pos = CVECTOR(cornerX[kCorner[i]], cornerY[kCorner[i]], local.z);
+            v[i].color = color_[n];
+            v[i].tu = kU[i];
+            v[i].tv = kV[i];
+        }
+        quads++;
+    }
+    return quads;
+}
+
+} // namespace storm
@@ -0,0 +1,480 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "ini_particle_system.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+using Keys = storm::ParticleTrack::Keys;
+
+// The simulation of SEAFOAM_PS/SEPS_PS as it was, without rendering
+class ReferenceSystem
+{
+    struct PARTICLE
+    {
+        CVECTOR pos, ang, v, chaos;
+        float size, weight, spin, spinVal, angle, speed, speed_chaos, speedVal;
+        int32_t time;
+        uint32_t flow_track_index;
+        uint32_t color;
+        bool live, done;
+    };
+
+  public:
+    ReferenceSystem(const storm::IniParticleParams &p, const Keys &alpha, const Keys &size, const Keys &speed,
+                    const Keys &spin, const Keys &angle)
+        : p_(p), Visibility(alpha), ParticleSize(size), ParticleSpeed(speed), ParticleSpin(spin),
+          ParticleAngle(angle)
+    {
+        ParticlesNum = p.particlesNum;
+        bRepeat = p.nonStopEmit;
+        DeltaTimeSLE = static_cast<int32_t>(p.emissionTime);
+        CurrentEmissionTimeRand = static_cast<float>(p.emissionTimeRand) * rand() / RAND_MAX;
+
+        Particle.resize(ParticlesNum);
+        for (int32_t n = 0; n < ParticlesNum; n++)
+        {
+            Particle[n] = {};
+            Particle[n].pos.x = Emitter.x + p.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].pos.y = Emitter.y + p.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].pos.z = Emitter.z + p.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].size = 0.0f;
+            Particle[n].color = p.color;
+            Particle[n].weight = p.weight + p.weightDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].speedVal = p.speed + p.speedDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].speed = 0;
+            SetDirection(n);
+            Particle[n].chaos.x = 0.0001f * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].chaos.y = 0.0001f * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].chaos.z = 0.0001f * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].speed_chaos = 1.0f - 0.1f * (static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].v = Particle[n].ang * Particle[n].speed;
+            Particle[n].spinVal = p.spin + p.spinDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].spin = Particle[n].spinVal;
+        }
+    }
+
+    void SetEmitter(CVECTOR pos, CVECTOR a)
+    {
+        Emitter = pos;
+        EmitterDirection = !a;
+    }
+
+    void AddTrackPoint(CVECTOR pos)
+    {
+        bUseFlowTrack = true;
+        pFlowTrack.push_back(pos);
+    }
+
+    void Update(uint32_t DeltaTime)
+    {
+        ProcessParticles(DeltaTime);
+        SetParticlesTracks();
+    }
+
+    std::vector<PARTICLE> Particle;
+    bool bComplete = false;
+
+  private:
+    void SetDirection(int32_t n)
+    {
+        if (p_.randomDirection)
+        {
+            Particle[n].ang.x = (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].ang.y = (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].ang.z = (0.5f - static_cast<float>(rand()) / RAND_MAX);
+        }
+        else
+        {
+            Particle[n].ang.x =
+                EmitterDirection.x + p_.directionDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].ang.y =
+                EmitterDirection.y + p_.directionDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].ang.z =
+                EmitterDirection.z + p_.directionDeviation * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+        }
+        Particle[n].ang = !Particle[n].ang;
+    }
+
+    bool EmitParticle()
+    {
+        for (int32_t n = 0; n < ParticlesNum; n++)
+        {
+            if (Particle[n].live)
+                continue;
+            if (Particle[n].done && (!bRepeat))
+                continue;
+            Particle[n].time = 0;
+            Particle[n].flow_track_index = 0;
+            Particle[n].pos.x = Emitter.x + p_.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].pos.y = Emitter.y + p_.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].pos.z = Emitter.z + p_.emitRadius * (0.5f - static_cast<float>(rand()) / RAND_MAX);
+            Particle[n].speed = 0;
+            SetDirection(n);
+            Particle[n].v = Particle[n].ang * Particle[n].speed;
+            Particle[n].live = true;
+            return true;
+        }
+        return false;
+    }
+
+    void ProcessParticles(uint32_t DeltaTime)
+    {
+        for (int32_t n = 0; n < ParticlesNum; n++)
+        {
+            if (!Particle[n].live)
+                continue;
+
+            Particle[n].time += DeltaTime;
+            if (Particle[n].time > p_.lifetime)
+            {
+                Particle[n].live = false;
+                if (!bRepeat)
+                    Particle[n].done = true;
+                Particle[n].size = 0;
+                Particle[n].color = p_.color;
+                if (p_.color != 0xffffffff)
+                {
+                    Particle[n].color &= 0xff000000;
+                    Particle[n].color |= 0xffffff * rand() / RAND_MAX;
+                }
+                Particle[n].time = 0;
+                continue;
+            }
+
+            if (bUseFlowTrack)
+            {
+                Particle[n].pos.x += DeltaTime * (Particle[n].v.x + Particle[n].chaos.x);
+                Particle[n].pos.y += DeltaTime * (Particle[n].v.y + Particle[n].chaos.y);
+                Particle[n].pos.z += DeltaTime * (Particle[n].v.z + Particle[n].chaos.z);
+                SetFlowTrack(n);
+                Particle[n].speed *= Particle[n].speed_chaos;
+                Particle[n].v = Particle[n].ang * Particle[n].speed;
+            }
+            else
+            {
+                Particle[n].pos.x += DeltaTime * (Particle[n].v.x + Particle[n].chaos.x);
+                Particle[n].pos.y += DeltaTime * (Particle[n].v.y + Particle[n].chaos.y);
+                Particle[n].pos.z += DeltaTime * (Particle[n].v.z + Particle[n].chaos.z);
+                Particle[n].angle += DeltaTime * Particle[n].spin;
+                Particle[n].pos.y -= Particle[n].weight * p_.gravity * DeltaTime;
+                Particle[n].speed *= Particle[n].speed_chaos;
+                Particle[n].v = Particle[n].ang * Particle[n].speed;
+            }
+        }
+
+        DeltaTimeSLE += DeltaTime;
+        if (DeltaTimeSLE >= (p_.emissionTime + CurrentEmissionTimeRand))
+        {
+            if (EmitParticle())
+                DeltaTimeSLE = 0;
+            CurrentEmissionTimeRand = static_cast<float>(p_.emissionTimeRand) * rand() / RAND_MAX;
+        }
+
+        if (!bRepeat)
+        {
+            nEmitted++;
+            if (static_cast<int>(nEmitted) > ParticlesNum)
+            {
+                bComplete = true;
+                for (int32_t n = 0; n < ParticlesNum; n++)
+                {
+                    if (Particle[n].done)
+                        continue;
+                    bComplete = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    void SetFlowTrack(uint32_t index)
+    {
+        CVECTOR dest;
+        if (Particle[index].flow_track_index >= pFlowTrack.size())
+            return;
+        dest = pFlowTrack[Particle[index].flow_track_index];
+        dest = dest - Particle[index].pos;
+        Particle[index].ang = !dest;
+        const auto dist = ~dest;
+        if (dist < p_.trackPointRadius)
+        {
+            Particle[index].flow_track_index++;
+        }
+    }
+
+    void SetParticlesTracks()
+    {
+        for (int32_t n = 0; n < ParticlesNum; n++)
+        {
+            if (!Particle[n].live)
+                continue;
+            const auto val = storm::ParticleTrack::search(Visibility, Particle[n].time);
+            const auto alpha = static_cast<uint32_t>(static_cast<float>(0xff) * val);
+            Particle[n].color = ((alpha << 24) & 0xff000000) | (Particle[n].color & 0xffffff);
+            Particle[n].size = storm::ParticleTrack::search(ParticleSize, Particle[n].time);
+            Particle[n].speed = Particle[n].speedVal * storm::ParticleTrack::search(ParticleSpeed, Particle[n].time);
+            Particle[n].spin = Particle[n].spinVal * storm::ParticleTrack::search(ParticleSpin, Particle[n].time);
+            if (ParticleAngle[0].time >= 0)
+                Particle[n].angle = storm::ParticleTrack::search(ParticleAngle, Particle[n].time);
+        }
+    }
+
+    const storm::IniParticleParams &p_;
+    Keys Visibility, ParticleSize, ParticleSpeed, ParticleSpin, ParticleAngle;
+    int32_t ParticlesNum;
+    bool bRepeat;
+    int32_t DeltaTimeSLE;
+    float CurrentEmissionTimeRand;
+    uint32_t nEmitted = 0;
+    bool bUseFlowTrack = false;
+    std::vector<CVECTOR> pFlowTrack;
+    CVECTOR Emitter{0.0f};
+    CVECTOR EmitterDirection{0.0f};
+};
+
+Keys MakeKeys(std::initializer_list<storm::ParticleTrack::Key> list)
+{
+    Keys keys{};
+    std::copy(list.begin(), list.end(), keys.begin());
+    return keys;
+}
+
+struct TestCase
+{
+    storm::IniParticleParams params;
+    Keys alpha, size, speed, spin, angle;
+
+    std::shared_ptr<const storm::IniParticleParams> build()
+    {
+        params.alphaTrack.build(alpha);
+        params.sizeTrack.build(size);
+        params.speedTrack.build(speed);
+        params.spinTrack.build(spin);
+        params.angleTrack.build(angle);
+        params.hasAngleTrack = angle[0].time >= 0;
+        return std::make_shared<const storm::IniParticleParams>(params);
+    }
+};
+
+// like the "seafoam" section: endless emission of slowly rising, fading puffs
+TestCase FoamCase()
+{
+    TestCase c;
+    c.params.particlesNum = 40;
+    c.params.emissionTime = 25.0f;
+    c.params.emissionTimeRand = 15.0f;
+    c.params.lifetime = 900;
+    c.params.gravity = 0.0002f;
+    c.params.weight = 1.0f;
+    c.params.weightDeviation = 0.5f;
+    c.params.speed = 0.004f;
+    c.params.speedDeviation = 0.002f;
+    c.params.spin = 0.002f;
+    c.params.spinDeviation = 0.004f;
+    c.params.directionDeviation = 0.6f;
+    c.params.emitRadius = 0.8f;
+    c.params.nonStopEmit = true;
+    c.alpha = MakeKeys({{0, 0.0f}, {100, 0.8f}, {600, 0.5f}, {900, 0.0f}});
+    c.size = MakeKeys({{0, 0.5f}, {900, 3.0f}});
+    c.speed = MakeKeys({{0, 1.0f}, {300, 0.4f}, {900, 0.1f}});
+    c.spin = MakeKeys({{0, 1.0f}});
+    return c;
+}
+
+// one burst in random directions which runs out, with tinted particles and an angle track
+TestCase BurstCase()
+{
+    TestCase c;
+    c.params.particlesNum = 150;
+    c.params.emissionTime = 0.0f;
+    c.params.lifetime = 400;
+    c.params.gravity = 0.001f;
+    c.params.weight = 1.0f;
+    c.params.speed = 0.01f;
+    c.params.speedDeviation = 0.005f;
+    c.params.randomDirection = true;
+    c.params.color = 0x80ff8040;
+    c.alpha = MakeKeys({{0, 1.0f}, {400, 0.0f}});
+    c.size = MakeKeys({{0, 0.2f}, {200, 1.0f}, {200, 1.5f}, {400, 0.1f}});
+    c.speed = MakeKeys({{0, 1.0f}});
+    c.spin = MakeKeys({});
+    c.angle = MakeKeys({{0, 0.0f}, {400, 3.14f}});
+    return c;
+}
+
+void CompareRuns(TestCase c, uint32_t seed, int frames, const std::vector<CVECTOR> &track = {})
+{
+    const auto params = c.build();
+
+    srand(seed);
+    ReferenceSystem reference(*params, c.alpha, c.size, c.speed, c.spin, c.angle);
+    for (const auto &point : track)
+        reference.AddTrackPoint(point);
+    std::vector<std::pair<CVECTOR, uint32_t>> expected;
+    std::vector<bool> expectedComplete;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        const auto t = static_cast<float>(frame);
+        reference.SetEmitter(CVECTOR(t * 0.3f, 0.1f * sinf(t * 0.1f), -t * 0.2f), CVECTOR(0.1f, 1.0f, 0.0f));
+        reference.Update(10 + (frame * 7) % 30);
+        for (const auto &particle : reference.Particle)
+            expected.emplace_back(particle.live ? particle.pos : CVECTOR(0.0f), particle.live ? particle.color : 0);
+        expectedComplete.push_back(reference.bComplete);
+    }
+
+    srand(seed);
+    storm::IniParticleSystem system(params);
+    for (const auto &point : track)
+        system.addTrackPoint(point);
+    size_t index = 0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        const auto t = static_cast<float>(frame);
+        system.setEmitter(CVECTOR(t * 0.3f, 0.1f * sinf(t * 0.1f), -t * 0.2f), CVECTOR(0.1f, 1.0f, 0.0f));
+        REQUIRE(system.update(10 + (frame * 7) % 30));
+        for (uint32_t n = 0; n < system.size(); n++, index++)
+        {
+            const auto pos = system.live(n) ? system.position(n) : CVECTOR(0.0f);
+            const auto color = system.live(n) ? system.color(n) : 0;
+            REQUIRE(pos.x == expected[index].first.x);
+            REQUIRE(pos.y == expected[index].first.y);
+            REQUIRE(pos.z == expected[index].first.z);
+            REQUIRE(color == expected[index].second);
+        }
+        REQUIRE(system.complete() == expectedComplete[frame]);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Baked particle tracks match the keyframe search", "[particles]")
+{
+    const std::vector<Keys> tracks = {
+        MakeKeys({}),
+        MakeKeys({{0, 1.0f}}),
+        MakeKeys({{100, 0.5f}, {400, 1.0f}, {1000, 0.0f}}),
+        // double key and keys out of order, as the ini files may have them
+        MakeKeys({{0, 0.0f}, {200, 1.0f}, {200, 2.0f}, {150, 0.5f}, {700, 0.2f}}),
+        // ends at the first negative time
+        MakeKeys({{0, 1.0f}, {300, 0.0f}, {-1, 0.0f}, {900, 5.0f}}),
+    };
+    Keys full{};
+    for (size_t i = 0; i < full.size(); i++)
+        full[i] = {static_cast<int32_t>(i * 50), static_cast<float>(i % 3)};
+
+    auto all = tracks;
+    all.push_back(full);
+    for (const auto &keys : all)
+    {
+        storm::ParticleTrack track;
+        track.build(keys);
+        for (int32_t t = -5; t < 2000; t++)
+            REQUIRE(track.value(t) == storm::ParticleTrack::search(keys, t));
+    }
+}
+
+TEST_CASE("Pooled particles move as the old systems did for fixed seeds", "[particles]")
+{
+    for (const uint32_t seed : {1u, 77u, 20210u})
+    {
+        CompareRuns(FoamCase(), seed, 400);
+        CompareRuns(BurstCase(), seed, 120);
+    }
+}
+
+TEST_CASE("Particles follow the flow track as the old systems did", "[particles]")
+{
+    auto c = FoamCase();
+    c.params.trackPointRadius = 1.5f;
+    c.params.speed = 0.02f;
+    const std::vector<CVECTOR> track = {CVECTOR(2.0f, 0.5f, 1.0f), CVECTOR(6.0f, 0.0f, -3.0f),
+                                        CVECTOR(10.0f, -1.0f, -8.0f)};
+    for (const uint32_t seed : {1u, 77u, 20210u})
+        CompareRuns(c, seed, 400, track);
+}
+
+TEST_CASE("Particles are laid on the surface when they are emitted", "[particles]")
+{
+    auto c = FoamCase();
+    c.params.surfaceOffset = 0.25f;
+    c.params.emitRadius = 0.0f;
+    storm::IniParticleSystem system(c.build());
+    system.useSurface(true);
+    system.setEmitter(CVECTOR(3.0f, 7.0f, 4.0f), CVECTOR(0.0f, 1.0f, 0.0f));
+
+    // plane at y = -2
+    uint32_t traces = 0;
+    const auto surface = [&traces](const CVECTOR &from, const CVECTOR &to) {
+        traces++;
+        return (from.y + 2.0f) / (from.y - to.y);
+    };
+    system.update(100, surface);
+    REQUIRE(traces == 1);
+    REQUIRE(system.live(0));
+    REQUIRE(system.position(0).y == Approx(-1.75f));
+
+    // the sample is taken under the emitter, not under each particle
+    c.params.emitRadius = 0.8f;
+    storm::IniParticleSystem spread(c.build());
+    spread.useSurface(true);
+    spread.setEmitter(CVECTOR(3.0f, 7.0f, 4.0f), CVECTOR(0.0f, 1.0f, 0.0f));
+    std::vector<CVECTOR> samples;
+    for (int step = 0; step < 20; step++)
+        spread.update(10, [&samples](const CVECTOR &from, const CVECTOR &to) {
+            samples.push_back(from);
+            return (from.y + 2.0f) / (from.y - to.y);
+        });
+    REQUIRE(!samples.empty());
+    REQUIRE(samples.size() <= 20);
+    for (const auto &from : samples)
+    {
+        REQUIRE(from.x == 3.0f);
+        REQUIRE(from.z == 4.0f);
+    }
+}
+
+TEST_CASE("Pooled particles benchmark", "[.][particles][benchmark]")
+{
+    constexpr size_t kSystems = 64;
+    auto c = FoamCase();
+    c.params.particlesNum = 128;
+    c.params.emissionTime = 5.0f;
+    c.params.lifetime = 5 * 128;
+    const auto params = c.build();
+
+    std::vector<std::unique_ptr<ReferenceSystem>> reference;
+    std::vector<std::unique_ptr<storm::IniParticleSystem>> pooled;
+    for (size_t i = 0; i < kSystems; i++)
+    {
+        reference.push_back(std::make_unique<ReferenceSystem>(*params, c.alpha, c.size, c.speed, c.spin, c.angle));
+        pooled.push_back(std::make_unique<storm::IniParticleSystem>(params));
+    }
+    // fill the pools
+    for (int frame = 0; frame < 200; frame++)
+        for (size_t i = 0; i < kSystems; i++)
+        {
+            reference[i]->Update(5);
+            pooled[i]->update(5);
+        }
+
+    BENCHMARK("old systems")
+    {
+        for (auto &system : reference)
+            system->Update(5);
+        return reference.back()->Particle.back().pos.y;
+    };
+
+    BENCHMARK("pooled systems")
+    {
+        for (auto &system : pooled)
+            system->update(5);
+        return pooled.back()->position(0).y;
+    };
+}
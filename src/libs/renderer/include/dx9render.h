@@ -248,6 +248,9 @@ class VDX9RENDER : public SERVICE
     // DX9Render: Techniques Section
     virtual bool TechniqueExecuteStart(const char *cBlockName) = 0;
     virtual bool TechniqueExecuteNext() = 0;
+    // true when a pass of the technique turns alpha blending on, so its draws depend on what was drawn before;
+    // found out once when the techniques are loaded
+    virtual bool IsTechniqueBlended(const char *cBlockName) = 0;
 
     // DX9Render: Draw Section
     virtual void DrawRects(RS_RECT *pRSR, uint32_t dwRectsNum, const char *cBlockName = nullptr,
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+namespace storm
+{
+
+/**
+ * \brief Contents of a texture file in memory, aligned so mips can be copied straight into locked surfaces
+ */
+class TextureFileData final
+{
+  public:
+    static constexpr size_t kAlignment = 16;
+
+    explicit TextureFileData(size_t size);
+    TextureFileData(const TextureFileData &) = delete;
+    TextureFileData &operator=(const TextureFileData &) = delete;
+
+    [[nodiscard]] uint8_t *data()
+    {
+        return data_.get();
+    }
+
+    [[nodiscard]] const uint8_t *data() const
+    {
+        return data_.get();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return size_;
+    }
+
+  private:
+    struct Deleter
+    {
+        void operator()(uint8_t *p) const
+        {
+            ::operator delete[](p, std::align_val_t{kAlignment});
+        }
+    };
+
+    std::unique_ptr<uint8_t[], Deleter> data_;
+    size_t size_;
+};
+
+/**
+ * \brief Least recently used cache of the files of released textures
+ *
+ * A texture gives its file back when it is released, so a texture which is created again after a location change
+ * is uploaded without touching the disk. Files of live textures are not kept, the capacity bounds released files only.
+ * Every file keeps the modification time it was read with, a file changed on disk since then is read anew.
+ */
+class TextureCache final
+{
+  public:
+    using Data = std::unique_ptr<TextureFileData>;
+
+    explicit TextureCache(size_t capacity = 0);
+
+    // 0 disables caching
+    void setCapacity(size_t bytes);
+
+    // returns nullptr on a miss, a hit leaves the cache as its texture is alive again, a stale file is dropped
+    [[nodiscard]] Data take(const std::string &name, std::filesystem::file_time_type time);
+    // files larger than the capacity are not stored, the least recently released ones are dropped to fit
+    void insert(const std::string &name, std::filesystem::file_time_type time, Data data);
+    void clear();
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    [[nodiscard]] size_t usage() const
+    {
+        return usage_;
+    }
+
+    [[nodiscard]] size_t count() const
+    {
+        return entries_.size();
+    }
+
+  private:
+    struct Entry
+    {
+        std::string name;
+        std::filesystem::file_time_type time;
+        Data data;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+    void trim();
+
+    // front is the most recently released
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t capacity_;
+    size_t usage_{};
+};
+
+} // namespace storm
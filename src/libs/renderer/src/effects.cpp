@@ -70,13 +70,43 @@ void Effects::compile(const char *fxPath)
         }
         else
         {
-            techniques_.emplace(std::move(name_in_lowercase), Technique(fx, technique, desc));
+            const bool blended = isPassBlended(fx, technique, desc.Passes);
+            techniques_.emplace(std::move(name_in_lowercase), Technique(fx, technique, desc, blended));
         }
 
         CHECKD3DERR(fx->FindNextValidTechnique(technique, &technique));
     }
 }
 
+bool Effects::isPassBlended(ID3DXEffect *fx, D3DXHANDLE technique, uint32_t passes)
+{
+    IDirect3DStateBlock9 *stateBlock = nullptr;
+    if (CHECKD3DERR(device_->CreateStateBlock(D3DSBT_ALL, &stateBlock)))
+        return false;
+    stateBlock->Capture();
+    device_->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
+
+    DWORD blend = FALSE;
+    UINT count = 0;
+    CHECKD3DERR(fx->SetTechnique(technique));
+    if (!CHECKD3DERR(fx->Begin(&count, D3DXFX_DONOTSAVESTATE)))
+    {
+        for (uint32_t pass = 0; pass < passes && pass < count; pass++)
+        {
+            CHECKD3DERR(fx->BeginPass(pass));
+            DWORD passBlend = FALSE;
+            device_->GetRenderState(D3DRS_ALPHABLENDENABLE, &passBlend);
+            blend |= passBlend;
+            CHECKD3DERR(fx->EndPass());
+        }
+        CHECKD3DERR(fx->End());
+    }
+
+    stateBlock->Apply();
+    stateBlock->Release();
+    return blend != FALSE;
+}
+
 void Effects::release()
 {
     for (auto *fx : effects_)
@@ -138,6 +168,17 @@ bool Effects::next()
     return false;
 }
 
+bool Effects::isBlended(const std::string &techniqueName) const
+{
+    // transform to lowercase to be compliant with the original code
+    std::string name_in_lowercase;
+    name_in_lowercase.reserve(techniqueName.length());
+    std::transform(std::begin(techniqueName), std::end(techniqueName), std::back_inserter(name_in_lowercase), tolower);
+
+    const auto technique = techniques_.find(name_in_lowercase);
+    return technique != techniques_.end() && technique->second.blended;
+}
+
 ID3DXEffect *Effects::getEffectPointer(const std::string &techniqueName)
 {
     // transform to lowercase to be compliant with the original code
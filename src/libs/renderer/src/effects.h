@@ -13,13 +13,15 @@ class Effects final
   private:
     struct Technique
     {
-        Technique(ID3DXEffect *fx, D3DXHANDLE handle, D3DXTECHNIQUE_DESC desc) : fx(fx), handle(handle), desc(desc)
+        Technique(ID3DXEffect *fx, D3DXHANDLE handle, D3DXTECHNIQUE_DESC desc, bool blended)
+            : fx(fx), handle(handle), desc(desc), blended(blended)
         {
         }
 
         ID3DXEffect *fx;
         D3DXHANDLE handle;
         D3DXTECHNIQUE_DESC desc;
+        bool blended; // a pass turns alpha blending on
     };
 
     IDirect3DDevice9 *device_;
@@ -33,6 +35,8 @@ class Effects final
     std::string_view debugMsg_;
 
     inline bool ErrorHandler(HRESULT hr, const char *file, unsigned line, const char *func, const char *expr) const;
+    // runs the passes without drawing and puts the device states back
+    bool isPassBlended(ID3DXEffect *fx, D3DXHANDLE technique, uint32_t passes);
 
   public:
     Effects(Effects &) = delete;
@@ -52,6 +56,8 @@ class Effects final
     bool begin(const std::string &techniqueName);
     // Execute next technique
     bool next();
+    // True when a pass of the technique turns alpha blending on
+    bool isBlended(const std::string &techniqueName) const;
     // Get effect pointer by technique name
     ID3DXEffect *getEffectPointer(const std::string &techniqueName);
 };
@@ -12,6 +12,8 @@
 #include "string_compare.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <SDL_timer.h>
 
 #include <fmt/chrono.h>
@@ -40,6 +42,11 @@ namespace
 {
 constexpr auto kKeyTakeScreenshot = "TakeScreenshot";
 
+// Order of the cube map sides in a .tx file
+constexpr D3DCUBEMAP_FACES kCubeMapFaces[] = {D3DCUBEMAP_FACE_POSITIVE_Z, D3DCUBEMAP_FACE_POSITIVE_X,
+                                              D3DCUBEMAP_FACE_NEGATIVE_Z, D3DCUBEMAP_FACE_NEGATIVE_X,
+                                              D3DCUBEMAP_FACE_POSITIVE_Y, D3DCUBEMAP_FACE_NEGATIVE_Y};
+
 #ifdef _WIN32 // Screenshot
 D3DXIMAGE_FILEFORMAT GetScreenshotFormat(const std::string &fmt)
 {
@@ -514,6 +521,8 @@ bool DX9RENDER::Init()
         bWindow = ini->GetInt(nullptr, "full_screen", 1) == 0;
 
         nTextureDegradation = ini->GetInt(nullptr, "texture_degradation", 0);
+        const auto textureCacheSize = std::max<int32_t>(ini->GetInt(nullptr, "texture_cache_size", 256), 0);
+        textureCache.setCapacity(static_cast<size_t>(textureCacheSize) * 1024 * 1024);
 
         FovMultiplier = ini->GetFloat(nullptr, "fov_multiplier", 1.0f);
 
@@ -1413,6 +1422,7 @@ int32_t DX9RENDER::TextureCreate(UINT width, UINT height, UINT levels, uint32_t
     Textures[t].dwSize = width * height * 4; // Assuming 32-bit pixels
     Textures[t].isCubeMap = false;
     Textures[t].loaded = true;
+    Textures[t].isTxFile = false;
 
     return t;
 }
@@ -1452,38 +1462,57 @@ bool DX9RENDER::TextureLoad(int32_t t)
         }
         fn[d++] = fn[s];
     }
-    // Opening the file
-    auto fileS = fio->_CreateFile(fn, std::ios::binary | std::ios::in);
-    if (!fileS.is_open())
+    const auto loadStart = std::chrono::steady_clock::now();
+    Textures[t].isTxFile = false;
+    // Taking the file of a released texture from the cache, unless it changed on disk, or reading it at once
+    std::error_code ec;
+    const auto fileTime = std::filesystem::last_write_time(std::filesystem::u8path(fio->ConvertPathResource(fn)), ec);
+    auto file = ec ? nullptr : textureCache.take(Textures[t].name, fileTime);
+    const bool isCached = file != nullptr;
+    if (isCached)
+    {
+        texLoadCacheHits++;
+    }
+    else
     {
-        // try to load without '.tx' (e.g. raw Targa)
-        std::filesystem::path path_to_tex{fn};
-        path_to_tex.replace_extension();
-        if (exists(path_to_tex))
+        // Opening the file
+        auto fileS = fio->_CreateFile(fn, std::ios::binary | std::ios::in);
+        if (!fileS.is_open())
         {
-            return TextureLoadUsingD3DX(path_to_tex.string().c_str(), t);
+            // try to load without '.tx' (e.g. raw Targa)
+            std::filesystem::path path_to_tex{fn};
+            path_to_tex.replace_extension();
+            if (exists(path_to_tex))
+            {
+                return TextureLoadUsingD3DX(path_to_tex.string().c_str(), t);
+            }
+            if (bTrace)
+            {
+                core.Trace("Can't load texture %s", fn);
+            }
+            delete Textures[t].name;
+            Textures[t].name = nullptr;
+            return false;
         }
-        if (bTrace)
+        const auto fileSize = static_cast<size_t>(fio->_GetFileSize(fn));
+        file = std::make_unique<storm::TextureFileData>(fileSize);
+        const auto isRead = fileSize >= sizeof(TX_FILE_HEADER) && fio->_ReadFile(fileS, file->data(), fileSize);
+        fio->_CloseFile(fileS);
+        if (!isRead)
         {
-            core.Trace("Can't load texture %s", fn);
+            if (bTrace)
+            {
+                core.Trace("Can't load texture %s", fn);
+            }
+            delete Textures[t].name;
+            Textures[t].name = nullptr;
+            return false;
         }
-        delete Textures[t].name;
-        Textures[t].name = nullptr;
-        return false;
     }
     // Reading the header
     TX_FILE_HEADER head;
-    if (!fio->_ReadFile(fileS, &head, sizeof(head)))
-    {
-        if (bTrace)
-        {
-            core.Trace("Can't load texture %s", fn);
-        }
-        delete Textures[t].name;
-        Textures[t].name = nullptr;
-        fio->_CloseFile(fileS);
-        return false;
-    }
+    std::memcpy(&head, file->data(), sizeof(head));
+    size_t offset = sizeof(head);
     // Analyzing the format
     D3DFORMAT d3dFormat = D3DFMT_UNKNOWN;
     int32_t textureFI;
@@ -1502,15 +1531,14 @@ bool DX9RENDER::TextureLoad(int32_t t)
         }
         delete Textures[t].name;
         Textures[t].name = nullptr;
-        fio->_CloseFile(fileS);
         return false;
     }
     d3dFormat = textureFormats[textureFI].d3dFormat;
     bool isSwizzled = textureFormats[textureFI].isSwizzled;
     const char *formatTxt = textureFormats[textureFI].format;
-    // Skipping mips
+    // Skipping mips, a cached file holds the levels already degraded
     uint32_t seekposition = 0;
-    for (int32_t nTD = nTextureDegradation; nTD > 0; nTD--)
+    for (int32_t nTD = isCached ? 0 : nTextureDegradation; nTD > 0; nTD--)
     {
         if (head.nmips <= 1 || head.width <= 32 || head.height <= 32)
         {
@@ -1527,10 +1555,7 @@ bool DX9RENDER::TextureLoad(int32_t t)
     {
         // Loading a regular texture
         // Position in file
-        if (seekposition)
-        {
-            fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-        }
+        offset += seekposition;
         // create the texture
         IDirect3DTexture9 *tex = nullptr;
         if (CHECKD3DERR(d3d9->CreateTexture(head.width, head.height, head.nmips, 0, d3dFormat, D3DPOOL_MANAGED, &tex,
@@ -1545,9 +1570,9 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             delete Textures[t].name;
             Textures[t].name = nullptr;
-            fio->_CloseFile(fileS);
             return false;
         }
+        Textures[t].txHead = head;
         // Filling the levels
         for (int32_t m = 0; m < head.nmips; m++)
         {
@@ -1562,8 +1587,9 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             else
             {
-                // read the mip
-                isError = !LoadTextureSurface(fileS, surface, head.mip_size, head.width, head.height, isSwizzled);
+                // copy the mip
+                isError =
+                    !LoadTextureSurface(*file, offset, surface, head.mip_size, head.width, head.height, isSwizzled);
             }
             // Freeing the surface
             if (surface)
@@ -1581,7 +1607,6 @@ bool DX9RENDER::TextureLoad(int32_t t)
                 }
                 delete Textures[t].name;
                 Textures[t].name = nullptr;
-                fio->_CloseFile(fileS);
                 tex->Release();
                 return false;
             }
@@ -1604,7 +1629,6 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             delete Textures[t].name;
             Textures[t].name = nullptr;
-            fio->_CloseFile(fileS);
             return false;
         }
         // Number of mips
@@ -1618,7 +1642,6 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             delete Textures[t].name;
             Textures[t].name = nullptr;
-            fio->_CloseFile(fileS);
             return false;
         }
         if (!(devcaps.TextureCaps & D3DPTEXTURECAPS_MIPCUBEMAP))
@@ -1638,91 +1661,22 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             delete Textures[t].name;
             Textures[t].name = nullptr;
-            fio->_CloseFile(fileS);
             return false;
         }
+        Textures[t].txHead = head;
         // Loading the sides
         bool isError = false;
-        if (seekposition)
+        for (const auto face : kCubeMapFaces)
         {
-            fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-        }
-        uint32_t sz =
-            LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_POSITIVE_Z, head.nmips, head.mip_size, head.width, isSwizzled);
-        if (sz)
-        {
-            Textures[t].dwSize += sz;
-            if (seekposition)
-            {
-                fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-            }
-            sz = LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_POSITIVE_X, head.nmips, head.mip_size, head.width,
-                                isSwizzled);
-            if (sz)
-            {
-                Textures[t].dwSize += sz;
-                if (seekposition)
-                {
-                    fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-                }
-                sz = LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_NEGATIVE_Z, head.nmips, head.mip_size, head.width,
-                                    isSwizzled);
-                if (sz)
-                {
-                    Textures[t].dwSize += sz;
-                    if (seekposition)
-                    {
-                        fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-                    }
-                    sz = LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_NEGATIVE_X, head.nmips, head.mip_size, head.width,
-                                        isSwizzled);
-                    if (sz)
-                    {
-                        Textures[t].dwSize += sz;
-                        if (seekposition)
-                        {
-                            fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-                        }
-                        sz = LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_POSITIVE_Y, head.nmips, head.mip_size,
-                                            head.width, isSwizzled);
-                        if (sz)
-                        {
-                            Textures[t].dwSize += sz;
-                            if (seekposition)
-                            {
-                                fio->_SetFilePointer(fileS, seekposition, std::ios::cur);
-                            }
-                            sz = LoadCubmapSide(fileS, tex, D3DCUBEMAP_FACE_NEGATIVE_Y, head.nmips, head.mip_size,
-                                                head.width, isSwizzled);
-                            if (!sz)
-                            {
-                                isError = true;
-                            }
-                            Textures[t].dwSize += sz;
-                        }
-                        else
-                        {
-                            isError = true;
-                        }
-                    }
-                    else
-                    {
-                        isError = true;
-                    }
-                }
-                else
-                {
-                    isError = true;
-                }
-            }
-            else
+            offset += seekposition;
+            const uint32_t sz =
+                LoadCubmapSide(*file, offset, tex, face, head.nmips, head.mip_size, head.width, isSwizzled);
+            if (!sz)
             {
                 isError = true;
+                break;
             }
-        }
-        else
-        {
-            isError = true;
+            Textures[t].dwSize += sz;
         }
 
         if (isError)
@@ -1734,13 +1688,14 @@ bool DX9RENDER::TextureLoad(int32_t t)
             }
             delete Textures[t].name;
             Textures[t].name = nullptr;
-            fio->_CloseFile(fileS);
             tex->Release();
             return false;
         }
         Textures[t].d3dtex = tex;
         Textures[t].isCubeMap = true;
     }
+    texLoadTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    texLoadCount++;
 
     //---------------------------------------------------------------
     // print statistics
@@ -1763,8 +1718,9 @@ bool DX9RENDER::TextureLoad(int32_t t)
     dwTotalSize += Textures[t].dwSize;
     //---------------------------------------------------------------
     Textures[t].loaded = true;
-    // Close the file
-    fio->_CloseFile(fileS);
+    // a file without a modification time is not cached, a change to it could not be seen
+    Textures[t].txTime = fileTime;
+    Textures[t].isTxFile = !ec;
     return true;
 }
 
@@ -1789,6 +1745,7 @@ bool DX9RENDER::TextureLoadUsingD3DX(const char* path, int32_t t)
     Textures[t].isCubeMap = false;
     Textures[t].dwSize = desc.Height * desc.Width * 4;
     Textures[t].loaded = true;
+    Textures[t].isTxFile = false;
 
     return true;
 #else
@@ -1801,8 +1758,9 @@ IDirect3DBaseTexture9 *DX9RENDER::GetBaseTexture(int32_t iTexture)
     return (iTexture >= 0) ? Textures[iTexture].d3dtex : nullptr;
 }
 
-uint32_t DX9RENDER::LoadCubmapSide(std::fstream &fileS, IDirect3DCubeTexture9 *tex, D3DCUBEMAP_FACES face,
-                                   uint32_t numMips, uint32_t mipSize, uint32_t size, bool isSwizzled)
+uint32_t DX9RENDER::LoadCubmapSide(const storm::TextureFileData &file, size_t &offset, IDirect3DCubeTexture9 *tex,
+                                   D3DCUBEMAP_FACES face, uint32_t numMips, uint32_t mipSize, uint32_t size,
+                                   bool isSwizzled)
 {
     uint32_t texsize = 0;
     // Filling the levels
@@ -1819,8 +1777,8 @@ uint32_t DX9RENDER::LoadCubmapSide(std::fstream &fileS, IDirect3DCubeTexture9 *t
         }
         else
         {
-            // read the mip
-            isError = !LoadTextureSurface(fileS, surface, mipSize, size, size, isSwizzled);
+            // copy the mip
+            isError = !LoadTextureSurface(file, offset, surface, mipSize, size, size, isSwizzled);
         }
         // Freeing the surface
         if (surface)
@@ -1843,27 +1801,26 @@ uint32_t DX9RENDER::LoadCubmapSide(std::fstream &fileS, IDirect3DCubeTexture9 *t
     return texsize;
 }
 
-bool DX9RENDER::LoadTextureSurface(std::fstream &fileS, IDirect3DSurface9 *suface, uint32_t mipSize, uint32_t width,
-                                   uint32_t height, bool isSwizzled)
+bool DX9RENDER::LoadTextureSurface(const storm::TextureFileData &file, size_t &offset, IDirect3DSurface9 *suface,
+                                   uint32_t mipSize, uint32_t width, uint32_t height, bool isSwizzled)
 {
     //------------------------------------------------------------------------------------------
     // PC version
     // ------------------------------------------------------------------------------------------
-    // Surface pointer
-    D3DLOCKED_RECT lock;
-    if (CHECKD3DERR(suface->LockRect(&lock, NULL, 0L)) == true)
+    // The file is truncated
+    if (offset > file.size() || file.size() - offset < mipSize)
     {
         return false;
     }
-    // Reading out
-    if (!fio->_ReadFile(fileS, lock.pBits, mipSize))
+    // Surface pointer
+    D3DLOCKED_RECT lock;
+    if (CHECKD3DERR(suface->LockRect(&lock, NULL, 0L)) == true)
     {
-        if (CHECKD3DERR(suface->UnlockRect()) == true)
-        {
-            return false;
-        }
         return false;
     }
+    // Copying
+    std::memcpy(lock.pBits, file.data() + offset, mipSize);
+    offset += mipSize;
     // Surface release
     if (CHECKD3DERR(suface->UnlockRect()) == true)
     {
@@ -1933,6 +1890,10 @@ bool DX9RENDER::TextureRelease(int32_t texid)
     }
     if (Textures[texid].name != nullptr)
     {
+        if (Textures[texid].loaded && Textures[texid].isTxFile && Textures[texid].d3dtex)
+        {
+            CacheTextureFile(texid);
+        }
         if (texLog)
         {
             auto fileS = fio->_CreateFile("texLoad.txt", std::ios::binary | std::ios::in | std::ios::out);
@@ -1993,6 +1954,57 @@ bool DX9RENDER::TextureRelease(int32_t texid)
     return true;
 }
 
+// Give the file of a released texture to the texture cache, the file is made of the levels of the texture
+void DX9RENDER::CacheTextureFile(int32_t t)
+{
+    const auto &head = Textures[t].txHead;
+    const auto sides = Textures[t].isCubeMap ? std::size(kCubeMapFaces) : 1;
+    size_t levelsSize = 0;
+    for (int32_t m = 0, mipSize = head.mip_size; m < head.nmips; m++, mipSize /= 4)
+    {
+        levelsSize += mipSize;
+    }
+    const auto fileSize = sizeof(head) + levelsSize * sides;
+    if (fileSize > textureCache.capacity())
+    {
+        return;
+    }
+    auto file = std::make_unique<storm::TextureFileData>(fileSize);
+    std::memcpy(file->data(), &head, sizeof(head));
+    size_t offset = sizeof(head);
+    for (size_t side = 0; side < sides; side++)
+    {
+        for (int32_t m = 0, mipSize = head.mip_size; m < head.nmips; m++, mipSize /= 4)
+        {
+            IDirect3DSurface9 *surface = nullptr;
+            const auto result =
+                Textures[t].isCubeMap
+                    ? static_cast<IDirect3DCubeTexture9 *>(Textures[t].d3dtex)
+                          ->GetCubeMapSurface(kCubeMapFaces[side], m, &surface)
+                    : static_cast<IDirect3DTexture9 *>(Textures[t].d3dtex)->GetSurfaceLevel(m, &surface);
+            if (CHECKD3DERR(result) == true || !surface)
+            {
+                return;
+            }
+            // a managed texture keeps its levels in system memory, reading them back does not wait for the device
+            D3DLOCKED_RECT lock;
+            const auto isLocked = CHECKD3DERR(surface->LockRect(&lock, NULL, D3DLOCK_READONLY)) == false;
+            if (isLocked)
+            {
+                std::memcpy(file->data() + offset, lock.pBits, mipSize);
+                surface->UnlockRect();
+            }
+            surface->Release();
+            if (!isLocked)
+            {
+                return;
+            }
+            offset += mipSize;
+        }
+    }
+    textureCache.insert(Textures[t].name, Textures[t].txTime, std::move(file));
+}
+
 //################################################################################
 bool DX9RENDER::SetCamera(const CVECTOR &pos, const CVECTOR &ang, float fov)
 {
@@ -3382,6 +3394,17 @@ bool DX9RENDER::TechniqueExecuteNext()
 #endif
 }
 
+bool DX9RENDER::IsTechniqueBlended(const char *cBlockName)
+{
+    if (!cBlockName || !cBlockName[0])
+        return false;
+#ifdef _WIN32 // Effects
+    return effects_.isBlended(cBlockName);
+#else
+    return pTechnique->IsBlended(cBlockName);
+#endif
+}
+
 void DX9RENDER::DrawRects(RS_RECT *pRSR, uint32_t dwRectsNum, const char *cBlockName, uint32_t dwSubTexturesX,
                           uint32_t dwSubTexturesY, float fScaleX, float fScaleY)
 {
@@ -4146,6 +4169,9 @@ char *DX9RENDER::GetTipsImage()
 void DX9RENDER::StartProgressView()
 {
     progressSafeCounter = 0;
+    texLoadTime = 0.0;
+    texLoadCount = 0;
+    texLoadCacheHits = 0;
     if (progressTexture < 0)
     {
         // Loading the texture
@@ -4378,6 +4404,14 @@ void DX9RENDER::EndProgressView()
         progressBackImage[0] = 0;
     if (progressTipsImage && progressTipsImageSize > 0)
         progressTipsImage[0] = 0;
+    if (texLoadCount)
+    {
+        core.Trace("Textures loaded: %u (%u from cache) in %.1f ms, cache: %.1f Mb", texLoadCount, texLoadCacheHits,
+                   texLoadTime, textureCache.usage() / 1024.0f / 1024.0f);
+        texLoadTime = 0.0;
+        texLoadCount = 0;
+        texLoadCacheHits = 0;
+    }
 }
 
 void DX9RENDER::SetColorParameters(float fGamma, float fBrightness, float fContrast)
@@ -6,6 +6,8 @@
 #include "technique.h"
 #endif
 #include "font.h"
+#include "texture.h"
+#include "texture_cache.h"
 #include "video_texture.h"
 #include "dx9render.h"
 #include "vma.hpp"
@@ -41,6 +43,10 @@ struct STEXTURE
     uint32_t dwSize;
     bool isCubeMap;
     bool loaded;
+    // levels of a texture loaded from a .tx file, its file is given back to the texture cache from them on release
+    TX_FILE_HEADER txHead;
+    std::filesystem::file_time_type txTime;
+    bool isTxFile;
 };
 
 //-----------buffers-----------
@@ -183,6 +189,7 @@ class DX9RENDER : public VDX9RENDER
     // DX9Render: Techniques Section
     bool TechniqueExecuteStart(const char *cBlockName) override;
     bool TechniqueExecuteNext() override;
+    bool IsTechniqueBlended(const char *cBlockName) override;
 
     // DX9Render: Draw Section
     void DrawRects(RS_RECT *pRSR, uint32_t dwRectsNum, const char *cBlockName = nullptr, uint32_t dwSubTexturesX = 1,
@@ -325,10 +332,12 @@ class DX9RENDER : public VDX9RENDER
     HRESULT ImageBlt(int32_t nTextureId, RECT *pDstRect, RECT *pSrcRect) override;
 
     void MakeScreenShot();
-    bool LoadTextureSurface(std::fstream &fileS, IDirect3DSurface9 *suface, uint32_t mipSize, uint32_t width,
-                            uint32_t height, bool isSwizzled);
-    uint32_t LoadCubmapSide(std::fstream &fileS, IDirect3DCubeTexture9 *tex, D3DCUBEMAP_FACES face, uint32_t numMips,
-                            uint32_t mipSize, uint32_t size, bool isSwizzled);
+    bool LoadTextureSurface(const storm::TextureFileData &file, size_t &offset, IDirect3DSurface9 *suface,
+                            uint32_t mipSize, uint32_t width, uint32_t height, bool isSwizzled);
+    uint32_t LoadCubmapSide(const storm::TextureFileData &file, size_t &offset, IDirect3DCubeTexture9 *tex,
+                            D3DCUBEMAP_FACES face, uint32_t numMips, uint32_t mipSize, uint32_t size,
+                            bool isSwizzled);
+    void CacheTextureFile(int32_t t);
 
     // core interface
     bool Init() override;
@@ -481,6 +490,12 @@ private:
     VideoTextureEntity *pVTL;
 
     int32_t nTextureDegradation;
+    // Files of released textures, reused when the same textures are created again
+    storm::TextureCache textureCache;
+    // Texture loading statistics between StartProgressView and EndProgressView
+    double texLoadTime = 0.0;
+    uint32_t texLoadCount = 0;
+    uint32_t texLoadCacheHits = 0;
     float aspectRatio;
     float m_fHeightDeformator;
 
@@ -1186,6 +1186,9 @@ uint32_t CTechnique::ProcessPass(char *pFile, uint32_t dwSize, char **pStr)
                 GetTokenWhile(SkipToken(*pStr, "="), temp, ";");
                 *pPass++ = GetCode(temp, RenderStates[dwSRSIndex].pParam, RenderStates[dwSRSIndex].dwParamNum,
                                    pPassCode, true);
+                // only the first technique of a block is executed
+                if (RenderStates[dwSRSIndex].State == D3DRS_ALPHABLENDENABLE && pB->dwNumTechniques == 0 && pPass[-1])
+                    pB->bBlended = true;
             }
             SKIP3;
         }
@@ -2239,6 +2242,15 @@ void CTechnique::RestoreSavedStates()
     ClearSavedStates();
 }
 
+bool CTechnique::IsBlended(const char *name) const
+{
+    char sBlockName[256];
+    strcpy_s(sBlockName, name);
+    tolwr(sBlockName);
+    const auto it = htBlocks.find(sBlockName);
+    return it != htBlocks.end() && pBlocks[it->second].bBlended;
+}
+
 void CTechnique::SetCurrentBlock(const char *name, uint32_t _dwNumParams, void *pParams)
 {
     if (name && name[0])
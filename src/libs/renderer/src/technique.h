@@ -42,6 +42,8 @@ struct block_t
     // techniques section
     uint32_t dwNumTechniques; // number of techniques
     technique_t *pTechniques;
+
+    bool bBlended; // a pass of the executed technique turns alpha blending on
 };
 
 struct shader_t // pixel/vertex shader structure
@@ -164,6 +166,7 @@ class CTechnique
     bool ExecutePassStart();
     bool ExecutePassNext();
     bool ExecutePass(bool bStart);
+    bool IsBlended(const char *name) const;
 
     CTechnique(VDX9RENDER *_pRS);
     ~CTechnique();
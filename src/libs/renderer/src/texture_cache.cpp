@@ -0,0 +1,71 @@
+#include "texture_cache.h"
+
+namespace storm
+{
+
+TextureFileData::TextureFileData(size_t size)
+    : data_(static_cast<uint8_t *>(::operator new[](size, std::align_val_t{kAlignment}))), size_(size)
+{
+}
+
+TextureCache::TextureCache(size_t capacity) : capacity_(capacity)
+{
+}
+
+void TextureCache::setCapacity(size_t bytes)
+{
+    capacity_ = bytes;
+    trim();
+}
+
+TextureCache::Data TextureCache::take(const std::string &name, std::filesystem::file_time_type time)
+{
+    const auto it = index_.find(name);
+    if (it == index_.end())
+        return nullptr;
+    if (it->second->time != time)
+    {
+        erase(it->second);
+        return nullptr;
+    }
+    auto data = std::move(it->second->data);
+    usage_ -= data->size();
+    entries_.erase(it->second);
+    index_.erase(it);
+    return data;
+}
+
+void TextureCache::insert(const std::string &name, std::filesystem::file_time_type time, Data data)
+{
+    if (const auto it = index_.find(name); it != index_.end())
+        erase(it->second);
+    if (!data || data->size() > capacity_)
+        return;
+
+    usage_ += data->size();
+    entries_.push_front(Entry{name, time, std::move(data)});
+    index_.emplace(name, entries_.begin());
+    trim();
+}
+
+void TextureCache::clear()
+{
+    index_.clear();
+    entries_.clear();
+    usage_ = 0;
+}
+
+void TextureCache::erase(std::list<Entry>::iterator it)
+{
+    usage_ -= it->data->size();
+    index_.erase(it->name);
+    entries_.erase(it);
+}
+
+void TextureCache::trim()
+{
+    while (usage_ > capacity_ && !entries_.empty())
+        erase(std::prev(entries_.end()));
+}
+
+} // namespace storm
@@ -0,0 +1,105 @@
+#include "texture_cache.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+
+const auto kTime = std::filesystem::file_time_type::clock::now();
+
+storm::TextureCache::Data File(size_t size, uint8_t fill)
+{
+    auto file = std::make_unique<storm::TextureFileData>(size);
+    std::memset(file->data(), fill, size);
+    return file;
+}
+
+} // namespace
+
+TEST_CASE("Texture cache keeps released files up to its capacity", "[renderer]")
+{
+    storm::TextureCache cache(100);
+
+    cache.insert("a", kTime, File(40, 1));
+    cache.insert("b", kTime, File(40, 2));
+    CHECK(cache.count() == 2);
+    CHECK(cache.usage() == 80);
+
+    // the least recently released file is dropped to fit
+    cache.insert("c", kTime, File(40, 3));
+    CHECK(cache.count() == 2);
+    CHECK(cache.usage() == 80);
+    CHECK(cache.take("a", kTime) == nullptr);
+
+    // a file is taken once, its texture gives it back on release
+    auto b = cache.take("b", kTime);
+    REQUIRE(b != nullptr);
+    CHECK(b->size() == 40);
+    CHECK(b->data()[39] == 2);
+    CHECK(reinterpret_cast<uintptr_t>(b->data()) % storm::TextureFileData::kAlignment == 0);
+    CHECK(cache.take("b", kTime) == nullptr);
+    CHECK(cache.usage() == 40);
+
+    cache.insert("b", kTime, std::move(b));
+    cache.insert("d", kTime, File(20, 4));
+    // b was released after c, so c goes first
+    cache.insert("e", kTime, File(30, 5));
+    CHECK(cache.take("c", kTime) == nullptr);
+    CHECK(cache.usage() == 90);
+    CHECK(cache.count() == 3);
+
+    SECTION("A file larger than the capacity is not stored")
+    {
+        cache.insert("f", kTime, File(101, 6));
+        CHECK(cache.take("f", kTime) == nullptr);
+        CHECK(cache.usage() == 90);
+    }
+
+    SECTION("A file released again replaces the stored one")
+    {
+        cache.insert("d", kTime, File(10, 7));
+        CHECK(cache.usage() == 80);
+        auto d = cache.take("d", kTime);
+        REQUIRE(d != nullptr);
+        CHECK(d->data()[0] == 7);
+    }
+
+    SECTION("A file changed on disk since its release is not used")
+    {
+        CHECK(cache.take("d", kTime + std::chrono::seconds(1)) == nullptr);
+        // the stale file is dropped
+        CHECK(cache.usage() == 70);
+        CHECK(cache.take("d", kTime) == nullptr);
+        CHECK(cache.take("e", kTime) != nullptr);
+    }
+
+    SECTION("Lowering the capacity drops the least recently released files")
+    {
+        cache.setCapacity(50);
+        CHECK(cache.usage() == 50);
+        CHECK(cache.take("b", kTime) == nullptr);
+        CHECK(cache.take("d", kTime) != nullptr);
+        CHECK(cache.take("e", kTime) != nullptr);
+    }
+
+    SECTION("No capacity disables the cache")
+    {
+        cache.setCapacity(0);
+        CHECK(cache.count() == 0);
+        cache.insert("g", kTime, File(1, 8));
+        CHECK(cache.take("g", kTime) == nullptr);
+        CHECK(cache.usage() == 0);
+    }
+
+    SECTION("Clear")
+    {
+        cache.clear();
+        CHECK(cache.count() == 0);
+        CHECK(cache.usage() == 0);
+        CHECK(cache.take("e", kTime) == nullptr);
+    }
+}
@@ -2,8 +2,22 @@
 
 #include "cannon_trace.h"
 
+#include <cstddef>
+
 class SEA_BASE : public CANNON_TRACE_BASE
 {
   public:
     virtual float WaveXZ(float x, float z, CVECTOR *vNormal = nullptr) = 0;
+
+    // Sets y of dwCount points to the sea height plus fDeltaY, dwStride is the distance between the points in bytes
+    // Cheaper than a call per point for grids of effect vertices
+    virtual void WaveXZ(CVECTOR *pPoints, uint32_t dwCount, size_t dwStride, float fDeltaY = 0.0f)
+    {
+        auto *p = reinterpret_cast<uint8_t *>(pPoints);
+        for (uint32_t i = 0; i < dwCount; i++, p += dwStride)
+        {
+            auto *v = reinterpret_cast<CVECTOR *>(p);
+            v->y = WaveXZ(v->x, v->z) + fDeltaY;
+        }
+    }
 };
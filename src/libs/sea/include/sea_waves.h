@@ -0,0 +1,53 @@
+#pragma once
+
+#include "c_vector.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storm
+{
+
+// One of the two tiled wave maps the sea surface is made of
+struct SeaWaveLayer
+{
+    // kWidth * kWidth heights and kWidth * kWidth (x, z) slopes of the current frame
+    const float *heights;
+    const float *normals;
+    float moveX, moveZ;
+    float scale;
+    float amp;
+};
+
+/**
+ * \brief Sea surface of the current frame made of two moving wave layers
+ *
+ * A light view over the frame data of SEA, which evaluates it per point as SEA::WaveXZ did and for whole arrays
+ * of points four at a time with SSE. Effects which need the sea under every vertex of a grid use the latter.
+ * Points farther than maxDistance from the camera lie on the zero plane.
+ */
+class SeaWaves final
+{
+  public:
+    static constexpr int32_t kWidth = 128;
+
+    SeaWaves(const SeaWaveLayer &layer1, const SeaWaveLayer &layer2, const CVECTOR &camera, float maxDistance)
+        : layer1_(layer1), layer2_(layer2), cameraX_(camera.x), cameraZ_(camera.z),
+          maxDistance2_(maxDistance * maxDistance)
+    {
+    }
+
+    float height(float x, float z, CVECTOR *normal = nullptr) const;
+
+    // sets y of count points to the sea height plus dy, stride is the distance between the points in bytes
+    void heights(CVECTOR *points, uint32_t count, size_t stride, float dy = 0.0f) const;
+
+  private:
+    void heights4(CVECTOR *p0, CVECTOR *p1, CVECTOR *p2, CVECTOR *p3, float dy) const;
+
+    SeaWaveLayer layer1_, layer2_;
+    float cameraX_, cameraZ_;
+    float maxDistance2_;
+};
+
+} // namespace storm
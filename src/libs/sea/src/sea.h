@@ -4,6 +4,7 @@
 #pragma once
 
 #include "sea_base.h"
+#include "sea_waves.h"
 #include "c_vector4.h"
 #include "dx9render.h"
 #include "vma.hpp"
@@ -150,7 +151,9 @@ class SEA : public SEA_BASE
     CMatrix mTexProjection;
 
     void SSE_WaveXZ(SeaVertex **pArray);
+    storm::SeaWaves Waves() const;
     float WaveXZ(float x, float z, CVECTOR *pNormal = nullptr) override;
+    void WaveXZ(CVECTOR *pPoints, uint32_t dwCount, size_t dwStride, float fDeltaY = 0.0f) override;
 
     void AddBlock(int32_t iTX, int32_t iTY, int32_t iSize, int32_t iLOD);
     void BuildTree(int32_t iTX, int32_t iTY, int32_t iLev);
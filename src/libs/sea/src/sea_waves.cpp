@@ -0,0 +1,185 @@
+#include "sea_waves.h"
+
+#include "math3d.h"
+
+#include <cmath>
+#include <emmintrin.h>
+
+namespace storm
+{
+
+namespace
+{
+
+constexpr int32_t kMask = SeaWaves::kWidth - 1;
+
+inline float Square(float f)
+{
+    return f * f;
+}
+
+// bilinear sample of four points of a layer, the same arithmetic as the scalar path so the results match exactly
+inline __m128 LayerHeights4(const SeaWaveLayer &layer, __m128 x, __m128 z)
+{
+    const __m128 scale = _mm_set1_ps(layer.scale);
+    const __m128 half = _mm_set1_ps(-0.5f);
+    const __m128 lx = _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(layer.moveX)), scale);
+    const __m128 lz = _mm_mul_ps(_mm_add_ps(z, _mm_set1_ps(layer.moveZ)), scale);
+
+    // ffloor
+    const __m128i ix = _mm_cvtps_epi32(_mm_add_ps(lx, half));
+    const __m128i iz = _mm_cvtps_epi32(_mm_add_ps(lz, half));
+    const __m128 fx = _mm_sub_ps(lx, _mm_cvtepi32_ps(ix));
+    const __m128 fz = _mm_sub_ps(lz, _mm_cvtepi32_ps(iz));
+
+    alignas(16) int32_t x1[4], z1[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(x1), ix);
+    _mm_store_si128(reinterpret_cast<__m128i *>(z1), iz);
+
+    alignas(16) float a1[4], a2[4], a3[4], a4[4];
+    for (int32_t i = 0; i < 4; i++)
+    {
+        const int32_t iX1 = x1[i] & kMask, iX2 = (x1[i] + 1) & kMask;
+        const int32_t iY1 = z1[i] & kMask, iY2 = (z1[i] + 1) & kMask;
+        a1[i] = layer.heights[iX1 + iY1 * SeaWaves::kWidth];
+        a2[i] = layer.heights[iX2 + iY1 * SeaWaves::kWidth];
+        a3[i] = layer.heights[iX1 + iY2 * SeaWaves::kWidth];
+        a4[i] = layer.heights[iX2 + iY2 * SeaWaves::kWidth];
+    }
+
+    const __m128 v1 = _mm_load_ps(a1), v2 = _mm_load_ps(a2), v3 = _mm_load_ps(a3), v4 = _mm_load_ps(a4);
+    // a1 + fX * (a2 - a1) + fZ * (a3 - a1) + fX * fZ * (a4 + a1 - a2 - a3)
+    __m128 r = _mm_add_ps(v1, _mm_mul_ps(fx, _mm_sub_ps(v2, v1)));
+    r = _mm_add_ps(r, _mm_mul_ps(fz, _mm_sub_ps(v3, v1)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(fx, fz), _mm_sub_ps(_mm_sub_ps(_mm_add_ps(v4, v1), v2), v3)));
+    return _mm_mul_ps(_mm_set1_ps(layer.amp), r);
+}
+
+} // namespace
+
+float SeaWaves::height(float x, float z, CVECTOR *pNormal) const
+{
+    int32_t iX11, iX12, iX21, iX22, iY11, iY12, iY21, iY22;
+
+    const float fDistance = Square(x - cameraX_) + Square(z - cameraZ_);
+    if (fDistance > maxDistance2_)
+    {
+        if (pNormal)
+            *pNormal = CVECTOR(0.0f, 1.0f, 0.0f);
+        return 0.0f;
+    }
+
+    const float x1 = (x + layer1_.moveX) * layer1_.scale;
+    const float z1 = (z + layer1_.moveZ) * layer1_.scale;
+    iX11 = ffloor(x1 + 0.0f), iX12 = iX11 + 1;
+    iY11 = ffloor(z1 + 0.0f), iY12 = iY11 + 1;
+    const float fX1 = (x1 - iX11);
+    const float fZ1 = (z1 - iY11);
+    iX11 &= kMask;
+    iX12 &= kMask;
+    iY11 &= kMask;
+    iY12 &= kMask;
+
+    const float x2 = (x + layer2_.moveX) * layer2_.scale;
+    const float z2 = (z + layer2_.moveZ) * layer2_.scale;
+    iX21 = ffloor(x2 + 0.0f), iX22 = iX21 + 1;
+    iY21 = ffloor(z2 + 0.0f), iY22 = iY21 + 1;
+    const float fX2 = (x2 - iX21);
+    const float fZ2 = (z2 - iY21);
+    iX21 &= kMask;
+    iX22 &= kMask;
+    iY21 &= kMask;
+    iY22 &= kMask;
+
+    const float *pSeaFrame1 = layer1_.heights;
+    const float *pSeaFrame2 = layer2_.heights;
+    float a1, a2, a3, a4;
+
+    a1 = pSeaFrame1[iX11 + iY11 * kWidth];
+    a2 = pSeaFrame1[iX12 + iY11 * kWidth];
+    a3 = pSeaFrame1[iX11 + iY12 * kWidth];
+    a4 = pSeaFrame1[iX12 + iY12 * kWidth];
+    float fRes = layer1_.amp * (a1 + fX1 * (a2 - a1) + fZ1 * (a3 - a1) + fX1 * fZ1 * (a4 + a1 - a2 - a3));
+
+    a1 = pSeaFrame2[iX21 + iY21 * kWidth];
+    a2 = pSeaFrame2[iX22 + iY21 * kWidth];
+    a3 = pSeaFrame2[iX21 + iY22 * kWidth];
+    a4 = pSeaFrame2[iX22 + iY22 * kWidth];
+    fRes += layer2_.amp * (a1 + fX2 * (a2 - a1) + fZ2 * (a3 - a1) + fX2 * fZ2 * (a4 + a1 - a2 - a3));
+
+    if (pNormal)
+    {
+        const float *pSeaNormalsFrame1 = layer1_.normals;
+        const float *pSeaNormalsFrame2 = layer2_.normals;
+        float nx1, nx2, nx3, nx4, nz1, nz2, nz3, nz4;
+
+        nx1 = pSeaNormalsFrame1[2 * (iX11 + iY11 * kWidth) + 0];
+        nz1 = pSeaNormalsFrame1[2 * (iX11 + iY11 * kWidth) + 1];
+        nx2 = pSeaNormalsFrame1[2 * (iX12 + iY11 * kWidth) + 0];
+        nz2 = pSeaNormalsFrame1[2 * (iX12 + iY11 * kWidth) + 1];
+        nx3 = pSeaNormalsFrame1[2 * (iX11 + iY12 * kWidth) + 0];
+        nz3 = pSeaNormalsFrame1[2 * (iX11 + iY12 * kWidth) + 1];
+        nx4 = pSeaNormalsFrame1[2 * (iX12 + iY12 * kWidth) + 0];
+        nz4 = pSeaNormalsFrame1[2 * (iX12 + iY12 * kWidth) + 1];
+
+        const float nX1 = (nx1 + fX1 * (nx2 - nx1) + fZ1 * (nx3 - nx1) + fX1 * fZ1 * (nx4 + nx1 - nx2 - nx3));
+        const float nZ1 = (nz1 + fX1 * (nz2 - nz1) + fZ1 * (nz3 - nz1) + fX1 * fZ1 * (nz4 + nz1 - nz2 - nz3));
+
+        nx1 = pSeaNormalsFrame2[2 * (iX21 + iY21 * kWidth) + 0];
+        nz1 = pSeaNormalsFrame2[2 * (iX21 + iY21 * kWidth) + 1];
+        nx2 = pSeaNormalsFrame2[2 * (iX22 + iY21 * kWidth) + 0];
+        nz2 = pSeaNormalsFrame2[2 * (iX22 + iY21 * kWidth) + 1];
+        nx3 = pSeaNormalsFrame2[2 * (iX21 + iY22 * kWidth) + 0];
+        nz3 = pSeaNormalsFrame2[2 * (iX21 + iY22 * kWidth) + 1];
+        nx4 = pSeaNormalsFrame2[2 * (iX22 + iY22 * kWidth) + 0];
+        nz4 = pSeaNormalsFrame2[2 * (iX22 + iY22 * kWidth) + 1];
+
+        const float nX2 = (nx1 + fX2 * (nx2 - nx1) + fZ2 * (nx3 - nx1) + fX2 * fZ2 * (nx4 + nx1 - nx2 - nx3));
+        const float nZ2 = (nz1 + fX2 * (nz2 - nz1) + fZ2 * (nz3 - nz1) + fX2 * fZ2 * (nz4 + nz1 - nz2 - nz3));
+
+        const float nY1 = sqrtf(1.0f - (Square(nX1) + Square(nZ1)));
+        const float nY2 = sqrtf(1.0f - (Square(nX2) + Square(nZ2)));
+
+        CVECTOR vNormal;
+        vNormal.x = layer1_.scale * layer1_.amp * nX1 + layer2_.scale * layer2_.amp * nX2;
+        vNormal.z = layer1_.scale * layer1_.amp * nZ1 + layer2_.scale * layer2_.amp * nZ2;
+        vNormal.y = nY1 + nY2;
+        *pNormal = !vNormal;
+    }
+
+    return fRes;
+}
+
+void SeaWaves::heights(CVECTOR *points, uint32_t count, size_t stride, float dy) const
+{
+    auto *p = reinterpret_cast<uint8_t *>(points);
+    auto at = [p, stride](uint32_t i) { return reinterpret_cast<CVECTOR *>(p + i * stride); };
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        heights4(at(i), at(i + 1), at(i + 2), at(i + 3), dy);
+    for (; i < count; i++)
+        at(i)->y = height(at(i)->x, at(i)->z) + dy;
+}
+
+void SeaWaves::heights4(CVECTOR *p0, CVECTOR *p1, CVECTOR *p2, CVECTOR *p3, float dy) const
+{
+    const __m128 x = _mm_setr_ps(p0->x, p1->x, p2->x, p3->x);
+    const __m128 z = _mm_setr_ps(p0->z, p1->z, p2->z, p3->z);
+
+    const __m128 dx = _mm_sub_ps(x, _mm_set1_ps(cameraX_));
+    const __m128 dz = _mm_sub_ps(z, _mm_set1_ps(cameraZ_));
+    const __m128 far = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)), _mm_set1_ps(maxDistance2_));
+
+    __m128 y = _mm_add_ps(LayerHeights4(layer1_, x, z), LayerHeights4(layer2_, x, z));
+    y = _mm_add_ps(_mm_andnot_ps(far, y), _mm_set1_ps(dy));
+
+    alignas(16) float res[4];
+    _mm_store_ps(res, y);
+    p0->y = res[0];
+    p1->y = res[1];
+    p2->y = res[2];
+    p3->y = res[3];
+}
+
+} // namespace storm
@@ -0,0 +1,225 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "sea_waves.h"
+
+#include "math3d.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr int32_t kWidth = storm::SeaWaves::kWidth;
+
+// random wave maps in the ranges SEA::CalculateHeightMap and SEA::CalculateNormalMap produce
+struct TestFrame
+{
+    explicit TestFrame(uint32_t seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> height(0.0f, 1.0f);
+        std::uniform_real_distribution<float> slope(-0.5f, 0.5f);
+        heights.resize(kWidth * kWidth);
+        normals.resize(2 * kWidth * kWidth);
+        for (auto &h : heights)
+            h = height(gen);
+        for (auto &n : normals)
+            n = slope(gen);
+    }
+
+    std::vector<float> heights, normals;
+};
+
+struct TestSea
+{
+    TestSea() : frame1(1), frame2(2)
+    {
+    }
+
+    storm::SeaWaves waves(const CVECTOR &camera, float maxDistance = 1600.0f) const
+    {
+        return storm::SeaWaves({frame1.heights.data(), frame1.normals.data(), 13.7f, -4.2f, 0.5f, 8.0f},
+                               {frame2.heights.data(), frame2.normals.data(), -31.5f, 8.9f, 0.25f, 4.0f}, camera,
+                               maxDistance);
+    }
+
+    TestFrame frame1, frame2;
+};
+
+// the height part of SEA::WaveXZ as it was before SeaWaves, over the frame of a TestSea
+float WaveXZ(const TestSea &sea, const CVECTOR &vCamPos, float fMaxSeaDistance, float x, float z)
+{
+    constexpr int32_t XWIDTH = kWidth;
+    const float *pSeaFrame1 = sea.frame1.heights.data();
+    const float *pSeaFrame2 = sea.frame2.heights.data();
+    const CVECTOR vMove1(13.7f, 0.0f, -4.2f), vMove2(-31.5f, 0.0f, 8.9f);
+    const float fScale1 = 0.5f, fScale2 = 0.25f;
+    const float fAmp1 = 8.0f, fAmp2 = 4.0f;
+
+    int32_t iX11, iX12, iX21, iX22, iY11, iY12, iY21, iY22;
+
+    const float fDistance = (x - vCamPos.x) * (x - vCamPos.x) + (z - vCamPos.z) * (z - vCamPos.z);
+    if (fDistance > fMaxSeaDistance * fMaxSeaDistance)
+        return 0.0f;
+
+    const float x1 = (x + vMove1.x) * fScale1;
+    const float z1 = (z + vMove1.z) * fScale1;
+    iX11 = ffloor(x1 + 0.0f), iX12 = iX11 + 1;
+    iY11 = ffloor(z1 + 0.0f), iY12 = iY11 + 1;
+    const float fX1 = (x1 - iX11);
+    const float fZ1 = (z1 - iY11);
+    iX11 &= (XWIDTH - 1);
+    iX12 &= (XWIDTH - 1);
+    iY11 &= (XWIDTH - 1);
+    iY12 &= (XWIDTH - 1);
+
+    const float x2 = (x + vMove2.x) * fScale2;
+    const float z2 = (z + vMove2.z) * fScale2;
+    iX21 = ffloor(x2 + 0.0f), iX22 = iX21 + 1;
+    iY21 = ffloor(z2 + 0.0f), iY22 = iY21 + 1;
+    const float fX2 = (x2 - iX21);
+    const float fZ2 = (z2 - iY21);
+    iX21 &= (XWIDTH - 1);
+    iX22 &= (XWIDTH - 1);
+    iY21 &= (XWIDTH - 1);
+    iY22 &= (XWIDTH - 1);
+
+    float a1, a2, a3, a4;
+
+    a1 = pSeaFrame1[iX11 + iY11 * XWIDTH];
+    a2 = pSeaFrame1[iX12 + iY11 * XWIDTH];
+    a3 = pSeaFrame1[iX11 + iY12 * XWIDTH];
+    a4 = pSeaFrame1[iX12 + iY12 * XWIDTH];
+    float fRes = fAmp1 * (a1 + fX1 * (a2 - a1) + fZ1 * (a3 - a1) + fX1 * fZ1 * (a4 + a1 - a2 - a3));
+
+    a1 = pSeaFrame2[iX21 + iY21 * XWIDTH];
+    a2 = pSeaFrame2[iX22 + iY21 * XWIDTH];
+    a3 = pSeaFrame2[iX21 + iY22 * XWIDTH];
+    a4 = pSeaFrame2[iX22 + iY22 * XWIDTH];
+    fRes += fAmp2 * (a1 + fX2 * (a2 - a1) + fZ2 * (a3 - a1) + fX2 * fZ2 * (a4 + a1 - a2 - a3));
+
+    return fRes;
+}
+
+struct TestVertex
+{
+    CVECTOR pos;
+    uint32_t color;
+    float tu, tv;
+};
+
+} // namespace
+
+TEST_CASE("SeaWaves batch matches per point heights", "[sea]")
+{
+    const TestSea sea;
+    const CVECTOR camera(-812.3f, 15.0f, 431.1f);
+    const auto waves = sea.waves(camera, 300.0f);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> offset(-400.0f, 400.0f);
+    // odd count, the tail goes through the scalar path
+    std::vector<TestVertex> vertices(1001);
+    for (auto &v : vertices)
+        v.pos = CVECTOR(camera.x + offset(gen), 100.0f, camera.z + offset(gen));
+    // integer coordinates are where ffloor differs from floor
+    vertices[0].pos = CVECTOR(-812.0f, 0.0f, 431.0f);
+    vertices[1].pos = CVECTOR(-801.0f, 0.0f, 440.0f);
+
+    waves.heights(&vertices[0].pos, static_cast<uint32_t>(vertices.size()), sizeof(TestVertex), 0.25f);
+
+    uint32_t far = 0;
+    for (const auto &v : vertices)
+    {
+        const float y = waves.height(v.pos.x, v.pos.z);
+        CHECK(v.pos.y == Approx(y + 0.25f).margin(1e-5));
+        if (y == 0.0f)
+            far++;
+    }
+    // the points beyond the sea distance lie on the zero plane
+    CHECK(far > 0);
+}
+
+TEST_CASE("SeaWaves batch matches SEA::WaveXZ", "[sea]")
+{
+    const TestSea sea;
+    const CVECTOR camera(35.2f, 12.0f, -1290.7f);
+    constexpr float kMaxDistance = 500.0f;
+    const auto waves = sea.waves(camera, kMaxDistance);
+
+    // an effect grid around the camera, crossing the sea distance and the integer coordinates of both layers
+    std::vector<TestVertex> vertices;
+    for (float z = -600.0f; z <= 600.0f; z += 7.5f)
+        for (float x = -600.0f; x <= 600.0f; x += 4.25f)
+            vertices.push_back(TestVertex{CVECTOR(camera.x + x, 0.0f, camera.z + z), 0, 0.0f, 0.0f});
+
+    waves.heights(&vertices[0].pos, static_cast<uint32_t>(vertices.size()), sizeof(TestVertex), 0.0f);
+
+    uint32_t far = 0;
+    for (const auto &v : vertices)
+    {
+        const float y = WaveXZ(sea, camera, kMaxDistance, v.pos.x, v.pos.z);
+        CHECK(v.pos.y == Approx(y).margin(1e-4));
+        if (y == 0.0f)
+            far++;
+    }
+    CHECK(far > 0);
+    CHECK(far < vertices.size());
+}
+
+TEST_CASE("SeaWaves normal does not change the height", "[sea]")
+{
+    const TestSea sea;
+    const auto waves = sea.waves(CVECTOR(0.0f, 0.0f, 0.0f), 100.0f);
+
+    for (float x = -50.0f; x < 50.0f; x += 3.7f)
+    {
+        CVECTOR normal;
+        const float y = waves.height(x, x * 0.5f, &normal);
+        CHECK(y == waves.height(x, x * 0.5f));
+        CHECK(sqrtf(~normal) == Approx(1.0f).margin(1e-5));
+        CHECK(normal.y > 0.0f);
+    }
+
+    CVECTOR normal;
+    CHECK(waves.height(500.0f, 0.0f, &normal) == 0.0f);
+    CHECK(normal.y == 1.0f);
+}
+
+TEST_CASE("SeaWaves broadside benchmark", "[.][sea][benchmark]")
+{
+    // water rings of 200 cannonballs, 8 x 8 vertices each
+    constexpr int32_t kSplashes = 200;
+    constexpr int32_t kVertices = 8 * 8;
+
+    const TestSea sea;
+    const auto waves = sea.waves(CVECTOR(0.0f, 10.0f, 0.0f));
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> offset(-200.0f, 200.0f);
+    std::vector<TestVertex> vertices;
+    for (int32_t i = 0; i < kSplashes; i++)
+    {
+        const float x = offset(gen), z = offset(gen);
+        for (int32_t j = 0; j < kVertices; j++)
+            vertices.push_back(TestVertex{CVECTOR(x + (j % 8) * 0.4f, 0.0f, z + (j / 8) * 0.4f), 0, 0.0f, 0.0f});
+    }
+
+    BENCHMARK("per point")
+    {
+        for (auto &v : vertices)
+            v.pos.y = waves.height(v.pos.x, v.pos.z) + 0.01f;
+        return vertices.back().pos.y;
+    };
+
+    BENCHMARK("batch per ring")
+    {
+        for (size_t i = 0; i < vertices.size(); i += kVertices)
+            waves.heights(&vertices[i].pos, kVertices, sizeof(TestVertex), 0.01f);
+        return vertices.back().pos.y;
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "attributes.h"
+#include "attributes_view.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief What the cannon controller of a ship tells the scripts, written only when it changes
+ *
+ * The values of the borts go to Ship.Cannons.Borts of the character. The nodes are found once and watched through
+ * attribute views: when a script changes or deletes a node the view lets go of it and the value is written again, so
+ * the scripts never keep a value the controller did not write. A value is written again when it moves by more than
+ * kEpsilon of itself; ratios reaching 0 or 1 are always written, scripts compare them exactly.
+ */
+class CannonPublisher final
+{
+  public:
+    struct Counters
+    {
+        uint64_t writes = 0;  // values written to attributes
+        uint64_t skips = 0;   // values that were not changed enough to be written
+        uint64_t lookups = 0; // bort nodes found by their path
+        uint64_t events = 0;  // not enough balls events
+    };
+
+    static constexpr float kEpsilon = 1e-3f;
+
+    // the values of the bort with the index in Ship.Cannons.Borts.<name> of the character
+    void publishBort(ATTRIBUTES &character, size_t index, const std::string &name, float maxFireDistance,
+                     float chargeRatio, float damageRatio);
+
+    // true when the script has to hear about it, for the player only
+    bool notEnoughBallsChanged(bool notEnoughBalls);
+    // the next value is sent whatever it is
+    void forgetNotEnoughBalls();
+
+    // everything is written and sent again
+    void reset();
+
+    static Counters &counters();
+
+  private:
+    struct Value
+    {
+        AttributeValueView view;
+        float value = 0.0f;
+    };
+
+    struct Bort
+    {
+        AttributeValueView view;
+        ATTRIBUTES *attribute = nullptr;
+        std::array<Value, 3> values;
+    };
+
+    static bool changed(float published, float value);
+    void write(ATTRIBUTES &bort, Value &value, const char *name, float newValue);
+
+    ATTRIBUTES *character_ = nullptr;
+    std::vector<Bort> borts_;
+    // the value sent last, -1 before the first one
+    int32_t notEnoughBalls_ = -1;
+};
+
+} // namespace storm
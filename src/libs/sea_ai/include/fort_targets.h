@@ -0,0 +1,49 @@
+#pragma once
+
+#include "c_vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Targets of the cannons of a fort, the enemies of one frame sorted along the x axis
+ *
+ * A cannon looks only at the targets whose x is within its fire range. Among the targets in range it takes the nearest
+ * one and the first one added when several are as near, so it finds the same ship as a scan of all ships in the order
+ * they were added.
+ */
+class FortTargets final
+{
+  public:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    void clear();
+    // the index is what nearest returns for the target
+    void add(uint32_t index, const CVECTOR &pos);
+    // sorts the targets, to be called after the last add
+    void build();
+
+    // index of the nearest target not farther than maxDistance or kNone
+    [[nodiscard]] uint32_t nearest(const CVECTOR &from, float maxDistance) const;
+
+    [[nodiscard]] bool empty() const
+    {
+        return targets_.empty();
+    }
+
+  private:
+    struct Target
+    {
+        CVECTOR pos;
+        // place in the order of adding
+        uint32_t order;
+        uint32_t index;
+    };
+
+    std::vector<Target> targets_;
+};
+
+} // namespace storm
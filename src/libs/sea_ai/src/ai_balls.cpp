@@ -257,7 +257,12 @@ void AIBalls::Execute(uint32_t Delta_Time)
             {
                 if (auto *pShip = static_cast<CANNON_TRACE_BASE *>(core.GetEntityPointer(ent_id)))
                 {
-                    fRes = pShip->Cannon_Trace(pBall->iBallOwner, vSrc, vDst);
+                    fRes = bBatchHits
+                               ? pShip->Cannon_CollectTrace(CANNON_BALL{pBall->iBallOwner, pBallsType->dwGoodIndex,
+                                                                        pBall->dwCannonType,
+                                                                        sqrtf(~(vSrc - pBall->vFirstPos))},
+                                                            vSrc, vDst)
+                               : pShip->Cannon_Trace(pBall->iBallOwner, vSrc, vDst);
                     if (fRes <= 1.0f)
                         break;
                 }
@@ -314,6 +319,15 @@ void AIBalls::Execute(uint32_t Delta_Time)
             }
         }
     }
+
+    if (bBatchHits)
+    {
+        // a copy, the scripts may change the layer
+        const auto ships = core.GetEntityIds(SHIP_CANNON_TRACE);
+        for (auto ent_id : ships)
+            if (auto *pShip = static_cast<CANNON_TRACE_BASE *>(core.GetEntityPointer(ent_id)))
+                pShip->Cannon_SendHits();
+    }
 }
 
 void AIBalls::Realize(uint32_t Delta_Time)
@@ -380,6 +394,7 @@ uint32_t AIBalls::AttributeChanged(ATTRIBUTES *pAttributeChanged)
         sTextureName = to_string(AttributesPointer->GetAttribute("Texture"));
         dwSubTexX = AttributesPointer->GetAttributeAsDword("SubTexX");
         dwSubTexY = AttributesPointer->GetAttributeAsDword("SubTexY");
+        bBatchHits = AttributesPointer->GetAttributeAsDword("BatchHits", 0) != 0;
 
         dwTextureIndex = AIHelper::pRS->TextureCreate(sTextureName.c_str());
 
@@ -62,6 +62,8 @@ class AIBalls : public Entity
     uint32_t dwTextureIndex{};         // texture index
     uint32_t dwSubTexX{}, dwSubTexY{}; // all balls must be in one texture
     uint32_t dwFireBallFromCameraTime;
+    // ships take the hits of the frame at once, in the SHIP_HITS event, instead of in an event per hit
+    bool bBatchHits{};
 
     std::vector<BALL_TYPE> aBallTypes; // Balls types container
     std::vector<RS_RECT> aBallRects;   // Balls container for render
@@ -6,6 +6,8 @@ AIFort *AIFort::pAIFort = nullptr;
 AIFort::AIFort()
 {
     dtFiredTimer.Setup(FRAND(1.0f), 1.0f);
+    fMinCannonDamageDistance = 0.0f;
+    bRecalculateParams = true;
     pLastTraceFort = nullptr;
     pShipsLights = nullptr;
     pAIFort = this;
@@ -27,13 +29,56 @@ void AIFort::SetDevice()
 {
 }
 
-float AIFort::GetSpeedV0(uint32_t dwFortIndex)
+// The script recalculates the parameters of a cannon type only for a new type or character and on fire ticks, when
+// the skills of the character may have changed. Other types take back the values it left in Ship.Cannons.
+float AIFort::SetCannonsType(AI_FORT *pFort, uint32_t dwType, bool bRecalculate)
 {
-    ATTRIBUTES *pACannon, *pACharacter;
-    pACharacter = aForts[dwFortIndex]->GetACharacter();
-    pACannon = pACharacter->FindAClass(pACharacter, "Ship.Cannons");
-    Assert(pACannon);
-    return pACannon->GetAttributeAsFloat("SpeedV0");
+    auto *pACharacter = pFort->GetACharacter();
+    if (bRecalculate || pFort->pParamsCharacter != pACharacter)
+    {
+        pFort->aCannonParams.clear();
+        pFort->pParamsCharacter = pACharacter;
+        pFort->dwParamsType = 0xFFFFFFFF;
+    }
+
+    auto *pACannons = pACharacter->FindAClass(pACharacter, "Ship.Cannons");
+    if (!pACannons)
+        pACannons = pACharacter->CreateSubAClass(pACharacter, "Ship.Cannons");
+    Assert(pACannons);
+
+    for (const auto &params : pFort->aCannonParams)
+    {
+        if (params.dwType != dwType)
+            continue;
+        if (pFort->dwParamsType != dwType)
+        {
+            for (const auto &[dwNameCode, sValue] : params.aValues)
+            {
+                const auto *pA = pACannons->GetAttributeClassByCode(dwNameCode);
+                if (!pA || pA->GetValue() != sValue)
+                    pACannons->SetAttribute(dwNameCode, sValue);
+            }
+            pFort->dwParamsType = dwType;
+        }
+        return params.fSpeedV0;
+    }
+
+    pACannons->SetAttributeUseDword("type", dwType);
+    core.Event(CANNON_RECALCULATE_PARAMETERS, "l", GetIndex(pACharacter));
+    pACannons = pACharacter->FindAClass(pACharacter, "Ship.Cannons");
+    Assert(pACannons);
+
+    auto &params = pFort->aCannonParams.emplace_back();
+    params.dwType = dwType;
+    params.fSpeedV0 = pACannons->GetAttributeAsFloat("SpeedV0");
+    for (uint32_t i = 0; i < pACannons->GetAttributesNum(); i++)
+    {
+        const auto *pA = pACannons->GetAttributeClass(i);
+        if (pA->GetAttributesNum() == 0 && pA->HasValue())
+            params.aValues.emplace_back(pA->GetThisNameCode(), pA->GetValue());
+    }
+    pFort->dwParamsType = dwType;
+    return params.fSpeedV0;
 }
 
 // float fAngF = 0.0f;
@@ -45,14 +90,17 @@ void AIFort::Execute(uint32_t Delta_Time)
     CVECTOR vDst = -CVECTOR(vSrc.x, yyy, vSrc.z);
     vDst.y = yyy;
     Trace(vSrc, vDst);*/
-    fMinCannonDamageDistance = AttributesPointer->GetAttributeAsFloat("MinCannonDamageDistance");
-
     const auto fDeltaTime = static_cast<float>(Delta_Time) * 0.001f;
+    const auto bFiredTimer = dtFiredTimer.Update(fDeltaTime);
+
+    const auto bRecalculate = bFiredTimer || bRecalculateParams;
+    bRecalculateParams = false;
+    if (bRecalculate)
+        fMinCannonDamageDistance = AttributesPointer->GetAttributeAsFloat("MinCannonDamageDistance");
+
     if (!aForts.size())
         return;
 
-    const auto bFiredTimer = dtFiredTimer.Update(fDeltaTime);
-
     for (uint32_t k = 0; k < aForts.size(); k++)
     {
         auto *pF = aForts[k];
@@ -63,6 +111,7 @@ void AIFort::Execute(uint32_t Delta_Time)
 
         auto fSpeedV0 = 0.0f;
         auto dwCurrentCannonType = 0xFFFFFFFF;
+        auto bTargets = false;
         const auto iMax = pF->GetAllCannonsNum(); // boal fix
         for (uint32_t i = 0; i < iMax; i++)
         {
@@ -70,41 +119,34 @@ void AIFort::Execute(uint32_t Delta_Time)
 
             const auto dwNewCurrentCannonType = pF->GetCannonType(i);
 
-            // update cannons parameters
+            // update cannons parameters, cannons of a type follow each other
             if (dwCurrentCannonType != dwNewCurrentCannonType)
             {
                 dwCurrentCannonType = dwNewCurrentCannonType;
-                auto *pACannons = pF->GetACharacter()->FindAClass(pF->GetACharacter(), "Ship.Cannons");
-                if (!pACannons)
-                    pACannons = pF->GetACharacter()->CreateSubAClass(pF->GetACharacter(), "Ship.Cannons");
-                Assert(pACannons);
-                pACannons->SetAttributeUseDword("type", dwCurrentCannonType);
-                core.Event(CANNON_RECALCULATE_PARAMETERS, "l", GetIndex(pF->GetACharacter()));
-
-                fSpeedV0 = GetSpeedV0(k);
+                fSpeedV0 = SetCannonsType(pF, dwCurrentCannonType, bRecalculate && i == 0);
             }
 
             if (!pC->isFired() && pC->isReady2Fire() && bFiredTimer)
             {
-                AIShip *pFireAIShip = nullptr;
-                auto fMinDistance = 1e10f;
-                auto vCPos = pC->GetPos();
-                const auto fMaxFireDistance = AICannon::CalcMaxFireDistance(vCPos.y, fSpeedV0, 0.35f); // FIX-ME
-                for (auto &j : AIShip::AIShips)
-                    if (!j->isDead() &&
-                        Helper.isEnemy(pF->GetACharacter(), j->GetACharacter()))
+                // enemies are gathered once for all cannons of the fort
+                if (!bTargets)
+                {
+                    bTargets = true;
+                    Targets.clear();
+                    for (uint32_t j = 0; j < AIShip::AIShips.size(); j++)
                     {
-                        const auto fDistance = j->GetDistance(vCPos);
-                        if (fDistance > fMaxFireDistance)
-                            continue;
-                        if (fDistance < fMinDistance)
-                        {
-                            fMinDistance = fDistance;
-                            pFireAIShip = j;
-                        }
+                        auto *pShip = AIShip::AIShips[j];
+                        if (!pShip->isDead() && Helper.isEnemy(pF->GetACharacter(), pShip->GetACharacter()))
+                            Targets.add(j, pShip->GetPos());
                     }
-                if (pFireAIShip)
-                    pC->Fire(fSpeedV0, pFireAIShip->GetPos());
+                    Targets.build();
+                }
+
+                const auto vCPos = pC->GetPos();
+                const auto fMaxFireDistance = AICannon::CalcMaxFireDistance(vCPos.y, fSpeedV0, 0.35f); // FIX-ME
+                const auto dwTarget = Targets.nearest(vCPos, fMaxFireDistance);
+                if (dwTarget < AIShip::AIShips.size())
+                    pC->Fire(fSpeedV0, AIShip::AIShips[dwTarget]->GetPos());
             }
             pC->Execute(fDeltaTime);
         }
@@ -315,6 +357,7 @@ uint64_t AIFort::ProcessMessage(MESSAGE &message)
 
 uint32_t AIFort::AttributeChanged(ATTRIBUTES *pAttribute)
 {
+    bRecalculateParams = true;
     return 0;
 }
 
@@ -500,6 +543,7 @@ void AIFort::Load(CSaveLoad *pSL)
     fMinCannonDamageDistance = pSL->LoadFloat();
     for (auto &aFort : aForts)
         aFort->Load(pSL, GetId());
+    bRecalculateParams = true;
 }
 
 void AIFort::AI_FORT::Save(CSaveLoad *pSL)
@@ -2,6 +2,7 @@
 
 #include "ai_cannon.h"
 #include "ai_ship.h"
+#include "fort_targets.h"
 
 #include "ship_lights.h"
 
@@ -121,6 +122,18 @@ class AIFort : public VAI_OBJBASE
 
         uint32_t dwCannonType, dwCulverinType, dwMortarType;
 
+        // Ship.Cannons of the character as CANNON_RECALCULATE_PARAMETERS left it, for each cannon type
+        struct CannonParams
+        {
+            uint32_t dwType;
+            float fSpeedV0;
+            std::vector<std::pair<uint32_t, std::string>> aValues;
+        };
+
+        std::vector<CannonParams> aCannonParams;
+        ATTRIBUTES *pParamsCharacter = nullptr;
+        uint32_t dwParamsType = 0xFFFFFFFF; // type whose parameters are in Ship.Cannons now
+
         MODEL *GetModel() const
         {
             return static_cast<MODEL *>(core.GetEntityPointer(GetModelEID()));
@@ -272,12 +285,16 @@ class AIFort : public VAI_OBJBASE
     std::vector<AI_FORT *> aForts; // fort container
 
     float fMinCannonDamageDistance;
+    // script parameters are read again on the next frame
+    bool bRecalculateParams;
+    // enemies of the fort whose cannons are aimed now
+    storm::FortTargets Targets;
 
     // Ships lights
     IShipLights *pShipsLights;
 
     void AddFortHit(int32_t iCharacterIndex, CVECTOR &vHitPos);
-    float GetSpeedV0(uint32_t dwFortIndex);
+    float SetCannonsType(AI_FORT *pFort, uint32_t dwType, bool bRecalculate);
     bool ScanFortForCannons(AI_FORT *pFort, const char *pModelsDir, const char *pLocatorsName) const;
     bool AddFort(ATTRIBUTES *pIslandAP, ATTRIBUTES *pFortAP, ATTRIBUTES *pFortCharacter, entid_t eidModel,
                  entid_t eidBlot);
@@ -187,11 +187,18 @@ void AIShipCannonController::Execute(float fDeltaTime)
             bNotEnoughBalls = true;
             break;
         }
-        core.Event(SHIP_NOT_ENOUGH_BALLS, "l", bNotEnoughBalls);
+        if (Publisher.notEnoughBallsChanged(bNotEnoughBalls))
+            core.Event(SHIP_NOT_ENOUGH_BALLS, "l", bNotEnoughBalls);
+    }
+    else
+    {
+        // another ship may tell the script in between
+        Publisher.forgetNotEnoughBalls();
     }
 
-    for (auto &bort : aShipBorts)
+    for (size_t i = 0; i < aShipBorts.size(); i++)
     {
+        auto &bort = aShipBorts[i];
         if (!bort.aCannons.empty())
         {
             // set maximum MaxFireDistance for all cannons
@@ -242,19 +249,12 @@ void AIShipCannonController::Execute(float fDeltaTime)
             // update borts parameters for script
             // if (GetAIShip()->isMainCharacter())
             {
-                ATTRIBUTES *pAPlayer = GetAIShip()->GetACharacter();
-                ATTRIBUTES *pABorts = pAPlayer->FindAClass(pAPlayer, "Ship.Cannons.Borts");
-                Assert(pABorts);
-                pABorts->SetAttribute(bort.sName.c_str(), "");
-                ATTRIBUTES *pACurBort = pABorts->FindAClass(pABorts, bort.sName.c_str());
-                Assert(pACurBort);
-
-                pACurBort->SetAttributeUseFloat("MaxFireDistance", bort.fMaxFireDistance);
-                pACurBort->SetAttributeUseFloat("ChargeRatio", bort.fChargePercent);
-                pACurBort->SetAttributeUseFloat("DamageRatio",
-                                                1.0f - (static_cast<float>(GetBortIntactCannonsNum(bort)) +
-                                                        static_cast<float>(GetBortDisabledCannonsNum(bort))) /
-                                                static_cast<float>(bort.aCannons.size()));
+                // only the values that changed are written
+                Publisher.publishBort(*GetAIShip()->GetACharacter(), i, bort.sName, bort.fMaxFireDistance,
+                                      bort.fChargePercent,
+                                      1.0f - (static_cast<float>(GetBortIntactCannonsNum(bort)) +
+                                              static_cast<float>(GetBortDisabledCannonsNum(bort))) /
+                                                 static_cast<float>(bort.aCannons.size()));
                 //        pACurBort->SetAttributeUseFloat("DamageRatio",
                 //                                        1.0f - static_cast<float>(GetBortIntactCannonsNum(i)) /
                 //                                        static_cast<float>(pBort
@@ -691,6 +691,7 @@ void AIShipCannonController::Realize(float fDeltaTime)
 bool AIShipCannonController::Init(ATTRIBUTES *_pAShip)
 {
     pAShip = _pAShip;
+    Publisher.reset();
 
     ATTRIBUTES *pACharacter = GetAIShip()->GetACharacter();
     ATTRIBUTES *pABorts = pACharacter->FindAClass(pACharacter, "Ship.Cannons.Borts");
@@ -979,6 +980,7 @@ void AIShipCannonController::Load(CSaveLoad *pSL)
 {
     bReload = pSL->LoadDword() != 0;
     bNotEnoughBalls = pSL->LoadDword() != 0;
+    Publisher.reset();
     pSL->LoadDword(); // TODO: $core-state-legacy
 
     const uint32_t dwNum = pSL->LoadDword();
@@ -1,6 +1,7 @@
 #pragma once
 
 #define INVALID_BORT_INDEX 0xFFFFFFFF
+#include "cannon_publisher.h"
 #include "string_compare.hpp"
 
 class AIShip;
@@ -20,6 +21,8 @@ class AIShipCannonController
     bool bReload;         // we must start reload at next frame
     bool bNotEnoughBalls; // if we haven't enough balls
 
+    storm::CannonPublisher Publisher; // borts parameters and events for script
+
     bool debugDrawToggle{false};
     std::vector<std::tuple<CVECTOR, uint32_t, float>> debugFirePositions;
 
@@ -0,0 +1,92 @@
+#include "cannon_publisher.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace storm
+{
+
+void CannonPublisher::publishBort(ATTRIBUTES &character, size_t index, const std::string &name, float maxFireDistance,
+                                  float chargeRatio, float damageRatio)
+{
+    if (character_ != &character)
+    {
+        reset();
+        character_ = &character;
+    }
+    if (borts_.size() <= index)
+        borts_.resize(index + 1);
+
+    auto &bort = borts_[index];
+    // the node went away or a script changed it, all values are written again
+    if (!bort.view.attribute())
+    {
+        auto *pABorts = character.FindAClass(&character, "Ship.Cannons.Borts");
+        if (!pABorts)
+            return;
+        counters().lookups++;
+        pABorts->SetAttribute(name, std::string_view(""));
+        bort.attribute = pABorts->GetAttributeClass(name);
+        bort.view.attach(*bort.attribute);
+        for (auto &value : bort.values)
+            value.view.reset();
+    }
+
+    write(*bort.attribute, bort.values[0], "MaxFireDistance", maxFireDistance);
+    write(*bort.attribute, bort.values[1], "ChargeRatio", chargeRatio);
+    write(*bort.attribute, bort.values[2], "DamageRatio", damageRatio);
+}
+
+bool CannonPublisher::notEnoughBallsChanged(bool notEnoughBalls)
+{
+    if (notEnoughBalls_ == static_cast<int32_t>(notEnoughBalls))
+        return false;
+    notEnoughBalls_ = notEnoughBalls;
+    counters().events++;
+    return true;
+}
+
+void CannonPublisher::forgetNotEnoughBalls()
+{
+    notEnoughBalls_ = -1;
+}
+
+void CannonPublisher::reset()
+{
+    character_ = nullptr;
+    borts_.clear();
+    forgetNotEnoughBalls();
+}
+
+CannonPublisher::Counters &CannonPublisher::counters()
+{
+    static Counters counters;
+    return counters;
+}
+
+bool CannonPublisher::changed(float published, float value)
+{
+    if (published == value)
+        return false;
+    if (value == 0.0f || value == 1.0f)
+        return true;
+    return !(std::fabs(value - published) <= kEpsilon * std::max(1.0f, std::fabs(value)));
+}
+
+void CannonPublisher::write(ATTRIBUTES &bort, Value &value, const char *name, float newValue)
+{
+    if (value.view.attribute() && !changed(value.value, newValue))
+    {
+        counters().skips++;
+        return;
+    }
+
+    // let go of the old value first, the view would copy it
+    value.view.reset();
+    bort.SetAttributeUseFloat(name, newValue);
+    value.view.attach(*bort.GetAttributeClass(name));
+    value.value = newValue;
+    counters().writes++;
+}
+
+} // namespace storm
@@ -0,0 +1,58 @@
+#include "fort_targets.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace storm
+{
+
+void FortTargets::clear()
+{
+    targets_.clear();
+}
+
+void FortTargets::add(uint32_t index, const CVECTOR &pos)
+{
+    targets_.push_back({pos, static_cast<uint32_t>(targets_.size()), index});
+}
+
+void FortTargets::build()
+{
+    std::sort(targets_.begin(), targets_.end(), [](const Target &a, const Target &b) { return a.pos.x < b.pos.x; });
+}
+
+uint32_t FortTargets::nearest(const CVECTOR &from, float maxDistance) const
+{
+    if (targets_.empty() || maxDistance < 0.0f)
+        return kNone;
+
+    // a range that is no number lets every target through, as the comparisons of the scan did
+    auto first = targets_.begin();
+    auto last = targets_.end();
+    if (maxDistance <= std::numeric_limits<float>::max())
+    {
+        // a little wider for the rounding of the bounds
+        const auto reach = maxDistance * 1.001f + 1.0f;
+        first = std::lower_bound(first, last, from.x - reach,
+                                 [](const Target &target, float x) { return target.pos.x < x; });
+        last = std::upper_bound(first, last, from.x + reach,
+                                [](float x, const Target &target) { return x < target.pos.x; });
+    }
+
+    const Target *best = nullptr;
+    auto bestDistance = 1e10f;
+    for (auto it = first; it != last; ++it)
+    {
+        const auto distance = sqrtf(~(it->pos - from));
+        if (distance > maxDistance)
+            continue;
+        if (distance < bestDistance || (best && distance == bestDistance && it->order < best->order))
+        {
+            best = &*it;
+            bestDistance = distance;
+        }
+    }
+    return best ? best->index : kNone;
+}
+
+} // namespace storm
@@ -0,0 +1,233 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "cannon_publisher.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+
+namespace
+{
+
+class Codec final : public VSTRING_CODEC
+{
+  public:
+    uint32_t GetNum() override
+    {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    uint32_t Convert(const char *pString) override
+    {
+        const auto [it, added] = codes_.emplace(pString, static_cast<uint32_t>(names_.size()));
+        if (added)
+            names_.emplace_back(pString);
+        return it->second;
+    }
+
+    uint32_t Convert(const char *pString, int32_t iLen) override
+    {
+        return Convert(std::string(pString, iLen).c_str());
+    }
+
+    const char *Convert(uint32_t code) override
+    {
+        return names_.at(code).c_str();
+    }
+
+    void VariableChanged() override
+    {
+    }
+
+  private:
+    std::map<std::string, uint32_t> codes_;
+    std::deque<std::string> names_;
+};
+
+const char *kBorts[] = {"cannonl", "cannonr", "cannonf", "cannonb"};
+const char *kValues[] = {"MaxFireDistance", "ChargeRatio", "DamageRatio"};
+
+struct Frame
+{
+    float values[4][3];
+};
+
+// the way AIShipCannonController::Execute wrote the borts every frame
+void WriteAll(ATTRIBUTES &character, const Frame &frame)
+{
+    auto *pABorts = character.FindAClass(&character, "Ship.Cannons.Borts");
+    REQUIRE(pABorts);
+    for (size_t b = 0; b < 4; b++)
+    {
+        pABorts->SetAttribute(kBorts[b], std::string_view(""));
+        auto *pACurBort = pABorts->FindAClass(pABorts, kBorts[b]);
+        for (size_t v = 0; v < 3; v++)
+            pACurBort->SetAttributeUseFloat(kValues[v], frame.values[b][v]);
+    }
+}
+
+void Publish(storm::CannonPublisher &publisher, ATTRIBUTES &character, const Frame &frame)
+{
+    for (size_t b = 0; b < 4; b++)
+        publisher.publishBort(character, b, kBorts[b], frame.values[b][0], frame.values[b][1], frame.values[b][2]);
+}
+
+// what a script reads is the value written every frame, within the epsilon and exact at the ends of the ratios
+void RequireSeen(ATTRIBUTES &expected, ATTRIBUTES &published)
+{
+    auto *pAExpected = expected.FindAClass(&expected, "Ship.Cannons.Borts");
+    auto *pAPublished = published.FindAClass(&published, "Ship.Cannons.Borts");
+    for (const auto *bort : kBorts)
+        for (const auto *name : kValues)
+        {
+            const auto *pA = pAPublished->GetAttributeClass(bort);
+            REQUIRE(pA);
+            REQUIRE(pA->GetValue().empty());
+            const auto *pAValue = pA->GetAttributeClass(name);
+            REQUIRE(pAValue);
+            const auto value = pAValue->GetValueAsFloat();
+            const auto reference = pAExpected->GetAttributeClass(bort)->GetAttributeClass(name)->GetValueAsFloat();
+            if (reference == 0.0f || reference == 1.0f)
+                REQUIRE(value == reference);
+            else
+                REQUIRE(std::fabs(value - reference) <=
+                        storm::CannonPublisher::kEpsilon * std::max(1.0f, std::fabs(reference)) * 1.01f);
+        }
+}
+
+ATTRIBUTES &MakeCharacter(ATTRIBUTES &world, const char *name)
+{
+    auto &character = world.CreateAttribute(name);
+    character.CreateSubAClass(&character, "Ship.Cannons.Borts");
+    // the script keeps its own things in the bort too
+    auto *pABorts = character.FindAClass(&character, "Ship.Cannons.Borts");
+    pABorts->CreateSubAClass(pABorts, "cannonl.damages.c0");
+    return character;
+}
+
+} // namespace
+
+TEST_CASE("Scripts read the bort values the controller wrote every frame", "[sea_ai]")
+{
+    Codec codec;
+    ATTRIBUTES world(codec);
+    auto &expected = MakeCharacter(world, "expected");
+    auto *published = &MakeCharacter(world, "published");
+    storm::CannonPublisher publisher;
+    const auto counters = storm::CannonPublisher::counters();
+
+    std::mt19937 gen(92);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::uniform_int_distribution<int> moment(0, 9);
+    Frame frame{};
+    for (auto &bort : frame.values)
+    {
+        bort[0] = 600.0f;
+        bort[1] = 0.0f;
+        bort[2] = 0.0f;
+    }
+
+    for (int f = 0; f < 3000; f++)
+    {
+        for (auto &bort : frame.values)
+        {
+            // the height of the ship on the waves, the reload and some damage now and then
+            bort[0] = 600.0f + 0.5f * noise(gen);
+            bort[1] = std::min(1.0f, bort[1] + 0.0006f);
+            if (bort[1] >= 1.0f && moment(gen) == 0)
+                bort[1] = 0.0f;
+            if (moment(gen) == 0 && f % 100 == 0)
+                bort[2] = std::min(1.0f, bort[2] + 0.1f);
+        }
+        WriteAll(expected, frame);
+        Publish(publisher, *published, frame);
+
+        // a script reads, or changes and deletes what the controller wrote
+        switch (f % 500)
+        {
+        case 100: {
+            auto *pABorts = published->FindAClass(published, "Ship.Cannons.Borts");
+            pABorts->GetAttributeClass("cannonr")->SetAttribute("ChargeRatio", std::string_view("7"));
+            break;
+        }
+        case 200: {
+            auto *pABorts = published->FindAClass(published, "Ship.Cannons.Borts");
+            pABorts->DeleteAttributeClassX(pABorts->GetAttributeClass("cannonf"));
+            break;
+        }
+        case 300: {
+            // a new ship for the character
+            auto *pAShip = published->GetAttributeClass("Ship");
+            published->DeleteAttributeClassX(pAShip);
+            published->CreateSubAClass(published, "Ship.Cannons.Borts");
+            break;
+        }
+        case 400: {
+            // the controller of another character
+            published = &MakeCharacter(world, ("published" + std::to_string(f)).c_str());
+            Publish(publisher, *published, frame);
+            break;
+        }
+        default:
+            break;
+        }
+        if (f % 500 == 100 || f % 500 == 200 || f % 500 == 300)
+            Publish(publisher, *published, frame);
+        RequireSeen(expected, *published);
+    }
+
+    const auto &after = storm::CannonPublisher::counters();
+    // the borts are found again only after a script took them away: one, all of them and another character
+    CHECK(after.lookups - counters.lookups == 4 + 6 * (1 + 4 + 4));
+    // most of the frames write nothing
+    CHECK(after.writes - counters.writes < 3000 * 12 / 4);
+    CHECK(after.skips - counters.skips > 3000 * 12 / 2);
+}
+
+TEST_CASE("Not enough balls is sent when it changes", "[sea_ai]")
+{
+    storm::CannonPublisher publisher;
+    CHECK(publisher.notEnoughBallsChanged(false));
+    CHECK_FALSE(publisher.notEnoughBallsChanged(false));
+    CHECK(publisher.notEnoughBallsChanged(true));
+    CHECK_FALSE(publisher.notEnoughBallsChanged(true));
+    publisher.forgetNotEnoughBalls();
+    CHECK(publisher.notEnoughBallsChanged(true));
+    CHECK(publisher.notEnoughBallsChanged(false));
+    publisher.reset();
+    CHECK(publisher.notEnoughBallsChanged(false));
+}
+
+TEST_CASE("Cannon publisher benchmark", "[.][sea_ai][benchmark]")
+{
+    Codec codec;
+    ATTRIBUTES world(codec);
+    auto &every = MakeCharacter(world, "every");
+    auto &changed = MakeCharacter(world, "changed");
+    storm::CannonPublisher publisher;
+    Frame frame{};
+    for (auto &bort : frame.values)
+        bort[0] = 600.0f;
+
+    // 40 ships of a battle, one frame
+    BENCHMARK("write every frame")
+    {
+        for (int ship = 0; ship < 40; ship++)
+        {
+            frame.values[0][1] += 1e-5f;
+            WriteAll(every, frame);
+        }
+    };
+    BENCHMARK("write changes")
+    {
+        for (int ship = 0; ship < 40; ship++)
+        {
+            frame.values[0][1] += 1e-5f;
+            Publish(publisher, changed, frame);
+        }
+    };
+}
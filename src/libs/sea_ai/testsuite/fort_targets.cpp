@@ -0,0 +1,122 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "fort_targets.h"
+
+#include <catch2/catch.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+struct TestShip
+{
+    CVECTOR pos;
+    bool enemy;
+    bool dead;
+};
+
+// the scan of AIFort::Execute as it was, every cannon over all ships
+uint32_t ScanTarget(const std::vector<TestShip> &ships, const CVECTOR &cannon, float maxFireDistance)
+{
+    auto target = storm::FortTargets::kNone;
+    auto fMinDistance = 1e10f;
+    for (uint32_t j = 0; j < ships.size(); j++)
+        if (!ships[j].dead && ships[j].enemy)
+        {
+            const auto fDistance = sqrtf(~(ships[j].pos - cannon));
+            if (fDistance > maxFireDistance)
+                continue;
+            if (fDistance < fMinDistance)
+            {
+                fMinDistance = fDistance;
+                target = j;
+            }
+        }
+    return target;
+}
+
+void Gather(storm::FortTargets &targets, const std::vector<TestShip> &ships)
+{
+    targets.clear();
+    for (uint32_t j = 0; j < ships.size(); j++)
+        if (!ships[j].dead && ships[j].enemy)
+            targets.add(j, ships[j].pos);
+    targets.build();
+}
+
+std::vector<TestShip> RandomShips(std::mt19937 &gen, size_t num, float spread)
+{
+    std::uniform_real_distribution<float> coord(-spread, spread);
+    std::uniform_real_distribution<float> height(-1.0f, 3.0f);
+    std::uniform_int_distribution<int> flag(0, 3);
+    std::vector<TestShip> ships(num);
+    for (auto &ship : ships)
+        ship = {CVECTOR(coord(gen), height(gen), coord(gen)), flag(gen) != 0, flag(gen) == 0};
+    return ships;
+}
+
+} // namespace
+
+TEST_CASE("Fort cannons pick the targets the ship scan picked", "[sea_ai]")
+{
+    std::mt19937 gen(91);
+    storm::FortTargets targets;
+    for (const auto spread : {300.0f, 2000.0f, 1e6f})
+    {
+        auto ships = RandomShips(gen, 120, spread);
+        // ships in the same spot, the first one in the list wins
+        ships[7] = ships[40] = ships[90] = {CVECTOR(120.0f, 1.0f, -35.0f), true, false};
+        Gather(targets, ships);
+
+        std::uniform_real_distribution<float> coord(-spread, spread);
+        std::uniform_real_distribution<float> range(0.0f, spread * 0.7f);
+        for (int i = 0; i < 2000; i++)
+        {
+            const CVECTOR cannon(coord(gen), 25.0f, coord(gen));
+            const auto distance = range(gen);
+            REQUIRE(targets.nearest(cannon, distance) == ScanTarget(ships, cannon, distance));
+        }
+        const CVECTOR fort(118.0f, 20.0f, -30.0f);
+        CHECK(targets.nearest(fort, 100.0f) == 7);
+        for (const auto distance : {-1.0f, 0.0f, 1e12f, std::numeric_limits<float>::infinity(),
+                                    std::numeric_limits<float>::quiet_NaN()})
+            CHECK(targets.nearest(fort, distance) == ScanTarget(ships, fort, distance));
+    }
+
+    targets.clear();
+    targets.build();
+    CHECK(targets.empty());
+    CHECK(targets.nearest(CVECTOR(0.0f), 1000.0f) == storm::FortTargets::kNone);
+}
+
+TEST_CASE("Fort targets benchmark", "[.][sea_ai][benchmark]")
+{
+    // a fort of 150 cannons at a sea battle of 60 ships
+    std::mt19937 gen(1);
+    const auto ships = RandomShips(gen, 60, 1500.0f);
+    std::uniform_real_distribution<float> spot(-60.0f, 60.0f);
+    std::vector<CVECTOR> cannons(150);
+    for (auto &cannon : cannons)
+        cannon = CVECTOR(400.0f + spot(gen), 20.0f, spot(gen));
+
+    BENCHMARK("scan per cannon")
+    {
+        uint32_t sum = 0;
+        for (const auto &cannon : cannons)
+            sum += ScanTarget(ships, cannon, 700.0f);
+        return sum;
+    };
+
+    storm::FortTargets targets;
+    BENCHMARK("gathered once")
+    {
+        Gather(targets, ships);
+        uint32_t sum = 0;
+        for (const auto &cannon : cannons)
+            sum += targets.nearest(cannon, 700.0f);
+        return sum;
+    };
+}
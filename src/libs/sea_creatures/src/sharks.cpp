@@ -496,10 +496,10 @@ int32_t Sharks::Shark::GenerateTrack(uint16_t *inds, Vertex *vrt, uint16_t base,
     for (int32_t i = 0; i < 10; i++)
     {
         vrt[i].pos = mdl->mtx * CVECTOR(vrt[i].pos);
-        vrt[i].pos.y = sb->WaveXZ(vrt[i].pos.x, vrt[i].pos.z) + 0.001f;
         vrt[i].color = 0x4fffffff;
         vrt[i].v -= vBase;
     }
+    sb->WaveXZ(&vrt[0].pos, 10, sizeof(Vertex), 0.001f);
     vrt[7].color = 0;
     vrt[8].color = 0;
     vrt[9].color = 0;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "trace_mesh.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace storm
+{
+
+// Points on both sides of a ship hull in model space, where the foam runs along it
+struct HullContour
+{
+    static constexpr int32_t kStepsY = 5;
+    static constexpr int32_t kStepsZ = 13;
+
+    // [side][z][y], side 0 is the left (-x) one, z goes from the bow and y from the top of the box
+    CVECTOR center[2][kStepsZ][kStepsY];
+};
+
+// Samples the contour of a built mesh inside the given box as SEAFOAM always did, safe to call from any thread
+HullContour TraceHullContour(const TraceMesh &mesh, const CVECTOR &boxCenter, const CVECTOR &boxSize);
+
+/**
+ * \brief Hull contours keyed by the content hash of the hull geometry
+ *
+ * Every ship of a model gets the same contour object. Contours missing from memory are looked up in the
+ * storage and traced only if they are not there either; requests for several hulls are traced in parallel.
+ */
+class HullContourCache final
+{
+  public:
+    struct Source
+    {
+        // the hull geometry in model space, built by the cache if it has to be traced
+        TraceMesh *mesh;
+        CVECTOR boxCenter;
+        CVECTOR boxSize;
+    };
+
+    // Files of the cache, the owner decides where they live and how they are accessed
+    struct Storage
+    {
+        // fills data with the whole named file, false if there is no such file of this size
+        std::function<bool(const std::string &name, void *data, size_t size)> read;
+        std::function<void(const std::string &name, const void *data, size_t size)> write;
+    };
+
+    // an empty storage keeps the contours in memory only
+    explicit HullContourCache(Storage storage = {});
+
+    // 0 threads means one per hardware thread
+    std::vector<std::shared_ptr<const HullContour>> get(const std::vector<Source> &sources, uint32_t threads = 0);
+    std::shared_ptr<const HullContour> get(const Source &source);
+
+    [[nodiscard]] size_t size() const;
+    void clear();
+
+    [[nodiscard]] static uint64_t key(const Source &source);
+
+  private:
+    [[nodiscard]] static std::string fileName(uint64_t key);
+    std::shared_ptr<const HullContour> load(uint64_t key) const;
+    void save(uint64_t key, const HullContour &contour) const;
+
+    Storage storage_;
+    std::unordered_map<uint64_t, std::shared_ptr<const HullContour>> contours_;
+};
+
+} // namespace storm
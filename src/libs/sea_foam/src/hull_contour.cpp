@@ -0,0 +1,222 @@
+#include "hull_contour.h"
+
+#include "math_inlines.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace storm
+{
+
+namespace
+{
+
+constexpr uint32_t kFileMagic = 0x434C5548; // "HULC"
+constexpr uint32_t kFileVersion = 1;
+
+constexpr size_t kContourPoints = 2 * HullContour::kStepsZ * HullContour::kStepsY;
+
+struct HullContourFile
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    CVECTOR center[2][HullContour::kStepsZ][HullContour::kStepsY];
+};
+
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+HullContour TraceHullContour(const TraceMesh &mesh, const CVECTOR &boxCenter, const CVECTOR &boxSize)
+{
+    constexpr int32_t kStepsY = HullContour::kStepsY;
+    constexpr int32_t kStepsZ = HullContour::kStepsZ;
+
+    HullContour contour{};
+    const auto yStep = 0.9f * boxSize.y / (kStepsY - 1);
+    const auto zStep = .15f * boxSize.z / kStepsZ;
+    float curY, curZ;
+    float startZ[kStepsY];
+
+    // <find_startZ>
+    curY = boxCenter.y + (boxSize.y / 2.0f);
+    for (int32_t y = 0; y < kStepsY; y++, curY -= yStep)
+    {
+        const CVECTOR src(boxCenter.x, curY, boxCenter.z + boxSize.z / 2.0f);
+        const CVECTOR dst(boxCenter.x, curY, boxCenter.z - boxSize.z / 2.0f);
+        const auto d = mesh.trace(src, dst);
+        if (d <= 1.0f)
+        {
+            startZ[y] = d * boxSize.z;
+            if (startZ[y] > (boxSize.z / 4.0f))
+                startZ[y] = 0.0f;
+        }
+        else
+            startZ[y] = 0.0f;
+    }
+
+    // <trace_from_sides>
+    const auto halfZ = (boxSize.z / 2.0f);
+    curZ = boxCenter.z + halfZ;
+    for (int32_t z = 0; z < kStepsZ; z++, curZ -= zStep * (1 + 8 * sinf(PId2 * (boxCenter.z + halfZ - curZ) / halfZ)))
+    {
+        curY = boxCenter.y + (boxSize.y / 2.0f);
+        for (int32_t y = 0; y < kStepsY; y++, curY -= yStep)
+        {
+            const auto deltaZ = startZ[y];
+            const CVECTOR srcLeft(boxCenter.x - boxSize.x / 2.0f, curY, curZ - deltaZ);
+            const CVECTOR srcRight(boxCenter.x + boxSize.x / 2.0f, curY, curZ - deltaZ);
+            const CVECTOR dst(boxCenter.x, curY, curZ - deltaZ);
+
+            auto &left = contour.center[0][z][y];
+            auto &right = contour.center[1][z][y];
+            left.y = right.y = curY;
+            left.z = right.z = curZ - deltaZ;
+
+            // <from_left>
+            auto d = mesh.trace(srcLeft, dst);
+            if (d > 1.0f)
+                left.x = boxCenter.x;
+            else
+                left.x = -0.0f + (1.0f - d) * (srcLeft.x - boxCenter.x) + boxCenter.x;
+
+            // <from_right>
+            d = mesh.trace(srcRight, dst);
+            if (d > 1.0f)
+                right.x = boxCenter.x;
+            else
+                right.x = 0.0f + (1.0f - d) * (srcRight.x - boxCenter.x) + boxCenter.x;
+        }
+    }
+    return contour;
+}
+
+HullContourCache::HullContourCache(Storage storage) : storage_(std::move(storage))
+{
+}
+
+uint64_t HullContourCache::key(const Source &source)
+{
+    auto hash = source.mesh->contentHash();
+    hash = HashBytes(hash, &kFileVersion, sizeof(kFileVersion));
+    hash = HashBytes(hash, &source.boxCenter, sizeof(CVECTOR));
+    return HashBytes(hash, &source.boxSize, sizeof(CVECTOR));
+}
+
+std::shared_ptr<const HullContour> HullContourCache::get(const Source &source)
+{
+    return get(std::vector<Source>{source}, 1).front();
+}
+
+std::vector<std::shared_ptr<const HullContour>> HullContourCache::get(const std::vector<Source> &sources,
+                                                                      uint32_t threads)
+{
+    std::vector<uint64_t> keys(sources.size());
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        keys[i] = key(sources[i]);
+        if (contours_.contains(keys[i]))
+            continue;
+        if (auto contour = load(keys[i]))
+        {
+            contours_.emplace(keys[i], std::move(contour));
+            continue;
+        }
+        // ships of one model in the same request are traced once
+        if (std::none_of(pending.begin(), pending.end(), [&](size_t j) { return keys[j] == keys[i]; }))
+            pending.push_back(i);
+    }
+
+    if (!pending.empty())
+    {
+        std::vector<HullContour> traced(pending.size());
+        std::atomic<size_t> next{0};
+        const auto worker = [&] {
+            for (size_t n = next++; n < pending.size(); n = next++)
+            {
+                const auto &source = sources[pending[n]];
+                source.mesh->build();
+                traced[n] = TraceHullContour(*source.mesh, source.boxCenter, source.boxSize);
+            }
+        };
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, static_cast<uint32_t>(pending.size()));
+        std::vector<std::thread> workers;
+        for (uint32_t i = 1; i < threads; i++)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &thread : workers)
+            thread.join();
+
+        for (size_t n = 0; n < pending.size(); n++)
+        {
+            save(keys[pending[n]], traced[n]);
+            contours_.emplace(keys[pending[n]], std::make_shared<const HullContour>(traced[n]));
+        }
+    }
+
+    std::vector<std::shared_ptr<const HullContour>> result(sources.size());
+    for (size_t i = 0; i < sources.size(); i++)
+        result[i] = contours_.at(keys[i]);
+    return result;
+}
+
+size_t HullContourCache::size() const
+{
+    return contours_.size();
+}
+
+void HullContourCache::clear()
+{
+    contours_.clear();
+}
+
+std::string HullContourCache::fileName(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.hull", static_cast<unsigned long long>(key));
+    return name;
+}
+
+std::shared_ptr<const HullContour> HullContourCache::load(uint64_t key) const
+{
+    if (!storage_.read)
+        return {};
+
+    HullContourFile file;
+    if (!storage_.read(fileName(key), &file, sizeof(file)))
+        return {};
+    if (file.magic != kFileMagic || file.version != kFileVersion || file.key != key)
+        return {};
+
+    auto contour = std::make_shared<HullContour>();
+    std::copy_n(&file.center[0][0][0], kContourPoints, &contour->center[0][0][0]);
+    return contour;
+}
+
+void HullContourCache::save(uint64_t key, const HullContour &contour) const
+{
+    if (!storage_.write)
+        return;
+
+    HullContourFile file{kFileMagic, kFileVersion, key};
+    std::copy_n(&contour.center[0][0][0], kContourPoints, &file.center[0][0][0]);
+    storage_.write(fileName(key), &file, sizeof(file));
+}
+
+} // namespace storm
@@ -3,6 +3,8 @@
 
 #include "entity.h"
 #include "core.h"
+#include "file_service.h"
+#include "fs.h"
 #include "math_inlines.h"
 #include "string_compare.hpp"
 
@@ -14,9 +16,51 @@ CREATE_CLASS(SEAFOAM)
 #define V_SPEED_K 10e-5f
 #define START_FADE_SPEED 5.f
 
+namespace
+{
+
+// Hull contours are derived from the game files, so they are cached next to the scripts in the user's folder
+storm::HullContourCache::Storage HullContourStorage()
+{
+    static const auto directory = (fs::GetStashPath() / "Cache" / "hulls").string();
+    const auto filePath = [](const std::string &name) { return (fs::path(directory) / name).string(); };
+
+    return {[filePath](const std::string &name, void *data, size_t size) {
+                const auto path = filePath(name);
+                if (!fio->_FileOrDirectoryExists(path.c_str()) || fio->_GetFileSize(path.c_str()) != size)
+                    return false;
+                auto fileS = fio->_CreateFile(path.c_str(), std::ios::binary | std::ios::in);
+                if (!fileS.is_open())
+                    return false;
+                const auto result = fio->_ReadFile(fileS, data, size);
+                fio->_CloseFile(fileS);
+                return result;
+            },
+            [filePath](const std::string &name, const void *data, size_t size) {
+                try
+                {
+                    if (!fio->_FileOrDirectoryExists(directory.c_str()))
+                        fio->_CreateDirectory(directory.c_str());
+                }
+                catch (const std::exception &e)
+                {
+                    core.Trace("Sea foam: can't create the hull contour cache %s: %s", directory.c_str(), e.what());
+                    return;
+                }
+                auto fileS = fio->_CreateFile(filePath(name).c_str(), std::ios::binary | std::ios::out);
+                if (!fileS.is_open())
+                    return;
+                fio->_WriteFile(fileS, data, size);
+                fio->_CloseFile(fileS);
+            }};
+}
+
+} // namespace
+
 //--------------------------------------------------------------------
 SEAFOAM::SEAFOAM()
-    : seaID(0), sea(nullptr), shipsCount(0), carcassTexture(0), isStorm(false), soundService(nullptr)
+    : seaID(0), sea(nullptr), shipsCount(0), hullContours(HullContourStorage()),
+      carcassTexture(0), isStorm(false), soundService(nullptr)
 {
     psIni = nullptr;
     renderer = nullptr;
@@ -53,6 +97,7 @@ bool SEAFOAM::Init()
     soundService = static_cast<VSoundService *>(core.GetService("SoundService"));
 
     psIni = fio->OpenIniFile("resource\\ini\\particles.ini");
+    psBatch = std::make_unique<storm::IniParticleBatch>(renderer);
 
     InitializeShipFoam();
 
@@ -68,13 +113,24 @@ bool SEAFOAM::Init()
 void SEAFOAM::InitializeShipFoam()
 {
     auto &&entities = core.GetEntityIds("ship");
-    for (auto ent : entities)
+
+    // contours of all hulls are traced at once before the ships are added, ships of one model share theirs
+    std::vector<storm::TraceMesh> meshes(entities.size());
+    std::vector<storm::HullContourCache::Source> sources;
+    for (size_t i = 0; i < entities.size(); i++)
     {
-        AddShip(ent);
+        auto *ship = static_cast<SHIP_BASE *>(core.GetEntityPointer(entities[i]));
+        sources.push_back(CollectHull(ship->GetModel(), meshes[i]));
+    }
+    const auto contours = hullContours.get(sources);
+
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        AddShip(entities[i], *contours[i]);
     }
 }
 
-void SEAFOAM::AddShip(entid_t pShipEID)
+void SEAFOAM::AddShip(entid_t pShipEID, const storm::HullContour &contour)
 {
     auto *foamInfo = &shipFoamInfo[shipsCount++];
 
@@ -82,14 +138,10 @@ void SEAFOAM::AddShip(entid_t pShipEID)
     foamInfo->shipModel = foamInfo->ship->GetModel();
     foamInfo->shipModel->GetNode(0)->geo->GetInfo(foamInfo->hullInfo);
     foamInfo->enabled = true;
-    foamInfo->frontEmitter[0] = new SEAFOAM_PS();
-    foamInfo->frontEmitter[0]->Init(psIni.get(), "seafoam");
-    foamInfo->frontEmitter[1] = new SEAFOAM_PS();
-    foamInfo->frontEmitter[1]->Init(psIni.get(), "seafoam2");
-    foamInfo->frontEmitter[2] = new SEAFOAM_PS();
-    foamInfo->frontEmitter[2]->Init(psIni.get(), "seafoam_front");
-
-    CreateTracePoints(foamInfo);
+    foamInfo->frontEmitter[0] = CreateEmitter("seafoam");
+    foamInfo->frontEmitter[1] = CreateEmitter("seafoam2");
+    foamInfo->frontEmitter[2] = CreateEmitter("seafoam_front");
+
     const auto wideK = sqrtf(foamInfo->hullInfo.boxsize.y / 17.f);
     foamInfo->carcass[0] = new TCarcass(TRACE_STEPS_Z, MEASURE_POINTS, renderer, true);
     foamInfo->carcass[0]->Initialize();
@@ -99,11 +151,38 @@ void SEAFOAM::AddShip(entid_t pShipEID)
     foamInfo->carcass[1]->Initialize();
     foamInfo->carcass[1]->InitCircleMeasure(wideK * 1.4f, wideK * 1.f, .55f);
 
+    CreateTracePoints(foamInfo, contour);
+
     foamInfo->firstSoundPlay = true;
     foamInfo->doSplash = false;
     foamInfo->sound = 0;
 }
 
+storm::IniParticleEmitter *SEAFOAM::CreateEmitter(const char *psname)
+{
+    // a missing system is reported once, and the foam is drawn without it
+    auto [params, isNew] = psParams.try_emplace(psname);
+    if (isNew)
+    {
+        if (!psIni)
+            core.Trace("Sea foam: no particles.ini, particle system %s is not created", psname);
+        else
+        {
+            try
+            {
+                params->second = storm::IniParticleParams::load(*psIni, psname);
+            }
+            catch (const std::exception &e)
+            {
+                core.Trace("Sea foam: particle system %s is not created: %s", psname, e.what());
+            }
+        }
+    }
+    if (!params->second)
+        return nullptr;
+    return new storm::IniParticleEmitter(renderer, params->second);
+}
+
 //--------------------------------------------------------------------
 void SEAFOAM::ReleaseShipFoam()
 {
@@ -126,94 +205,43 @@ void SEAFOAM::ReleaseShipFoam()
 }
 
 //--------------------------------------------------------------------
-void SEAFOAM::CreateTracePoints(tShipFoamInfo *_shipFoamInfo)
+static storm::TraceMesh *pHullMesh = nullptr;
+
+static bool AddHullPolygon(const GEOS::VERTEX *vr, int32_t nv)
 {
-    const auto yStep = 0.9f * _shipFoamInfo->hullInfo.boxsize.y / (TRACE_STEPS_Y - 1);
-    const auto zStep = .15f * _shipFoamInfo->hullInfo.boxsize.z / TRACE_STEPS_Z;
-    float curY, curZ;
-    GEOS::VERTEX startSrcV, startDestV{};
-    float startZ[TRACE_STEPS_Y];
-
-    // <find_startZ>
-    curY = _shipFoamInfo->hullInfo.boxcenter.y + (_shipFoamInfo->hullInfo.boxsize.y / 2.0f);
-
-    startSrcV.x = _shipFoamInfo->hullInfo.boxcenter.x;
-    startSrcV.z = _shipFoamInfo->hullInfo.boxcenter.z + _shipFoamInfo->hullInfo.boxsize.z / 2.0f;
-
-    startDestV.x = _shipFoamInfo->hullInfo.boxcenter.x;
-    startDestV.z = _shipFoamInfo->hullInfo.boxcenter.z - _shipFoamInfo->hullInfo.boxsize.z / 2.0f;
-    int y;
-    for (y = 0; y < TRACE_STEPS_Y; y++, curY -= yStep)
+    CVECTOR v[3];
+    for (int32_t i = 2; i < nv; i++)
     {
-        startSrcV.y = curY;
-        startDestV.y = curY;
-        const auto d = _shipFoamInfo->shipModel->GetNode(0)->geo->Trace(startSrcV, startDestV);
-        if (d <= 1.0f)
-        {
-            startZ[y] = d * _shipFoamInfo->hullInfo.boxsize.z
-                /*(startSrcV.z - 2.0f * _shipFoamInfo->hullInfo.boxcenter.z) + _shipFoamInfo->hullInfo.boxcenter.z*/;
-            if (startZ[y] > (_shipFoamInfo->hullInfo.boxsize.z / 4.0f))
-                startZ[y] = 0.0f;
-        }
-        else
-            startZ[y] = 0.0f;
+        v[0] = CVECTOR(vr[0].x, vr[0].y, vr[0].z);
+        v[1] = CVECTOR(vr[i - 1].x, vr[i - 1].y, vr[i - 1].z);
+        v[2] = CVECTOR(vr[i].x, vr[i].y, vr[i].z);
+        pHullMesh->addTriangle(v[0], v[1], v[2]);
     }
+    return true;
+}
 
-    // <trace_from_sides>
-    const auto halfZ = (_shipFoamInfo->hullInfo.boxsize.z / 2.0f);
-    curZ = _shipFoamInfo->hullInfo.boxcenter.z + halfZ;
-    for (auto z = 0; z < TRACE_STEPS_Z;
-         z++, curZ -= zStep * (1 + 8 * sinf(PId2 * (_shipFoamInfo->hullInfo.boxcenter.z + halfZ - curZ) / halfZ)))
-    {
-        curY = _shipFoamInfo->hullInfo.boxcenter.y + (_shipFoamInfo->hullInfo.boxsize.y / 2.0f);
-        CVECTOR meanPointSum(0.0f, 0.0f, 0.0f);
-        auto meanCount = 0;
-        auto firstEnabledY = 0;
-        float deltaZ;
-        auto kSum = 0.0f;
-
-        for (y = 0; y < TRACE_STEPS_Y; y++, curY -= yStep)
-        {
-            deltaZ = startZ[y];
-            const CVECTOR srcLeft(_shipFoamInfo->hullInfo.boxcenter.x - _shipFoamInfo->hullInfo.boxsize.x / 2.0f, curY,
-                                  curZ - deltaZ);
-            const CVECTOR srcRight(_shipFoamInfo->hullInfo.boxcenter.x + _shipFoamInfo->hullInfo.boxsize.x / 2.0f, curY,
-                                   curZ - deltaZ);
-            const CVECTOR dst(_shipFoamInfo->hullInfo.boxcenter.x, curY, curZ - deltaZ);
-            GEOS::VERTEX srcLeftV, srcRightV, dstV;
-            srcLeftV.x = srcLeft.x;
-            srcLeftV.y = srcLeft.y;
-            srcLeftV.z = srcLeft.z;
-            srcRightV.x = srcRight.x;
-            srcRightV.y = srcRight.y;
-            srcRightV.z = srcRight.z;
-            dstV.x = dst.x;
-            dstV.y = dst.y;
-            dstV.z = dst.z;
-
-            _shipFoamInfo->hull[0][z].center[y].y = curY;
-            _shipFoamInfo->hull[0][z].center[y].z = curZ - deltaZ;
-            _shipFoamInfo->hull[1][z].center[y].y = curY;
-            _shipFoamInfo->hull[1][z].center[y].z = curZ - deltaZ;
-            // <from_left>
-            auto d = _shipFoamInfo->shipModel->GetNode(0)->geo->Trace(srcLeftV, dstV);
-            if (d > 1.0f)
-                _shipFoamInfo->hull[0][z].center[y].x = _shipFoamInfo->hullInfo.boxcenter.x;
-            else
-                _shipFoamInfo->hull[0][z].center[y].x = -0.0f +
-                                                        (1.0f - d) * (srcLeft.x - _shipFoamInfo->hullInfo.boxcenter.x) +
-                                                        _shipFoamInfo->hullInfo.boxcenter.x;
-
-            // <from_right>
-            d = _shipFoamInfo->shipModel->GetNode(0)->geo->Trace(srcRightV, dstV);
-            if (d > 1.0f)
-                _shipFoamInfo->hull[1][z].center[y].x = _shipFoamInfo->hullInfo.boxcenter.x;
-            else
-                _shipFoamInfo->hull[1][z].center[y].x =
-                    0.0f + (1.0f - d) * (srcRight.x - _shipFoamInfo->hullInfo.boxcenter.x) +
-                    _shipFoamInfo->hullInfo.boxcenter.x;
-        }
-    }
+storm::HullContourCache::Source SEAFOAM::CollectHull(MODEL *model, storm::TraceMesh &mesh)
+{
+    // the whole hull geometry in its local space, where the contour is traced
+    GEOS::INFO hullInfo;
+    model->GetNode(0)->geo->GetInfo(hullInfo);
+    mesh.clear();
+    pHullMesh = &mesh;
+    model->GetNode(0)->geo->Clip(nullptr, 0, hullInfo.boxcenter, 1e5f, AddHullPolygon);
+    pHullMesh = nullptr;
+    return {&mesh, CVECTOR(hullInfo.boxcenter.x, hullInfo.boxcenter.y, hullInfo.boxcenter.z),
+            CVECTOR(hullInfo.boxsize.x, hullInfo.boxsize.y, hullInfo.boxsize.z)};
+}
+
+//--------------------------------------------------------------------
+void SEAFOAM::CreateTracePoints(tShipFoamInfo *_shipFoamInfo, const storm::HullContour &contour)
+{
+    static_assert(TRACE_STEPS_Y == storm::HullContour::kStepsY && TRACE_STEPS_Z == storm::HullContour::kStepsZ);
+
+    for (auto side = 0; side < 2; side++)
+        for (auto z = 0; z < TRACE_STEPS_Z; z++)
+            for (auto y = 0; y < TRACE_STEPS_Y; y++)
+                _shipFoamInfo->hull[side][z].center[y] = contour.center[side][z][y];
 }
 
 //--------------------------------------------------------------------
@@ -394,34 +422,46 @@ void SEAFOAM::RealizeShipFoam_Particles(tShipFoamInfo &_shipFoamInfo, uint32_t _
     frontEmitterPos.z += FOAM_SHIFT_Z + .25f * shipSpeed;
     frontEmitterPos.y -= speedDeltaY;
     frontEmitterPos.x -= FOAM_SHIFT_X;
-    _shipFoamInfo.frontEmitter[0]->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, CVECTOR(0.f, 1.f, 0.f));
-    _shipFoamInfo.frontEmitter[0]->Realize(_dTime);
+    if (auto *emitter = _shipFoamInfo.frontEmitter[0])
+    {
+        emitter->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, CVECTOR(0.f, 1.f, 0.f));
+        emitter->realize(_dTime, *psBatch);
+    }
 
     frontEmitterPos.x += 2 * FOAM_SHIFT_X;
-    _shipFoamInfo.frontEmitter[1]->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, CVECTOR(0.f, 1.f, 0.f));
-    _shipFoamInfo.frontEmitter[1]->Realize(_dTime);
+    if (auto *emitter = _shipFoamInfo.frontEmitter[1])
+    {
+        emitter->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, CVECTOR(0.f, 1.f, 0.f));
+        emitter->realize(_dTime, *psBatch);
+    }
 
     frontEmitterPos.x -= FOAM_SHIFT_X;
 
     if (isStorm)
     {
+        auto *emitter = _shipFoamInfo.frontEmitter[2];
         static auto oldFrontEmitterPosY = frontEmitterPos.y;
         if ((frontEmitterPos.y - oldFrontEmitterPosY) / _dTime < 5e-4f) // 0.025
         {
-            _shipFoamInfo.frontEmitter[2]->EnableEmit(false);
+            if (emitter)
+                emitter->enableEmit(false);
             _shipFoamInfo.doSplash = false;
         }
         else
         {
-            _shipFoamInfo.frontEmitter[2]->EnableEmit(true);
+            if (emitter)
+                emitter->enableEmit(true);
             _shipFoamInfo.doSplash = true;
         }
         oldFrontEmitterPosY = frontEmitterPos.y;
-        auto mtx2 = _shipFoamInfo.shipModel->mtx;
-        mtx2.Pos() = 0.f;
-        const auto a = mtx2 * CVECTOR(0.f, 1.0f, -.15f);
-        _shipFoamInfo.frontEmitter[2]->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, a);
-        _shipFoamInfo.frontEmitter[2]->Realize(_dTime);
+        if (emitter)
+        {
+            auto mtx2 = _shipFoamInfo.shipModel->mtx;
+            mtx2.Pos() = 0.f;
+            const auto a = mtx2 * CVECTOR(0.f, 1.0f, -.15f);
+            emitter->SetEmitter(_shipFoamInfo.shipModel->mtx * frontEmitterPos, a);
+            emitter->realize(_dTime, *psBatch);
+        }
     }
 
     if (soundService && (_shipFoamInfo.doSplash))
@@ -506,6 +546,7 @@ void SEAFOAM::Realize(uint32_t _dTime)
             continue;
         RealizeShipFoam_Particles(*foamInfo, _dTime);
     }
+    psBatch->flush();
 
     static CMatrix wMatrix;
     renderer->SetTransform(D3DTS_WORLD, static_cast<D3DMATRIX *>(wMatrix));
@@ -5,11 +5,16 @@
 #include "v_sound_service.h"
 #include "dx9render.h"
 #include "geos.h"
+#include "hull_contour.h"
+#include "ini_particle_emitter.h"
 #include "model.h"
 #include "sea_base.h"
-#include "seafoam_ps.h"
 #include "ship_base.h"
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 ///////////////////////////////////////////////////////////////////
 // CLASS DEFINITION
 ///////////////////////////////////////////////////////////////////
@@ -28,7 +33,7 @@ struct tShipFoamInfo
     GEOS::INFO hullInfo;
     SHIP_BASE *ship;
     TCarcass *carcass[2];
-    SEAFOAM_PS *frontEmitter[3];
+    storm::IniParticleEmitter *frontEmitter[3];
     MODEL *shipModel;
     TSD_ID sound;
     bool doSplash;
@@ -70,10 +75,12 @@ class SEAFOAM : public Entity
     void ReleaseShipFoam();
     void RealizeShipFoam_Particles(tShipFoamInfo &_shipFoamInfo, uint32_t dTime);
     void RealizeShipFoam_Mesh(tShipFoamInfo &_shipFoamInfo, uint32_t dTime);
-    void CreateTracePoints(tShipFoamInfo *_shipFoamInfo);
+    storm::HullContourCache::Source CollectHull(MODEL *model, storm::TraceMesh &mesh);
+    void CreateTracePoints(tShipFoamInfo *_shipFoamInfo, const storm::HullContour &contour);
     void InterpolateLeftParticle(tShipFoamInfo &_shipFoamInfo, int z, uint32_t dTime);
     void InterpolateRightParticle(tShipFoamInfo &_shipFoamInfo, int z, uint32_t dTime);
-    void AddShip(entid_t pShipEID);
+    void AddShip(entid_t pShipEID, const storm::HullContour &contour);
+    storm::IniParticleEmitter *CreateEmitter(const char *psname);
 
     VDX9RENDER *renderer;
     entid_t seaID;
@@ -81,6 +88,10 @@ class SEAFOAM : public Entity
     tShipFoamInfo shipFoamInfo[MAX_SHIPS]{};
     int shipsCount;
     std::unique_ptr<INIFILE> psIni;
+    // particles.ini sections shared by the emitters of all ships
+    std::unordered_map<std::string, std::shared_ptr<const storm::IniParticleParams>> psParams;
+    std::unique_ptr<storm::IniParticleBatch> psBatch;
+    storm::HullContourCache hullContours;
     int32_t carcassTexture;
     bool isStorm;
     VSoundService *soundService;
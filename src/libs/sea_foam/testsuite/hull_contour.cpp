@@ -0,0 +1,196 @@
+#include "hull_contour.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// A closed hull like box with a pointed bow and a narrowing bottom, so the traces hit slanted faces, faces out as
+// the faces of ship models
+void BuildHull(storm::TraceMesh &mesh, float width, float height, float length)
+{
+    constexpr int32_t kSections = 16;
+    const auto section = [&](int32_t i, CVECTOR *ring) {
+        const auto z = -length / 2.0f + length * static_cast<float>(i) / kSections;
+        // the bow closes to a point
+        const auto bow = z > length / 4.0f ? 1.0f - (z - length / 4.0f) / (length / 4.0f) : 1.0f;
+        const auto half = std::max(0.01f, width / 2.0f * bow);
+        ring[0] = CVECTOR(-half, height / 2.0f, z);
+        ring[1] = CVECTOR(half, height / 2.0f, z);
+        ring[2] = CVECTOR(half * 0.4f, -height / 2.0f, z);
+        ring[3] = CVECTOR(-half * 0.4f, -height / 2.0f, z);
+    };
+
+    CVECTOR prev[4], cur[4];
+    section(0, prev);
+    mesh.addPolygon(prev, 4);
+    for (int32_t i = 1; i <= kSections; i++)
+    {
+        section(i, cur);
+        for (int32_t k = 0; k < 4; k++)
+        {
+            const auto n = (k + 1) % 4;
+            mesh.addTriangle(prev[k], cur[n], prev[n]);
+            mesh.addTriangle(prev[k], cur[k], cur[n]);
+        }
+        std::copy(cur, cur + 4, prev);
+    }
+    std::reverse(prev, prev + 4);
+    mesh.addPolygon(prev, 4);
+}
+
+storm::HullContourCache::Source MakeSource(storm::TraceMesh &mesh, float width, float height, float length)
+{
+    BuildHull(mesh, width, height, length);
+    return {&mesh, CVECTOR(0.0f, 0.0f, 0.0f), CVECTOR(width, height, length)};
+}
+
+storm::HullContour Fresh(const storm::HullContourCache::Source &source)
+{
+    storm::TraceMesh mesh;
+    BuildHull(mesh, source.boxSize.x, source.boxSize.y, source.boxSize.z);
+    mesh.build();
+    return storm::TraceHullContour(mesh, source.boxCenter, source.boxSize);
+}
+
+void RequireEqual(const storm::HullContour &a, const storm::HullContour &b)
+{
+    for (int32_t side = 0; side < 2; side++)
+        for (int32_t z = 0; z < storm::HullContour::kStepsZ; z++)
+            for (int32_t y = 0; y < storm::HullContour::kStepsY; y++)
+            {
+                const auto &va = a.center[side][z][y];
+                const auto &vb = b.center[side][z][y];
+                REQUIRE(va.x == vb.x);
+                REQUIRE(va.y == vb.y);
+                REQUIRE(va.z == vb.z);
+            }
+}
+
+// Files kept in memory, as the storage SEAFOAM gives the cache keeps them on disk
+struct MemoryStorage
+{
+    storm::HullContourCache::Storage storage()
+    {
+        return {[this](const std::string &name, void *data, size_t size) {
+                    const auto file = files.find(name);
+                    if (file == files.end() || file->second.size() != size)
+                        return false;
+                    std::memcpy(data, file->second.data(), size);
+                    return true;
+                },
+                [this](const std::string &name, const void *data, size_t size) {
+                    const auto *bytes = static_cast<const char *>(data);
+                    files[name].assign(bytes, bytes + size);
+                }};
+    }
+
+    std::map<std::string, std::vector<char>> files;
+};
+
+} // namespace
+
+TEST_CASE("Hull contour traces the hull sides", "[sea_foam]")
+{
+    storm::TraceMesh mesh;
+    const auto source = MakeSource(mesh, 8.0f, 6.0f, 40.0f);
+    mesh.build();
+    const auto contour = storm::TraceHullContour(mesh, source.boxCenter, source.boxSize);
+
+    // the traces start at the stem and reach the full beam further aft
+    CHECK(contour.center[0][0][0].x == Approx(-0.01f).margin(1e-3f));
+    CHECK(contour.center[1][0][0].x == Approx(0.01f).margin(1e-3f));
+    // the traces start on the beam, and as with GEOM a face at the start of a trace is not hit, so the beam is checked
+    // below the deck, where the sides narrow
+    const auto &aft = contour.center[0][storm::HullContour::kStepsZ - 1][1];
+    const auto beam = 4.0f * (0.4f + 0.6f * (aft.y + 3.0f) / 6.0f);
+    CHECK(aft.x == Approx(-beam).margin(1e-3f));
+    CHECK(contour.center[1][storm::HullContour::kStepsZ - 1][1].x == Approx(beam).margin(1e-3f));
+    for (int32_t z = 0; z < storm::HullContour::kStepsZ; z++)
+        for (int32_t y = 0; y < storm::HullContour::kStepsY; y++)
+        {
+            CHECK(contour.center[0][z][y].x <= 0.0f);
+            CHECK(contour.center[1][z][y].x >= 0.0f);
+        }
+}
+
+TEST_CASE("Cached hull contours match fresh traces", "[sea_foam]")
+{
+    MemoryStorage storage;
+
+    storm::TraceMesh mesh, sameMesh;
+    const auto source = MakeSource(mesh, 8.0f, 6.0f, 40.0f);
+    const auto sameSource = MakeSource(sameMesh, 8.0f, 6.0f, 40.0f);
+    const auto fresh = Fresh(source);
+
+    storm::HullContourCache cache(storage.storage());
+    const auto contour = cache.get(source);
+    RequireEqual(*contour, fresh);
+
+    SECTION("ships of one model share the contour")
+    {
+        REQUIRE(storm::HullContourCache::key(source) == storm::HullContourCache::key(sameSource));
+        CHECK(cache.get(sameSource) == contour);
+        CHECK(cache.size() == 1);
+    }
+
+    SECTION("contours are loaded from the storage")
+    {
+        REQUIRE(storage.files.size() == 1);
+        storm::HullContourCache other(storage.storage());
+        storm::TraceMesh unbuilt;
+        const auto loaded = other.get(MakeSource(unbuilt, 8.0f, 6.0f, 40.0f));
+        RequireEqual(*loaded, fresh);
+    }
+
+    SECTION("damaged files are traced again")
+    {
+        auto &file = storage.files.begin()->second;
+        const auto size = file.size();
+        file.resize(size - 1);
+        storm::HullContourCache other(storage.storage());
+        storm::TraceMesh rebuilt;
+        RequireEqual(*other.get(MakeSource(rebuilt, 8.0f, 6.0f, 40.0f)), fresh);
+        // and saved over the damaged file
+        CHECK(storage.files.size() == 1);
+        CHECK(file.size() == size);
+    }
+
+    SECTION("other boxes are other contours")
+    {
+        storm::TraceMesh otherMesh;
+        auto otherSource = MakeSource(otherMesh, 8.0f, 6.0f, 40.0f);
+        otherSource.boxSize.y = 5.0f;
+        CHECK(storm::HullContourCache::key(otherSource) != storm::HullContourCache::key(source));
+        CHECK(cache.get(otherSource) != contour);
+    }
+}
+
+TEST_CASE("Hull contours of several ships are traced in parallel", "[sea_foam]")
+{
+    constexpr int32_t kHulls = 6;
+    std::vector<storm::TraceMesh> meshes(kHulls + 2);
+    std::vector<storm::HullContourCache::Source> sources;
+    for (int32_t i = 0; i < kHulls; i++)
+        sources.push_back(MakeSource(meshes[i], 6.0f + i, 5.0f + 0.5f * i, 30.0f + 4.0f * i));
+    // two more ships of the first models
+    sources.push_back(MakeSource(meshes[kHulls], 6.0f, 5.0f, 30.0f));
+    sources.push_back(MakeSource(meshes[kHulls + 1], 7.0f, 5.5f, 34.0f));
+
+    storm::HullContourCache cache;
+    const auto contours = cache.get(sources, 4);
+    REQUIRE(contours.size() == sources.size());
+    CHECK(cache.size() == kHulls);
+    CHECK(contours[kHulls] == contours[0]);
+    CHECK(contours[kHulls + 1] == contours[1]);
+    for (size_t i = 0; i < sources.size(); i++)
+        RequireEqual(*contours[i], Fresh(sources[i]));
+}
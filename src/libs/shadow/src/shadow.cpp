@@ -49,6 +49,7 @@ bool Shadow::Init()
     col = static_cast<COLLIDE *>(core.GetService("coll"));
     if (col == nullptr)
         throw std::runtime_error("No service: COLLIDE");
+    casters = core.GetLayerSnapshot(SHADOW);
 
     core.AddToLayer(REALIZE, GetId(), 900);
 
@@ -193,7 +194,8 @@ void Shadow::Realize(uint32_t Delta_Time)
     rs->GetTransform(D3DTS_PROJECTION, visPoj);
     FindPlanes(visView, visPoj);
 
-    const auto its = core.GetEntityIds(SHADOW);
+    casters.update();
+    const auto &its = casters.ids();
 
     CVECTOR hdest = headPos + !(headPos - light_pos) * 100.0f;
     float ray = col->Trace(its, headPos, hdest, nullptr, 0);
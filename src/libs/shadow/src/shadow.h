@@ -2,6 +2,7 @@
 
 #include "collide.h"
 #include "dx9render.h"
+#include "entity_layer.h"
 #include "model.h"
 #include "vma.hpp"
 
@@ -9,6 +10,8 @@ class Shadow : public Entity
 {
     VDX9RENDER *rs;
     COLLIDE *col;
+    // what the shadow falls on
+    storm::LayerSnapshot casters;
     void FindPlanes(const CMatrix &view, const CMatrix &proj);
     PLANE planes[6];
     entid_t entity;
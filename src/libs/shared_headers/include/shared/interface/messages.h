@@ -49,6 +49,7 @@
 #define MSG_INTERFACE_LOADPICTUREFROMSAVE 45059
 #define MSG_INTERFACE_GETPICTUREFROMPICTURE 45060
 #define MSG_INTERFACE_SET_TOOLTIP 45061
+#define MSG_INTERFACE_GET_RENDER_STATS 45062
 
 #define MSG_STRSERVICE_OPEN_FILE 45100
 #define MSG_STRSERVICE_CLOSE_FILE 45101
@@ -38,6 +38,7 @@
 #define SHIP_HULL_DAMAGE "ShpHullDamage"
 #define SHIP_SAIL_DAMAGE "ShpSailDamage"
 #define SHIP_HULL_HIT "Shp_HullHit"
+#define SHIP_HITS "Shp_Hits"
 #define SHIP_SHIP2ISLAND_COLLISION "Shp_ShipIslColl"
 #define SHIP_SHIP2SHIP_COLLISION "Shp_Ship2ShipColl"
 #define SHIP_GET_CURRENT_BALLS_NUM "Shp_GetCurBallsNum"
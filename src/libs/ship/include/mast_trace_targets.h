@@ -0,0 +1,52 @@
+#pragma once
+
+#include "c_vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief What the masts of the ships may hit in a frame, bounding spheres sorted along the x axis
+ *
+ * A mast segment gets only the targets whose spheres it passes through, in the order they were added, so traces of
+ * them find the same first hit as traces of the whole layer. Targets without bounds are always found.
+ */
+class MastTraceTargets final
+{
+  public:
+    void clear();
+    // the index is what find returns for the target
+    void add(uint32_t index, const CVECTOR &center, float radius);
+    void addUnbounded(uint32_t index);
+    // sorts the targets, to be called after the last add
+    void build();
+
+    // indices of the targets the segment may touch, in the order of adding
+    void find(const CVECTOR &src, const CVECTOR &dst, std::vector<uint32_t> &indices) const;
+
+    [[nodiscard]] size_t size() const
+    {
+        return targets_.size() + unbounded_.size();
+    }
+
+  private:
+    struct Target
+    {
+        CVECTOR center;
+        float radius;
+        // place in the order of adding
+        uint32_t order;
+        uint32_t index;
+    };
+
+    std::vector<Target> targets_;
+    std::vector<Target> unbounded_;
+    float maxRadius_ = 0.0f;
+    uint32_t added_ = 0;
+    mutable std::vector<const Target *> found_;
+};
+
+} // namespace storm
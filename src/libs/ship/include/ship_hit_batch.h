@@ -0,0 +1,101 @@
+#pragma once
+
+#include "attributes.h"
+#include "c_vector.h"
+#include "cannon_trace.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Cannon ball hits of a ship in a frame, for the scripts to take at once
+ *
+ * The hits of the hull are listed as they came and totalled per owner, ball and cannon type. The hits of a mast or of
+ * a hull part are counted for it with the first of them, the scripts write its new damage back to its node.
+ */
+class ShipHitBatch final
+{
+  public:
+    struct Hit
+    {
+        CANNON_BALL ball;
+        CVECTOR pos;
+        // the nearest fire place not burning, -1 if there is none
+        int32_t firePlace;
+        float firePlaceDistance;
+    };
+
+    struct Total
+    {
+        int32_t owner;
+        uint32_t ballType;
+        uint32_t cannonType;
+        uint32_t count;
+        // of the hits, on average
+        float distance;
+    };
+
+    struct PartHit
+    {
+        // index of the part in the ship
+        int32_t part;
+        // what the scripts know the part by
+        int32_t number;
+        std::string name;
+        uint32_t count;
+        // the first hit
+        CANNON_BALL ball;
+        CVECTOR pos;
+        // of the part before the hits
+        float damage;
+    };
+
+    void hull(const CANNON_BALL &ball, const CVECTOR &pos, int32_t firePlace, float firePlaceDistance);
+    void mast(int32_t part, int32_t number, float damage, const CANNON_BALL &ball, const CVECTOR &pos);
+    void hullPart(int32_t part, int32_t number, const char *name, float damage, const CANNON_BALL &ball,
+                  const CVECTOR &pos);
+
+    void clear();
+
+    [[nodiscard]] bool empty() const
+    {
+        return hits_.empty() && masts_.empty() && hullParts_.empty();
+    }
+
+    [[nodiscard]] const std::vector<Hit> &hits() const
+    {
+        return hits_;
+    }
+
+    [[nodiscard]] const std::vector<PartHit> &masts() const
+    {
+        return masts_;
+    }
+
+    [[nodiscard]] const std::vector<PartHit> &hullParts() const
+    {
+        return hullParts_;
+    }
+
+    [[nodiscard]] std::vector<Total> totals() const;
+
+    // replaces what the node holds: count, hits.h<n>, totals.t<n>, masts.m<n> and hulls.h<n>
+    void write(ATTRIBUTES &node) const;
+
+    // the damage the scripts wrote back to the mast or hull part, as it was if they wrote nothing
+    static float damage(ATTRIBUTES &node, const char *group, size_t index, float damage);
+
+  private:
+    static void addPart(std::vector<PartHit> &parts, int32_t part, int32_t number, const char *name, float damage,
+                        const CANNON_BALL &ball, const CVECTOR &pos);
+
+    std::vector<Hit> hits_;
+    std::vector<PartHit> masts_;
+    std::vector<PartHit> hullParts_;
+};
+
+} // namespace storm
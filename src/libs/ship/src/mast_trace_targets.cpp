@@ -0,0 +1,61 @@
+#include "mast_trace_targets.h"
+
+#include <algorithm>
+
+namespace storm
+{
+
+void MastTraceTargets::clear()
+{
+    targets_.clear();
+    unbounded_.clear();
+    maxRadius_ = 0.0f;
+    added_ = 0;
+}
+
+void MastTraceTargets::add(uint32_t index, const CVECTOR &center, float radius)
+{
+    targets_.push_back({center, radius, added_++, index});
+    maxRadius_ = std::max(maxRadius_, radius);
+}
+
+void MastTraceTargets::addUnbounded(uint32_t index)
+{
+    unbounded_.push_back({CVECTOR(0.0f, 0.0f, 0.0f), 0.0f, added_++, index});
+}
+
+void MastTraceTargets::build()
+{
+    std::sort(targets_.begin(), targets_.end(),
+              [](const Target &a, const Target &b) { return a.center.x < b.center.x; });
+}
+
+void MastTraceTargets::find(const CVECTOR &src, const CVECTOR &dst, std::vector<uint32_t> &indices) const
+{
+    indices.clear();
+    found_.clear();
+
+    const auto minX = std::min(src.x, dst.x) - maxRadius_;
+    const auto maxX = std::max(src.x, dst.x) + maxRadius_;
+    auto it = std::lower_bound(targets_.begin(), targets_.end(), minX,
+                               [](const Target &target, float x) { return target.center.x < x; });
+
+    const auto dir = dst - src;
+    const auto len2 = ~dir;
+    for (; it != targets_.end() && it->center.x <= maxX; ++it)
+    {
+        // the nearest point of the segment to the center
+        auto t = len2 > 0.0f ? ((it->center - src) | dir) / len2 : 0.0f;
+        t = std::clamp(t, 0.0f, 1.0f);
+        if (~(src + dir * t - it->center) <= it->radius * it->radius)
+            found_.push_back(&*it);
+    }
+    for (const auto &target : unbounded_)
+        found_.push_back(&target);
+
+    std::sort(found_.begin(), found_.end(), [](const Target *a, const Target *b) { return a->order < b->order; });
+    for (const auto *target : found_)
+        indices.push_back(target->index);
+}
+
+} // namespace storm
@@ -1,5 +1,6 @@
 #include "ship.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include "ai_flow_graph.h"
@@ -791,6 +792,13 @@ void SHIP::Execute(uint32_t DeltaTime)
     // activate mast tracer
     if (dtMastTrace.Update(fDeltaTime))
     {
+        if (!bMastTargets)
+        {
+            bMastTargets = true;
+            MastShipTargets.Gather(core.GetEntityIds(MAST_SHIP_TRACE));
+            MastIslandTargets.Gather(core.GetEntityIds(MAST_ISLAND_TRACE));
+        }
+
         for (int32_t i = 0; i < iNumMasts; i++)
             if (!pMasts[i].bBroken)
             {
@@ -802,12 +810,12 @@ void SHIP::Execute(uint32_t DeltaTime)
                 v1 = matrix * pM->vSrc;
                 v2 = matrix * pM->vDst;
 
-                auto id = GetId();
-                fShipRes = pCollide->Trace(core.GetEntityIds(MAST_SHIP_TRACE), v1, v2, &id, 1);
+                entid_t hit;
+                fShipRes = MastShipTargets.Trace(v1, v2, GetId(), &hit);
                 if (fShipRes <= 1.0f)
                 {
                     auto *pACollideCharacter = GetACharacter();
-                    auto *pShip = static_cast<SHIP *>(core.GetEntityPointer(pCollide->GetObjectID()));
+                    auto *pShip = static_cast<SHIP *>(core.GetEntityPointer(hit));
                     if (pShip)
                         pACollideCharacter = pShip->GetACharacter();
                     pV = core.Event(SHIP_MAST_DAMAGE, "llffffaa", SHIP_MAST_TOUCH_SHIP, pM->iMastNum, v1.x, v1.y, v1.z,
@@ -817,8 +825,7 @@ void SHIP::Execute(uint32_t DeltaTime)
                     }
                 }
 
-                id = GetModelEID();
-                fIslRes = pCollide->Trace(core.GetEntityIds(MAST_ISLAND_TRACE), v1, v2, &id, 1);
+                fIslRes = MastIslandTargets.Trace(v1, v2, GetModelEID(), &hit);
                 if (fIslRes <= 1.0f)
                 {
                     pV = core.Event(SHIP_MAST_DAMAGE, "llffffa", SHIP_MAST_TOUCH_ISLAND, pM->iMastNum, v1.x, v1.y, v1.z,
@@ -922,6 +929,87 @@ void SHIP::Execute(uint32_t DeltaTime)
     }
 }
 
+namespace
+{
+
+// ships move after their bounds are taken, by less than that in a frame
+constexpr float kMastTargetMargin = 5.0f;
+
+void AddNodeBounds(NODE *pNode, CVECTOR &vMin, CVECTOR &vMax)
+{
+    if (!pNode)
+        return;
+    if (pNode->geo)
+    {
+        GEOS::INFO gi;
+        pNode->geo->GetInfo(gi);
+        const auto vCenter = pNode->glob_mtx * CVECTOR(gi.boxcenter.x, gi.boxcenter.y, gi.boxcenter.z);
+        vMin.x = std::min(vMin.x, vCenter.x - gi.radius);
+        vMin.y = std::min(vMin.y, vCenter.y - gi.radius);
+        vMin.z = std::min(vMin.z, vCenter.z - gi.radius);
+        vMax.x = std::max(vMax.x, vCenter.x + gi.radius);
+        vMax.y = std::max(vMax.y, vCenter.y + gi.radius);
+        vMax.z = std::max(vMax.z, vCenter.z + gi.radius);
+    }
+    for (auto *pNext : pNode->next)
+        AddNodeBounds(pNext, vMin, vMax);
+}
+
+// the model a mast trace goes through, ships trace their models
+MODEL *GetTraceModel(Entity *pEntity)
+{
+    if (auto *pModel = dynamic_cast<MODEL *>(pEntity))
+        return pModel;
+    if (auto *pShip = dynamic_cast<SHIP_BASE *>(pEntity))
+        return pShip->GetModel();
+    return nullptr;
+}
+
+} // namespace
+
+void SHIP::MAST_TARGETS::Gather(entity_container_cref entities)
+{
+    Targets.clear();
+    aIDs.assign(entities.begin(), entities.end());
+    for (uint32_t i = 0; i < aIDs.size(); i++)
+    {
+        auto *pModel = GetTraceModel(static_cast<Entity *>(core.GetEntityPointer(aIDs[i])));
+        auto *pRoot = pModel ? pModel->GetNode(0) : nullptr;
+        if (!pRoot)
+        {
+            Targets.addUnbounded(i);
+            continue;
+        }
+
+        CVECTOR vMin(1e10f, 1e10f, 1e10f), vMax(-1e10f, -1e10f, -1e10f);
+        AddNodeBounds(pRoot, vMin, vMax);
+        if (vMin.x > vMax.x)
+            continue;
+        Targets.add(i, (vMin + vMax) * 0.5f, sqrtf(~(vMax - vMin)) * 0.5f + kMastTargetMargin);
+    }
+    Targets.build();
+}
+
+float SHIP::MAST_TARGETS::Trace(const CVECTOR &v1, const CVECTOR &v2, entid_t exclude, entid_t *pHit)
+{
+    // as COLLIDE::Trace of the whole layer, the first of the nearest hits
+    auto fBest = 2.0f;
+    *pHit = invalid_entity;
+    Targets.find(v1, v2, aFound);
+    for (const auto i : aFound)
+    {
+        if (aIDs[i] == exclude)
+            continue;
+        const auto fRes = pCollide->Trace(aIDs[i], v1, v2);
+        if (fRes < fBest)
+        {
+            fBest = fRes;
+            *pHit = aIDs[i];
+        }
+    }
+    return fBest;
+}
+
 /*
 void SHIP::MastFall(mast_t* pM) {
   if (pM && pM->pNode && pM->fDamage >= 1.0f) {
@@ -1105,6 +1193,9 @@ void SHIP::RestoreLightAndFog()
 
 void SHIP::Realize(uint32_t dtime)
 {
+    // ships move before the masts of the next frame are traced
+    bMastTargets = false;
+
     if (!bMounted)
         return;
 
@@ -1434,6 +1525,14 @@ bool SHIP::Mount(ATTRIBUTES *_pAShip)
         InitSailState();
     }
 
+    // the model files are read on other threads while the scripts prepare the ship
+    char temp_str[1024];
+    if (const char *pName = GetAShip()->GetAttribute("Name"))
+    {
+        sprintf_s(temp_str, "ships\\%s\\%s", pName, pName);
+        pGS->PrefetchGeometry(temp_str);
+    }
+
     core.Event("Ship_StartLoad", "a", GetACharacter());
     core.Event(SEA_GET_LAYERS, "i", GetId());
 
@@ -1471,7 +1570,6 @@ bool SHIP::Mount(ATTRIBUTES *_pAShip)
     RecalculateWorldOffset();
     bUse = uniIDX == 0;
 
-    char temp_str[1024];
     sprintf_s(temp_str, "ships\\%s\\%s", cShipIniName, cShipIniName);
 
     model_id = core.CreateEntity("MODELR");
@@ -1777,6 +1875,16 @@ float SHIP::Trace(const CVECTOR &src, const CVECTOR &dst)
 };
 
 float SHIP::Cannon_Trace(int32_t iBallOwner, const CVECTOR &vSrc, const CVECTOR &vDst)
+{
+    return TraceBall(iBallOwner, nullptr, vSrc, vDst);
+}
+
+float SHIP::Cannon_CollectTrace(const CANNON_BALL &ball, const CVECTOR &vSrc, const CVECTOR &vDst)
+{
+    return TraceBall(ball.iOwner, &ball, vSrc, vDst);
+}
+
+float SHIP::TraceBall(int32_t iBallOwner, const CANNON_BALL *pBall, const CVECTOR &vSrc, const CVECTOR &vDst)
 {
     MODEL *pModel = GetModel();
     Assert(pModel);
@@ -1794,6 +1902,11 @@ float SHIP::Cannon_Trace(int32_t iBallOwner, const CVECTOR &vSrc, const CVECTOR
             if (fRes <= 1.0f)
             {
                 const CVECTOR v1 = vSrc + fRes * (vDst - vSrc);
+                if (pBall)
+                {
+                    Hits.mast(i, pM->iMastNum, pM->fDamage, *pBall, v1);
+                    continue;
+                }
                 VDATA *pV = core.Event(SHIP_MAST_DAMAGE, "llffffal", SHIP_MAST_TOUCH_BALL, pM->iMastNum, v1.x, v1.y,
                                        v1.z, pM->fDamage, GetACharacter(), iBallOwner);
                 pM->fDamage = Clamp(pV->GetFloat());
@@ -1812,6 +1925,11 @@ float SHIP::Cannon_Trace(int32_t iBallOwner, const CVECTOR &vSrc, const CVECTOR
                 if (fRes <= 1.0f)
                 {
                     const CVECTOR v1 = vSrc + fRes * (vDst - vSrc);
+                    if (pBall)
+                    {
+                        Hits.hullPart(i, pM->iHullNum, pM->pNode->GetName(), pM->fDamage, *pBall, v1);
+                        continue;
+                    }
 
                     VDATA *pV = core.Event(SHIP_HULL_DAMAGE, "llffffas", SHIP_HULL_TOUCH_BALL, pM->iHullNum, v1.x, v1.y,
                                            v1.z, pM->fDamage, GetACharacter(), pM->pNode->GetName());
@@ -1846,13 +1964,50 @@ float SHIP::Cannon_Trace(int32_t iBallOwner, const CVECTOR &vSrc, const CVECTOR
                     iBestIndex = i;
                 }
             }
-        core.Event(SHIP_HULL_HIT, "illffflf", GetId(), iBallOwner, iOurIndex, vTemp.x, vTemp.y, vTemp.z, iBestIndex,
-                   fMinDistance);
+        if (pBall)
+            Hits.hull(*pBall, vTemp, iBestIndex, fMinDistance);
+        else
+            core.Event(SHIP_HULL_HIT, "illffflf", GetId(), iBallOwner, iOurIndex, vTemp.x, vTemp.y, vTemp.z,
+                       iBestIndex, fMinDistance);
         core.Send_Message(blots_id, "lffffff", MSG_BLOTS_HIT, vTemp.x, vTemp.y, vTemp.z, vDir.x, vDir.y, vDir.z);
     }
     return fRes;
 }
 
+void SHIP::Cannon_SendHits()
+{
+    if (Hits.empty())
+        return;
+
+    // the scripts take the hits of the frame from Ship.Hits of the character, the node is gone after the event
+    ATTRIBUTES *pACharacter = GetACharacter();
+    ATTRIBUTES *pAHits = pACharacter->CreateSubAClass(pACharacter, "Ship.Hits");
+    Hits.write(*pAHits);
+    core.Event(SHIP_HITS, "ialla", GetId(), pACharacter, GetIndex(pACharacter),
+               static_cast<int32_t>(Hits.hits().size()), pAHits);
+
+    // the scripts wrote the new damage of the masts and hull parts back, if they kept the node
+    pAHits = pACharacter->FindAClass(pACharacter, "Ship.Hits");
+    for (size_t i = 0; i < Hits.masts().size(); i++)
+    {
+        mast_t *pM = &pMasts[Hits.masts()[i].part];
+        if (pAHits)
+            pM->fDamage = Clamp(storm::ShipHitBatch::damage(*pAHits, "masts", i, pM->fDamage));
+        MastFall(pM);
+    }
+    for (size_t i = 0; i < Hits.hullParts().size(); i++)
+    {
+        hull_t *pM = &pHulls[Hits.hullParts()[i].part];
+        if (pAHits)
+            pM->fDamage = Clamp(storm::ShipHitBatch::damage(*pAHits, "hulls", i, pM->fDamage));
+        HullFall(pM);
+    }
+
+    if (pAHits)
+        pACharacter->FindAClass(pACharacter, "Ship")->DeleteAttributeClassX(pAHits);
+    Hits.clear();
+}
+
 uint32_t SHIP::AttributeChanged(ATTRIBUTES *pAttribute)
 {
     return 0;
@@ -9,10 +9,12 @@
 #include "fire_place.h"
 #include "geometry.h"
 #include "island_base.h"
+#include "mast_trace_targets.h"
 #include "model.h"
 #include "save_load.h"
 #include "sea_base.h"
 #include "ship_base.h"
+#include "ship_hit_batch.h"
 #include "ship_msg.h"
 
 #define DELTA_TIME(x) ((x)*0.001f)
@@ -81,6 +83,19 @@ class SHIP : public SHIP_BASE
     static COLLIDE *pCollide;
     static VGEOMETRY *pGS;
 
+    // what the masts of all ships may hit, gathered by the first ship tracing its masts in a frame
+    struct MAST_TARGETS
+    {
+        storm::MastTraceTargets Targets;
+        std::vector<entid_t> aIDs;
+        std::vector<uint32_t> aFound;
+
+        void Gather(entity_container_cref entities);
+        float Trace(const CVECTOR &v1, const CVECTOR &v2, entid_t exclude, entid_t *pHit);
+    };
+    inline static MAST_TARGETS MastShipTargets, MastIslandTargets;
+    inline static bool bMastTargets = false;
+
     CMatrix mRoot;
     CVECTOR vSpeed, vSpeedsA;
     float fMinusVolume;
@@ -141,6 +156,10 @@ class SHIP : public SHIP_BASE
     void CheckShip2Strand(float fDeltaTime);
     void MastFall(mast_t *pM);
     void HullFall(hull_t *pM);
+
+    // ball hits of the frame when AIBalls collects them, sent by Cannon_SendHits
+    storm::ShipHitBatch Hits;
+    float TraceBall(int32_t iBallOwner, const CANNON_BALL *pBall, const CVECTOR &vSrc, const CVECTOR &vDst);
     void FakeFire(const char *sBort, float fRandTime);
 
     CMatrix UpdateModelMatrix();
@@ -230,6 +249,8 @@ class SHIP : public SHIP_BASE
 
     // inherit functions CANNON_TRACE_BASE
     float Cannon_Trace(int32_t iBallOwner, const CVECTOR &src, const CVECTOR &dst) override;
+    float Cannon_CollectTrace(const CANNON_BALL &ball, const CVECTOR &src, const CVECTOR &dst) override;
+    void Cannon_SendHits() override;
 
     // inherit functions VAI_OBJBASE
     void SetACharacter(ATTRIBUTES *pAP) override;
@@ -0,0 +1,141 @@
+#include "ship_hit_batch.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace storm
+{
+
+namespace
+{
+void writeBall(ATTRIBUTES &node, const CANNON_BALL &ball, const CVECTOR &pos)
+{
+    node.SetAttributeUseFloat("x", pos.x);
+    node.SetAttributeUseFloat("y", pos.y);
+    node.SetAttributeUseFloat("z", pos.z);
+    node.SetAttributeUseDword("owner", static_cast<uint32_t>(ball.iOwner));
+    node.SetAttributeUseDword("ball", ball.dwGoodIndex);
+    node.SetAttributeUseDword("cannon", ball.dwCannonType);
+    node.SetAttributeUseFloat("distance", ball.fDistance);
+}
+
+void writeParts(ATTRIBUTES &node, const char *group, const char *prefix, const char *number,
+                const std::vector<ShipHitBatch::PartHit> &parts)
+{
+    if (parts.empty())
+        return;
+    auto &list = node.CreateAttribute(group);
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        const auto &part = parts[i];
+        auto &item = list.CreateAttribute(prefix + std::to_string(i));
+        writeBall(item, part.ball, part.pos);
+        item.SetAttributeUseDword(number, static_cast<uint32_t>(part.number));
+        if (!part.name.empty())
+            item.SetAttribute("name", part.name);
+        item.SetAttributeUseDword("count", part.count);
+        item.SetAttributeUseFloat("damage", part.damage);
+    }
+}
+} // namespace
+
+void ShipHitBatch::hull(const CANNON_BALL &ball, const CVECTOR &pos, int32_t firePlace, float firePlaceDistance)
+{
+    hits_.push_back({ball, pos, firePlace, firePlaceDistance});
+}
+
+void ShipHitBatch::mast(int32_t part, int32_t number, float damage, const CANNON_BALL &ball, const CVECTOR &pos)
+{
+    addPart(masts_, part, number, nullptr, damage, ball, pos);
+}
+
+void ShipHitBatch::hullPart(int32_t part, int32_t number, const char *name, float damage, const CANNON_BALL &ball,
+                            const CVECTOR &pos)
+{
+    addPart(hullParts_, part, number, name, damage, ball, pos);
+}
+
+void ShipHitBatch::clear()
+{
+    hits_.clear();
+    masts_.clear();
+    hullParts_.clear();
+}
+
+std::vector<ShipHitBatch::Total> ShipHitBatch::totals() const
+{
+    std::vector<Total> totals;
+    for (const auto &hit : hits_)
+    {
+        const auto &ball = hit.ball;
+        auto it = std::find_if(totals.begin(), totals.end(), [&ball](const Total &total) {
+            return std::tie(total.owner, total.ballType, total.cannonType) ==
+                   std::tie(ball.iOwner, ball.dwGoodIndex, ball.dwCannonType);
+        });
+        if (it == totals.end())
+            it = totals.insert(totals.end(), {ball.iOwner, ball.dwGoodIndex, ball.dwCannonType, 0, 0.0f});
+        it->count++;
+        it->distance += ball.fDistance;
+    }
+    for (auto &total : totals)
+        total.distance /= static_cast<float>(total.count);
+    return totals;
+}
+
+void ShipHitBatch::write(ATTRIBUTES &node) const
+{
+    node.DeleteAttributeClassX(&node);
+
+    node.SetAttributeUseDword("count", static_cast<uint32_t>(hits_.size()));
+    if (!hits_.empty())
+    {
+        auto &list = node.CreateAttribute("hits");
+        for (size_t i = 0; i < hits_.size(); i++)
+        {
+            const auto &hit = hits_[i];
+            auto &item = list.CreateAttribute("h" + std::to_string(i));
+            writeBall(item, hit.ball, hit.pos);
+            item.SetAttributeUseDword("fireplace", static_cast<uint32_t>(hit.firePlace));
+            item.SetAttributeUseFloat("fireplacedistance", hit.firePlaceDistance);
+        }
+
+        auto &totalList = node.CreateAttribute("totals");
+        const auto totals = this->totals();
+        for (size_t i = 0; i < totals.size(); i++)
+        {
+            const auto &total = totals[i];
+            auto &item = totalList.CreateAttribute("t" + std::to_string(i));
+            item.SetAttributeUseDword("owner", static_cast<uint32_t>(total.owner));
+            item.SetAttributeUseDword("ball", total.ballType);
+            item.SetAttributeUseDword("cannon", total.cannonType);
+            item.SetAttributeUseDword("count", total.count);
+            item.SetAttributeUseFloat("distance", total.distance);
+        }
+    }
+
+    writeParts(node, "masts", "m", "mast", masts_);
+    writeParts(node, "hulls", "h", "hull", hullParts_);
+}
+
+float ShipHitBatch::damage(ATTRIBUTES &node, const char *group, size_t index, float damage)
+{
+    const auto *list = node.GetAttributeClass(group);
+    if (!list || index >= list->GetAttributesNum())
+        return damage;
+    return list->GetAttributeClass(static_cast<uint32_t>(index))->GetAttributeAsFloat("damage", damage);
+}
+
+void ShipHitBatch::addPart(std::vector<PartHit> &parts, int32_t part, int32_t number, const char *name, float damage,
+                           const CANNON_BALL &ball, const CVECTOR &pos)
+{
+    const auto it =
+        std::find_if(parts.begin(), parts.end(), [part](const PartHit &partHit) { return partHit.part == part; });
+    if (it != parts.end())
+    {
+        it->count++;
+        return;
+    }
+    parts.push_back({part, number, name ? name : "", 1, ball, pos, damage});
+}
+
+} // namespace storm
@@ -47,6 +47,8 @@ bool ShipLights::Init()
     pCollide = static_cast<COLLIDE *>(core.GetService("coll"));
     Assert(pCollide);
     pSea = static_cast<SEA_BASE *>(core.GetEntityPointer(core.GetEntityId("sea")));
+    SailsTrace = core.GetLayerSnapshot(SAILS_TRACE);
+    SunTrace = core.GetLayerSnapshot(SUN_TRACE);
     return true;
 }
 
@@ -470,6 +472,9 @@ void ShipLights::Execute(uint32_t dwDeltaTime)
     CVECTOR vCamPos, vCamAng;
     pRS->GetCamera(vCamPos, vCamAng, fFov);
 
+    SailsTrace.update();
+    SunTrace.update();
+
     for (uint32_t i = 0; i < aLights.size(); i++)
     {
         ShipLight &L = aLights[i];
@@ -511,18 +516,16 @@ void ShipLights::Execute(uint32_t dwDeltaTime)
         {
             L.bVisible = true;
 
-            float fDistance =
-                pCollide->Trace(core.GetEntityIds(SAILS_TRACE), L.vCurPos, vCamPos, nullptr, 0);
+            float fDistance = pCollide->Trace(SailsTrace.ids(), L.vCurPos, vCamPos, nullptr, 0);
             L.fFlareAlphaMax = (fDistance >= 1.0f) ? 1.0f : 0.2f;
 
-            const auto its = core.GetEntityIds(SUN_TRACE);
-            fDistance = pCollide->Trace(its, L.vCurPos, vCamPos, nullptr, 0);
+            fDistance = pCollide->Trace(SunTrace.ids(), L.vCurPos, vCamPos, nullptr, 0);
             const float fLen = fDistance * sqrtf(~(vCamPos - L.vCurPos));
             L.bVisible = fDistance >= 1.0f || (fLen < 0.6f);
 
             if (!L.bOff && !L.bLightOff && L.bVisible)
             {
-                const float fDistance = pCollide->Trace(its, vCamPos, L.vCurPos, nullptr, 0);
+                const float fDistance = pCollide->Trace(SunTrace.ids(), vCamPos, L.vCurPos, nullptr, 0);
                 const float fLen = (1.0f - fDistance) * sqrtf(~(vCamPos - L.vCurPos));
 
                 L.bVisible = fLen < 0.6f;
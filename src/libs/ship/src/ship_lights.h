@@ -2,6 +2,7 @@
 
 #include "collide.h"
 #include "dx9render.h"
+#include "entity_layer.h"
 #include "math_inlines.h"
 #include "sea_base.h"
 #include <ship_lights.h>
@@ -112,6 +113,8 @@ class ShipLights : public IShipLights
     uint32_t dwCoronaSubTexX, dwCoronaSubTexY;
 
     SEA_BASE *pSea;
+    // what the flares are traced against
+    storm::LayerSnapshot SailsTrace, SunTrace;
 
     bool LoadLights();
     LightType *FindLightType(std::string sLightType);
@@ -0,0 +1,192 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "mast_trace_targets.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+struct Sphere
+{
+    CVECTOR center;
+    float radius;
+    // a layer entity the targets can not bound
+    bool bounded = true;
+};
+
+struct Segment
+{
+    CVECTOR src;
+    CVECTOR dst;
+};
+
+bool Touches(const Segment &segment, const Sphere &sphere)
+{
+    const auto dir = segment.dst - segment.src;
+    const auto len2 = ~dir;
+    const auto t = len2 > 0.0f ? std::clamp(((sphere.center - segment.src) | dir) / len2, 0.0f, 1.0f) : 0.0f;
+    return ~(segment.src + dir * t - sphere.center) <= sphere.radius * sphere.radius;
+}
+
+// what every trace of a mast went through: the whole layer in its order
+std::vector<uint32_t> TraceAll(const std::vector<Sphere> &layer, const Segment &segment)
+{
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < layer.size(); i++)
+        if (!layer[i].bounded || Touches(segment, layer[i]))
+            indices.push_back(i);
+    return indices;
+}
+
+storm::MastTraceTargets Gather(const std::vector<Sphere> &layer)
+{
+    storm::MastTraceTargets targets;
+    for (uint32_t i = 0; i < layer.size(); i++)
+        if (layer[i].bounded)
+            targets.add(i, layer[i].center, layer[i].radius);
+        else
+            targets.addUnbounded(i);
+    targets.build();
+    return targets;
+}
+
+// ships in lines abreast, each of its masts from the deck up and leaning a little
+struct Fleet
+{
+    std::vector<Sphere> ships;
+    std::vector<Segment> masts;
+};
+
+Fleet Formation(std::mt19937 &gen, size_t ships, float spacing)
+{
+    std::uniform_real_distribution<float> jitter(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> lean(-0.15f, 0.15f);
+    Fleet fleet;
+    for (size_t s = 0; s < ships; s++)
+    {
+        const CVECTOR pos(static_cast<float>(s % 20) * spacing + jitter(gen), 0.0f,
+                          static_cast<float>(s / 20) * spacing * 3.0f + jitter(gen));
+        fleet.ships.push_back({pos + CVECTOR(0.0f, 15.0f, 0.0f), 30.0f});
+        for (int32_t m = 0; m < 3; m++)
+        {
+            const auto base = pos + CVECTOR(0.0f, 4.0f, -14.0f + 14.0f * m);
+            fleet.masts.push_back({base, base + CVECTOR(lean(gen), 1.0f, lean(gen)) * 30.0f});
+        }
+    }
+    return fleet;
+}
+
+} // namespace
+
+TEST_CASE("Mast trace targets find what the whole layer touches", "[ship]")
+{
+    std::mt19937 gen(96);
+    std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 80.0f);
+    std::uniform_real_distribution<float> offset(-60.0f, 60.0f);
+    std::uniform_int_distribution<int32_t> percent(0, 99);
+
+    std::vector<uint32_t> found;
+    for (const auto count : {0, 1, 7, 60, 300})
+    {
+        std::vector<Sphere> layer;
+        for (int32_t i = 0; i < count; i++)
+            layer.push_back({CVECTOR(pos(gen), pos(gen) * 0.05f, pos(gen)), radius(gen), percent(gen) >= 5});
+        const auto targets = Gather(layer);
+        CHECK(targets.size() == layer.size());
+
+        for (int32_t i = 0; i < 500; i++)
+        {
+            const CVECTOR src(pos(gen), pos(gen) * 0.05f, pos(gen));
+            // masts, points and long segments
+            const auto kind = percent(gen);
+            const auto dst = kind < 10   ? src
+                             : kind < 20 ? CVECTOR(pos(gen), 0.0f, pos(gen))
+                                         : src + CVECTOR(offset(gen), offset(gen), offset(gen));
+            const Segment segment{src, dst};
+            targets.find(segment.src, segment.dst, found);
+            REQUIRE(found == TraceAll(layer, segment));
+        }
+    }
+}
+
+TEST_CASE("Mast trace targets keep the order of the layer", "[ship]")
+{
+    // equal spheres on one spot, added in an order unlike their x
+    std::vector<Sphere> layer;
+    for (int32_t i = 0; i < 10; i++)
+        layer.push_back({CVECTOR(static_cast<float>((i * 7) % 10) * 0.1f, 0.0f, 0.0f), 5.0f, i != 4});
+    auto targets = Gather(layer);
+    std::vector<uint32_t> found;
+    targets.find(CVECTOR(0.0f, -10.0f, 0.0f), CVECTOR(0.0f, 10.0f, 0.0f), found);
+    CHECK(found == std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+    targets.find(CVECTOR(100.0f, -10.0f, 0.0f), CVECTOR(100.0f, 10.0f, 0.0f), found);
+    CHECK(found == std::vector<uint32_t>{4});
+
+    targets.clear();
+    CHECK(targets.size() == 0);
+    targets.find(CVECTOR(0.0f, -10.0f, 0.0f), CVECTOR(0.0f, 10.0f, 0.0f), found);
+    CHECK(found.empty());
+}
+
+TEST_CASE("Mast trace targets in a formation", "[ship]")
+{
+    std::mt19937 gen(961);
+    const auto fleet = Formation(gen, 60, 80.0f);
+    const auto targets = Gather(fleet.ships);
+
+    // every mast finds its own ship, the one it is excluded from, and rarely another
+    size_t pairs = 0;
+    std::vector<uint32_t> found;
+    for (size_t m = 0; m < fleet.masts.size(); m++)
+    {
+        targets.find(fleet.masts[m].src, fleet.masts[m].dst, found);
+        REQUIRE(std::find(found.begin(), found.end(), m / 3) != found.end());
+        pairs += found.size();
+    }
+    CHECK(pairs < fleet.masts.size() * 2);
+}
+
+TEST_CASE("Mast trace targets benchmark", "[.][ship][benchmark]")
+{
+    std::mt19937 gen(1);
+    const auto fleet = Formation(gen, 60, 80.0f);
+    {
+        const auto targets = Gather(fleet.ships);
+        std::vector<uint32_t> found;
+        size_t pairs = 0;
+        for (const auto &mast : fleet.masts)
+        {
+            targets.find(mast.src, mast.dst, found);
+            pairs += found.size();
+        }
+        WARN("60 ships, 180 masts, traced pairs " << fleet.masts.size() * fleet.ships.size() << " -> " << pairs);
+    }
+
+    BENCHMARK("whole layer for 180 masts")
+    {
+        size_t pairs = 0;
+        for (const auto &mast : fleet.masts)
+            pairs += TraceAll(fleet.ships, mast).size();
+        return pairs;
+    };
+    BENCHMARK("gather 60 ships and find for 180 masts")
+    {
+        const auto targets = Gather(fleet.ships);
+        std::vector<uint32_t> found;
+        size_t pairs = 0;
+        for (const auto &mast : fleet.masts)
+        {
+            targets.find(mast.src, mast.dst, found);
+            pairs += found.size();
+        }
+        return pairs;
+    };
+}
@@ -0,0 +1,405 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "core_impl.h"
+#include "shared/sea_ai/script_defines.h"
+#include "ship_hit_batch.h"
+
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+class Codec final : public VSTRING_CODEC
+{
+  public:
+    uint32_t GetNum() override
+    {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    uint32_t Convert(const char *pString) override
+    {
+        const auto [it, added] = codes_.emplace(pString, static_cast<uint32_t>(names_.size()));
+        if (added)
+            names_.emplace_back(pString);
+        return it->second;
+    }
+
+    uint32_t Convert(const char *pString, int32_t iLen) override
+    {
+        return Convert(std::string(pString, iLen).c_str());
+    }
+
+    const char *Convert(uint32_t code) override
+    {
+        return names_.at(code).c_str();
+    }
+
+    void VariableChanged() override
+    {
+    }
+
+  private:
+    std::map<std::string, uint32_t> codes_;
+    std::deque<std::string> names_;
+};
+
+// the damage a script takes from the hull for a ball, less for the ones from further away
+float HullDamage(uint32_t ballType, uint32_t cannonType, float distance)
+{
+    return (10.0f + 5.0f * static_cast<float>(ballType) + static_cast<float>(cannonType)) / (1.0f + 0.01f * distance);
+}
+
+// the way AIBalls set the ball and SHIP::Cannon_Trace sent SHIP_HULL_HIT for every hit, and a script took it
+void HitEach(ATTRIBUTES &balls, ATTRIBUTES &character, const CANNON_BALL &ball, const CVECTOR &pos)
+{
+    balls.SetAttributeUseDword("CurrentBallType", ball.dwGoodIndex);
+    balls.SetAttributeUseDword("CurrentBallCannonType", ball.dwCannonType);
+    balls.SetAttributeUseFloat("CurrentBallDistance", ball.fDistance);
+
+    auto *pAShip = character.GetAttributeClass("Ship");
+    const auto damage = HullDamage(balls.GetAttributeAsDword("CurrentBallType"),
+                                   balls.GetAttributeAsDword("CurrentBallCannonType"),
+                                   balls.GetAttributeAsFloat("CurrentBallDistance"));
+    pAShip->SetAttributeUseFloat("HP", pAShip->GetAttributeAsFloat("HP") - damage);
+    pAShip->SetAttributeUseDword("LastHitOwner", static_cast<uint32_t>(ball.iOwner));
+    pAShip->SetAttributeUseFloat("LastHitX", pos.x);
+}
+
+// a SHIP_HITS handler doing the same from the totals of the frame
+void HitAll(ATTRIBUTES &character)
+{
+    auto *pAShip = character.GetAttributeClass("Ship");
+    auto *pAHits = pAShip->GetAttributeClass("Hits");
+    auto hp = pAShip->GetAttributeAsFloat("HP");
+    if (auto *pATotals = pAHits->GetAttributeClass("totals"))
+        for (uint32_t i = 0; i < pATotals->GetAttributesNum(); i++)
+        {
+            auto *pATotal = pATotals->GetAttributeClass(i);
+            hp -= static_cast<float>(pATotal->GetAttributeAsDword("count")) *
+                  HullDamage(pATotal->GetAttributeAsDword("ball"), pATotal->GetAttributeAsDword("cannon"),
+                             pATotal->GetAttributeAsFloat("distance"));
+        }
+    pAShip->SetAttributeUseFloat("HP", hp);
+    const auto last = pAHits->GetAttributeAsDword("count") - 1;
+    auto *pALast = pAHits->GetAttributeClass("hits")->GetAttributeClass(last);
+    pAShip->SetAttributeUseDword("LastHitOwner", pALast->GetAttributeAsDword("owner"));
+    pAShip->SetAttributeUseFloat("LastHitX", pALast->GetAttributeAsFloat("x"));
+}
+
+// SHIP_HULL_HIT and SHIP_HITS handlers doing what HitEach and HitAll do, on characters of their own
+constexpr auto kHitScript = R"(
+object AIBalls;
+object EachCharacter;
+object AllCharacter;
+
+void Main()
+{
+    EachCharacter.Ship.HP = 5000.0;
+    AllCharacter.Ship.HP = 5000.0;
+}
+
+float HullDamage(int ballType, int cannonType, float distance)
+{
+    return (10.0 + 5.0 * ballType + cannonType) / (1.0 + 0.01 * distance);
+}
+
+void OnHullHit()
+{
+    aref rShipObject = GetEventData();
+    int iBallOwner = GetEventData();
+    int iOurIndex = GetEventData();
+    float x = GetEventData();
+    float y = GetEventData();
+    float z = GetEventData();
+    int iFirePlace = GetEventData();
+    float fFirePlaceDistance = GetEventData();
+
+    aref rShip;
+    makearef(rShip, EachCharacter.Ship);
+    float fDamage = HullDamage(sti(AIBalls.CurrentBallType), sti(AIBalls.CurrentBallCannonType),
+                               stf(AIBalls.CurrentBallDistance));
+    rShip.HP = stf(rShip.HP) - fDamage;
+    rShip.LastHitOwner = iBallOwner;
+    rShip.LastHitX = x;
+}
+
+void OnHits()
+{
+    aref rShipObject = GetEventData();
+    aref rCharacter = GetEventData();
+    int iCharacterIndex = GetEventData();
+    int iCount = GetEventData();
+    aref rHits = GetEventData();
+
+    aref rShip;
+    aref rTotals;
+    aref rTotal;
+    aref rList;
+    aref rLast;
+    makearef(rShip, rCharacter.Ship);
+    makearef(rTotals, rHits.totals);
+    float fHP = stf(rShip.HP);
+    int i;
+    int n = GetAttributesNum(rTotals);
+    for (i = 0; i < n; i++)
+    {
+        rTotal = GetAttributeN(rTotals, i);
+        fHP = fHP - HullDamage(sti(rTotal.ball), sti(rTotal.cannon), stf(rTotal.distance)) * sti(rTotal.count);
+    }
+    rShip.HP = fHP;
+
+    makearef(rList, rHits.hits);
+    rLast = GetAttributeN(rList, iCount - 1);
+    rShip.LastHitOwner = sti(rLast.owner);
+    rShip.LastHitX = stf(rLast.x);
+}
+)";
+
+// the script on disk for the compiler, the folder is lower case for the resource path lookup on Linux
+class ScriptFolder final
+{
+  public:
+    ScriptFolder() : path_(std::filesystem::temp_directory_path() / "storm_ship_hits")
+    {
+        std::filesystem::create_directories(path_);
+        std::ofstream(path_ / "main.c") << kHitScript;
+    }
+
+    ~ScriptFolder()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    std::string string() const
+    {
+        return path_.string();
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+// core.Event goes to the compiler of the test while it lives
+class CoreCompiler final
+{
+  public:
+    explicit CoreCompiler(COMPILER &compiler)
+    {
+        core_internal.Compiler = &compiler;
+    }
+
+    ~CoreCompiler()
+    {
+        core_internal.Compiler = nullptr;
+    }
+};
+
+// the grapeshot of a broadside at close range, the distance of the balls of a volley is about the same
+std::vector<CANNON_BALL> Broadside(std::mt19937 &gen, size_t count)
+{
+    std::uniform_real_distribution<float> spread(0.0f, 0.5f);
+    std::uniform_int_distribution<int32_t> owner(0, 2);
+    std::vector<CANNON_BALL> balls;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto o = owner(gen);
+        balls.push_back({o, 3, static_cast<uint32_t>(o % 2), 40.0f + 10.0f * static_cast<float>(o) + spread(gen)});
+    }
+    return balls;
+}
+
+} // namespace
+
+TEST_CASE("Hits are written for the scripts", "[ship]")
+{
+    Codec codec;
+    ATTRIBUTES node(codec);
+    storm::ShipHitBatch batch;
+    CHECK(batch.empty());
+
+    batch.hull({1, 2, 0, 10.0f}, CVECTOR(1.0f, 2.0f, 3.0f), 4, 1.5f);
+    batch.hull({7, 2, 0, 30.0f}, CVECTOR(4.0f, 5.0f, 6.0f), -1, 0.0f);
+    batch.hull({1, 2, 0, 20.0f}, CVECTOR(7.0f, 8.0f, 9.0f), 4, 2.5f);
+    batch.hull({1, 5, 0, 20.0f}, CVECTOR(0.0f, 0.0f, 0.0f), 3, 0.5f);
+    batch.mast(2, 5, 0.25f, {1, 2, 0, 10.0f}, CVECTOR(0.0f, 10.0f, 0.0f));
+    batch.mast(2, 5, 0.5f, {7, 2, 0, 30.0f}, CVECTOR(0.0f, 11.0f, 0.0f));
+    batch.mast(0, 1, 0.0f, {7, 2, 0, 30.0f}, CVECTOR(0.0f, 12.0f, 0.0f));
+    batch.hullPart(3, 6, "bakh", 0.75f, {1, 2, 1, 10.0f}, CVECTOR(0.0f, 1.0f, -5.0f));
+    CHECK_FALSE(batch.empty());
+
+    // an earlier frame left something behind
+    node.CreateAttribute("stale");
+    batch.write(node);
+    CHECK_FALSE(node.GetAttributeClass("stale"));
+    CHECK(node.GetAttributeAsDword("count") == 4);
+
+    auto *pAHits = node.GetAttributeClass("hits");
+    REQUIRE(pAHits);
+    REQUIRE(pAHits->GetAttributesNum() == 4);
+    auto *pAHit = pAHits->GetAttributeClass("h2");
+    REQUIRE(pAHit);
+    CHECK(pAHit->GetAttributeAsFloat("x") == 7.0f);
+    CHECK(pAHit->GetAttributeAsFloat("y") == 8.0f);
+    CHECK(pAHit->GetAttributeAsFloat("z") == 9.0f);
+    CHECK(pAHit->GetAttributeAsDword("owner") == 1);
+    CHECK(pAHit->GetAttributeAsDword("ball") == 2);
+    CHECK(pAHit->GetAttributeAsDword("cannon") == 0);
+    CHECK(pAHit->GetAttributeAsFloat("distance") == 20.0f);
+    CHECK(pAHit->GetAttributeAsDword("fireplace") == 4);
+    CHECK(pAHit->GetAttributeAsFloat("fireplacedistance") == 2.5f);
+    CHECK(static_cast<int32_t>(pAHits->GetAttributeClass("h1")->GetAttributeAsDword("fireplace")) == -1);
+
+    // per owner, ball and cannon type, in the order they first hit
+    auto *pATotals = node.GetAttributeClass("totals");
+    REQUIRE(pATotals);
+    REQUIRE(pATotals->GetAttributesNum() == 3);
+    auto *pATotal = pATotals->GetAttributeClass("t0");
+    CHECK(pATotal->GetAttributeAsDword("owner") == 1);
+    CHECK(pATotal->GetAttributeAsDword("ball") == 2);
+    CHECK(pATotal->GetAttributeAsDword("count") == 2);
+    CHECK(pATotal->GetAttributeAsFloat("distance") == 15.0f);
+    CHECK(pATotals->GetAttributeClass("t1")->GetAttributeAsDword("owner") == 7);
+    CHECK(pATotals->GetAttributeClass("t2")->GetAttributeAsDword("ball") == 5);
+
+    // a part once, with its first hit and the damage before
+    auto *pAMasts = node.GetAttributeClass("masts");
+    REQUIRE(pAMasts);
+    REQUIRE(pAMasts->GetAttributesNum() == 2);
+    auto *pAMast = pAMasts->GetAttributeClass("m0");
+    CHECK(pAMast->GetAttributeAsDword("mast") == 5);
+    CHECK(pAMast->GetAttributeAsDword("count") == 2);
+    CHECK(pAMast->GetAttributeAsDword("owner") == 1);
+    CHECK(pAMast->GetAttributeAsFloat("y") == 10.0f);
+    CHECK(pAMast->GetAttributeAsFloat("damage") == 0.25f);
+    auto *pAHulls = node.GetAttributeClass("hulls");
+    REQUIRE(pAHulls);
+    REQUIRE(pAHulls->GetAttributesNum() == 1);
+    auto *pAHull = pAHulls->GetAttributeClass("h0");
+    CHECK(pAHull->GetAttributeAsDword("hull") == 6);
+    CHECK(to_string(pAHull->GetAttribute("name")) == "bakh");
+    CHECK(pAHull->GetAttributeAsDword("cannon") == 1);
+
+    // the scripts write the new damage back
+    pAMast->SetAttributeUseFloat("damage", 0.9f);
+    CHECK(storm::ShipHitBatch::damage(node, "masts", 0, 0.25f) == 0.9f);
+    CHECK(storm::ShipHitBatch::damage(node, "masts", 1, 0.0f) == 0.0f);
+    pAHull->DeleteAttributeClassX(pAHull->GetAttributeClass("damage"));
+    CHECK(storm::ShipHitBatch::damage(node, "hulls", 0, 0.75f) == 0.75f);
+    CHECK(storm::ShipHitBatch::damage(node, "hulls", 1, 0.5f) == 0.5f);
+
+    batch.clear();
+    CHECK(batch.empty());
+    batch.write(node);
+    CHECK(node.GetAttributeAsDword("count") == 0);
+    CHECK(node.GetAttributesNum() == 1);
+    CHECK(storm::ShipHitBatch::damage(node, "masts", 0, 0.25f) == 0.25f);
+}
+
+TEST_CASE("Scripts take the same damage from the hits of a frame as from every hit", "[ship]")
+{
+    Codec codec;
+    ATTRIBUTES world(codec);
+    auto &balls = world.CreateAttribute("AIBalls");
+    auto &each = world.CreateAttribute("each");
+    auto &all = world.CreateAttribute("all");
+    each.CreateSubAClass(&each, "Ship")->SetAttributeUseFloat("HP", 5000.0f);
+    all.CreateSubAClass(&all, "Ship")->SetAttributeUseFloat("HP", 5000.0f);
+
+    std::mt19937 gen(100);
+    storm::ShipHitBatch batch;
+    for (int frame = 0; frame < 50; frame++)
+    {
+        const auto volley = Broadside(gen, 1 + frame % 30);
+        for (size_t i = 0; i < volley.size(); i++)
+        {
+            const CVECTOR pos(static_cast<float>(i), 1.0f, 0.0f);
+            HitEach(balls, each, volley[i], pos);
+            batch.hull(volley[i], pos, -1, 0.0f);
+        }
+        batch.write(*all.CreateSubAClass(&all, "Ship.Hits"));
+        HitAll(all);
+        all.GetAttributeClass("Ship")->DeleteAttributeClassX(all.FindAClass(&all, "Ship.Hits"));
+        batch.clear();
+
+        auto *pAEach = each.GetAttributeClass("Ship");
+        auto *pAAll = all.GetAttributeClass("Ship");
+        // the rounding of the health written back after every hit, at most
+        REQUIRE(pAAll->GetAttributeAsFloat("HP") == Approx(pAEach->GetAttributeAsFloat("HP")).margin(0.1));
+        REQUIRE(pAAll->GetAttributeAsDword("LastHitOwner") == pAEach->GetAttributeAsDword("LastHitOwner"));
+        REQUIRE(pAAll->GetAttributeAsFloat("LastHitX") == pAEach->GetAttributeAsFloat("LastHitX"));
+        REQUIRE_FALSE(pAAll->GetAttributeClass("Hits"));
+    }
+}
+
+TEST_CASE("Ship hit batch benchmark", "[.][ship][benchmark]")
+{
+    const ScriptFolder folder;
+    COMPILER compiler;
+    const CoreCompiler coreCompiler(compiler);
+    compiler.SetProgramDirectory(folder.string().c_str());
+    REQUIRE(compiler.CreateProgram("main.c"));
+    compiler.Run();
+    compiler.SetEventHandler(SHIP_HULL_HIT, "OnHullHit", 0);
+    compiler.SetEventHandler(SHIP_HITS, "OnHits", 0);
+
+    auto &balls = *static_cast<VDATA *>(core.GetScriptVariable("AIBalls"))->GetAClass();
+    auto &each = *static_cast<VDATA *>(core.GetScriptVariable("EachCharacter"))->GetAClass();
+    auto &all = *static_cast<VDATA *>(core.GetScriptVariable("AllCharacter"))->GetAClass();
+
+    std::mt19937 gen(100);
+    const auto volley = Broadside(gen, 24);
+    storm::ShipHitBatch batch;
+
+    // AIBalls::Execute and SHIP::Cannon_Trace for every hit, the script takes the ball from AIBalls
+    const auto frameEach = [&] {
+        for (size_t i = 0; i < volley.size(); i++)
+        {
+            const auto &ball = volley[i];
+            balls.SetAttributeUseDword("CurrentBallType", ball.dwGoodIndex);
+            balls.SetAttributeUseDword("CurrentBallCannonType", ball.dwCannonType);
+            balls.SetAttributeUseFloat("CurrentBallDistance", ball.fDistance);
+            core.Event(SHIP_HULL_HIT, "illffflf", invalid_entity, ball.iOwner, 0, static_cast<float>(i), 1.0f, 0.0f,
+                       -1, 0.0f);
+        }
+    };
+    // the hits collected and sent once as SHIP::Cannon_SendHits does
+    const auto frameAll = [&] {
+        for (size_t i = 0; i < volley.size(); i++)
+            batch.hull(volley[i], CVECTOR(static_cast<float>(i), 1.0f, 0.0f), -1, 0.0f);
+        ATTRIBUTES *pAHits = all.CreateSubAClass(&all, "Ship.Hits");
+        batch.write(*pAHits);
+        core.Event(SHIP_HITS, "ialla", invalid_entity, &all, 0, static_cast<int32_t>(batch.hits().size()), pAHits);
+        if ((pAHits = all.FindAClass(&all, "Ship.Hits")))
+            all.FindAClass(&all, "Ship")->DeleteAttributeClassX(pAHits);
+        batch.clear();
+    };
+
+    // the handlers agree before they are timed
+    frameEach();
+    frameAll();
+    auto *pAEach = each.GetAttributeClass("Ship");
+    auto *pAAll = all.GetAttributeClass("Ship");
+    REQUIRE(pAAll->GetAttributeAsFloat("HP") == Approx(pAEach->GetAttributeAsFloat("HP")).margin(0.1));
+    REQUIRE(pAAll->GetAttributeAsDword("LastHitOwner") == pAEach->GetAttributeAsDword("LastHitOwner"));
+    REQUIRE(pAAll->GetAttributeAsFloat("LastHitX") == pAEach->GetAttributeAsFloat("LastHitX"));
+    REQUIRE_FALSE(pAAll->GetAttributeClass("Hits"));
+
+    BENCHMARK("grapeshot broadside at close range, an event per hit")
+    {
+        frameEach();
+    };
+    BENCHMARK("grapeshot broadside at close range, an event per frame")
+    {
+        frameAll();
+    };
+}
@@ -7,7 +7,7 @@
 
 //--------------------------------------------------------------------
 TSinkSplash::TSinkSplash()
-    : ps(nullptr), enabled(false), sea(nullptr), time(0), distortDivider(0), center(), dir(), growK(0)
+    : enabled(false), sea(nullptr), time(0), distortDivider(0), center(), dir(), growK(0)
 {
 }
 
@@ -20,17 +20,12 @@ TSinkSplash::~TSinkSplash()
 //--------------------------------------------------------------------
 void TSinkSplash::Initialize(INIFILE *_ini, SEA_BASE *_sea)
 {
-    // ps = new SEPS_PS();
-    // ps->Init(_ini, "sink");
-
     sea = _sea;
 }
 
 //--------------------------------------------------------------------
 void TSinkSplash::Release()
 {
-    // if (ps)
-    //    delete ps;
 }
 
 //--------------------------------------------------------------------
@@ -69,8 +64,6 @@ void TSinkSplash::Start(const CVECTOR &_pos, uint16_t *_indexes, SINK_VERTEX *_v
             *(_indexes++) = vOffset + sink_effect::GRID_STEPS * (z + 1) + x + 1;
             *(_indexes++) = vOffset + sink_effect::GRID_STEPS * z + x + 1;
         }
-
-    // ps->Reset();
 }
 
 //--------------------------------------------------------------------
@@ -106,7 +99,6 @@ void TSinkSplash::Process(uint32_t _dTime, uint16_t *_indexes, SINK_VERTEX *_ver
     localDir.y = 1.0f;
     localDir.z = sin(rho) * sin(alpha);
     // localDir += /*(((float) time) / (2 * SPLASH_FADE_TIME))**/this->dir;
-    // ps->SetEmitter(pos, localDir);
 
     time += _dTime;
 
@@ -190,7 +182,6 @@ void TSinkSplash::Reset(uint16_t *_indexes, SINK_VERTEX *_vertexes)
 //--------------------------------------------------------------------
 void TSinkSplash::AdditionalRealize(uint32_t dTime)
 {
-    // ps->Realize(_dTime);
 }
 
 //--------------------------------------------------------------------
@@ -4,7 +4,6 @@
 #include "v_sound_service.h"
 #include "dx9render.h"
 #include "sea_base.h"
-#include "seps.h"
 
 ///////////////////////////////////////////////////////////////////
 // CLASS DEFINITION
@@ -33,7 +32,6 @@ class TSinkSplash
   private:
     float HeightF(uint32_t time, float _r, float _k);
 
-    SEPS_PS *ps;
     bool enabled;
     SEA_BASE *sea;
     uint32_t time;
@@ -3,21 +3,36 @@
 #include "core.h"
 #include "rands.h"
 
-
-#include "iv_buffer_manager.h"
 #include "math_inlines.h"
 
 CREATE_CLASS(WaterRings)
 
+namespace
+{
+// ring grid around its centre before it is scaled and turned, the same for every ring
+struct RingGridPoint
+{
+    float gX, gZ;
+    float tu, tv;
+};
+
+RingGridPoint ringGrid[waterrings::GRID_STEPS_COUNT * waterrings::GRID_STEPS_COUNT];
+} // namespace
+
 //------------------------------------------------------------------------------------
-WaterRings::WaterRings() : ivManager(nullptr)
+WaterRings::WaterRings() : renderService(nullptr), sea(nullptr), vBuffer(-1), iBuffer(-1), ringTexture(-1)
 {
 }
 
 //------------------------------------------------------------------------------------
 WaterRings::~WaterRings()
 {
-    delete ivManager;
+    if (!renderService)
+        return;
+    if (vBuffer >= 0)
+        renderService->ReleaseVertexBuffer(vBuffer);
+    if (iBuffer >= 0)
+        renderService->ReleaseIndexBuffer(iBuffer);
     renderService->TextureRelease(ringTexture);
 }
 
@@ -35,18 +50,31 @@ bool WaterRings::Init()
     if (!renderService)
         throw std::runtime_error("No service: dx9render");
 
-    ivManager =
-        new IVBufferManager(renderService, waterrings::RING_FVF, sizeof(RING_VERTEX), waterrings::TRIANGLES_COUNT * 3,
-                            waterrings::GRID_STEPS_COUNT * waterrings::GRID_STEPS_COUNT, waterrings::MAX_RINGS);
+    constexpr auto gridVertices = waterrings::GRID_STEPS_COUNT * waterrings::GRID_STEPS_COUNT;
+    vBuffer = renderService->CreateVertexBuffer(waterrings::RING_FVF,
+                                                waterrings::MAX_RINGS * gridVertices * sizeof(RING_VERTEX),
+                                                D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC);
+    if (vBuffer < 0 || !CreateIndexBuffer())
+        throw std::runtime_error("WaterRings: can't create buffers");
+
+    const float midX = (waterrings::GRID_STEPS_COUNT - 1) / 2.f;
+    const float midZ = (waterrings::GRID_STEPS_COUNT - 1) / 2.f;
+    auto *point = ringGrid;
+    for (auto z = 0; z < waterrings::GRID_STEPS_COUNT; ++z)
+        for (auto x = 0; x < waterrings::GRID_STEPS_COUNT; ++x, ++point)
+        {
+            point->gX = (x - midX) / midX;
+            point->gZ = (z - midZ) / midZ;
+            point->tu = (static_cast<float>(x) / (waterrings::GRID_STEPS_COUNT - 1)) * .5f;
+            point->tv = static_cast<float>(z) / (waterrings::GRID_STEPS_COUNT - 1);
+        }
 
     ringTexture = renderService->TextureCreate("ring.tga");
 
     for (auto i = 0; i < waterrings::MAX_RINGS; i++)
     {
-        rings[i].ivIndex = ivManager->ReserveElement();
         rings[i].activeTime = 0;
         rings[i].active = false;
-        rings[i].firstUpdate = true;
         rings[i].x = 0.f;
         rings[i].z = 0.f;
     }
@@ -55,32 +83,90 @@ bool WaterRings::Init()
     // UNGUARD
 }
 
+//------------------------------------------------------------------------------------
+bool WaterRings::CreateIndexBuffer()
+{
+    constexpr auto gridVertices = waterrings::GRID_STEPS_COUNT * waterrings::GRID_STEPS_COUNT;
+    iBuffer = renderService->CreateIndexBuffer(waterrings::MAX_RINGS * waterrings::TRIANGLES_COUNT * 3 *
+                                               sizeof(uint16_t));
+    if (iBuffer < 0)
+        return false;
+
+    // the grids of all rings share one index buffer
+    auto *indexes = static_cast<uint16_t *>(renderService->LockIndexBuffer(iBuffer));
+    if (!indexes)
+        return false;
+    for (auto i = 0; i < waterrings::MAX_RINGS; i++)
+    {
+        const auto vOffset = i * gridVertices;
+        for (auto z = 0; z < waterrings::GRID_STEPS_COUNT - 1; ++z)
+            for (auto x = 0; x < waterrings::GRID_STEPS_COUNT - 1; ++x)
+            {
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * z + x);
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x);
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x + 1);
+
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * z + x);
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x + 1);
+                *(indexes++) = static_cast<uint16_t>(vOffset + waterrings::GRID_STEPS_COUNT * z + x + 1);
+            }
+    }
+    renderService->UnLockIndexBuffer(iBuffer);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------
+void WaterRings::LostRender()
+{
+    if (iBuffer >= 0)
+        renderService->ReleaseIndexBuffer(iBuffer);
+    iBuffer = -1;
+}
+
+//------------------------------------------------------------------------------------
+void WaterRings::RestoreRender()
+{
+    // the renderer would bring the indexes back empty, so the buffer is made again
+    CreateIndexBuffer();
+}
+
 //------------------------------------------------------------------------------------
 void WaterRings::Realize(uint32_t _dTime)
 {
-    if (!sea)
+    if (!sea || iBuffer < 0)
         return;
 
-    // update buffers for rings
-    ivManager->LockBuffers();
-    uint16_t *iPointer;
-    RING_VERTEX *vPointer;
-    int32_t vOffset;
+    constexpr auto gridVertices = waterrings::GRID_STEPS_COUNT * waterrings::GRID_STEPS_COUNT;
+
+    // only the active rings are written, one after another
+    RING_VERTEX *vertices = nullptr;
+    auto count = 0;
     for (auto i = 0; i < waterrings::MAX_RINGS; i++)
     {
         // check if ring needs to be removed
         if (rings[i].activeTime > (waterrings::FADE_IN_TIME + waterrings::FADE_OUT_TIME))
             rings[i].active = false;
-        ivManager->GetPointers(rings[i].ivIndex, static_cast<uint16_t **>(&iPointer), (void **)&vPointer, &vOffset);
-        UpdateGrid(i, iPointer, vPointer, vOffset);
+        if (!rings[i].active)
+            continue;
+
+        if (!vertices)
+            vertices = static_cast<RING_VERTEX *>(renderService->LockVertexBuffer(vBuffer, D3DLOCK_DISCARD));
+        UpdateGrid(i, vertices + count * gridVertices);
+        ++count;
 
-        if (rings[i].active)
-            rings[i].activeTime += _dTime;
+        rings[i].activeTime += _dTime;
     }
-    ivManager->UnlockBuffers();
+    if (!vertices)
+        return;
+
+    // the sea under all rings at once
+    sea->WaveXZ(&vertices->pos, count * gridVertices, sizeof(RING_VERTEX), waterrings::Y_DELTA);
+    renderService->UnLockVertexBuffer(vBuffer);
 
     renderService->TextureSet(0, ringTexture);
-    ivManager->DrawBuffers("waterring");
+    renderService->DrawBuffer(vBuffer, sizeof(RING_VERTEX), iBuffer, 0, count * gridVertices, 0,
+                              count * waterrings::TRIANGLES_COUNT, "waterring");
 }
 
 //------------------------------------------------------------------------------------
@@ -134,83 +220,30 @@ uint64_t WaterRings::ProcessMessage(MESSAGE &message)
 }
 
 //------------------------------------------------------------------------------------
-void WaterRings::UpdateGrid(int _ringI, uint16_t *_iPointer, RING_VERTEX *_vPointer, int32_t _vOffset)
+void WaterRings::UpdateGrid(int _ringI, RING_VERTEX *_vPointer)
 {
-    Assert(_iPointer);
     Assert(_vPointer);
 
-    float a;
-    tRing *ring = &rings[_ringI];
-    int x, z;
-
-    if (ring->firstUpdate)
-    {
-        uint16_t *indexes = _iPointer;
-        for (z = 0; z < waterrings::GRID_STEPS_COUNT - 1; ++z)
-            for (x = 0; x < waterrings::GRID_STEPS_COUNT - 1; ++x)
-            {
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * z + x);
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x);
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x + 1);
-
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * z + x);
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * (z + 1) + x + 1);
-                *(indexes++) = static_cast<uint16_t>(_vOffset + waterrings::GRID_STEPS_COUNT * z + x + 1);
-            }
-        ring->firstUpdate = false;
-    }
+    const tRing *ring = &rings[_ringI];
 
+    // fade and size only depend on the age of the ring
+    float a;
     if (ring->activeTime < waterrings::FADE_IN_TIME)
         a = static_cast<float>(ring->activeTime) / waterrings::FADE_IN_TIME;
     else
         a = 1.f - (static_cast<float>(ring->activeTime - waterrings::FADE_IN_TIME) / waterrings::FADE_OUT_TIME);
+    const uint32_t texA = static_cast<uint32_t>(a * 50) << 24;
+    const float r = .4f + 1.5f * ring->activeTime / (waterrings::FADE_IN_TIME + waterrings::FADE_OUT_TIME);
 
-    const float midX = (waterrings::GRID_STEPS_COUNT - 1) / 2.f;
-    const float midZ = (waterrings::GRID_STEPS_COUNT - 1) / 2.f;
     RING_VERTEX *ringVertex = _vPointer;
-    float gX, gZ;
-    if (ring->active)
-    {
-        const uint32_t texA = static_cast<uint32_t>(a * 50) << 24;
-        const float r = .4f + 1.5f * ring->activeTime / (waterrings::FADE_IN_TIME + waterrings::FADE_OUT_TIME);
-
-        for (z = 0; z < waterrings::GRID_STEPS_COUNT; ++z)
-            for (x = 0; x < waterrings::GRID_STEPS_COUNT; ++x)
-            {
-                ringVertex->color = texA;
-                gX = (x - midX) / midX;
-                gZ = (z - midZ) / midZ;
-                ringVertex->pos.x = ring->x + r * (gX * ring->cosA + gZ * ring->sinA);
-                ringVertex->pos.z = ring->z + r * (gZ * ring->cosA - gX * ring->sinA);
-                ringVertex->pos.y = waterrings::Y_DELTA + sea->WaveXZ(ringVertex->pos.x, ringVertex->pos.z);
-                // if (ring->state == RING_WALK)
-                {
-                    ringVertex->tu = (static_cast<float>(x) / (waterrings::GRID_STEPS_COUNT - 1)) * .5f;
-                    ringVertex->tv = static_cast<float>(z) / (waterrings::GRID_STEPS_COUNT - 1);
-                }
-                /*
-                else if (ring->state == RING_RUN)
-                {
-                  ringVertex->tu = ((float) x / (GRID_STEPS_COUNT - 1))*.5f+.5f;
-                  ringVertex->tv = (float) z / (GRID_STEPS_COUNT - 1);
-                }
-                */
-                ++ringVertex;
-            }
-    }
-    else
+    for (const auto &point : ringGrid)
     {
-        for (z = 0; z < waterrings::GRID_STEPS_COUNT; ++z)
-            for (x = 0; x < waterrings::GRID_STEPS_COUNT; ++x)
-            {
-                ringVertex->color = 0x00000000;
-                ringVertex->pos.x = 0.f;
-                ringVertex->pos.z = 0.f;
-                ringVertex->pos.y = 0.f;
-                ringVertex->tu = 0.f;
-                ringVertex->tv = 0.f;
-                ++ringVertex;
-            }
+        ringVertex->color = texA;
+        ringVertex->pos.x = ring->x + r * (point.gX * ring->cosA + point.gZ * ring->sinA);
+        ringVertex->pos.z = ring->z + r * (point.gZ * ring->cosA - point.gX * ring->sinA);
+        ringVertex->tu = point.tu;
+        ringVertex->tv = point.tv;
+        ++ringVertex;
     }
 }
 
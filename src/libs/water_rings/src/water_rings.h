@@ -6,7 +6,6 @@
 #include "sea_base.h"
 #include "vma.hpp"
 //#include "..\geom_lib\geos.h"
-#include "iv_buffer_manager.h"
 
 namespace waterrings
 {
@@ -39,10 +38,8 @@ struct tRing
 {
     bool active;
     int32_t activeTime;
-    int32_t ivIndex;
     float x, z;
     tRingState state;
-    bool firstUpdate;
     float cosA, sinA;
 };
 
@@ -64,19 +61,25 @@ class WaterRings : public Entity
         case Stage::realize:
             Realize(delta);
             break;
-            /*case Stage::lost_render:
-                LostRender(delta); break;
-            case Stage::restore_render:
-                RestoreRender(delta); break;*/
+        case Stage::lost_render:
+            LostRender();
+            break;
+        case Stage::restore_render:
+            RestoreRender();
+            break;
         }
     }
 
   private:
-    void UpdateGrid(int _ringI, uint16_t *iPointer, RING_VERTEX *vPointer, int32_t vOffset);
+    void LostRender();
+    void RestoreRender();
+    bool CreateIndexBuffer();
+    void UpdateGrid(int _ringI, RING_VERTEX *vPointer);
 
     VDX9RENDER *renderService;
     SEA_BASE *sea;
-    IVBufferManager *ivManager;
+    // active rings are packed at the start of the buffer each frame and drawn at once
+    int32_t vBuffer, iBuffer;
     int32_t ringTexture;
     tRing rings[waterrings::MAX_RINGS];
 };
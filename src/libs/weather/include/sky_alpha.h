@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief The alpha channel of a sky face kept in system memory
+ *
+ * Copied once from the texture when the sky loads it, so finding how much of the sun the clouds hide needs no lock of
+ * the texture. Faces larger than kMaxSize on a side are kept downsampled, every texel the average of the ones it
+ * covers. DXT faces are decompressed. A map without a face, as when there is no texture, is opaque.
+ */
+class SkyAlphaMap final
+{
+  public:
+    static constexpr uint32_t kMaxSize = 64;
+
+    enum class Format
+    {
+        // also X8R8G8B8, its high byte is taken as it is
+        A8R8G8B8,
+        A4R4G4B4,
+        A1R5G5B5,
+        // transparent where a block with color0 <= color1 has the index 3
+        DXT1,
+        // DXT2 and DXT3, premultiplying the colour leaves the alpha as it is
+        DXT3,
+        // DXT4 and DXT5
+        DXT5,
+    };
+
+    // pitch in bytes, of a row of 4x4 blocks for the DXT formats
+    void set(const uint8_t *bits, uint32_t pitch, uint32_t width, uint32_t height, Format format = Format::A8R8G8B8);
+    void clear();
+
+    [[nodiscard]] bool empty() const
+    {
+        return alpha_.empty();
+    }
+
+    [[nodiscard]] uint32_t width() const
+    {
+        return width_;
+    }
+
+    [[nodiscard]] uint32_t height() const
+    {
+        return height_;
+    }
+
+    // the texel at the texture coordinates as SKY::GetPixelColor picked it, 255 without a face
+    [[nodiscard]] uint8_t sample(float u, float v) const;
+
+    // alpha of the sky between the current and the next faces, 0..1
+    static float blend(const SkyAlphaMap &current, const SkyAlphaMap &next, float k, float u, float v);
+
+  private:
+    // the alpha of every texel of a DXT face in rows of width bytes
+    static std::vector<uint8_t> decompress(const uint8_t *bits, uint32_t pitch, uint32_t width, uint32_t height,
+                                           Format format);
+
+    template <class Alpha> void downsample(uint32_t width, uint32_t height, Alpha alpha);
+
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    std::vector<uint8_t> alpha_;
+};
+
+} // namespace storm
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace storm
+{
+
+/**
+ * \brief Stars of the sky in the order of magnitude, the brightest first
+ *
+ * A star is seen when it is brighter than the magnitude limit of the field of view, so the seen stars are always the
+ * first ones and a change of the view only changes how many of them are drawn. Colours are written for the seen
+ * stars only, four at a time, with the twinkle of the star number, the height fade of the star and its magnitude.
+ */
+class StarField final
+{
+  public:
+    // the magnitude at which a star is as bright as it gets
+    static constexpr float kBrightest = -2.0f;
+    // the twinkle repeats every 5 and every 7 stars, the table is also a multiple of 4
+    static constexpr size_t kTwinklePeriod = 140;
+
+    void clear();
+    // to be added in the order of magnitude, alpha is the height fade 0..1, colour without alpha
+    void add(float magnitude, float alpha, uint32_t color);
+    void setAlpha(size_t index, float alpha);
+
+    [[nodiscard]] size_t size() const
+    {
+        return size_;
+    }
+
+    // how many of the first stars are brighter than the limit
+    [[nodiscard]] size_t visible(float maxMagnitude) const;
+
+    // the waves of the twinkle over 5 and the random factors over 7 stars, the fade of all stars
+    void setTwinkle(const float (&waves)[5], const float (&random)[7], float fade);
+
+    // colours of the first count stars with alpha in the high byte
+    void fill(float maxMagnitude, size_t count, uint32_t *colors) const;
+
+    // if colours filled for one limit differ from the other in no alpha by a step
+    static bool sameColors(float maxMagnitude1, float maxMagnitude2);
+
+  private:
+    size_t size_ = 0;
+    // padded to 4 stars
+    std::vector<float> magnitudes_;
+    std::vector<float> alphas_;
+    std::vector<uint32_t> colors_;
+    alignas(16) float twinkle_[kTwinklePeriod]{};
+};
+
+} // namespace storm
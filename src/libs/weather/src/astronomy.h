@@ -1,5 +1,6 @@
 #pragma once
 
+#include "star_field.h"
 #include "typedef.h"
 #include <vector>
 
@@ -96,7 +97,12 @@ class Astronomy : public Entity
         bool bEnable;
         int32_t iVertexBuffer, iVertexBufferColors;
         IDirect3DVertexDeclaration9 *pDecl;
-        float fPrevFov;
+        entid_t eidWeather;
+
+        // the limit and the number of stars the colour buffer was written for
+        bool bUpdateColors;
+        float fColorsMagnitude;
+        size_t dwColorsCount;
 
         struct Star
         {
@@ -110,7 +116,9 @@ class Astronomy : public Entity
         };
 
         uint32_t Spectr[256]{};
+        // in the order of magnitude, as the vertex buffers
         std::vector<Star> aStars;
+        storm::StarField Field;
 
         float fFadeValue;
         float fFadeTimeStart;
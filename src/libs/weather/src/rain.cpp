@@ -384,6 +384,10 @@ void RAIN::RealizeDrops(uint32_t Delta_Time)
     rs->SetWorld(IMatrix);
     rs->TextureSet(0, iSeaDropTex);
 
+    // drops lie on the sea, which has moved since the last frame
+    if (pSea && !aSeaDrops.empty())
+        pSea->WaveXZ(&aSeaDrops[0].vPos, static_cast<uint32_t>(aSeaDrops.size()), sizeof(seadrop_t), 0.015f);
+
     auto pVSeaDropBuffer = static_cast<SEADROPVERTEX *>(rs->LockVertexBuffer(iVBSeaDrops, D3DLOCK_DISCARD));
     int32_t n = 0;
     if (pVSeaDropBuffer)
@@ -401,8 +405,7 @@ void RAIN::RealizeDrops(uint32_t Delta_Time)
                 continue;
             }
 
-            CVECTOR v = drop.vPos;
-            v.y = pSea->WaveXZ(v.x, v.z) + 0.015f;
+            const CVECTOR v = drop.vPos;
 
             SEADROPVERTEX *pV = &pVSeaDropBuffer[n * 4];
 
@@ -60,6 +60,8 @@ void SKY::Release()
             pRS->TextureRelease(TexturesNextID[i]);
             TexturesNextID[i] = -1;
         }
+        AlphaMaps[i].clear();
+        AlphaMapsNext[i].clear();
     }
 
     if (iSkyVertsID >= 0)
@@ -299,12 +301,14 @@ void SKY::LoadTextures()
     {
         sprintf_s(str, "%s%s", static_cast<const char *>(sSkyDir.c_str()), names[i]);
         TexturesID[i] = pRS->TextureCreate(str);
+        CopyAlpha(TexturesID[i], AlphaMaps[i]);
 
         if (aSkyDirArray.size() > 1)
         {
             sprintf_s(str, "%s%s", static_cast<const char *>(sSkyDirNext.c_str()), names[i]);
             TexturesNextID[i] = pRS->TextureCreate(str);
         }
+        CopyAlpha(TexturesNextID[i], AlphaMapsNext[i]);
     }
 
     fAngleY = 0.0f;
@@ -585,9 +589,11 @@ void SKY::UpdateTimeFactor()
             if (TexturesID[i] >= 0)
                 pRS->TextureRelease(TexturesID[i]);
             TexturesID[i] = TexturesNextID[i];
+            AlphaMaps[i] = std::move(AlphaMapsNext[i]);
 
             sprintf_s(str, "%s%s", static_cast<const char *>(sSkyDirNext.c_str()), names[i]);
             TexturesNextID[i] = pRS->TextureCreate(str);
+            CopyAlpha(TexturesNextID[i], AlphaMapsNext[i]);
         }
     }
 }
@@ -705,42 +711,58 @@ float SKY::CalculateAlphaForSun(const CVECTOR &vSunPos, float fSunSize)
         // looking for alpha in texture
         if (nTexNum != -1)
         {
-            const auto dwCol1 =
-                GetPixelColor(static_cast<IDirect3DTexture9 *>(pRS->GetTextureFromID(TexturesID[nTexNum])), fu, fv);
-            const auto dwCol2 =
-                GetPixelColor(static_cast<IDirect3DTexture9 *>(pRS->GetTextureFromID(TexturesNextID[nTexNum])), fu, fv);
-
             const auto fK = fTimeFactor - static_cast<int32_t>(fTimeFactor);
-            const auto fAlpha = (1.f - fK) * (dwCol1 >> 24) / 255.f + fK * (dwCol2 >> 24) / 255.f;
-            return fAlpha;
+            return storm::SkyAlphaMap::blend(AlphaMaps[nTexNum], AlphaMapsNext[nTexNum], fK, fu, fv);
         }
     }
 
     return 1.f;
 }
 
-uint32_t SKY::GetPixelColor(IDirect3DTexture9 *pTex, float fu, float fv) const
+void SKY::CopyAlpha(int32_t iTextureID, storm::SkyAlphaMap &map) const
 {
-    HRESULT hok;
-    auto dwCol = 0xFFFFFFFF;
-
+    map.clear();
+    auto *pTex = iTextureID >= 0 ? static_cast<IDirect3DTexture9 *>(pRS->GetTextureFromID(iTextureID)) : nullptr;
     if (!pTex)
-        return dwCol;
+        return;
 
     D3DSURFACE_DESC texdesc;
-    pRS->GetLevelDesc(pTex, 0, &texdesc);
-    const auto x = static_cast<int32_t>(Bring2Range(0.0f, static_cast<float>(texdesc.Width - 1), 0.0f,
-                                                 static_cast<float>(texdesc.Width), texdesc.Width * fu));
-    const auto y = static_cast<int32_t>(Bring2Range(0.0f, static_cast<float>(texdesc.Height - 1), 0.0f,
-                                                 static_cast<float>(texdesc.Height), texdesc.Height * fv));
+    if (pRS->GetLevelDesc(pTex, 0, &texdesc) != D3D_OK)
+        return;
+
+    // a format without alpha is opaque to the sky shader as well
+    storm::SkyAlphaMap::Format format;
+    switch (texdesc.Format)
+    {
+    case D3DFMT_A8R8G8B8:
+    case D3DFMT_X8R8G8B8:
+        format = storm::SkyAlphaMap::Format::A8R8G8B8;
+        break;
+    case D3DFMT_A4R4G4B4:
+        format = storm::SkyAlphaMap::Format::A4R4G4B4;
+        break;
+    case D3DFMT_A1R5G5B5:
+        format = storm::SkyAlphaMap::Format::A1R5G5B5;
+        break;
+    case D3DFMT_DXT1:
+        format = storm::SkyAlphaMap::Format::DXT1;
+        break;
+    case D3DFMT_DXT2:
+    case D3DFMT_DXT3:
+        format = storm::SkyAlphaMap::Format::DXT3;
+        break;
+    case D3DFMT_DXT4:
+    case D3DFMT_DXT5:
+        format = storm::SkyAlphaMap::Format::DXT5;
+        break;
+    default:
+        return;
+    }
 
     D3DLOCKED_RECT lockRect;
-    if ((hok = pRS->LockRect(pTex, 0, &lockRect, nullptr, D3DLOCK_READONLY)) == D3D_OK)
+    if (pRS->LockRect(pTex, 0, &lockRect, nullptr, D3DLOCK_READONLY) == D3D_OK)
     {
-        auto *pLine = (uint32_t *)(static_cast<uint8_t *>(lockRect.pBits) + y * lockRect.Pitch);
-        dwCol = pLine[x];
+        map.set(static_cast<const uint8_t *>(lockRect.pBits), lockRect.Pitch, texdesc.Width, texdesc.Height, format);
         pRS->UnlockRect(pTex, 0);
     }
-
-    return dwCol;
 }
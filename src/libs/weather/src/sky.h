@@ -1,5 +1,6 @@
 #pragma once
 
+#include "sky_alpha.h"
 #include "typedef.h"
 #include <string>
 #include <vector>
@@ -65,6 +66,9 @@ class SKY : public Entity
     VDX9RENDER *pRS;
     int32_t TexturesID[SKY_NUM_TEXTURES];
     int32_t TexturesNextID[SKY_NUM_TEXTURES];
+    // alpha of the faces for the sun, read without locking the textures
+    storm::SkyAlphaMap AlphaMaps[SKY_NUM_TEXTURES];
+    storm::SkyAlphaMap AlphaMapsNext[SKY_NUM_TEXTURES];
     float fTimeFactor;
 
     int32_t iSkyVertsID = -1;
@@ -87,5 +91,5 @@ class SKY : public Entity
     void GetSkyDirStrings(std::string &sSkyDir, std::string &sSkyDirNext);
     void UpdateTimeFactor();
 
-    uint32_t GetPixelColor(IDirect3DTexture9 *pTex, float fu, float fv) const;
+    void CopyAlpha(int32_t iTextureID, storm::SkyAlphaMap &map) const;
 };
@@ -0,0 +1,154 @@
+#include "sky_alpha.h"
+
+#include "math_inlines.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace storm
+{
+
+namespace
+{
+template <class T> T read(const uint8_t *bits)
+{
+    T value;
+    std::memcpy(&value, bits, sizeof(T));
+    return value;
+}
+} // namespace
+
+std::vector<uint8_t> SkyAlphaMap::decompress(const uint8_t *bits, uint32_t pitch, uint32_t width, uint32_t height,
+                                             Format format)
+{
+    std::vector<uint8_t> alpha(width * height);
+    const uint32_t blockSize = format == Format::DXT1 ? 8 : 16;
+    for (uint32_t by = 0; by < (height + 3) / 4; by++)
+        for (uint32_t bx = 0; bx < (width + 3) / 4; bx++)
+        {
+            const auto *block = bits + by * pitch + bx * blockSize;
+
+            // the alpha of the 16 texels of the block, rows of 4
+            uint8_t texels[16];
+            if (format == Format::DXT1)
+            {
+                const bool transparent = read<uint16_t>(block) <= read<uint16_t>(block + 2);
+                const auto indices = read<uint32_t>(block + 4);
+                for (uint32_t i = 0; i < 16; i++)
+                    texels[i] = transparent && ((indices >> (i * 2)) & 3) == 3 ? 0 : 255;
+            }
+            else if (format == Format::DXT3)
+            {
+                const auto values = read<uint64_t>(block);
+                for (uint32_t i = 0; i < 16; i++)
+                    texels[i] = static_cast<uint8_t>(((values >> (i * 4)) & 0xF) * 17);
+            }
+            else
+            {
+                const uint32_t a0 = block[0];
+                const uint32_t a1 = block[1];
+                uint8_t palette[8] = {static_cast<uint8_t>(a0), static_cast<uint8_t>(a1)};
+                if (a0 > a1)
+                    for (uint32_t i = 1; i < 7; i++)
+                        palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+                else
+                {
+                    for (uint32_t i = 1; i < 5; i++)
+                        palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+                    palette[6] = 0;
+                    palette[7] = 255;
+                }
+                uint64_t indices = 0;
+                std::memcpy(&indices, block + 2, 6);
+                for (uint32_t i = 0; i < 16; i++)
+                    texels[i] = palette[(indices >> (i * 3)) & 7];
+            }
+
+            // blocks on the right and bottom edges of faces not a multiple of 4 in size
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+                    alpha[(by * 4 + y) * width + bx * 4 + x] = texels[y * 4 + x];
+        }
+    return alpha;
+}
+
+template <class Alpha> void SkyAlphaMap::downsample(uint32_t width, uint32_t height, Alpha alpha)
+{
+    width_ = std::min(width, kMaxSize);
+    height_ = std::min(height, kMaxSize);
+    alpha_.resize(width_ * height_);
+    for (uint32_t y = 0; y < height_; y++)
+    {
+        const auto y0 = y * height / height_;
+        const auto y1 = (y + 1) * height / height_;
+        for (uint32_t x = 0; x < width_; x++)
+        {
+            const auto x0 = x * width / width_;
+            const auto x1 = (x + 1) * width / width_;
+            uint32_t sum = 0;
+            for (auto sy = y0; sy < y1; sy++)
+                for (auto sx = x0; sx < x1; sx++)
+                    sum += alpha(sx, sy);
+            const auto count = (y1 - y0) * (x1 - x0);
+            alpha_[y * width_ + x] = static_cast<uint8_t>((sum + count / 2) / count);
+        }
+    }
+}
+
+void SkyAlphaMap::set(const uint8_t *bits, uint32_t pitch, uint32_t width, uint32_t height, Format format)
+{
+    if (!bits || width == 0 || height == 0)
+    {
+        clear();
+        return;
+    }
+
+    switch (format)
+    {
+    case Format::A8R8G8B8:
+        downsample(width, height, [bits, pitch](uint32_t x, uint32_t y) {
+            return read<uint32_t>(bits + y * pitch + x * 4) >> 24;
+        });
+        break;
+    case Format::A4R4G4B4:
+        downsample(width, height, [bits, pitch](uint32_t x, uint32_t y) {
+            return (read<uint16_t>(bits + y * pitch + x * 2) >> 12) * 17u;
+        });
+        break;
+    case Format::A1R5G5B5:
+        downsample(width, height, [bits, pitch](uint32_t x, uint32_t y) {
+            return (read<uint16_t>(bits + y * pitch + x * 2) & 0x8000) ? 255u : 0u;
+        });
+        break;
+    default: {
+        const auto alpha = decompress(bits, pitch, width, height, format);
+        downsample(width, height, [&alpha, width](uint32_t x, uint32_t y) { return alpha[y * width + x]; });
+        break;
+    }
+    }
+}
+
+void SkyAlphaMap::clear()
+{
+    width_ = height_ = 0;
+    alpha_.clear();
+}
+
+uint8_t SkyAlphaMap::sample(float u, float v) const
+{
+    if (alpha_.empty())
+        return 0xFF;
+
+    const auto x = static_cast<int32_t>(Bring2Range(0.0f, static_cast<float>(width_ - 1), 0.0f,
+                                                    static_cast<float>(width_), width_ * u));
+    const auto y = static_cast<int32_t>(Bring2Range(0.0f, static_cast<float>(height_ - 1), 0.0f,
+                                                    static_cast<float>(height_), height_ * v));
+    return alpha_[y * width_ + x];
+}
+
+float SkyAlphaMap::blend(const SkyAlphaMap &current, const SkyAlphaMap &next, float k, float u, float v)
+{
+    return (1.f - k) * current.sample(u, v) / 255.f + k * next.sample(u, v) / 255.f;
+}
+
+} // namespace storm
@@ -0,0 +1,104 @@
+#include "star_field.h"
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace storm
+{
+
+namespace
+{
+// the least part of the brightness a star keeps at the limit
+constexpr float kFaintest = 0.01f;
+} // namespace
+
+void StarField::clear()
+{
+    size_ = 0;
+    magnitudes_.clear();
+    alphas_.clear();
+    colors_.clear();
+}
+
+void StarField::add(float magnitude, float alpha, uint32_t color)
+{
+    magnitudes_.resize(size_);
+    alphas_.resize(size_);
+    colors_.resize(size_);
+    magnitudes_.push_back(magnitude);
+    alphas_.push_back(alpha);
+    colors_.push_back(color);
+    size_++;
+
+    const auto padded = (size_ + 3) & ~size_t(3);
+    magnitudes_.resize(padded, magnitude);
+    alphas_.resize(padded, 0.0f);
+    colors_.resize(padded, 0);
+}
+
+void StarField::setAlpha(size_t index, float alpha)
+{
+    alphas_[index] = alpha;
+}
+
+size_t StarField::visible(float maxMagnitude) const
+{
+    if (maxMagnitude <= kBrightest)
+        return 0;
+    return std::lower_bound(magnitudes_.begin(), magnitudes_.begin() + size_, maxMagnitude) - magnitudes_.begin();
+}
+
+void StarField::setTwinkle(const float (&waves)[5], const float (&random)[7], float fade)
+{
+    for (size_t i = 0; i < kTwinklePeriod; i++)
+        twinkle_[i] = fade * waves[i % 5] * random[i % 7] * 255.0f;
+}
+
+void StarField::fill(float maxMagnitude, size_t count, uint32_t *colors) const
+{
+    count = std::min(count, size_);
+    if (count == 0 || maxMagnitude <= kBrightest)
+        return;
+
+    // as Bring2Range(1.0, kFaintest, kBrightest, maxMagnitude, magnitude)
+    const auto brightest = _mm_set1_ps(kBrightest);
+    const auto slope = _mm_set1_ps((1.0f - kFaintest) / (maxMagnitude - kBrightest));
+    const auto one = _mm_set1_ps(1.0f);
+
+    size_t t = 0;
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const auto magnitude = _mm_max_ps(_mm_loadu_ps(&magnitudes_[i]), brightest);
+        const auto k = _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(magnitude, brightest), slope));
+        const auto alpha = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(&twinkle_[t]), _mm_loadu_ps(&alphas_[i])), k);
+        const auto color = _mm_or_si128(_mm_slli_epi32(_mm_cvtps_epi32(alpha), 24),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(&colors_[i])));
+        if (i + 4 <= count)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(colors + i), color);
+        }
+        else
+        {
+            alignas(16) uint32_t tail[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(tail), color);
+            std::memcpy(colors + i, tail, (count - i) * sizeof(uint32_t));
+        }
+
+        t += 4;
+        if (t == kTwinklePeriod)
+            t = 0;
+    }
+}
+
+bool StarField::sameColors(float maxMagnitude1, float maxMagnitude2)
+{
+    const auto lo = std::min(maxMagnitude1, maxMagnitude2);
+    const auto hi = std::max(maxMagnitude1, maxMagnitude2);
+    if (lo <= kBrightest)
+        return lo == hi;
+    // a star seen with both limits changes the most when it is at the lower one
+    return 255.0f * (1.0f - kFaintest) * (hi - lo) / (hi - kBrightest) < 0.5f;
+}
+
+} // namespace storm
@@ -16,7 +16,11 @@ Astronomy::STARS::STARS()
     iTexture = -1;
     iVertexBuffer = -1;
     iVertexBufferColors = -1;
-    fPrevFov = -1.0f;
+    eidWeather = {};
+
+    bUpdateColors = true;
+    fColorsMagnitude = 0.0f;
+    dwColorsCount = 0;
 
     fFadeValue = 1.f;
     fFadeTimeStart = -1.f;
@@ -42,6 +46,7 @@ Astronomy::STARS::~STARS()
 void Astronomy::STARS::Init(ATTRIBUTES *pAP)
 {
     aStars.clear();
+    Field.clear();
 
     if (iTexture >= 0)
         pRS->TextureRelease(iTexture);
@@ -97,7 +102,8 @@ void Astronomy::STARS::Init(ATTRIBUTES *pAP)
     fFadeTimeStart = pAP->GetAttributeAsFloat("FadeStartTime", -1.f);
     fFadeTime = pAP->GetAttributeAsFloat("FadeTime", 0.2f);
 
-    fPrevFov = -1.0f;
+    bUpdateColors = true;
+    dwColorsCount = 0;
 
     // if (!bEnable) return;
 
@@ -223,6 +229,15 @@ void Astronomy::STARS::Init(ATTRIBUTES *pAP)
             }
         }
 
+        // the brightest stars first, so a field of view draws the first of them
+        std::stable_sort(aStars.begin(), aStars.end(), [](const Star &a, const Star &b) { return a.fMag < b.fMag; });
+        for (uint32_t i = 0; i < aStars.size(); i++)
+        {
+            const auto &s = aStars[i];
+            pVPos[i] = fRadius * s.vPos;
+            Field.add(s.fMag, s.fAlpha, s.dwColor);
+        }
+
         pRS->UnLockVertexBuffer(iVertexBuffer);
         pRS->UnLockVertexBuffer(iVertexBufferColors);
         fio->_CloseFile(fileS);
@@ -236,11 +251,12 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
     {
         if ((fFadeTime > 0.f && fFadeValue < 1.f) || (fFadeTime < 0.f && fFadeValue > 0.f))
         {
-            entid_t eid;
-            if (eid = core.GetEntityId("weather"))
+            auto *pWeather = static_cast<WEATHER_BASE *>(core.GetEntityPointerSafe(eidWeather));
+            if (!pWeather && (eidWeather = core.GetEntityId("weather")))
+                pWeather = static_cast<WEATHER_BASE *>(core.GetEntityPointer(eidWeather));
+            if (pWeather)
             {
-                auto fTime =
-                    static_cast<WEATHER_BASE *>(core.GetEntityPointer(eid))->GetFloat(whf_time_counter);
+                auto fTime = pWeather->GetFloat(whf_time_counter);
                 if (fTime > fFadeTimeStart)
                 {
                     auto fOldFadeValue = fFadeValue;
@@ -255,7 +271,7 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
                         fFadeValue = 1.f;
 
                     if (static_cast<int32_t>(20.f * fOldFadeValue) != static_cast<int32_t>(20.f * fFadeValue))
-                        fPrevFov = -1.f;
+                        bUpdateColors = true;
 
                     bEnable = fFadeValue > 0.f;
                 }
@@ -279,7 +295,9 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
 
     auto fMaxMag = Bring2Range(fTelescopeMagnitude, fVisualMagnitude, 0.14f, 1.285f, fFov);
 
-    if (fabsf(fFov - fPrevFov) > 1e-5f)
+    // a change of the view draws more or less of the stars, the colours are only written when an alpha changes
+    const auto dwVisible = Field.visible(fMaxMag);
+    if (bUpdateColors || dwVisible > dwColorsCount || !storm::StarField::sameColors(fColorsMagnitude, fMaxMag))
     {
         float fTmpK[5];
         float fTmpRnd[7];
@@ -293,21 +311,21 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
         fTmpK[4] = 0.85f + 0.15f * sinf(m_fTwinklingTime * 7.f);
         for (int32_t n = 0; n < 7; n++)
             fTmpRnd[n] = 0.8f + FRAND(0.2f);
-        auto *pVColors = static_cast<uint32_t *>(pRS->LockVertexBuffer(iVertexBufferColors, D3DLOCK_DISCARD));
-        auto size = aStars.size();
-        for (uint32_t i = 0; i < size; i++)
+        Field.setTwinkle(fTmpK, fTmpRnd, fFadeValue);
+        if (auto *pVColors = static_cast<uint32_t *>(pRS->LockVertexBuffer(iVertexBufferColors, D3DLOCK_DISCARD)))
         {
-            auto &s = aStars[i];
-
-            auto fAlpha = fFadeValue * fTmpK[i % 5] * fTmpRnd[i % 7] * s.fAlpha * 255.0f *
-                          Bring2Range(1.0f, 0.01f, -2.0f, fMaxMag, s.fMag);
+            Field.fill(fMaxMag, dwVisible, pVColors);
+            pRS->UnLockVertexBuffer(iVertexBufferColors);
 
-            uint32_t dwAlpha = ftoi(fAlpha);
-            pVColors[i] = (dwAlpha << 24L) | s.dwColor;
+            bUpdateColors = false;
+            fColorsMagnitude = fMaxMag;
+            dwColorsCount = dwVisible;
         }
-        pRS->UnLockVertexBuffer(iVertexBufferColors);
     }
 
+    if (dwVisible == 0 || bUpdateColors)
+        return;
+
     pRS->SetRenderState(D3DRS_POINTSPRITEENABLE, true);
     pRS->SetRenderState(D3DRS_POINTSCALEENABLE, true);
     pRS->SetRenderState(D3DRS_POINTSIZE, F2DW(fSize));
@@ -327,7 +345,7 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
     if (pRS->TechniqueExecuteStart("stars"))
         do
         {
-            pRS->DrawPrimitive(D3DPT_POINTLIST, 0, aStars.size());
+            pRS->DrawPrimitive(D3DPT_POINTLIST, 0, static_cast<uint32_t>(dwVisible));
         } while (pRS->TechniqueExecuteNext());
 
     pRS->SetRenderState(D3DRS_POINTSPRITEENABLE, false);
@@ -423,8 +441,6 @@ void Astronomy::STARS::Realize(double dDeltaTime, double dHour)
     }*/
     // RDTSC_E(dw1);
 
-    fPrevFov = fFov;
-
     // core.Trace("RDTSC = %d", dw1);
     // Astronomy::pRS->SetTransform(D3DTS_VIEW, mView);
 }
@@ -468,13 +484,14 @@ void Astronomy::STARS::TimeUpdate(ATTRIBUTES *pAP)
         return;
     }
 
-    fPrevFov = -1.0f;
+    bUpdateColors = true;
     for (uint32_t i = 0; i < aStars.size(); i++)
     {
         auto &s = aStars[i];
         const auto vPos = fRadius * s.vPos;
         s.fAlpha = (vPos.y < fHeightFade) ? Clamp(vPos.y / fHeightFade) : 1.0f;
         pVPos[i] = vPos;
+        Field.setAlpha(i, s.fAlpha);
     }
 
     pRS->UnLockVertexBuffer(iVertexBuffer);
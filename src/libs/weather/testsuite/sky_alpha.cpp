@@ -0,0 +1,300 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "sky_alpha.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+// a locked face: 32 bit texels in rows of pitch bytes
+struct Face
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    std::vector<uint8_t> bits;
+
+    uint32_t &texel(uint32_t x, uint32_t y)
+    {
+        return reinterpret_cast<uint32_t *>(bits.data() + y * pitch)[x];
+    }
+};
+
+template <class Alpha> Face MakeFace(uint32_t width, uint32_t height, uint32_t padding, Alpha alpha)
+{
+    Face face{width, height, width * 4 + padding, {}};
+    face.bits.resize(face.pitch * height);
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            face.texel(x, y) = (alpha(x, y) << 24) | 0x00C08040;
+    return face;
+}
+
+// the texel SKY::GetPixelColor read from the locked texture
+uint32_t GetPixelColor(Face &face, float fu, float fv)
+{
+    auto clamp = [](float value, float max) { return value < 0.0f ? 0.0f : (value > max ? max : value); };
+    const auto x = static_cast<int32_t>(clamp(face.width * fu, static_cast<float>(face.width)) /
+                                        static_cast<float>(face.width) * static_cast<float>(face.width - 1));
+    const auto y = static_cast<int32_t>(clamp(face.height * fv, static_cast<float>(face.height)) /
+                                        static_cast<float>(face.height) * static_cast<float>(face.height - 1));
+    return face.texel(x, y);
+}
+
+} // namespace
+
+TEST_CASE("Sky alpha map reads the texels of small faces", "[weather]")
+{
+    std::mt19937 gen(95);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+    std::uniform_real_distribution<float> coord(-0.2f, 1.2f);
+
+    // width, height and the bytes the rows are padded with
+    const std::tuple<uint32_t, uint32_t, uint32_t> sizes[] = {{64, 64, 0}, {37, 20, 12}, {1, 1, 0}, {16, 64, 4}};
+    for (const auto &[width, height, padding] : sizes)
+    {
+        auto face = MakeFace(width, height, padding, [&](uint32_t, uint32_t) { return byte(gen); });
+        storm::SkyAlphaMap map;
+        map.set(face.bits.data(), face.pitch, width, height);
+        REQUIRE(map.width() == width);
+        REQUIRE(map.height() == height);
+
+        for (int32_t i = 0; i < 2000; i++)
+        {
+            const auto u = coord(gen);
+            const auto v = coord(gen);
+            REQUIRE(map.sample(u, v) == GetPixelColor(face, u, v) >> 24);
+        }
+        CHECK(map.sample(0.0f, 0.0f) == face.texel(0, 0) >> 24);
+        CHECK(map.sample(1.0f, 1.0f) == face.texel(width - 1, height - 1) >> 24);
+    }
+}
+
+TEST_CASE("Sky alpha map keeps large faces downsampled", "[weather]")
+{
+    // clouds as large spots, a texel of the map covers 4 by 8 of the face
+    auto face = MakeFace(256, 512, 0, [](uint32_t x, uint32_t y) { return (x / 64 + y / 128) % 2 ? 255u : 0u; });
+    storm::SkyAlphaMap map;
+    map.set(face.bits.data(), face.pitch, 256, 512);
+    CHECK(map.width() == storm::SkyAlphaMap::kMaxSize);
+    CHECK(map.height() == storm::SkyAlphaMap::kMaxSize);
+
+    // the same away from the edges of the spots
+    std::mt19937 gen(951);
+    std::uniform_real_distribution<float> coord(0.0f, 1.0f);
+    size_t checked = 0;
+    for (int32_t i = 0; i < 5000; i++)
+    {
+        const auto u = coord(gen);
+        const auto v = coord(gen);
+        const auto du = u * 4.0f - static_cast<int32_t>(u * 4.0f);
+        const auto dv = v * 4.0f - static_cast<int32_t>(v * 4.0f);
+        if (du < 0.05f || du > 0.95f || dv < 0.05f || dv > 0.95f)
+            continue;
+        REQUIRE(map.sample(u, v) == GetPixelColor(face, u, v) >> 24);
+        checked++;
+    }
+    CHECK(checked > 3000);
+
+    // a gradient is averaged, a texel of the map is 4 steps of it
+    face = MakeFace(1024, 128, 8, [](uint32_t x, uint32_t) { return x / 4; });
+    map.set(face.bits.data(), face.pitch, 1024, 128);
+    for (auto u = 0.0f; u <= 1.0f; u += 0.01f)
+        CHECK(std::abs(static_cast<int32_t>(map.sample(u, 0.5f)) -
+                       static_cast<int32_t>(GetPixelColor(face, u, 0.5f) >> 24)) <= 8);
+}
+
+TEST_CASE("Sky alpha map blends the current and the next faces", "[weather]")
+{
+    auto current = MakeFace(8, 8, 0, [](uint32_t x, uint32_t) { return x * 32; });
+    auto next = MakeFace(8, 8, 0, [](uint32_t, uint32_t y) { return 255 - y * 32; });
+    storm::SkyAlphaMap currentMap;
+    storm::SkyAlphaMap nextMap;
+    currentMap.set(current.bits.data(), current.pitch, 8, 8);
+    nextMap.set(next.bits.data(), next.pitch, 8, 8);
+
+    std::mt19937 gen(952);
+    std::uniform_real_distribution<float> coord(0.0f, 1.0f);
+    for (int32_t i = 0; i < 500; i++)
+    {
+        const auto u = coord(gen);
+        const auto v = coord(gen);
+        const auto k = coord(gen);
+        const auto col1 = GetPixelColor(current, u, v);
+        const auto col2 = GetPixelColor(next, u, v);
+        const auto expected = (1.f - k) * (col1 >> 24) / 255.f + k * (col2 >> 24) / 255.f;
+        REQUIRE(storm::SkyAlphaMap::blend(currentMap, nextMap, k, u, v) == Approx(expected));
+    }
+
+    // without a next sky the blend goes to opaque, as with no texture to lock
+    storm::SkyAlphaMap none;
+    CHECK(none.empty());
+    CHECK(none.sample(0.5f, 0.5f) == 255);
+    CHECK(storm::SkyAlphaMap::blend(currentMap, none, 0.0f, 1.0f, 0.0f) == Approx(224.f / 255.f));
+    CHECK(storm::SkyAlphaMap::blend(currentMap, none, 1.0f, 1.0f, 0.0f) == Approx(1.0f));
+
+    currentMap.set(nullptr, 0, 8, 8);
+    CHECK(currentMap.empty());
+}
+
+TEST_CASE("Sky alpha map reads 16 bit and DXT faces", "[weather]")
+{
+    std::mt19937 gen(953);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+    std::uniform_real_distribution<float> coord(-0.2f, 1.2f);
+
+    // the 16 bit and DXT faces against 32 bit faces with the alpha they hold
+    const auto check = [&](const std::vector<uint8_t> &bits, uint32_t pitch, uint32_t width, uint32_t height,
+                           storm::SkyAlphaMap::Format format, const std::vector<uint32_t> &alpha) {
+        auto face = MakeFace(width, height, 0, [&](uint32_t x, uint32_t y) { return alpha[y * width + x]; });
+        storm::SkyAlphaMap map;
+        map.set(bits.data(), pitch, width, height, format);
+        REQUIRE(map.width() == width);
+        REQUIRE(map.height() == height);
+        for (int32_t i = 0; i < 2000; i++)
+        {
+            const auto u = coord(gen);
+            const auto v = coord(gen);
+            REQUIRE(map.sample(u, v) == GetPixelColor(face, u, v) >> 24);
+        }
+    };
+
+    SECTION("16 bit")
+    {
+        constexpr uint32_t width = 9, height = 7, pitch = width * 2 + 6;
+        std::vector<uint8_t> bits4444(pitch * height), bits1555(pitch * height);
+        std::vector<uint32_t> alpha4444(width * height), alpha1555(width * height);
+        for (uint32_t y = 0; y < height; y++)
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const auto texel = static_cast<uint16_t>(byte(gen) << 8 | byte(gen));
+                std::memcpy(&bits4444[y * pitch + x * 2], &texel, 2);
+                std::memcpy(&bits1555[y * pitch + x * 2], &texel, 2);
+                alpha4444[y * width + x] = (texel >> 12) * 17;
+                alpha1555[y * width + x] = texel & 0x8000 ? 255 : 0;
+            }
+        check(bits4444, pitch, width, height, storm::SkyAlphaMap::Format::A4R4G4B4, alpha4444);
+        check(bits1555, pitch, width, height, storm::SkyAlphaMap::Format::A1R5G5B5, alpha1555);
+    }
+
+    // sizes not a multiple of 4 end in part blocks
+    for (const auto &[width, height] : {std::pair{8u, 8u}, std::pair{10u, 5u}, std::pair{3u, 2u}})
+    {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+
+        SECTION("DXT1 " + std::to_string(width) + "x" + std::to_string(height))
+        {
+            const uint32_t pitch = blocksX * 8;
+            std::vector<uint8_t> bits(pitch * blocksY);
+            std::vector<uint32_t> alpha(width * height);
+            for (uint32_t b = 0; b < blocksX * blocksY; b++)
+            {
+                auto *block = &bits[b * 8];
+                // every other block has the transparent index
+                const auto color0 = static_cast<uint16_t>(b % 2 ? 0x1234 : 0xF234);
+                const auto color1 = static_cast<uint16_t>(0x8234);
+                uint32_t indices = 0;
+                for (uint32_t i = 0; i < 4; i++)
+                    indices |= byte(gen) << (i * 8);
+                std::memcpy(block, &color0, 2);
+                std::memcpy(block + 2, &color1, 2);
+                std::memcpy(block + 4, &indices, 4);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const auto x = b % blocksX * 4 + i % 4;
+                    const auto y = b / blocksX * 4 + i / 4;
+                    if (x < width && y < height)
+                        alpha[y * width + x] = color0 <= color1 && (indices >> (i * 2) & 3) == 3 ? 0 : 255;
+                }
+            }
+            check(bits, pitch, width, height, storm::SkyAlphaMap::Format::DXT1, alpha);
+        }
+
+        SECTION("DXT3 " + std::to_string(width) + "x" + std::to_string(height))
+        {
+            const uint32_t pitch = blocksX * 16;
+            std::vector<uint8_t> bits(pitch * blocksY);
+            std::vector<uint32_t> alpha(width * height);
+            for (uint32_t b = 0; b < blocksX * blocksY; b++)
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const auto value = byte(gen) & 0xF;
+                    bits[b * 16 + i / 2] |= static_cast<uint8_t>(value << (i % 2 * 4));
+                    const auto x = b % blocksX * 4 + i % 4;
+                    const auto y = b / blocksX * 4 + i / 4;
+                    if (x < width && y < height)
+                        alpha[y * width + x] = value * 17;
+                }
+            check(bits, pitch, width, height, storm::SkyAlphaMap::Format::DXT3, alpha);
+        }
+
+        SECTION("DXT5 " + std::to_string(width) + "x" + std::to_string(height))
+        {
+            const uint32_t pitch = blocksX * 16;
+            std::vector<uint8_t> bits(pitch * blocksY);
+            std::vector<uint32_t> alpha(width * height);
+            for (uint32_t b = 0; b < blocksX * blocksY; b++)
+            {
+                // both palette modes, a0 > a1 interpolates 6 values, else 4 and 0 and 255
+                const auto a0 = byte(gen);
+                const auto a1 = byte(gen);
+                std::vector<uint32_t> palette = {a0, a1};
+                if (a0 > a1)
+                    for (int32_t i = 1; i < 7; i++)
+                        palette.push_back(static_cast<uint32_t>(std::lround(((7 - i) * a0 + i * a1) / 7.0)));
+                else
+                {
+                    for (int32_t i = 1; i < 5; i++)
+                        palette.push_back(static_cast<uint32_t>(std::lround(((5 - i) * a0 + i * a1) / 5.0)));
+                    palette.push_back(0);
+                    palette.push_back(255);
+                }
+
+                bits[b * 16] = static_cast<uint8_t>(a0);
+                bits[b * 16 + 1] = static_cast<uint8_t>(a1);
+                uint64_t indices = 0;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const uint64_t index = byte(gen) & 7;
+                    indices |= index << (i * 3);
+                    const auto x = b % blocksX * 4 + i % 4;
+                    const auto y = b / blocksX * 4 + i / 4;
+                    if (x < width && y < height)
+                        alpha[y * width + x] = palette[index];
+                }
+                std::memcpy(&bits[b * 16 + 2], &indices, 6);
+            }
+            check(bits, pitch, width, height, storm::SkyAlphaMap::Format::DXT5, alpha);
+        }
+    }
+}
+
+TEST_CASE("Sky alpha map benchmark", "[.][weather][benchmark]")
+{
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+    auto face = MakeFace(512, 512, 0, [&](uint32_t, uint32_t) { return byte(gen); });
+    storm::SkyAlphaMap map;
+    BENCHMARK("copy a 512 face")
+    {
+        map.set(face.bits.data(), face.pitch, 512, 512);
+        return map.width();
+    };
+    BENCHMARK("blend 1000 samples")
+    {
+        auto sum = 0.0f;
+        for (int32_t i = 0; i < 1000; i++)
+            sum += storm::SkyAlphaMap::blend(map, map, 0.3f, i / 1000.0f, 1.0f - i / 1000.0f);
+        return sum;
+    };
+}
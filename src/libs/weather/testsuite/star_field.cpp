@@ -0,0 +1,205 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "star_field.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+struct Star
+{
+    float fMag;
+    float fAlpha;
+    uint32_t dwColor;
+};
+
+float Bring2Range(float Min1, float Max1, float Min2, float Max2, float Value)
+{
+    Value = std::clamp(Value, Min2, Max2);
+    return Min1 + (Value - Min2) / (Max2 - Min2) * (Max1 - Min1);
+}
+
+float MaxMagnitude(float fov)
+{
+    return Bring2Range(13.0f, 8.5f, 0.14f, 1.285f, fov);
+}
+
+// what STARS::Realize wrote for every star of the catalog when the field of view changed
+uint32_t OldColor(const Star &s, uint32_t i, const float (&k)[5], const float (&rnd)[7], float fade, float maxMag)
+{
+    const auto fAlpha =
+        fade * k[i % 5] * rnd[i % 7] * s.fAlpha * 255.0f * Bring2Range(1.0f, 0.01f, -2.0f, maxMag, s.fMag);
+    return (static_cast<uint32_t>(std::lrintf(fAlpha)) << 24) | s.dwColor;
+}
+
+// a catalog, most of the stars faint, in the order of magnitude
+std::vector<Star> Catalog(std::mt19937 &gen, size_t count)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> color(0, 0xFFFFFF);
+    std::vector<Star> stars;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto alpha = unit(gen);
+        stars.push_back({-1.5f + 15.0f * std::sqrt(unit(gen)), alpha < 0.2f ? alpha * 5.0f : 1.0f, color(gen)});
+    }
+    std::stable_sort(stars.begin(), stars.end(), [](const Star &a, const Star &b) { return a.fMag < b.fMag; });
+    return stars;
+}
+
+storm::StarField Field(const std::vector<Star> &stars)
+{
+    storm::StarField field;
+    for (const auto &s : stars)
+        field.add(s.fMag, s.fAlpha, s.dwColor);
+    return field;
+}
+
+struct Twinkle
+{
+    float k[5];
+    float rnd[7];
+};
+
+Twinkle MakeTwinkle(std::mt19937 &gen)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Twinkle twinkle{};
+    for (auto &k : twinkle.k)
+        k = 0.4f + 0.6f * unit(gen);
+    for (auto &rnd : twinkle.rnd)
+        rnd = 0.8f + 0.2f * unit(gen);
+    return twinkle;
+}
+
+} // namespace
+
+TEST_CASE("Star field sees the stars of the field of view", "[weather]")
+{
+    std::mt19937 gen(97);
+    for (const auto count : {0, 1, 3, 4, 5, 139, 4097})
+    {
+        const auto stars = Catalog(gen, count);
+        auto field = Field(stars);
+        REQUIRE(field.size() == stars.size());
+
+        const auto twinkle = MakeTwinkle(gen);
+        const auto fade = count % 2 ? 1.0f : 0.55f;
+        field.setTwinkle(twinkle.k, twinkle.rnd, fade);
+
+        std::vector<uint32_t> colors(stars.size() + 1, 0xDEADBEEF);
+        for (auto fov = 0.05f; fov < 1.5f; fov += 0.01f)
+        {
+            const auto maxMag = MaxMagnitude(fov);
+            const auto visible = field.visible(maxMag);
+            field.fill(maxMag, visible, colors.data());
+            // nothing past the stars is written
+            REQUIRE(colors.back() == 0xDEADBEEF);
+
+            for (uint32_t i = 0; i < stars.size(); i++)
+            {
+                // more than the least brightness before the limit
+                const auto seen = Bring2Range(1.0f, 0.01f, -2.0f, maxMag, stars[i].fMag) > 0.01f;
+                REQUIRE(seen == (i < visible));
+                if (!seen)
+                    continue;
+                const auto expected = OldColor(stars[i], i, twinkle.k, twinkle.rnd, fade, maxMag);
+                REQUIRE((colors[i] & 0xFFFFFF) == (expected & 0xFFFFFF));
+                REQUIRE(std::abs(static_cast<int32_t>(colors[i] >> 24) - static_cast<int32_t>(expected >> 24)) <= 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Star field keeps colours while the limit moves by less than a step", "[weather]")
+{
+    std::mt19937 gen(971);
+    const auto stars = Catalog(gen, 2000);
+    auto field = Field(stars);
+    const auto twinkle = MakeTwinkle(gen);
+    field.setTwinkle(twinkle.k, twinkle.rnd, 1.0f);
+
+    std::uniform_real_distribution<float> magnitude(8.5f, 13.0f);
+    std::uniform_real_distribution<float> shift(-0.05f, 0.05f);
+    std::vector<uint32_t> colors1(stars.size());
+    std::vector<uint32_t> colors2(stars.size());
+    size_t same = 0;
+    for (int32_t i = 0; i < 500; i++)
+    {
+        const auto maxMag1 = magnitude(gen);
+        const auto maxMag2 = maxMag1 + (i % 10 ? shift(gen) * 0.1f : shift(gen));
+        CHECK(storm::StarField::sameColors(maxMag1, maxMag2) == storm::StarField::sameColors(maxMag2, maxMag1));
+        if (!storm::StarField::sameColors(maxMag1, maxMag2))
+            continue;
+        same++;
+        const auto visible = std::min(field.visible(maxMag1), field.visible(maxMag2));
+        field.fill(maxMag1, visible, colors1.data());
+        field.fill(maxMag2, visible, colors2.data());
+        for (size_t n = 0; n < visible; n++)
+            REQUIRE(std::abs(static_cast<int32_t>(colors1[n] >> 24) - static_cast<int32_t>(colors2[n] >> 24)) <= 1);
+    }
+    CHECK(same > 250);
+    CHECK(storm::StarField::sameColors(10.0f, 10.0f));
+    CHECK_FALSE(storm::StarField::sameColors(8.5f, 13.0f));
+
+    // the height fade of a star changes alone
+    field.setAlpha(0, 0.0f);
+    field.fill(13.0f, 1, colors1.data());
+    CHECK(colors1[0] == stars[0].dwColor);
+}
+
+TEST_CASE("Star field benchmark", "[.][weather][benchmark]")
+{
+    std::mt19937 gen(1);
+    const auto stars = Catalog(gen, 16384);
+    auto field = Field(stars);
+    const auto twinkle = MakeTwinkle(gen);
+    field.setTwinkle(twinkle.k, twinkle.rnd, 1.0f);
+    std::vector<uint32_t> colors(stars.size());
+
+    // a spyglass held at the eye: the field of view sways a little every frame
+    std::uniform_real_distribution<float> sway(-0.002f, 0.002f);
+    size_t written = 0;
+    size_t rewrites = 0;
+    auto colorsMag = -100.0f;
+    for (int32_t frame = 0; frame < 600; frame++)
+    {
+        const auto maxMag = MaxMagnitude(0.5f + sway(gen));
+        const auto visible = field.visible(maxMag);
+        if (visible > written || !storm::StarField::sameColors(colorsMag, maxMag))
+        {
+            written = visible;
+            colorsMag = maxMag;
+            rewrites++;
+        }
+    }
+    WARN("16384 stars, visible " << field.visible(MaxMagnitude(1.285f)) << " to " << field.visible(MaxMagnitude(0.14f))
+                                 << ", colour rewrites in 600 frames of a swaying spyglass " << rewrites);
+
+    BENCHMARK("old colours of 16384 stars")
+    {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < stars.size(); i++)
+            sum += colors[i] = OldColor(stars[i], i, twinkle.k, twinkle.rnd, 1.0f, 8.5f);
+        return sum;
+    };
+    BENCHMARK("fill the visible stars")
+    {
+        field.fill(8.5f, field.visible(8.5f), colors.data());
+        return colors[0];
+    };
+    BENCHMARK("visible count of 100 fields of view")
+    {
+        size_t sum = 0;
+        for (int32_t i = 0; i < 100; i++)
+            sum += field.visible(MaxMagnitude(0.14f + i * 0.0114f));
+        return sum;
+    };
+}
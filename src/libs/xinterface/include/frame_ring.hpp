@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace storm
+{
+
+/**
+ * \brief Small ring of frames decoded ahead of presentation by a worker thread
+ * \tparam Frame - decoded frame storage, reused between decodes
+ * \tparam SIZE - number of frames held in flight
+ *
+ * The decoder callback runs on the worker and fills the frame passed to it, returning false at the end of the
+ * stream. Frames get presentation times from their index and the frame duration, the consumer picks the newest
+ * frame which is due at the given playback time. The frame returned by acquire() stays valid until the next
+ * acquire() or stop().
+ *
+ * A stream bound to the thread that made it, like a COM one, is opened and closed by the worker as well: the open
+ * callback runs before the first decode and gives the frame duration, the close callback runs when the worker exits,
+ * also after a failed open.
+ */
+template <typename Frame, size_t SIZE = 4> class FrameDecodeRing final
+{
+    static_assert(SIZE >= 2, "the ring needs a presented frame and at least one frame in flight");
+
+  public:
+    using clock = std::chrono::steady_clock;
+    using decoder_type = std::function<bool(Frame &)>;
+    using open_type = std::function<bool(clock::duration &frame_duration)>;
+    using close_type = std::function<void()>;
+
+    FrameDecodeRing() = default;
+    FrameDecodeRing(const FrameDecodeRing &) = delete;
+    FrameDecodeRing &operator=(const FrameDecodeRing &) = delete;
+
+    ~FrameDecodeRing()
+    {
+        stop();
+    }
+
+    void start(decoder_type decoder, clock::duration frame_duration)
+    {
+        start(
+            [frame_duration](clock::duration &duration) {
+                duration = frame_duration;
+                return true;
+            },
+            std::move(decoder), {});
+    }
+
+    /**
+     * \brief Starts the worker and waits for it to open the stream
+     * \return false if the stream could not be opened, the ring is at the end of the stream then
+     */
+    bool start(open_type open, decoder_type decoder, close_type close)
+    {
+        stop();
+
+        open_ = std::move(open);
+        decoder_ = std::move(decoder);
+        close_ = std::move(close);
+        frameDuration_ = {};
+        head_ = 0;
+        count_ = 0;
+        decoded_ = 0;
+        presented_ = -1;
+        endOfStream_ = false;
+        stop_ = false;
+        opening_ = true;
+
+        worker_ = std::thread([this] { decodeThread(); });
+
+        std::unique_lock lock(mtx_);
+        cv_.wait(lock, [this] { return !opening_; });
+        return opened_;
+    }
+
+    void stop()
+    {
+        if (!worker_.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+
+    /**
+     * \brief Returns the newest frame due at playback time, or nullptr if it was already returned or is not decoded
+     */
+    const Frame *acquire(clock::duration playback_time)
+    {
+        bool freed = false;
+        const Frame *frame = nullptr;
+        {
+            std::lock_guard lock(mtx_);
+            // drop frames which are already overdue
+            while (count_ >= 2 && due(slots_[next(head_)], playback_time))
+            {
+                head_ = next(head_);
+                --count_;
+                freed = true;
+            }
+
+            if (count_ > 0 && due(slots_[head_], playback_time) && slots_[head_].index != presented_)
+            {
+                presented_ = slots_[head_].index;
+                frame = &slots_[head_].frame;
+            }
+        }
+
+        if (freed)
+        {
+            cv_.notify_all();
+        }
+        return frame;
+    }
+
+    /**
+     * \brief True when the decoder reached the end of the stream and the last frame is due
+     */
+    bool finished(clock::duration playback_time) const
+    {
+        std::lock_guard lock(mtx_);
+        return endOfStream_ && playback_time >= frameDuration_ * decoded_;
+    }
+
+    [[nodiscard]] size_t buffered() const
+    {
+        std::lock_guard lock(mtx_);
+        return count_;
+    }
+
+    /**
+     * \brief Blocks until the worker decoded the given number of frames since start() or reached the end of the stream
+     */
+    void waitDecoded(int64_t frames)
+    {
+        if (!worker_.joinable())
+        {
+            return;
+        }
+
+        std::unique_lock lock(mtx_);
+        cv_.wait(lock, [this, frames] { return endOfStream_ || decoded_ >= frames; });
+    }
+
+  private:
+    struct Slot
+    {
+        Frame frame{};
+        int64_t index{};
+    };
+
+    static constexpr size_t next(size_t idx)
+    {
+        return (idx + 1) % SIZE;
+    }
+
+    bool due(const Slot &slot, clock::duration playback_time) const
+    {
+        return frameDuration_ * slot.index <= playback_time;
+    }
+
+    void decodeThread()
+    {
+        clock::duration frame_duration{};
+        const bool opened = open_(frame_duration);
+        {
+            std::lock_guard lock(mtx_);
+            frameDuration_ = frame_duration;
+            endOfStream_ = !opened;
+            opened_ = opened;
+            opening_ = false;
+        }
+        cv_.notify_all();
+
+        if (opened)
+        {
+            decodeFrames();
+        }
+        if (close_)
+        {
+            close_();
+        }
+    }
+
+    void decodeFrames()
+    {
+        for (;;)
+        {
+            size_t slot_idx;
+            {
+                std::unique_lock lock(mtx_);
+                cv_.wait(lock, [this] { return stop_ || count_ < SIZE; });
+                if (stop_)
+                {
+                    return;
+                }
+                slot_idx = (head_ + count_) % SIZE;
+            }
+
+            // the slot is outside of the consumer range, so it can be filled without the lock
+            auto &slot = slots_[slot_idx];
+            const bool decoded = decoder_(slot.frame);
+
+            {
+                std::lock_guard lock(mtx_);
+                if (decoded)
+                {
+                    slot.index = decoded_++;
+                    ++count_;
+                }
+                else
+                {
+                    endOfStream_ = true;
+                }
+            }
+            cv_.notify_all();
+
+            if (!decoded)
+            {
+                return;
+            }
+        }
+    }
+
+    std::array<Slot, SIZE> slots_{};
+    size_t head_{};
+    size_t count_{};
+    int64_t decoded_{};
+    int64_t presented_{-1};
+    bool endOfStream_{};
+    bool stop_{};
+    bool opening_{};
+    bool opened_{};
+
+    open_type open_;
+    decoder_type decoder_;
+    close_type close_;
+    clock::duration frameDuration_{};
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread worker_;
+};
+
+} // namespace storm
@@ -43,6 +43,7 @@ CAviPlayer::CAviPlayer()
     pTex = nullptr;
     m_bFirstDraw = true;
     m_bMakeUninitializeDD = false;
+    m_bHaveFrame = false;
 }
 
 CAviPlayer::~CAviPlayer()
@@ -65,12 +66,6 @@ bool CAviPlayer::Init()
     core.SetLayerType(VIDEO_EXECUTE, layer_type_t::execute);
     core.AddToLayer(VIDEO_EXECUTE, GetId(), 1);
 
-    if (!GetInterfaces())
-    {
-        m_bContinue = false;
-        CleanupInterfaces();
-    }
-
     return true;
 }
 
@@ -78,10 +73,6 @@ void CAviPlayer::Execute(uint32_t delta_time)
 {
     if (m_bContinue == false)
     {
-#ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
-        if (pAMStream != nullptr)
-            pAMStream->SetState(STREAMSTATE_STOP);
-#endif
         CleanupInterfaces();
         core.Event("ievntEndVideo");
     }
@@ -92,11 +83,7 @@ void CAviPlayer::Realize(uint32_t delta_time)
     //~!~
     // rs->BeginScene();
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
-    int i;
-    HRESULT hr;
-    DDSURFACEDESC ddsd;
-    ddsd.dwSize = sizeof(ddsd);
-    if (pSample == nullptr)
+    if (pTex == nullptr)
     {
         m_bContinue = false;
         return;
@@ -108,49 +95,34 @@ void CAviPlayer::Realize(uint32_t delta_time)
         m_bFirstDraw = false;
     }
 
-    hr = pSample->Update(0, nullptr, nullptr, NULL);
-    if (hr == S_OK)
+    // frames are decoded ahead by the worker, here is at most one texture upload per render frame
+    const auto playbackTime = std::chrono::steady_clock::now() - m_playbackStart;
+    if (const auto *frame = m_decodeRing.acquire(playbackTime))
     {
-        hr = pVideoSurface->Lock(nullptr, &ddsd, 0, nullptr);
-        if (hr != S_OK)
-            return;
-
-        D3DLOCKED_RECT d3dlkRect;
-        hr = pTex->LockRect(0, &d3dlkRect, &lockRect, 0);
-        if (hr != S_OK)
-            return;
-
-        auto nPitch = d3dlkRect.Pitch;
-        auto *pOutData = static_cast<char *>(d3dlkRect.pBits);
-        auto *pInData = static_cast<char *>(ddsd.lpSurface);
-        const auto copySize = ddsd.lPitch < d3dlkRect.Pitch ? ddsd.lPitch : d3dlkRect.Pitch;
-        for (i = 0; i < static_cast<int>(ddsd.dwHeight); i++)
-        {
-            memcpy(pOutData, pInData, copySize);
-            pInData += ddsd.lPitch;
-            pOutData += d3dlkRect.Pitch;
-        }
-
-        pTex->UnlockRect(0);
-        pVideoSurface->Unlock(nullptr);
+        UploadFrame(*frame);
+    }
 
-        if (m_bShowVideo)
+    if (m_decodeRing.finished(playbackTime))
+    {
+        if (bLoop)
         {
-            rs->SetTexture(0, pTex);
-            rs->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, XI_AVIVIDEO_FVF, 2, v, sizeof(XI_AVIVIDEO_VERTEX), "battle_icons");
+            CleanupInterfaces();
+            if (!PlayMedia(filename.c_str()))
+            {
+                m_bContinue = false;
+            }
         }
-    }
-    else if (hr == MS_S_ENDOFSTREAM && bLoop)
-    {
-        CleanupInterfaces();
-        if(!GetInterfaces() || !PlayMedia(filename.c_str()))
+        else
         {
             m_bContinue = false;
         }
+        return;
     }
-    else
+
+    if (m_bShowVideo && m_bHaveFrame)
     {
-        m_bContinue = false;
+        rs->SetTexture(0, pTex);
+        rs->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, XI_AVIVIDEO_FVF, 2, v, sizeof(XI_AVIVIDEO_VERTEX), "battle_icons");
     }
 #else
     m_bContinue = false;
@@ -185,61 +157,19 @@ uint64_t CAviPlayer::ProcessMessage(MESSAGE &message)
 bool CAviPlayer::PlayMedia(const char *fileName)
 {
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
-    auto hr = S_OK;
-    DDSURFACEDESC ddsd;
-
-    WCHAR wPath[MAX_PATH]; // wide (32-bit) string name
-    MultiByteToWideChar(CP_ACP, 0, fileName, -1, wPath, sizeof(wPath) / sizeof(wPath[0]));
-
-    if (pAMStream == nullptr)
-        return false;
-
-    hr = pAMStream->OpenFile(wPath, 0);
-    if (FAILED(hr))
-    {
-        core.Trace("Video Error!!!(0x%8x) Can`t load video file = %s", hr, fileName);
-        return false;
-    }
-
-    hr = pAMStream->GetMediaStream(MSPID_PrimaryVideo, &pPrimaryVidStream);
-    if (FAILED(hr))
-    {
-        core.Trace("Video Error!!! Can`t get media stream");
-        return false;
-    }
-    hr = pPrimaryVidStream->QueryInterface(IID_IDirectDrawMediaStream, (void **)&pDDStream);
-    if (FAILED(hr))
-    {
-        core.Trace("Video Error!!! Can`t query interface DirectDrawMediaStream");
-        return false;
-    }
-    ddsd.dwSize = sizeof(ddsd);
-    hr = pDDStream->GetFormat(&ddsd, nullptr, nullptr, nullptr);
-    if (FAILED(hr))
-    {
-        core.Trace("Video Error!!! Can`t get stream format");
-        return false;
-    }
-    int32_t srcWidth = ddsd.dwWidth;
-    int32_t srcHeight = ddsd.dwHeight;
-    hr = pDD->CreateSurface(&ddsd, &pVideoSurface, nullptr);
-    if (FAILED(hr))
+    // the stream objects are created, used and released by the decode thread, they are never marshalled
+    const std::string file = fileName;
+    if (!m_decodeRing.start(
+            [this, file](std::chrono::steady_clock::duration &frameDuration) {
+                return OpenStream(file.c_str(), frameDuration);
+            },
+            [this](VideoFrame &frame) { return DecodeFrame(frame); }, [this] { CloseStream(); }))
     {
-        core.Trace("Video Error!!! Can`t create surface for video imaging");
         return false;
     }
 
-    lockRect.left = 0;
-    lockRect.top = 0;
-    lockRect.right = srcWidth;
-    lockRect.bottom = srcHeight;
-
-    hr = pDDStream->CreateSample(static_cast<IDirectDrawSurface *>(pVideoSurface), nullptr, 0, &pSample);
-    if (FAILED(hr))
-    {
-        core.Trace("Video Error!!! Can`t create sample for this video");
-        return false;
-    }
+    const int32_t srcWidth = lockRect.right;
+    const int32_t srcHeight = lockRect.bottom;
 
     RECT dstRect;
     GetWindowRect(static_cast<HWND>(core.GetWindow()->OSHandle()), &dstRect);
@@ -269,10 +199,11 @@ bool CAviPlayer::PlayMedia(const char *fileName)
     pd3dsurf->GetDesc(&d3d9surf_desc);
     pd3dsurf->Release();
 
-    hr = rs->CreateTexture(AVI_GetTextureSize(srcWidth), AVI_GetTextureSize(srcHeight), 1, 0, d3d9surf_desc.Format,
-                           D3DPOOL_MANAGED, &pTex);
+    auto hr = rs->CreateTexture(AVI_GetTextureSize(srcWidth), AVI_GetTextureSize(srcHeight), 1, 0,
+                                d3d9surf_desc.Format, D3DPOOL_MANAGED, &pTex);
     if (FAILED(hr))
     {
+        pTex = nullptr;
         core.Trace("Video Error!!! Can`t create texture for this video");
         return false;
     }
@@ -298,6 +229,73 @@ bool CAviPlayer::PlayMedia(const char *fileName)
     v[3].tu = static_cast<float>(lockRect.right) / AVI_GetTextureSize(srcWidth);
     v[3].tv = static_cast<float>(lockRect.bottom) / AVI_GetTextureSize(srcHeight);
 
+    m_bHaveFrame = false;
+    m_playbackStart = std::chrono::steady_clock::now();
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CAviPlayer::OpenStream(const char *fileName, std::chrono::steady_clock::duration &frameDuration)
+{
+#ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
+    // called on the decode thread
+    if (!GetInterfaces())
+        return false;
+
+    auto hr = S_OK;
+    DDSURFACEDESC ddsd;
+
+    WCHAR wPath[MAX_PATH]; // wide (32-bit) string name
+    MultiByteToWideChar(CP_ACP, 0, fileName, -1, wPath, sizeof(wPath) / sizeof(wPath[0]));
+
+    hr = pAMStream->OpenFile(wPath, 0);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!!(0x%8x) Can`t load video file = %s", hr, fileName);
+        return false;
+    }
+
+    hr = pAMStream->GetMediaStream(MSPID_PrimaryVideo, &pPrimaryVidStream);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!! Can`t get media stream");
+        return false;
+    }
+    hr = pPrimaryVidStream->QueryInterface(IID_IDirectDrawMediaStream, (void **)&pDDStream);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!! Can`t query interface DirectDrawMediaStream");
+        return false;
+    }
+    ddsd.dwSize = sizeof(ddsd);
+    hr = pDDStream->GetFormat(&ddsd, nullptr, nullptr, nullptr);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!! Can`t get stream format");
+        return false;
+    }
+    hr = pDD->CreateSurface(&ddsd, &pVideoSurface, nullptr);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!! Can`t create surface for video imaging");
+        return false;
+    }
+
+    lockRect.left = 0;
+    lockRect.top = 0;
+    lockRect.right = ddsd.dwWidth;
+    lockRect.bottom = ddsd.dwHeight;
+
+    hr = pDDStream->CreateSample(static_cast<IDirectDrawSurface *>(pVideoSurface), nullptr, 0, &pSample);
+    if (FAILED(hr))
+    {
+        core.Trace("Video Error!!! Can`t create sample for this video");
+        return false;
+    }
+
     hr = pAMStream->SetState(STREAMSTATE_RUN);
     if (FAILED(hr))
     {
@@ -305,6 +303,13 @@ bool CAviPlayer::PlayMedia(const char *fileName)
         return false;
     }
 
+    // STREAM_TIME is measured in 100ns units
+    STREAM_TIME frameTime = 0;
+    if (FAILED(pDDStream->GetTimePerFrame(&frameTime)) || frameTime <= 0)
+        frameTime = 10000000 / 25;
+    frameDuration =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(frameTime * 100));
+
     return true;
 #else
     return false;
@@ -316,8 +321,8 @@ bool CAviPlayer::GetInterfaces()
     HRESULT hr = S_OK;
 
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
-    // Initialize COM
-    if (FAILED(hr = CoInitialize(NULL)))
+    // Initialize COM for the decode thread
+    if (FAILED(hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED)))
         return false;
     m_bMakeUninitializeDD = true;
 
@@ -366,9 +371,75 @@ bool CAviPlayer::GetInterfaces()
 #endif
 }
 
+bool CAviPlayer::DecodeFrame(VideoFrame &frame)
+{
+#ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
+    // called on the decode thread
+    if (pSample == nullptr)
+        return false;
+
+    if (pSample->Update(0, nullptr, nullptr, NULL) != S_OK)
+        return false;
+
+    DDSURFACEDESC ddsd;
+    ddsd.dwSize = sizeof(ddsd);
+    if (pVideoSurface->Lock(nullptr, &ddsd, DDLOCK_WAIT | DDLOCK_READONLY, nullptr) != S_OK)
+        return false;
+
+    frame.pitch = ddsd.lPitch;
+    frame.height = ddsd.dwHeight;
+    const auto *pInData = static_cast<const char *>(ddsd.lpSurface);
+    frame.data.assign(pInData, pInData + static_cast<size_t>(frame.pitch) * frame.height);
+
+    pVideoSurface->Unlock(nullptr);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CAviPlayer::UploadFrame(const VideoFrame &frame)
+{
+    D3DLOCKED_RECT d3dlkRect;
+    if (pTex == nullptr || pTex->LockRect(0, &d3dlkRect, &lockRect, 0) != S_OK)
+        return;
+
+    auto *pOutData = static_cast<char *>(d3dlkRect.pBits);
+    const auto *pInData = frame.data.data();
+    const auto copySize = frame.pitch < d3dlkRect.Pitch ? frame.pitch : d3dlkRect.Pitch;
+    for (int32_t i = 0; i < frame.height; i++)
+    {
+        memcpy(pOutData, pInData, copySize);
+        pInData += frame.pitch;
+        pOutData += d3dlkRect.Pitch;
+    }
+
+    pTex->UnlockRect(0);
+    m_bHaveFrame = true;
+}
+
 void CAviPlayer::CleanupInterfaces()
+{
+    // the decode thread releases the stream interfaces on its way out
+    m_decodeRing.stop();
+    m_bHaveFrame = false;
+
+#ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
+    IRELEASE(pTmpRenderTarget);
+#endif
+
+    if (pTex != nullptr && rs != nullptr)
+        rs->Release(pTex);
+    pTex = nullptr;
+}
+
+void CAviPlayer::CloseStream()
 {
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
+    // called on the decode thread
+    if (pAMStream != nullptr)
+        pAMStream->SetState(STREAMSTATE_STOP);
+
     IRELEASE(pSample);
     IRELEASE(pDDStream);
     IRELEASE(pPrimaryVidStream);
@@ -378,12 +449,6 @@ void CAviPlayer::CleanupInterfaces()
     IRELEASE(pPrimarySurface);
     IRELEASE(pDD);
 
-    IRELEASE(pTmpRenderTarget);
-
-    if (pTex != nullptr && rs != nullptr)
-        rs->Release(pTex);
-    pTex = nullptr;
-
     if (m_bMakeUninitializeDD)
         CoUninitialize();
 #endif
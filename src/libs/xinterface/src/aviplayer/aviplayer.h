@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../base_video.h"
+#include "frame_ring.hpp"
+
+#include <chrono>
+#include <vector>
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
 #include <amstream.h>
 #include <ddraw.h>
@@ -56,6 +60,14 @@ class CAviPlayer : public xiBaseVideo
     }
 
   protected:
+    // video frame copied out of the stream surface by the decode thread
+    struct VideoFrame
+    {
+        std::vector<char> data;
+        int32_t pitch{};
+        int32_t height{};
+    };
+
     bool m_bContinue;
 
 #ifdef _WIN32 // FIX_LINUX ddraw.h and amstream.h
@@ -77,11 +89,21 @@ class CAviPlayer : public xiBaseVideo
     IDirect3DSurface9 *pTmpRenderTarget;
     IDirect3DTexture9 *pTex;
 
+    storm::FrameDecodeRing<VideoFrame> m_decodeRing;
+    std::chrono::steady_clock::time_point m_playbackStart;
+    bool m_bHaveFrame;
+
     void ReleaseAll();
     bool PlayMedia(const char *fileName);
-    bool GetInterfaces();
+    void UploadFrame(const VideoFrame &frame);
     void CleanupInterfaces();
 
+    // on the decode thread
+    bool OpenStream(const char *fileName, std::chrono::steady_clock::duration &frameDuration);
+    bool GetInterfaces();
+    bool DecodeFrame(VideoFrame &frame);
+    void CloseStream();
+
     bool m_bFirstDraw;
     bool m_bMakeUninitializeDD;
 
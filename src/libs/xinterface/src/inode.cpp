@@ -27,6 +27,7 @@ CINODE::CINODE()
     m_bDeleting = false;
     m_pToolTip = nullptr;
     m_bMakeActionInDeclick = false;
+    m_bRenderDirty = true;
 }
 
 CINODE::~CINODE()
@@ -198,6 +198,7 @@ class CINODE
     virtual void SetUsing(bool bUsing)
     {
         m_bUse = bUsing;
+        SetRenderDirty();
     }
 
     virtual bool IsClick(int buttonID, int32_t xPos, int32_t yPos) = 0;
@@ -331,6 +332,27 @@ class CINODE
     virtual bool CheckByToolTip(float fX, float fY);
     void ShowToolTip() const;
 
+    // retained rendering: node output depends only on its state and may be cached between frames
+    virtual bool IsStaticRender() const
+    {
+        return false;
+    }
+
+    void SetRenderDirty()
+    {
+        m_bRenderDirty = true;
+    }
+
+    bool IsRenderDirty() const
+    {
+        return m_bRenderDirty;
+    }
+
+    void ClearRenderDirty()
+    {
+        m_bRenderDirty = false;
+    }
+
     XINTERFACE_BASE *ptrOwner;
 
     VDX9RENDER *m_rs;
@@ -375,4 +397,6 @@ class CINODE
     CXI_ToolTip *m_pToolTip;
 
     bool m_bMakeActionInDeclick;
+
+    bool m_bRenderDirty;
 };
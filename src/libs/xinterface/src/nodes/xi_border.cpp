@@ -90,6 +90,7 @@ void CXI_BORDER::ChangePosition(XYRECT &rNewPos)
     }
 
     FillVertexBuffers();
+    SetRenderDirty();
 }
 
 void CXI_BORDER::SaveParametersToIni()
@@ -26,6 +26,11 @@ class CXI_BORDER : public CINODE
 
     uint32_t MessageProc(int32_t msgcode, MESSAGE &message) override;
 
+    bool IsStaticRender() const override
+    {
+        return true;
+    }
+
   protected:
     void LoadIni(INIFILE *ini1, const char *name1, INIFILE *ini2, const char *name2) override;
     void FillIndexBuffers() const;
@@ -193,6 +193,7 @@ void CXI_FORMATEDTEXT::ReleaseAll()
 
 int CXI_FORMATEDTEXT::CommandExecute(int wActCode)
 {
+    SetRenderDirty();
     if (m_bUse && !m_bFrized)
     {
         if (m_listCur == nullptr)
@@ -350,6 +351,7 @@ bool CXI_FORMATEDTEXT::IsClick(int buttonID, int32_t xPos, int32_t yPos)
 
 void CXI_FORMATEDTEXT::ChangePosition(XYRECT &rNewPos)
 {
+    SetRenderDirty();
     m_rect = rNewPos;
 
     RefreshAlignment();
@@ -780,6 +782,7 @@ void CXI_FORMATEDTEXT::GetOneLine(int fontNum, const char *pStr, char *buf, int
 
 void CXI_FORMATEDTEXT::SetFormatedText(const char *str)
 {
+    SetRenderDirty();
     // delete old lines
     while (m_listRoot != nullptr)
     {
@@ -799,6 +802,7 @@ void CXI_FORMATEDTEXT::SetFormatedText(const char *str)
 
 void CXI_FORMATEDTEXT::SetPointer(float fPos)
 {
+    SetRenderDirty();
     if (m_bSelectableCursor)
         SetVertexToNewGroup(true, FindUpGroup(static_cast<int32_t>(m_nStringGroupQuantity * fPos)),
                             FindDownGroup(static_cast<int32_t>(m_nStringGroupQuantity * fPos)));
@@ -843,8 +847,9 @@ float CXI_FORMATEDTEXT::GetCurPos() const
     return 0.f;
 }
 
-void CXI_FORMATEDTEXT::SetColor(uint32_t dwCol) const
+void CXI_FORMATEDTEXT::SetColor(uint32_t dwCol)
 {
+    SetRenderDirty();
     for (STRING_DESCRIBER *dscrTmp = m_listRoot; dscrTmp; dscrTmp = dscrTmp->next)
     {
         dscrTmp->color = dwCol;
@@ -1018,6 +1023,7 @@ void CXI_FORMATEDTEXT::MakeTagChecking(bool &tagState, uint32_t &tagColor, uint3
 
 uint32_t CXI_FORMATEDTEXT::MessageProc(int32_t msgcode, MESSAGE &message)
 {
+    SetRenderDirty();
     switch (msgcode)
     {
     case 0: // add text to the formatted list and return the number of occupied lines
@@ -1254,6 +1260,7 @@ int32_t CXI_FORMATEDTEXT::FindDownGroup(int32_t grNum)
 
 void CXI_FORMATEDTEXT::SetVertexToNewGroup(bool bUpDirect, int32_t upIdx, int32_t downIdx)
 {
+    SetRenderDirty();
     int i;
 
     if (downIdx - upIdx >= m_allStrings)
@@ -1347,6 +1354,7 @@ void CXI_FORMATEDTEXT::MouseThis(float fX, float fY)
 
 void CXI_FORMATEDTEXT::CheckScrollButtons()
 {
+    SetRenderDirty();
     const bool oldUp = m_bUpEnable;
     const bool oldDown = m_bDownEnable;
     if (m_listCur == nullptr)
@@ -1497,6 +1505,7 @@ void CXI_FORMATEDTEXT::SetCurrentGroupNum(int32_t nFirstNum, int32_t nSelectNum)
 
 void CXI_FORMATEDTEXT::ReplaceString(int32_t nGrpNum, const char *pSrcStr)
 {
+    SetRenderDirty();
     if (nGrpNum < 0)
         return;
     if (nGrpNum > m_nStringGroupQuantity)
@@ -1547,6 +1556,7 @@ void CXI_FORMATEDTEXT::ReplaceString(int32_t nGrpNum, const char *pSrcStr)
 void CXI_FORMATEDTEXT::InsertStringBefore(STRING_DESCRIBER *pNextDescr, const char *pSrcStr, int32_t nGrpNum,
                                           uint32_t dwColor)
 {
+    SetRenderDirty();
     if (!pNextDescr)
         return;
 
@@ -1598,6 +1608,7 @@ XYRECT CXI_FORMATEDTEXT::GetCursorRect()
 
 void CXI_FORMATEDTEXT::SetCurLine(STRING_DESCRIBER *pNewCurLine)
 {
+    SetRenderDirty();
     if (!pNewCurLine)
         return;
     m_listCur = pNewCurLine;
@@ -1633,6 +1644,7 @@ void CXI_FORMATEDTEXT::ScrollerUpdate()
 
 void CXI_FORMATEDTEXT::VAlignment(int32_t nAlign)
 {
+    SetRenderDirty();
     if (nAlign == 1)
     {
         if (m_nAllTextStrings > 0 && m_nAllTextStrings < m_allStrings)
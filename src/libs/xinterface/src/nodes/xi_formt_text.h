@@ -52,11 +52,16 @@ class CXI_FORMATEDTEXT : public CINODE
         return true;
     }
 
+    bool IsStaticRender() const override
+    {
+        return m_pVidTex == nullptr;
+    }
+
     void SetFormatedText(const char *str);
     void SetPointer(float fPos);
     float GetLineStep() const;
     float GetCurPos() const;
-    void SetColor(uint32_t dwCol) const;
+    void SetColor(uint32_t dwCol);
 
     int32_t GetAllHeight();
 
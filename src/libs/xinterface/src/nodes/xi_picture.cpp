@@ -156,6 +156,7 @@ void CXI_PICTURE::ChangePosition(XYRECT &rNewPos)
     m_v[2].pos.y = static_cast<float>(m_rect.top);
     m_v[3].pos.x = static_cast<float>(m_rect.right);
     m_v[3].pos.y = static_cast<float>(m_rect.bottom);
+    SetRenderDirty();
 }
 
 void CXI_PICTURE::SaveParametersToIni()
@@ -364,11 +365,13 @@ void CXI_PICTURE::ChangeUV(FXYRECT &frNewUV)
     m_v[2].tv = frNewUV.top;
     m_v[3].tu = frNewUV.right;
     m_v[3].tv = frNewUV.bottom;
+    SetRenderDirty();
 }
 
 void CXI_PICTURE::ChangeColor(uint32_t dwColor)
 {
     m_v[0].color = m_v[1].color = m_v[2].color = m_v[3].color = dwColor;
+    SetRenderDirty();
 }
 
 void CXI_PICTURE::SetPictureSize(int32_t &nWidth, int32_t &nHeight)
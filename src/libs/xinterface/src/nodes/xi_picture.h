@@ -27,6 +27,12 @@ class CXI_PICTURE : public CINODE
     void ChangePosition(XYRECT &rNewPos) override;
     void SaveParametersToIni() override;
     uint32_t MessageProc(int32_t msgcode, MESSAGE &message) override;
+
+    bool IsStaticRender() const override
+    {
+        return !m_bMakeBlind && m_pTex == nullptr;
+    }
+
     virtual void ChangeUV(FXYRECT &frNewUV);
     void ChangeColor(uint32_t dwColor);
     void SetPictureSize(int32_t &nWidth, int32_t &nHeight);
@@ -139,6 +139,7 @@ void CXI_RECTANGLE::ChangePosition(XYRECT &rNewPos)
     m_pVert[2].pos.y = static_cast<float>(m_rect.top);
     m_pVert[3].pos.x = static_cast<float>(m_rect.right);
     m_pVert[3].pos.y = static_cast<float>(m_rect.bottom);
+    SetRenderDirty();
 }
 
 void CXI_RECTANGLE::SaveParametersToIni()
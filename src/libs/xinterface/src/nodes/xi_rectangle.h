@@ -28,6 +28,11 @@ class CXI_RECTANGLE : public CINODE
         return true;
     }
 
+    bool IsStaticRender() const override
+    {
+        return true;
+    }
+
   protected:
     void LoadIni(INIFILE *ini1, const char *name1, INIFILE *ini2, const char *name2) override;
     void UpdateColors();
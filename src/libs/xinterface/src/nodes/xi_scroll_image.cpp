@@ -628,6 +628,7 @@ void CXI_SCROLLIMAGE::LoadIni(INIFILE *ini1, const char *name1, INIFILE *ini2, c
 
 float CXI_SCROLLIMAGE::ChangeDinamicParameters(float fXDelta)
 {
+    SetRenderDirty();
     if (m_Image.empty())
         return 0.f;
     int n;
@@ -886,6 +887,7 @@ void CXI_SCROLLIMAGE::ReleaseAll()
 
 int CXI_SCROLLIMAGE::CommandExecute(int wActCode)
 {
+    SetRenderDirty();
     int i;
     if (m_bUse && !m_Image.empty() && m_pScroll != nullptr)
     {
@@ -964,6 +966,7 @@ bool CXI_SCROLLIMAGE::IsClick(int buttonID, int32_t xPos, int32_t yPos)
 
 void CXI_SCROLLIMAGE::ChangePosition(XYRECT &rNewPos)
 {
+    SetRenderDirty();
     const int32_t nLeftOffset = rNewPos.left - m_rect.left;
     const int32_t nTopOffset = rNewPos.top - m_rect.top;
     const int32_t nRightOffset = rNewPos.right - m_rect.right;
@@ -1003,6 +1006,7 @@ void CXI_SCROLLIMAGE::SaveParametersToIni()
 
 void CXI_SCROLLIMAGE::ChangeScroll(int nScrollItemNum)
 {
+    SetRenderDirty();
     ATTRIBUTES *pAttr = core.Entity_GetAttributeClass(g_idInterface, m_nodeName);
     if (pAttr != nullptr)
     {
@@ -1101,6 +1105,7 @@ void CXI_SCROLLIMAGE::ChangeScroll(int nScrollItemNum)
 
 void CXI_SCROLLIMAGE::DeleteImage(int imgNum)
 {
+    SetRenderDirty();
     if (imgNum < 0 || imgNum >= m_Image.size())
         return;
     if (m_Image.size() <= m_nNotUsedQuantity)
@@ -1122,6 +1127,7 @@ void CXI_SCROLLIMAGE::DeleteImage(int imgNum)
 
 void CXI_SCROLLIMAGE::RefreshScroll()
 {
+    SetRenderDirty();
     int i, n;
     char param[256];
     // UpdateTexturesGroup();
@@ -1494,6 +1500,7 @@ XYRECT CXI_SCROLLIMAGE::GetCursorRect()
 
 void CXI_SCROLLIMAGE::UpdateTexturesGroup()
 {
+    SetRenderDirty();
     // m_sGroupName m_nGroupTex m_nGroupQuantity
     int i;
 
@@ -1585,6 +1592,7 @@ void CXI_SCROLLIMAGE::IMAGEDESCRIBE::Clear()
 
 uint32_t CXI_SCROLLIMAGE::MessageProc(int32_t msgcode, MESSAGE &message)
 {
+    SetRenderDirty();
     switch (msgcode)
     {
     case 0: // enable / disable display of the frame
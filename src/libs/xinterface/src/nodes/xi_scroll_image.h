@@ -57,6 +57,12 @@ class CXI_SCROLLIMAGE : public CINODE
     XYRECT GetCursorRect() override;
     uint32_t MessageProc(int32_t msgcode, MESSAGE &message) override;
 
+    // the selection blinks only on the current node, which is never cached
+    bool IsStaticRender() const override
+    {
+        return !m_bDoMove;
+    }
+
     void ChangeScroll(int nScrollItemNum);
     void DeleteImage(int imgNum);
     void RefreshScroll();
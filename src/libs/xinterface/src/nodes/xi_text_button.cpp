@@ -583,6 +583,7 @@ bool CXI_TEXTBUTTON::IsClick(int buttonID, int32_t xPos, int32_t yPos)
 
 void CXI_TEXTBUTTON::ChangePosition(XYRECT &rNewPos)
 {
+    SetRenderDirty();
     m_rect = rNewPos;
     FillPositionIntoVertices();
 }
@@ -605,6 +606,7 @@ void CXI_TEXTBUTTON::SaveParametersToIni()
 
 uint32_t CXI_TEXTBUTTON::MessageProc(int32_t msgcode, MESSAGE &message)
 {
+    SetRenderDirty();
     switch (msgcode)
     {
     case 0: // change the text on the button
@@ -652,6 +654,7 @@ uint32_t CXI_TEXTBUTTON::MessageProc(int32_t msgcode, MESSAGE &message)
 
 void CXI_TEXTBUTTON::SetUsing(bool bUsing)
 {
+    SetRenderDirty();
     m_bUse = bUsing;
     m_nPressedDelay = 0;
 }
@@ -34,6 +34,12 @@ class CXI_TEXTBUTTON : public CINODE
     void SetUsing(bool bUsing) override;
     void MakeLClickPreaction() override;
 
+    // while pressed it moves back by itself
+    bool IsStaticRender() const override
+    {
+        return m_nPressedDelay == 0;
+    }
+
   protected:
     void LoadIni(INIFILE *ini1, const char *name1, INIFILE *ini2, const char *name2) override;
     void FillPositionIntoVertices();
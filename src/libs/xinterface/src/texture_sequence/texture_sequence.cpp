@@ -46,6 +46,8 @@ TextureSequence::TextureSequence()
     m_AllTex = -1;
     m_bHorzFlip = false;
     m_bVertFlip = false;
+    m_renderedNum = -1;
+    m_renderedBlend = -1;
 }
 
 TextureSequence::~TextureSequence()
@@ -108,6 +110,9 @@ IDirect3DTexture9 *TextureSequence::Initialize(VDX9RENDER *pRS, const char *cTSf
     // first render
     m_curNum = 0;
     m_dwCurDeltaTime = 0;
+    m_startTime = std::chrono::steady_clock::now();
+    m_renderedNum = -1;
+    m_renderedBlend = -1;
     // ToTextureRender(0.f);
 
     return m_pTexture;
@@ -119,16 +124,20 @@ IDirect3DTexture9 *TextureSequence::Initialize(VDX9RENDER *pRS, const char *cTSf
 //-----------------------------------------------------------------------------
 bool TextureSequence::FrameUpdate()
 {
-    m_dwCurDeltaTime += core.GetRDeltaTime();
-    while (m_dwCurDeltaTime > m_dwDeltaTime)
-    {
-        m_dwCurDeltaTime -= m_dwDeltaTime;
-        m_curNum++;
-        if (m_curNum >= m_maxCurNum)
-            m_curNum = 0;
-    }
+    using namespace std::chrono;
+
+    const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - m_startTime).count();
+    m_curNum = static_cast<int32_t>((elapsed / m_dwDeltaTime) % m_maxCurNum);
+    m_dwCurDeltaTime = static_cast<uint32_t>(elapsed % m_dwDeltaTime);
+
+    // the blend factor goes to the device as 8 bit value, nothing changes between equal steps
+    const auto blend = static_cast<int32_t>(255.f * m_dwCurDeltaTime / m_dwDeltaTime);
+    if (blend == m_renderedBlend && m_curNum == m_renderedNum)
+        return true;
 
-    ToTextureRender(static_cast<float>(m_dwCurDeltaTime) / static_cast<float>(m_dwDeltaTime));
+    m_renderedNum = m_curNum;
+    m_renderedBlend = blend;
+    ToTextureRender(blend / 255.f);
     return true;
 }
 
@@ -222,6 +231,7 @@ void TextureSequence::LostRender() const
 
 void TextureSequence::RestoreRender()
 {
+    m_renderedNum = -1;
     m_pRS->CreateTexture(m_texWidth, m_texHeight, 1, D3DUSAGE_RENDERTARGET, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT,
                          &m_pTexture);
 }
@@ -2,6 +2,8 @@
 
 #include "video_texture.h"
 
+#include <chrono>
+
 //-----------------------------------------------------------------------------
 // Name: class VideoToTexture
 // Desc: play video into texture
@@ -22,6 +24,11 @@ class TextureSequence : public CVideoTexture
     int32_t m_curNum;
     uint32_t m_dwCurDeltaTime;
 
+    // sequence time comes from the clock, the texture is rendered again only when its content changes
+    std::chrono::steady_clock::time_point m_startTime;
+    int32_t m_renderedNum;
+    int32_t m_renderedBlend;
+
     int32_t m_AllTex;
 
     void ToTextureRender(float blendValue) const;
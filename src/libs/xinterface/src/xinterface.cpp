@@ -99,6 +99,12 @@ XINTERFACE::XINTERFACE()
     m_pTexture = nullptr;
     m_pPrevTexture = nullptr;
 
+    m_bRetainedRender = false;
+    m_bStaticLayerValid = false;
+    m_pStaticLayerTexture = nullptr;
+    m_nNodesRedrawn = 0;
+    m_nNodesReused = 0;
+
     m_pEvents = nullptr;
 
     m_nColumnQuantity = 15;
@@ -153,6 +159,7 @@ XINTERFACE::~XINTERFACE()
     if (m_pPrevTexture)
         pRenderService->Release(m_pPrevTexture);
     m_pTexture = m_pPrevTexture = nullptr;
+    ReleaseStaticLayer();
 
     if (pPictureService != nullptr)
     {
@@ -347,7 +354,13 @@ void XINTERFACE::Realize(uint32_t)
     pRenderService->SetTransform(D3DTS_VIEW, matv);
     pRenderService->SetTransform(D3DTS_PROJECTION, matp);
 
-    DrawNode(m_pNodes, Delta_Time, 0, 80);
+    m_nNodesRedrawn = 0;
+    m_nNodesReused = 0;
+
+    auto *pFirstNode = m_pNodes;
+    if (m_bRetainedRender && !(m_pEditor && m_pEditor->IsShowMode()))
+        pFirstNode = DrawStaticLayer(Delta_Time);
+    DrawNode(pFirstNode, Delta_Time, 0, 80);
 
     // Do mouse move
     auto *pOldNode = m_pCurNode;
@@ -464,6 +477,7 @@ uint64_t XINTERFACE::ProcessMessage(MESSAGE &message)
             auto *pNode = m_pNodes->FindNode(param.c_str());
             if (pNode != nullptr)
             {
+                pNode->SetRenderDirty();
                 auto msgCode = message.Long();
                 if (msgCode == -1)
                 {
@@ -711,7 +725,10 @@ uint64_t XINTERFACE::ProcessMessage(MESSAGE &message)
             break;
         CINODE *pNod = m_pNodes->FindNode(param.c_str());
         if (pNod != nullptr)
+        {
             pNod->m_bSelected = bSelectable;
+            pNod->SetRenderDirty();
+        }
     }
     break;
     case MSG_INTERFACE_GET_SELECTABLE: // ls
@@ -1051,6 +1068,15 @@ uint64_t XINTERFACE::ProcessMessage(MESSAGE &message)
                    pcPicTextureName, pcPicGroupName, pcPicImageName, nPicWidth, nPicHeight);
     }
     break;
+
+    case MSG_INTERFACE_GET_RENDER_STATS: // "lee"
+    {
+        if (auto *pvdat = message.ScriptVariablePointer())
+            pvdat->Set(static_cast<int32_t>(m_nNodesRedrawn));
+        if (auto *pvdat = message.ScriptVariablePointer())
+            pvdat->Set(static_cast<int32_t>(m_nNodesReused));
+    }
+    break;
     }
 
     return 0;
@@ -1126,6 +1152,7 @@ void XINTERFACE::LoadIni()
     m_fpMouseOutZoneOffset.x = ini->GetFloat(section, "mouseOutZoneWidth", 0.f);
     m_fpMouseOutZoneOffset.y = ini->GetFloat(section, "mouseOutZoneHeight", 0.f);
     m_nMouseLastClickTimeMax = ini->GetInt(section, "mouseDblClickInterval", 300);
+    m_bRetainedRender = ini->GetInt(section, "retainedRender", 0) != 0;
 
     CMatrix oldmatp;
     pRenderService->GetTransform(D3DTS_PROJECTION, (D3DMATRIX *)&oldmatp);
@@ -1901,7 +1928,7 @@ void XINTERFACE::RestoreNodeLocks(int32_t nStoreCode)
     m_aLocksArray.erase(m_aLocksArray.begin() + n);
 }
 
-void XINTERFACE::DrawNode(CINODE *nod, uint32_t Delta_Time, int32_t startPrior, int32_t endPrior) const
+void XINTERFACE::DrawNode(CINODE *nod, uint32_t Delta_Time, int32_t startPrior, int32_t endPrior)
 {
     for (; nod != nullptr; nod = nod->m_next)
     {
@@ -1911,6 +1938,8 @@ void XINTERFACE::DrawNode(CINODE *nod, uint32_t Delta_Time, int32_t startPrior,
             break;
         if (nod->m_bUse)
         {
+            m_nNodesRedrawn++;
+            nod->ClearRenderDirty();
             if (nod == m_pGlowCursorNode)
             {
                 nod->Draw(false, 0);
@@ -2553,6 +2582,155 @@ void XINTERFACE::ShowPrevTexture()
     pRenderService->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, XI_ONETEX_FVF, 30, pV, sizeof(XI_ONETEX_VERTEX));
 }
 
+CINODE *XINTERFACE::DrawStaticLayer(uint32_t Delta_Time)
+{
+    // the layer is the leading run of nodes whose picture depends on their state only
+    m_aStaticLayerCandidates.clear();
+    auto *pNod = m_pNodes;
+    for (; pNod != nullptr; pNod = pNod->m_next)
+    {
+        if (pNod->GetPriority() > 80 || !pNod->IsStaticRender() || pNod->m_list != nullptr)
+            break;
+        if (pNod == m_pCurNode || pNod == m_pGlowCursorNode)
+            break;
+        m_aStaticLayerCandidates.push_back({pNod, pNod->m_bUse});
+    }
+
+    // compositing a single node saves nothing
+    if (m_aStaticLayerCandidates.size() < 2)
+    {
+        m_bStaticLayerValid = false;
+        return m_pNodes;
+    }
+
+    auto bValid = m_bStaticLayerValid && m_pStaticLayerTexture != nullptr &&
+                  m_aStaticLayerCandidates.size() == m_aStaticLayerNodes.size();
+    for (size_t n = 0; bValid && n < m_aStaticLayerCandidates.size(); n++)
+    {
+        const auto &cur = m_aStaticLayerCandidates[n];
+        const auto &old = m_aStaticLayerNodes[n];
+        if (cur.pNode != old.pNode || cur.bUse != old.bUse || cur.pNode->IsRenderDirty())
+            bValid = false;
+    }
+
+    if (!bValid)
+    {
+        m_aStaticLayerNodes.swap(m_aStaticLayerCandidates);
+        m_bStaticLayerValid = UpdateStaticLayer(Delta_Time);
+        if (!m_bStaticLayerValid)
+            return m_pNodes;
+    }
+    else
+    {
+        for (const auto &node : m_aStaticLayerNodes)
+            if (node.bUse)
+                m_nNodesReused++;
+    }
+
+    // layer content is premultiplied by alpha
+    XI_ONETEX_VERTEX pV[4];
+    for (auto i = 0; i < 4; i++)
+    {
+        pV[i].color = 0xFFFFFFFF;
+        pV[i].pos.z = 1.f;
+    }
+    pV[0].pos.x = pV[1].pos.x = 0.f;
+    pV[2].pos.x = pV[3].pos.x = static_cast<float>(dwScreenWidth);
+    pV[0].pos.y = pV[2].pos.y = 0.f;
+    pV[1].pos.y = pV[3].pos.y = static_cast<float>(dwScreenHeight);
+    pV[0].tu = pV[1].tu = 0.f;
+    pV[2].tu = pV[3].tu = 1.f;
+    pV[0].tv = pV[2].tv = 0.f;
+    pV[1].tv = pV[3].tv = 1.f;
+
+    pRenderService->SetTexture(0, m_pStaticLayerTexture);
+    pRenderService->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, XI_ONETEX_FVF, 2, pV, sizeof(XI_ONETEX_VERTEX),
+                                    "iStaticLayer");
+
+    return pNod;
+}
+
+bool XINTERFACE::UpdateStaticLayer(uint32_t Delta_Time)
+{
+    IDirect3DSurface9 *pRenderTarget = nullptr;
+    D3DSURFACE_DESC desc;
+    if (pRenderService->GetRenderTarget(&pRenderTarget) != D3D_OK)
+        return false;
+    const auto hr = pRenderTarget->GetDesc(&desc);
+    pRenderTarget->Release();
+    if (hr != D3D_OK)
+        return false;
+
+    if (m_pStaticLayerTexture)
+    {
+        D3DSURFACE_DESC layerDesc;
+        if (pRenderService->GetLevelDesc(m_pStaticLayerTexture, 0, &layerDesc) != D3D_OK ||
+            layerDesc.Width != desc.Width || layerDesc.Height != desc.Height)
+            ReleaseStaticLayer();
+    }
+    if (!m_pStaticLayerTexture &&
+        pRenderService->CreateTexture(desc.Width, desc.Height, 1, D3DUSAGE_RENDERTARGET, D3DFMT_A8R8G8B8,
+                                      D3DPOOL_DEFAULT, &m_pStaticLayerTexture) != D3D_OK)
+    {
+        m_pStaticLayerTexture = nullptr;
+        return false;
+    }
+
+    IDirect3DSurface9 *pLayerSurface = nullptr;
+    if (m_pStaticLayerTexture->GetSurfaceLevel(0, &pLayerSurface) != D3D_OK)
+        return false;
+
+    pRenderService->EndScene();
+    pRenderService->PushRenderTarget();
+    pRenderService->SetRenderTarget(pLayerSurface, nullptr);
+    pLayerSurface->Release();
+    pRenderService->BeginScene();
+    pRenderService->Clear(0, nullptr, D3DCLEAR_TARGET, 0, 1.f, 0);
+
+    // accumulate coverage in alpha so the layer can be blended as premultiplied colour
+    pRenderService->SetRenderState(D3DRS_SEPARATEALPHABLENDENABLE, TRUE);
+    pRenderService->SetRenderState(D3DRS_SRCBLENDALPHA, D3DBLEND_ONE);
+    pRenderService->SetRenderState(D3DRS_DESTBLENDALPHA, D3DBLEND_INVSRCALPHA);
+
+    for (const auto &node : m_aStaticLayerNodes)
+    {
+        node.pNode->ClearRenderDirty();
+        if (node.bUse)
+        {
+            node.pNode->Draw(false, Delta_Time);
+            m_nNodesRedrawn++;
+        }
+    }
+
+    pRenderService->SetRenderState(D3DRS_SEPARATEALPHABLENDENABLE, FALSE);
+
+    pRenderService->EndScene();
+    pRenderService->PopRenderTarget();
+    pRenderService->BeginScene();
+
+    return true;
+}
+
+void XINTERFACE::LostRender()
+{
+    // the layer target lives in the default pool and must be gone before the device is reset
+    ReleaseStaticLayer();
+}
+
+void XINTERFACE::RestoreRender()
+{
+    // the target is created again and the nodes drawn into it on the next frame
+    m_bStaticLayerValid = false;
+}
+
+void XINTERFACE::ReleaseStaticLayer()
+{
+    if (m_pStaticLayerTexture)
+        pRenderService->Release(m_pStaticLayerTexture);
+    m_pStaticLayerTexture = nullptr;
+    m_bStaticLayerValid = false;
+}
+
 void XINTERFACE::ReleaseOld()
 {
     if (m_pEditor)
@@ -2586,6 +2764,8 @@ void XINTERFACE::ReleaseOld()
     m_pCurNode = nullptr;
     m_pContHelp = nullptr;
     m_pGlowCursorNode = nullptr;
+    m_aStaticLayerNodes.clear();
+    m_bStaticLayerValid = false;
 
     while (m_imgLists != nullptr)
     {
@@ -80,6 +80,8 @@ class XINTERFACE : public XINTERFACE_BASE
     bool Init() override;
     void Execute(uint32_t Delta_Time);
     void Realize(uint32_t Delta_Time);
+    void LostRender();
+    void RestoreRender();
     bool CreateState(ENTITY_STATE_GEN *state_gen);
     bool LoadState(ENTITY_STATE *state);
     uint64_t ProcessMessage(MESSAGE &message) override;
@@ -95,10 +97,12 @@ class XINTERFACE : public XINTERFACE_BASE
         case Stage::realize:
             Realize(delta);
             break;
-            /*case Stage::lost_render:
-              LostRender(delta); break;
-            case Stage::restore_render:
-              RestoreRender(delta); break;*/
+        case Stage::lost_render:
+            LostRender();
+            break;
+        case Stage::restore_render:
+            RestoreRender();
+            break;
         }
     }
 
@@ -236,8 +240,12 @@ class XINTERFACE : public XINTERFACE_BASE
     void ShowContextHelp();
 
     // draw function
-    void DrawNode(CINODE *nod, uint32_t Delta_Time, int32_t startPrior = 0, int32_t endPrior = 32000) const;
+    void DrawNode(CINODE *nod, uint32_t Delta_Time, int32_t startPrior = 0, int32_t endPrior = 32000);
     void ShowPrevTexture();
+    // retained rendering of the static bottom layer
+    CINODE *DrawStaticLayer(uint32_t Delta_Time);
+    bool UpdateStaticLayer(uint32_t Delta_Time);
+    void ReleaseStaticLayer();
     // initialisation function
     void LoadIni();
     void LoadDialog(const char *sFileName);
@@ -380,6 +388,23 @@ class XINTERFACE : public XINTERFACE_BASE
     IDirect3DTexture9 *m_pTexture;
     IDirect3DTexture9 *m_pPrevTexture;
 
+    // retained static layer: leading static nodes composited into an off-screen target
+    struct STATIC_LAYER_NODE
+    {
+        CINODE *pNode;
+        bool bUse;
+    };
+
+    bool m_bRetainedRender;
+    bool m_bStaticLayerValid;
+    IDirect3DTexture9 *m_pStaticLayerTexture;
+    std::vector<STATIC_LAYER_NODE> m_aStaticLayerNodes;
+    std::vector<STATIC_LAYER_NODE> m_aStaticLayerCandidates;
+
+    // per-frame render statistics
+    uint32_t m_nNodesRedrawn;
+    uint32_t m_nNodesReused;
+
     // vertex & index data
     int32_t vBuf, iBuf;
     uint32_t nVert, nIndx;
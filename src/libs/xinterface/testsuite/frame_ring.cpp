@@ -0,0 +1,226 @@
+#include "frame_ring.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+struct TestFrame
+{
+    int32_t number{-1};
+    std::vector<uint8_t> pixels;
+};
+
+// synthetic source producing numbered frames filled with their number
+class SyntheticSource
+{
+  public:
+    explicit SyntheticSource(int32_t frames) : frames_(frames)
+    {
+    }
+
+    bool operator()(TestFrame &frame)
+    {
+        if (produced_ >= frames_)
+        {
+            return false;
+        }
+        frame.number = produced_;
+        frame.pixels.assign(16, static_cast<uint8_t>(produced_));
+        ++produced_;
+        return true;
+    }
+
+  private:
+    int32_t frames_;
+    std::atomic<int32_t> produced_{0};
+};
+
+// lets the decoder through one frame at a time, so the consumer runs ahead of it
+class Gate
+{
+  public:
+    void open()
+    {
+        {
+            std::lock_guard lock(mtx_);
+            ++passes_;
+        }
+        cv_.notify_all();
+    }
+
+    void pass()
+    {
+        std::unique_lock lock(mtx_);
+        cv_.wait(lock, [this] { return passes_ > 0; });
+        --passes_;
+    }
+
+  private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    int32_t passes_{};
+};
+
+// acquires the frame with the given number once the worker has decoded it
+template <typename Ring>
+const TestFrame *acquireFrame(Ring &ring, int32_t number, std::chrono::steady_clock::duration time)
+{
+    ring.waitDecoded(number + 1);
+    return ring.acquire(time);
+}
+
+} // namespace
+
+TEST_CASE("Frame decode ring presents frames by playback time", "[xinterface]")
+{
+    storm::FrameDecodeRing<TestFrame, 4> ring;
+    SyntheticSource source(10);
+    ring.start([&source](TestFrame &frame) { return source(frame); }, 40ms);
+
+    SECTION("First frame is due immediately")
+    {
+        const auto *frame = acquireFrame(ring, 0, 0ms);
+        REQUIRE(frame != nullptr);
+        CHECK(frame->number == 0);
+        CHECK(frame->pixels[0] == 0);
+
+        // already presented
+        CHECK(ring.acquire(10ms) == nullptr);
+    }
+
+    SECTION("Frames follow the clock")
+    {
+        for (int32_t n = 0; n < 4; n++)
+        {
+            const auto *frame = acquireFrame(ring, n, n * 40ms);
+            REQUIRE(frame != nullptr);
+            CHECK(frame->number == n);
+            CHECK(frame->pixels[15] == n);
+        }
+    }
+
+    SECTION("Overdue frames are skipped")
+    {
+        REQUIRE(acquireFrame(ring, 0, 0ms) != nullptr);
+        // the ring is full
+        ring.waitDecoded(4);
+        CHECK(ring.buffered() == 4);
+        const auto *frame = ring.acquire(120ms);
+        REQUIRE(frame != nullptr);
+        CHECK(frame->number == 3);
+    }
+
+    SECTION("End of stream")
+    {
+        CHECK_FALSE(ring.finished(0ms));
+        const TestFrame *last = nullptr;
+        for (int32_t n = 0; n < 10; n++)
+        {
+            last = acquireFrame(ring, n, n * 40ms);
+            REQUIRE(last != nullptr);
+        }
+        CHECK(last->number == 9);
+        // the stream has fewer frames, so this returns at its end
+        ring.waitDecoded(11);
+        CHECK(ring.finished(400ms));
+        CHECK_FALSE(ring.finished(399ms));
+    }
+}
+
+TEST_CASE("Frame decode ring with slow decoder", "[xinterface]")
+{
+    storm::FrameDecodeRing<TestFrame, 2> ring;
+    SyntheticSource source(3);
+    Gate gate;
+    ring.start(
+        [&source, &gate](TestFrame &frame) {
+            gate.pass();
+            return source(frame);
+        },
+        1ms);
+
+    // consumer is never handed a frame twice and sees frames in order
+    int32_t last = -1;
+    for (int32_t n = 0; n < 3; n++)
+    {
+        CHECK(ring.acquire(1h) == nullptr);
+        gate.open();
+        const auto *frame = acquireFrame(ring, n, 1h);
+        REQUIRE(frame != nullptr);
+        CHECK(frame->number > last);
+        last = frame->number;
+    }
+    CHECK(last == 2);
+
+    gate.open();
+    ring.waitDecoded(4);
+    CHECK(ring.finished(1h));
+    ring.stop();
+}
+
+TEST_CASE("Frame decode ring opens and closes the stream on the worker", "[xinterface]")
+{
+    storm::FrameDecodeRing<TestFrame, 2> ring;
+    std::thread::id opened_on;
+    std::thread::id closed_on;
+    std::atomic<int32_t> closed{0};
+    std::promise<void> closing;
+    const auto open = [&opened_on](std::chrono::steady_clock::duration &frame_duration) {
+        opened_on = std::this_thread::get_id();
+        frame_duration = 40ms;
+        return true;
+    };
+    const auto close = [&closed_on, &closed, &closing] {
+        closed_on = std::this_thread::get_id();
+        ++closed;
+        closing.set_value();
+    };
+
+    SECTION("Stopped")
+    {
+        SyntheticSource source(100);
+        REQUIRE(ring.start(open, [&source](TestFrame &frame) { return source(frame); }, close));
+        CHECK(opened_on != std::this_thread::get_id());
+        // the frame duration comes from the open callback
+        REQUIRE(acquireFrame(ring, 0, 0ms) != nullptr);
+        ring.waitDecoded(2);
+        CHECK(ring.acquire(39ms) == nullptr);
+        REQUIRE(ring.acquire(40ms) != nullptr);
+        ring.stop();
+        CHECK(closed == 1);
+        CHECK(closed_on == opened_on);
+    }
+
+    SECTION("At the end of the stream")
+    {
+        SyntheticSource source(1);
+        REQUIRE(ring.start(open, [&source](TestFrame &frame) { return source(frame); }, close));
+        // the worker closes the stream by itself
+        closing.get_future().wait();
+        CHECK(closed == 1);
+        CHECK(closed_on == opened_on);
+        ring.stop();
+        CHECK(closed == 1);
+    }
+
+    SECTION("Failed to open")
+    {
+        SyntheticSource source(10);
+        CHECK_FALSE(ring.start([](std::chrono::steady_clock::duration &) { return false; },
+                               [&source](TestFrame &frame) { return source(frame); }, close));
+        CHECK(ring.finished(0ms));
+        ring.stop();
+        CHECK(closed == 1);
+        CHECK(closed_on != std::this_thread::get_id());
+    }
+}
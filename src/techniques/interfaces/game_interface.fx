@@ -384,6 +384,30 @@ technique iVideo
     }
 }
 
+technique iStaticLayer
+{
+    pass p0
+    {
+        CullMode = none;
+        FogEnable = false;
+        ZEnable = false;
+        Lighting = false;
+        AlphaBlendEnable = true;
+        AlphaTestEnable = false;
+        SrcBlend = one;
+        DestBlend = invsrcalpha;
+
+        ColorOp[0] = SelectArg1;
+        ColorArg1[0] = texture;
+
+        AlphaOp[0] = SelectArg1;
+        AlphaArg1[0] = texture;
+
+        ColorOp[1] = disable;
+        AlphaOp[1] = disable;
+    }
+}
+
 technique iScrollImages_border
 {
     pass p0